@@ -224,7 +224,8 @@ AlignedRead::FlagBits AlignedRead::compress(const Flags& flags) const noexcept
 
 AlignedRead::Flags AlignedRead::decompress(const FlagBits& flags) const noexcept
 {
-    return {flags[0], flags[1], flags[2], flags[3], flags[4], flags[5], flags[6], flags[7], flags[8], flags[9]};
+    // Flags lists multiple_segment_template first, but compress stores all_segments_in_read_aligned in bit 0
+    return {flags[1], flags[0], flags[2], flags[3], flags[4], flags[5], flags[6], flags[7], flags[8], flags[9]};
 }
 
 AlignedRead::Segment::FlagBits AlignedRead::Segment::compress(const Flags& flags)
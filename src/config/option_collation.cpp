@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <functional>
 #include <utility>
+#include <memory>
 #include <thread>
 #include <sstream>
 
@@ -318,7 +319,8 @@ ReferenceGenome make_reference(const OptionMap& options)
         }
     }
     try {
-        return octopus::make_reference(std::move(resolved_path), ref_cache_size, is_threading_allowed(options));
+        return octopus::make_reference(std::move(resolved_path), ref_cache_size, is_threading_allowed(options),
+                                       true, true, options.at("memory-map-reference").as<bool>());
     } catch (MissingFileError& e) {
         e.set_location_specified("the command line option --reference");
         throw;
@@ -726,7 +728,10 @@ ReadManager make_read_manager(const OptionMap& options)
 {
     auto read_paths = get_read_paths(options);
     const auto max_open_files = as_unsigned("max-open-read-files", options);
-    return ReadManager {std::move(read_paths), max_open_files};
+    // One handle per thread lets every thread read the same file at once
+    const auto num_threads = get_num_threads(options);
+    const auto max_handles_per_file = num_threads ? *num_threads : std::max(std::thread::hardware_concurrency(), 1u);
+    return ReadManager {std::move(read_paths), max_open_files, max_handles_per_file};
 }
 
 bool denovo_candidate_variant_discovery_enabled(const OptionMap& options)
@@ -1247,7 +1252,14 @@ auto make_variant_generator_builder(const OptionMap& options, const boost::optio
         if (is_set("assembler-mask-base-quality", options)) {
             reassembler_options.mask_threshold = as_unsigned("assembler-mask-base-quality", options);
         }
-        reassembler_options.execution_policy = get_thread_execution_policy(options);
+        // Bins are assembled on whatever helpers are idle in the thread budget, so any multithreaded run can use them
+        const auto num_threads = get_num_threads(options);
+        if (!num_threads || *num_threads > 1) {
+            reassembler_options.execution_policy = ExecutionPolicy::par;
+        }
+        if (as_unsigned("assembler-threads", options) > 0) {
+            reassembler_options.max_helpers = as_unsigned("assembler-threads", options);
+        }
         reassembler_options.num_fallbacks = as_unsigned("num-fallback-kmers", options);
         reassembler_options.fallback_interval_size = as_unsigned("fallback-kmer-gap", options);
         reassembler_options.bin_size = as_unsigned("max-region-to-assemble", options);
@@ -2029,6 +2041,16 @@ boost::optional<std::size_t> get_max_genotypes(const OptionMap& options, const s
     }
 }
 
+// The cancer caller's default max-genotypes limits cancer genotypes, so germline genotypes are only limited on request
+boost::optional<std::size_t> get_max_germline_genotypes(const OptionMap& options)
+{
+    if (options.count("max-genotypes") == 1) {
+        return as_unsigned("max-genotypes", options);
+    } else {
+        return boost::none;
+    }
+}
+
 boost::optional<std::size_t> get_max_genotype_combinations(const OptionMap& options, const std::string& caller)
 {
     if (options.count("max-genotype-combinations") == 1) {
@@ -2145,6 +2167,7 @@ CallerFactory make_caller_factory(const ReferenceGenome& reference, ReadPipe& re
             vc_builder.set_normal_sample(normals.front());
         }
         vc_builder.set_max_somatic_haplotypes(as_unsigned("max-somatic-haplotypes", options));
+        vc_builder.set_max_germline_genotypes(get_max_germline_genotypes(options));
         vc_builder.set_somatic_snv_prior(options.at("somatic-snv-prior").as<float>());
         vc_builder.set_somatic_indel_prior(options.at("somatic-indel-prior").as<float>());
         vc_builder.set_min_expected_somatic_frequency(options.at("min-expected-somatic-frequency").as<float>());
@@ -2190,6 +2213,7 @@ CallerFactory make_caller_factory(const ReferenceGenome& reference, ReadPipe& re
     const auto target_working_memory = get_target_working_memory(options);
     if (target_working_memory) vc_builder.set_target_memory_footprint(*target_working_memory);
     vc_builder.set_execution_policy(get_thread_execution_policy(options));
+    vc_builder.set_max_likelihood_helpers(as_unsigned("likelihood-threads", options));
     auto bad_region_detector = make_bad_region_detector(options, read_profile);
     if (bad_region_detector) {
         vc_builder.set_bad_region_detector(std::move(*bad_region_detector));
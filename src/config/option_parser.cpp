@@ -76,10 +76,20 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<int>()->implicit_value(0),
      "Maximum number of threads to be used. If no argument is provided unlimited threads are assumed")
     
+    ("likelihood-threads",
+     po::value<int>()->default_value(0),
+     "Maximum number of additional threads used to evaluate haplotype likelihoods within a single calling region."
+     " These are taken from the --threads budget when idle")
+    
     ("max-reference-cache-memory,X",
      po::value<MemoryFootprint>()->default_value(*parse_footprint("500MB"), "500MB"),
      "Maximum memory for cached reference sequence")
     
+    ("memory-map-reference",
+     po::bool_switch()->default_value(false),
+     "Memory map a preprocessed copy of the reference, which is written next to the reference (or to the temporary"
+     " directory if that is not writable) the first time it is used")
+    
     ("target-read-buffer-memory,B",
      po::value<MemoryFootprint>()->default_value(*parse_footprint("6GB"), "6GB"),
      "None-binding request to limit the memory of buffered read data")
@@ -409,6 +419,11 @@ OptionMap parse_options(const int argc, const char** argv)
      po::bool_switch()->default_value(false),
      "Forces all regions to be assembled")
     
+    ("assembler-threads",
+     po::value<int>()->default_value(0),
+     "Maximum number of additional threads used to assemble bins within a single calling region."
+     " These are taken from the --threads budget when idle. If zero, any idle threads are used")
+    
     ("assembler-mask-base-quality",
      po::value<int>()->default_value(10),
      "Aligned bases with quality less than this will be converted to reference before"
@@ -1148,7 +1163,7 @@ po::parsed_options run(po::command_line_parser& parser)
 void validate(const OptionMap& vm)
 {
     const std::vector<std::string> positive_int_options {
-        "threads", "mask-low-quality-tails", "mask-tails", "soft-clip-mask-threshold", "mask-soft-clipped-boundary-bases",
+        "threads", "likelihood-threads", "assembler-threads", "mask-low-quality-tails", "mask-tails", "soft-clip-mask-threshold", "mask-soft-clipped-boundary-bases",
         "min-mapping-quality", "good-base-quality", "min-good-bases", "min-read-length",
         "max-read-length", "min-base-quality", "max-variant-size",
         "num-fallback-kmers", "max-assemble-region-overlap", "assembler-mask-base-quality",
@@ -11,6 +11,8 @@
 #include <cassert>
 #include <iostream>
 #include <limits>
+#include <numeric>
+#include <string>
 
 #include "concepts/mappable.hpp"
 #include "basics/aligned_template.hpp"
@@ -28,6 +30,7 @@
 #include "utils/append.hpp"
 #include "utils/erase_if.hpp"
 #include "utils/map_utils.hpp"
+#include "utils/select_top_k.hpp"
 
 namespace octopus {
 
@@ -44,6 +47,7 @@ Caller::Caller(Components&& components, Parameters parameters)
 , likelihood_model_ {std::move(components.likelihood_model)}
 , phaser_ {std::move(components.phaser)}
 , bad_region_detector_ {std::move(components.bad_region_detector)}
+, max_likelihood_helpers_ {components.max_likelihood_helpers}
 , parameters_ {std::move(parameters)}
 {
     if (parameters_.max_haplotypes == 0) {
@@ -145,12 +149,27 @@ auto convert_to_vcf(std::deque<CallWrapper>&& calls, const VcfRecordFactory& fac
 
 } // namespace
 
-std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMeter& progress_meter) const
+boost::optional<GenomicRegion> Caller::read_region(const GenomicRegion& call_region) const
+{
+    if (candidate_generator_.requires_reads()) {
+        return expand(call_region, 100);
+    } else {
+        return boost::none;
+    }
+}
+
+std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMeter& progress_meter,
+                                   boost::optional<PrefetchedReads> prefetched_reads) const
 {
     ReadPipe::Report reads_report {};
     ReadMap reads;
     if (candidate_generator_.requires_reads()) {
-        reads = read_pipe_.get().fetch_reads(expand(call_region, 100), reads_report);
+        if (prefetched_reads) {
+            reads = std::move(prefetched_reads->reads);
+            reads_report = std::move(prefetched_reads->report);
+        } else {
+            reads = read_pipe_.get().fetch_reads(*read_region(call_region), reads_report);
+        }
         add_reads(reads, candidate_generator_);
         if (!refcalls_requested() && all_empty(reads)) {
             if (debug_log_) stream(*debug_log_) << "Stopping early as no reads found in call region " << call_region;
@@ -535,6 +554,62 @@ ExecutionPolicy Caller::exucution_policy() const noexcept
     return parameters_.execution_policy;
 }
 
+namespace {
+
+// By Jensen's inequality, the log-likelihood of a genotype is at least the mean log-likelihood of its
+// haplotypes, so the sum of the haplotype log-likelihoods is a lower bound that is additive over haplotypes.
+auto sum_log_likelihoods(const MappableBlock<IndexedHaplotype<>>& haplotypes, const std::vector<SampleName>& samples,
+                         const HaplotypeLikelihoodArray& haplotype_likelihoods)
+{
+    std::vector<double> result(haplotypes.size());
+    std::transform(std::cbegin(haplotypes), std::cend(haplotypes), std::begin(result), [&] (const auto& haplotype) {
+        double sum {0};
+        for (const auto& sample : samples) {
+            const auto& likelihoods = haplotype_likelihoods(sample, haplotype);
+            sum += std::accumulate(std::cbegin(likelihoods), std::cend(likelihoods), 0.0);
+        }
+        return sum;
+    });
+    return result;
+}
+
+} // namespace
+
+MappableBlock<Genotype<IndexedHaplotype<>>>
+Caller::generate_genotypes(const MappableBlock<IndexedHaplotype<>>& haplotypes, const unsigned ploidy,
+                           const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                           const boost::optional<std::size_t> max_genotypes) const
+{
+    const auto num_possible_genotypes = num_genotypes_noexcept(haplotypes.size(), ploidy);
+    if (!max_genotypes || (num_possible_genotypes && *num_possible_genotypes <= *max_genotypes)) {
+        return generate_all_genotypes(haplotypes, ploidy);
+    }
+    const auto haplotype_log_likelihoods = sum_log_likelihoods(haplotypes, samples_, haplotype_likelihoods);
+    const auto top_genotypes = select_top_k_multisets(haplotype_log_likelihoods, ploidy, *max_genotypes);
+    MappableBlock<Genotype<IndexedHaplotype<>>> result {mapped_region(haplotypes)};
+    result.reserve(top_genotypes.size());
+    for (const auto& haplotype_indices : top_genotypes) {
+        Genotype<IndexedHaplotype<>> genotype {ploidy};
+        for (const auto idx : haplotype_indices) genotype.emplace(haplotypes[idx]);
+        result.push_back(std::move(genotype));
+    }
+    // Ensure reference genotype is always included, helping to keep QUAL in reasonable range
+    const static auto is_hom_ref = [] (const auto& genotype) { return is_homozygous_reference(genotype); };
+    if (!result.empty() && std::none_of(std::cbegin(result), std::cend(result), is_hom_ref)) {
+        const auto reference_itr = std::find_if(std::cbegin(haplotypes), std::cend(haplotypes),
+                                                [] (const auto& haplotype) { return is_reference(haplotype); });
+        if (reference_itr != std::cend(haplotypes)) {
+            result.back() = Genotype<IndexedHaplotype<>> {ploidy, *reference_itr};
+        }
+    }
+    if (debug_log_) {
+        stream(*debug_log_) << "Generated the top " << result.size() << " of "
+                            << (num_possible_genotypes ? std::to_string(*num_possible_genotypes) : "too many to count")
+                            << " possible genotypes with ploidy " << ploidy;
+    }
+    return result;
+}
+
 Caller::GeneratorStatus
 Caller::generate_active_haplotypes(const GenomicRegion& call_region,
                                    HaplotypeGenerator& haplotype_generator,
@@ -1085,7 +1160,7 @@ Caller::make_haplotype_generator(const MappableFlatSet<Variant>& candidates,
 
 HaplotypeLikelihoodArray Caller::make_haplotype_likelihood_cache() const
 {
-    return HaplotypeLikelihoodArray {likelihood_model_, parameters_.max_haplotypes, samples_};
+    return HaplotypeLikelihoodArray {likelihood_model_, parameters_.max_haplotypes, samples_, max_likelihood_helpers_};
 }
 
 VcfRecordFactory Caller::make_record_factory(const ReadMap& reads) const
@@ -58,6 +58,7 @@ public:
         HaplotypeLikelihoodModel likelihood_model;
         Phaser phaser;
         boost::optional<BadRegionDetector> bad_region_detector = boost::none;
+        unsigned max_likelihood_helpers = 0;
     };
     
     struct Parameters
@@ -77,6 +78,13 @@ public:
     
     using ReadMap = octopus::ReadMap;
     
+    // Reads fetched for a call region ahead of calling it, e.g. on another thread
+    struct PrefetchedReads
+    {
+        ReadMap reads;
+        ReadPipe::Report report;
+    };
+    
     Caller() = delete;
     
     Caller(Components&& components, Parameters parameters);
@@ -95,7 +103,12 @@ public:
     unsigned min_callable_ploidy() const;
     unsigned max_callable_ploidy() const;
     
-    std::deque<VcfRecord> call(const GenomicRegion& call_region, ProgressMeter& progress_meter) const;
+    // The region call fetches reads from before generating candidates, if any
+    boost::optional<GenomicRegion> read_region(const GenomicRegion& call_region) const;
+    
+    // If given, reads must have been fetched from read_region(call_region)
+    std::deque<VcfRecord> call(const GenomicRegion& call_region, ProgressMeter& progress_meter,
+                               boost::optional<PrefetchedReads> reads = boost::none) const;
     
     std::vector<VcfRecord> regenotype(const std::vector<Variant>& variants, ProgressMeter& progress_meter) const;
     
@@ -134,6 +147,7 @@ private:
     HaplotypeLikelihoodModel likelihood_model_;
     Phaser phaser_;
     boost::optional<BadRegionDetector> bad_region_detector_;
+    unsigned max_likelihood_helpers_;
     Parameters parameters_;
     
     // virtual methods
@@ -150,6 +164,13 @@ protected:
     
     boost::optional<MemoryFootprint> target_max_memory() const noexcept;
     ExecutionPolicy exucution_policy() const noexcept;
+    
+    // All genotypes of the given ploidy if there are at most max_genotypes, otherwise the max_genotypes
+    // genotypes with the greatest lower bound on their likelihood, found without generating the others.
+    MappableBlock<Genotype<IndexedHaplotype<>>>
+    generate_genotypes(const MappableBlock<IndexedHaplotype<>>& haplotypes, unsigned ploidy,
+                       const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                       boost::optional<std::size_t> max_genotypes) const;
 
 private:
     virtual std::unique_ptr<Latents>
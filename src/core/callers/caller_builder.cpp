@@ -219,6 +219,12 @@ CallerBuilder& CallerBuilder::set_likelihood_model(HaplotypeLikelihoodModel mode
     return *this;
 }
 
+CallerBuilder& CallerBuilder::set_max_likelihood_helpers(const unsigned n) noexcept
+{
+    components_.max_likelihood_helpers = n;
+    return *this;
+}
+
 CallerBuilder& CallerBuilder::set_model_based_haplotype_dedup(bool use) noexcept
 {
     params_.deduplicate_haplotypes_with_caller_model = use;
@@ -257,6 +263,12 @@ CallerBuilder& CallerBuilder::set_max_somatic_haplotypes(unsigned n) noexcept
     return *this;
 }
 
+CallerBuilder& CallerBuilder::set_max_germline_genotypes(boost::optional<std::size_t> max) noexcept
+{
+    params_.max_germline_genotypes = max;
+    return *this;
+}
+
 CallerBuilder& CallerBuilder::set_somatic_snv_prior(double rate) noexcept
 {
     params_.somatic_snv_prior = rate;
@@ -403,7 +415,8 @@ Caller::Components CallerBuilder::make_components() const
         components_.haplotype_generator_builder,
         components_.likelihood_model,
         Phaser {Phaser::Config {Phaser::GenotypeMatchType::exact, params_.min_phase_score}},
-        components_.bad_region_detector
+        components_.bad_region_detector,
+        components_.max_likelihood_helpers
     };
 }
 
@@ -475,6 +488,7 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                                                           params_.min_refcall_posterior,
                                                           get_ploidies(samples, *requested_contig_, params_.ploidies),
                                                           make_population_prior_model(params_.snp_heterozygosity, params_.indel_heterozygosity),
+                                                          params_.max_genotypes,
                                                           params_.max_genotype_combinations,
                                                           params_.use_independent_genotype_priors,
                                                           params_.deduplicate_haplotypes_with_caller_model
@@ -497,6 +511,7 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                 params_.credible_mass,
                 params_.min_credible_somatic_frequency,
                 params_.max_genotypes,
+                params_.max_germline_genotypes,
                 params_.max_somatic_haplotypes,
                 params_.normal_contamination_risk,
                 params_.deduplicate_haplotypes_with_caller_model,
@@ -518,6 +533,7 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                                                     params_.min_variant_posterior,
                                                     params_.min_denovo_posterior,
                                                     params_.min_refcall_posterior,
+                                                    params_.max_genotypes,
                                                     params_.max_genotype_combinations,
                                                     params_.deduplicate_haplotypes_with_caller_model
                                                 });
@@ -549,6 +565,7 @@ CallerBuilder::CallerFactoryMap CallerBuilder::generate_factory() const
                                                     params_.max_clones,
                                                     params_.max_copy_loss,
                                                     params_.max_copy_gain,
+                                                    params_.max_genotypes,
                                                     params_.max_genotype_combinations,
                                                     params_.dropout_concentration,
                                                     params_.sample_dropout_concentrations,
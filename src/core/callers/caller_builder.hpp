@@ -70,6 +70,7 @@ public:
     CallerBuilder& set_max_genotypes(boost::optional<std::size_t> max) noexcept;
     CallerBuilder& set_max_genotype_combinations(boost::optional<std::size_t> max) noexcept;
     CallerBuilder& set_likelihood_model(HaplotypeLikelihoodModel model) noexcept;
+    CallerBuilder& set_max_likelihood_helpers(unsigned n) noexcept;
     CallerBuilder& set_model_based_haplotype_dedup(bool use) noexcept;
     CallerBuilder& set_independent_genotype_prior_flag(bool use_independent) noexcept;
     CallerBuilder& set_max_vb_seeds(unsigned n) noexcept;
@@ -78,6 +79,7 @@ public:
     CallerBuilder& add_normal_sample(SampleName normal_sample);
     CallerBuilder& set_normal_sample(SampleName normal_sample);
     CallerBuilder& set_max_somatic_haplotypes(unsigned n) noexcept;
+    CallerBuilder& set_max_germline_genotypes(boost::optional<std::size_t> max) noexcept;
     CallerBuilder& set_somatic_snv_prior(double prior) noexcept;
     CallerBuilder& set_somatic_indel_prior(double prior) noexcept;
     CallerBuilder& set_min_expected_somatic_frequency(double frequency) noexcept;
@@ -121,6 +123,7 @@ private:
         HaplotypeLikelihoodModel likelihood_model;
         Phaser phaser;
         boost::optional<BadRegionDetector> bad_region_detector = boost::none;
+        unsigned max_likelihood_helpers = 0;
     };
     
     struct Parameters
@@ -139,6 +142,7 @@ private:
         // cancer
         std::vector<SampleName> normal_samples;
         unsigned max_somatic_haplotypes;
+        boost::optional<std::size_t> max_germline_genotypes;
         double somatic_snv_prior, somatic_indel_prior;
         double min_expected_somatic_frequency;
         double credible_mass;
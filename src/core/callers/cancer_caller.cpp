@@ -55,6 +55,9 @@ CancerCaller::CancerCaller(Caller::Components&& components,
     if (parameters_.max_genotypes && *parameters_.max_genotypes == 0) {
         throw std::logic_error {"CancerCaller: max genotypes must be > 0"};
     }
+    if (parameters_.max_germline_genotypes && *parameters_.max_germline_genotypes == 0) {
+        throw std::logic_error {"CancerCaller: max germline genotypes must be > 0"};
+    }
     if (has_normal_sample()) {
         if (std::find(std::cbegin(samples_), std::cend(samples_), normal_sample()) == std::cend(samples_)) {
             throw std::invalid_argument {"CancerCaller: normal sample is not a valid sample"};
@@ -142,13 +145,25 @@ CancerCaller::infer_latents(const HaplotypeBlock& haplotypes,
     // Store any intermediate results in Latents for reuse, so the order of model evaluation matters!
     auto result = std::make_unique<Latents>(haplotypes, samples_, parameters_);
     set_model_priors(*result);
-    generate_germline_genotypes(*result, result->indexed_haplotypes_);
+    generate_germline_genotypes(*result, result->indexed_haplotypes_, haplotype_likelihoods);
     if (debug_log_) stream(*debug_log_) << "There are " << result->germline_genotypes_.size() << " candidate germline genotypes";
+    // The CNV model only depends on the germline genotypes, so if a helper thread is free it is evaluated
+    // while the germline and somatic models are fitted, and joined when its evidence is first needed.
+    // Models prime the likelihoods they are given, so the CNV model then needs its own copy.
+    HelperThreads cnv_model_helper {1};
+    const bool concurrent_cnv_model {!cnv_model_helper.empty()};
+    boost::optional<HaplotypeLikelihoodArray> cnv_model_likelihoods {};
+    if (concurrent_cnv_model) cnv_model_likelihoods = haplotype_likelihoods;
+    HelperTask<CNVModel::InferredLatents> cnv_model {std::move(cnv_model_helper), [&] () {
+        return evaluate_cnv_model(*result, concurrent_cnv_model ? *cnv_model_likelihoods : haplotype_likelihoods,
+                                  concurrent_cnv_model); }};
     evaluate_germline_model(*result, haplotype_likelihoods);
-    evaluate_cnv_model(*result, haplotype_likelihoods);
     if (haplotypes.size() > 1) {
-        fit_somatic_model(*result, haplotype_likelihoods);
+        fit_somatic_model(*result, haplotype_likelihoods, cnv_model);
         evaluate_noise_model(*result, haplotype_likelihoods);
+    }
+    join_cnv_model(*result, cnv_model);
+    if (haplotypes.size() > 1) {
         set_model_posteriors(*result);
     }
     return result;
@@ -169,7 +184,8 @@ void CancerCaller::set_cancer_genotype_prior_model(Latents& latents) const
     latents.cancer_genotype_prior_model_ = CancerGenotypePriorModel {*latents.germline_prior_model_, std::move(mutation_model)};
 }
 
-void CancerCaller::fit_somatic_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const
+void CancerCaller::fit_somatic_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                                     HelperTask<CNVModel::InferredLatents>& cnv_model) const
 {
     set_cancer_genotype_prior_model(latents);
     latents.max_evidence_somatic_model_index_ = 0;
@@ -183,8 +199,13 @@ void CancerCaller::fit_somatic_model(Latents& latents, const HaplotypeLikelihood
         if (debug_log_) stream(*debug_log_) << "There are " << latents.cancer_genotypes_.size() << " candidate cancer genotypes";
         evaluate_somatic_model(latents, haplotype_likelihoods);
         latents.somatic_model_posteriors_.push_back(latents.somatic_model_inferences_.back().approx_log_evidence);
-        if (debug_log_) stream(*debug_log_) << "Evidence for somatic model with somatic ploidy "
-                             << somatic_ploidy << " is " << latents.somatic_model_posteriors_.back();
+        if (debug_log_) {
+            const auto& vb_statistics = latents.somatic_model_inferences_.back().vb_statistics;
+            stream(*debug_log_) << "Evidence for somatic model with somatic ploidy "
+                                << somatic_ploidy << " is " << latents.somatic_model_posteriors_.back()
+                                << " (" << vb_statistics.num_iterations << " VB iterations over " << vb_statistics.num_seeds
+                                << " seeds, " << vb_statistics.num_pruned_seeds << " pruned)";
+        }
         
         if (somatic_ploidy > 1) {
             if (latents.somatic_model_inferences_.back().approx_log_evidence
@@ -194,6 +215,7 @@ void CancerCaller::fit_somatic_model(Latents& latents, const HaplotypeLikelihood
                 break;
             }
         } else {
+            join_cnv_model(latents, cnv_model);
             set_model_posteriors(latents);
             if (latents.model_posteriors_.somatic < std::max(latents.model_posteriors_.germline, latents.model_posteriors_.cnv)) {
                 break;
@@ -273,9 +295,10 @@ CancerCaller::calculate_model_posterior(const HaplotypeBlock& haplotypes,
     }
 }
 
-void CancerCaller::generate_germline_genotypes(Latents& latents, const IndexedHaplotypeBlock& haplotypes) const
+void CancerCaller::generate_germline_genotypes(Latents& latents, const IndexedHaplotypeBlock& haplotypes,
+                                               const HaplotypeLikelihoodArray& haplotype_likelihoods) const
 {
-    latents.germline_genotypes_ = generate_all_genotypes(haplotypes, parameters_.ploidy);
+    latents.germline_genotypes_ = generate_genotypes(haplotypes, parameters_.ploidy, haplotype_likelihoods, parameters_.max_germline_genotypes);
 }
 
 namespace {
@@ -510,17 +533,35 @@ void CancerCaller::evaluate_germline_model(Latents& latents, const HaplotypeLike
     latents.germline_model_inferences_ = latents.germline_model_->evaluate(latents.germline_genotypes_, pooled_likelihoods);
 }
 
-void CancerCaller::evaluate_cnv_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const
+CancerCaller::CNVModel::InferredLatents
+CancerCaller::evaluate_cnv_model(const Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                                 const bool concurrent_with_germline_model) const
 {
-    assert(!latents.germline_genotypes_.empty() && latents.germline_prior_model_);
-    auto cnv_model_priors = get_cnv_model_priors(*latents.germline_prior_model_);
+    assert(!latents.germline_genotypes_.empty());
+    // The germline prior model caches, so is not shared with a concurrently evaluated germline model
+    std::unique_ptr<GenotypePriorModel> own_germline_prior_model {};
+    if (concurrent_with_germline_model) {
+        own_germline_prior_model = make_germline_prior_model(latents.haplotypes_);
+        own_germline_prior_model->prime(latents.haplotypes_);
+    }
+    assert(own_germline_prior_model || latents.germline_prior_model_);
+    const auto& germline_prior_model = own_germline_prior_model ? *own_germline_prior_model : *latents.germline_prior_model_;
+    auto cnv_model_priors = get_cnv_model_priors(germline_prior_model);
     CNVModel::AlgorithmParameters params {};
     if (parameters_.max_vb_seeds) params.max_seeds = *parameters_.max_vb_seeds;
     params.target_max_memory = this->target_max_memory();
     params.execution_policy = this->exucution_policy();
     CNVModel cnv_model {samples_, cnv_model_priors, params};
     cnv_model.prime(latents.haplotypes_);
-    latents.cnv_model_inferences_ = cnv_model.evaluate(latents.germline_genotypes_,  haplotype_likelihoods);
+    return cnv_model.evaluate(latents.germline_genotypes_,  haplotype_likelihoods);
+}
+
+void CancerCaller::join_cnv_model(Latents& latents, HelperTask<CNVModel::InferredLatents>& cnv_model) const
+{
+    if (!latents.cnv_model_joined_) {
+        latents.cnv_model_inferences_ = cnv_model.get();
+        latents.cnv_model_joined_ = true;
+    }
 }
 
 void CancerCaller::evaluate_somatic_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const
@@ -22,6 +22,7 @@
 #include "core/models/genotype/individual_model.hpp"
 #include "core/models/genotype/subclone_model.hpp"
 #include "basics/phred.hpp"
+#include "utils/executor.hpp"
 #include "caller.hpp"
 
 namespace octopus {
@@ -62,6 +63,7 @@ public:
         SomaticMutationModel::Parameters somatic_mutation_model_params;
         double min_expected_somatic_frequency, credible_mass, min_credible_somatic_frequency;
         boost::optional<std::size_t> max_genotypes = 20000;
+        boost::optional<std::size_t> max_germline_genotypes = boost::none;
         unsigned max_somatic_haplotypes = 1;
         NormalContaminationRisk normal_contamination_risk = NormalContaminationRisk::low;
         bool deduplicate_haplotypes_with_germline_model = true;
@@ -143,7 +145,8 @@ private:
     using GermlineGenotypeProbabilityMap = std::unordered_map<GermlineGenotypeReference, double>;
     using ProbabilityVector              = std::vector<double>;
     
-    void generate_germline_genotypes(Latents& latents, const IndexedHaplotypeBlock& haplotypes) const;
+    void generate_germline_genotypes(Latents& latents, const IndexedHaplotypeBlock& haplotypes,
+                                     const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     void generate_cancer_genotypes(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     void generate_cancer_genotypes_with_clean_normal(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     void generate_cancer_genotypes_with_contaminated_normal(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
@@ -152,7 +155,9 @@ private:
     bool has_high_normal_contamination_risk(const Latents& latents) const;
     
     void evaluate_germline_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
-    void evaluate_cnv_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
+    CNVModel::InferredLatents evaluate_cnv_model(const Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                                                 bool concurrent_with_germline_model) const;
+    void join_cnv_model(Latents& latents, HelperTask<CNVModel::InferredLatents>& cnv_model) const;
     void evaluate_somatic_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     void evaluate_noise_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     
@@ -160,7 +165,8 @@ private:
     void set_model_posteriors(Latents& latents) const;
 
     void set_cancer_genotype_prior_model(Latents& latents) const;
-    void fit_somatic_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
+    void fit_somatic_model(Latents& latents, const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                           HelperTask<CNVModel::InferredLatents>& cnv_model) const;
     
     std::unique_ptr<GenotypePriorModel> make_germline_prior_model(const HaplotypeBlock& haplotypes) const;
     CNVModel::Priors get_cnv_model_priors(const GenotypePriorModel& prior_model) const;
@@ -212,6 +218,7 @@ private:
     MappableBlock<Genotype<IndexedHaplotype<>>> germline_genotypes_;
     GermlineModel::InferredLatents germline_model_inferences_;
     CNVModel::InferredLatents cnv_model_inferences_;
+    bool cnv_model_joined_ = false;
     // somatic model
     std::vector<MappableBlock<CancerGenotype<IndexedHaplotype<>>>> cancer_genotypes_;
     std::vector<SomaticModel::InferredLatents> somatic_model_inferences_;
@@ -333,7 +333,7 @@ std::unique_ptr<CellCaller::Caller::Latents>
 CellCaller::infer_latents(const HaplotypeBlock& haplotypes, const HaplotypeLikelihoodArray& haplotype_likelihoods) const
 {
     const auto indexed_haplotypes = index(haplotypes);
-    auto genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.ploidy);
+    auto genotypes = generate_genotypes(indexed_haplotypes, parameters_.ploidy, haplotype_likelihoods, parameters_.max_genotypes);
     
     if (debug_log_) stream(*debug_log_) << "There are " << genotypes.size() << " candidate genotypes";
     
@@ -343,13 +343,13 @@ CellCaller::infer_latents(const HaplotypeBlock& haplotypes, const HaplotypeLikel
     if (parameters_.max_copy_loss > 0 || parameters_.max_copy_gain > 0) {
         copy_number_change_detection_enabled = true;
         for (unsigned loss {1}; loss <= parameters_.max_copy_loss; ++loss) {
-            auto copy_loss_genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.ploidy - loss);
+            auto copy_loss_genotypes = generate_genotypes(indexed_haplotypes, parameters_.ploidy - loss, haplotype_likelihoods, parameters_.max_genotypes);
             default_ploidy_idx += copy_loss_genotypes.size();
             utils::append(std::move(copy_loss_genotypes), copy_change_genotypes);
         }
         utils::append(genotypes, copy_change_genotypes);
         for (unsigned gain {1}; gain <= parameters_.max_copy_gain; ++gain) {
-            auto copy_gain_genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.ploidy + gain);
+            auto copy_gain_genotypes = generate_genotypes(indexed_haplotypes, parameters_.ploidy + gain, haplotype_likelihoods, parameters_.max_genotypes);
             utils::append(std::move(copy_gain_genotypes), copy_change_genotypes);
         }
     }
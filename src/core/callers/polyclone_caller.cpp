@@ -628,7 +628,9 @@ PolycloneCaller::fit_sublone_model(const HaplotypeBlock& haplotypes,
         }
         auto inferences = model.evaluate(curr_genotypes, haplotype_likelihoods, std::move(hints));
         if (debug_log_) {
-            stream(*debug_log_) << "Evidence for model with clonality " << clonality << " is " << inferences.approx_log_evidence;
+            stream(*debug_log_) << "Evidence for model with clonality " << clonality << " is " << inferences.approx_log_evidence
+                                << " (" << inferences.vb_statistics.num_iterations << " VB iterations over " << inferences.vb_statistics.num_seeds
+                                << " seeds, " << inferences.vb_statistics.num_pruned_seeds << " pruned)";
             const auto max_genotype_posterior_itr = std::max_element(std::cbegin(inferences.weighted_genotype_posteriors), std::cend(inferences.weighted_genotype_posteriors));
             const std::size_t map_genotype_idx = std::distance(std::cbegin(inferences.weighted_genotype_posteriors), max_genotype_posterior_itr);
             auto debug_stream = stream(*debug_log_);
@@ -746,7 +746,7 @@ PopulationCaller::infer_latents_with_joint_model(const HaplotypeBlock& haplotype
     const model::PopulationModel model {*prior_model, {parameters_.max_genotype_combinations}, debug_log_};
     prior_model->prime(haplotypes);
     if (unique_ploidies_.size() == 1) {
-        auto genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.ploidies.front());
+        auto genotypes = generate_genotypes(indexed_haplotypes, parameters_.ploidies.front(), haplotype_likelihoods, parameters_.max_genotypes);
         if (debug_log_) stream(*debug_log_) << "There are " << genotypes.size() << " candidate genotypes";
         auto inferences = model.evaluate(samples_, haplotypes, genotypes, haplotype_likelihoods);
         return std::make_unique<Latents>(samples_, indexed_haplotypes, std::move(genotypes), std::move(inferences));
@@ -754,7 +754,7 @@ PopulationCaller::infer_latents_with_joint_model(const HaplotypeBlock& haplotype
         model::PopulationModel::GenotypeVector genotypes {};
         for (const auto ploidy : unique_ploidies_) {
             if (ploidy > 0) {
-                append(generate_all_genotypes(indexed_haplotypes, ploidy), genotypes);
+                append(generate_genotypes(indexed_haplotypes, ploidy, haplotype_likelihoods, parameters_.max_genotypes), genotypes);
             } else {
                 genotypes.push_back(Genotype<IndexedHaplotype<>> {});
             }
@@ -773,7 +773,7 @@ PopulationCaller::infer_latents_with_independence_model(const HaplotypeBlock& ha
     prior_model->prime(haplotypes);
     const model::IndependentPopulationModel model {*prior_model, debug_log_};
     if (parameters_.ploidies.size() == 1) {
-        auto genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.ploidies.front());
+        auto genotypes = generate_genotypes(indexed_haplotypes, parameters_.ploidies.front(), haplotype_likelihoods, parameters_.max_genotypes);
         if (debug_log_) stream(*debug_log_) << "There are " << genotypes.size() << " candidate genotypes";
         auto inferences = model.evaluate(samples_, genotypes, haplotype_likelihoods);
         return std::make_unique<Latents>(samples_, indexed_haplotypes, std::move(genotypes), std::move(inferences));
@@ -781,7 +781,7 @@ PopulationCaller::infer_latents_with_independence_model(const HaplotypeBlock& ha
         model::PopulationModel::GenotypeVector genotypes {};
         for (const auto ploidy : unique_ploidies_) {
             if (ploidy > 0) {
-                append(generate_all_genotypes(indexed_haplotypes, ploidy), genotypes);
+                append(generate_genotypes(indexed_haplotypes, ploidy, haplotype_likelihoods, parameters_.max_genotypes), genotypes);
             } else {
                 genotypes.push_back(Genotype<IndexedHaplotype<>> {});
             }
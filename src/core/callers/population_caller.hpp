@@ -38,7 +38,7 @@ public:
         Phred<double> min_variant_posterior, min_refcall_posterior;
         std::vector<unsigned> ploidies;
         boost::optional<CoalescentModel::Parameters> prior_model_params;
-        boost::optional<std::size_t> max_genotype_combinations;
+        boost::optional<std::size_t> max_genotypes, max_genotype_combinations;
         bool use_independent_genotype_priors = false;
         bool deduplicate_haplotypes_with_germline_model = true;
     };
@@ -378,10 +378,10 @@ TrioCaller::infer_latents(const HaplotypeBlock& haplotypes,
         const model::IndividualModel sample_model {*prior_model};
         GenotypeBlock parent_genotypes {mapped_region(haplotypes)}, empty_genotypes {mapped_region(haplotypes)};
         if (parameters_.maternal_ploidy > 0) {
-            parent_genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.maternal_ploidy);
+            parent_genotypes = generate_genotypes(indexed_haplotypes, parameters_.maternal_ploidy, haplotype_likelihoods, parameters_.max_genotypes);
             haplotype_likelihoods.prime(parameters_.trio.mother());
         } else {
-            parent_genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.paternal_ploidy);
+            parent_genotypes = generate_genotypes(indexed_haplotypes, parameters_.paternal_ploidy, haplotype_likelihoods, parameters_.max_genotypes);
             haplotype_likelihoods.prime(parameters_.trio.father());
         }
         auto sample_latents = sample_model.evaluate(parent_genotypes, haplotype_likelihoods);
@@ -406,13 +406,13 @@ TrioCaller::infer_latents(const HaplotypeBlock& haplotypes,
         TrioModel::Options {parameters_.max_genotype_combinations},
         debug_log_
     };
-    auto maternal_genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.maternal_ploidy);
+    auto maternal_genotypes = generate_genotypes(indexed_haplotypes, parameters_.maternal_ploidy, haplotype_likelihoods, parameters_.max_genotypes);
     if (parameters_.maternal_ploidy == parameters_.paternal_ploidy) {
         auto latents = model.evaluate(maternal_genotypes, haplotype_likelihoods);
         return std::make_unique<Latents>(std::move(indexed_haplotypes), std::move(maternal_genotypes),
                                          std::move(latents), parameters_.trio);
     } else {
-        auto paternal_genotypes = generate_all_genotypes(indexed_haplotypes, parameters_.paternal_ploidy);
+        auto paternal_genotypes = generate_genotypes(indexed_haplotypes, parameters_.paternal_ploidy, haplotype_likelihoods, parameters_.max_genotypes);
         if (parameters_.maternal_ploidy == parameters_.child_ploidy) {
             auto latents = model.evaluate(maternal_genotypes, paternal_genotypes,
                                           maternal_genotypes, haplotype_likelihoods);
@@ -34,7 +34,7 @@ public:
         boost::optional<CoalescentModel::Parameters> germline_prior_model_params;
         DeNovoModel::Parameters denovo_model_params;
         Phred<double> min_variant_posterior, min_denovo_posterior, min_refcall_posterior;
-        boost::optional<std::size_t> max_genotype_combinations;
+        boost::optional<std::size_t> max_genotypes, max_genotype_combinations;
         bool deduplicate_haplotypes_with_germline_model = true;
     };
     
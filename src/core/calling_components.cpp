@@ -13,6 +13,8 @@
 #include "config/config.hpp"
 #include "config/option_collation.hpp"
 #include "utils/map_utils.hpp"
+#include "utils/executor.hpp"
+#include "io/htslib_thread_pool.hpp"
 #include "logging/logging.hpp"
 #include "exceptions/user_error.hpp"
 
@@ -732,10 +734,28 @@ VcfWriter make_output_vcf_writer(const options::OptionMap& options)
     return make_vcf_writer(options::get_output_path(options));
 }
 
+void init_thread_budget(const options::OptionMap& options)
+{
+    // --likelihood-threads and --assembler-threads only cap the helpers leased from this budget
+    const auto num_threads = options::get_num_threads(options);
+    set_thread_budget(num_threads ? *num_threads : 0);
+}
+
+void init_htslib_thread_pool()
+{
+    // BGZF and CRAM decoding gets a quarter of the thread budget, leased for the whole run. The calling
+    // task pool is shrunk by the same amount, so runs with fewer than four threads decode on the
+    // calling threads as before.
+    static const HelperThreads htslib_threads {get_thread_budget() / 4};
+    io::set_htslib_thread_pool_size(htslib_threads.size());
+}
+
 } // namespace
 
 GenomeCallingComponents collate_genome_calling_components(const options::OptionMap& options)
 {
+    init_thread_budget(options);
+    init_htslib_thread_pool(); // before any htslib files are opened
     auto reference    = options::make_reference(options);
     auto read_manager = options::make_read_manager(options);
     // Check this here to avoid creating output file on error
@@ -83,6 +83,13 @@ std::vector<std::string> ConditionalThresholdVariantCallFilter::get_failing_vcf_
     return result;
 }
 
+std::vector<VariantCallFilter::ClassificationList>
+ConditionalThresholdVariantCallFilter::classify_block(const MeasureBlock& measures, const std::size_t num_calls, const SampleList& samples) const
+{
+    // The thresholds used depend on each call's chooser measures, so classify call by call
+    return SinglePassVariantCallFilter::classify_block(measures, num_calls, samples);
+}
+
 std::size_t ConditionalThresholdVariantCallFilter::choose_filter(const MeasureVector& measures) const
 {
     const MeasureVector chooser_measures(std::prev(std::cend(measures), num_chooser_measures_), std::cend(measures));
@@ -52,6 +52,7 @@ private:
     virtual bool passes_all_hard_filters(const MeasureVector& measures) const override;
     virtual bool passes_all_soft_filters(const MeasureVector& measures) const override;
     virtual std::vector<std::string> get_failing_vcf_filter_keys(const MeasureVector& measures) const override;
+    virtual std::vector<ClassificationList> classify_block(const MeasureBlock& measures, std::size_t num_calls, const SampleList& samples) const override;
     
     std::size_t choose_filter(const MeasureVector& measures) const;
     bool passes_all_hard_filters(const MeasureVector& measures, MeasureIndexRange range) const;
@@ -128,9 +128,26 @@ void DoublePassVariantCallFilter::record(const VcfRecord& call, const MeasureVec
 void DoublePassVariantCallFilter::record(const CallBlock& block, const MeasureBlock& measures, std::size_t record_idx,
                                          const VcfHeader& dest_header, const SampleList& samples, OptionalVcfWriter& annotated_vcf) const
 {
-    assert(measures.size() == block.size());
-    for (auto tup : boost::combine(block, measures)) {
-        record(tup.get<0>(), tup.get<1>(), record_idx++, dest_header, samples, annotated_vcf);
+    assert(measures.size() == measures_.size());
+    record_block(record_idx, measures, block.size(), samples.size());
+    for (std::size_t call_idx {0}; call_idx < block.size(); ++call_idx) {
+        if (annotated_vcf) {
+            VcfRecord::Builder annotation_builder {block[call_idx]};
+            annotate(annotation_builder, get_call_measures(measures, call_idx), dest_header);
+            *annotated_vcf << annotation_builder.build_once();
+        }
+        log_progress(mapped_region(block[call_idx]));
+    }
+}
+
+void DoublePassVariantCallFilter::record_block(const std::size_t first_call_idx, const MeasureBlock& measures,
+                                               const std::size_t num_calls, const std::size_t num_samples) const
+{
+    for (std::size_t call_idx {0}; call_idx < num_calls; ++call_idx) {
+        for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
+            this->record(first_call_idx + call_idx, sample_idx,
+                         get_sample_measures(measures, call_idx, sample_idx, requires_aggregated_allele_measures()));
+        }
     }
 }
 
@@ -42,6 +42,9 @@ protected:
     
     const Path& temp_directory() const noexcept;
     
+    // Records each sample of each call in the block. Records the sample measures of each call by default.
+    virtual void record_block(std::size_t first_call_idx, const MeasureBlock& measures, std::size_t num_calls, std::size_t num_samples) const;
+    
 private:
     using OptionalVcfWriter = boost::optional<VcfWriter>;
     
@@ -0,0 +1,197 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "flat_forest.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <future>
+#include <cmath>
+#include <cassert>
+
+#include "ranger/Forest.h"
+#include "ranger/utility.h"
+
+#include "utils/executor.hpp"
+
+namespace octopus { namespace csr {
+
+namespace {
+
+class MalformedForest : public std::runtime_error
+{
+public:
+    MalformedForest(const FlatForest::Path& file, const std::string& reason)
+    : std::runtime_error {"Bad forest file " + file.string() + ": " + reason}
+    {}
+};
+
+} // namespace
+
+constexpr std::uint32_t FlatForest::terminal_;
+
+FlatForest::FlatForest(const Path& ranger_forest)
+: nodes_ {}
+, roots_ {}
+, terminal_probabilities_ {}
+, feature_names_ {}
+, is_ordered_feature_ {}
+, class_values_ {}
+{
+    std::ifstream file {ranger_forest.string(), std::ios::binary};
+    if (!file.good()) throw MalformedForest {ranger_forest, "could not open file"};
+    ranger::Forest::MetaInfo meta {};
+    ranger::read_meta(file, meta);
+    feature_names_ = std::move(meta.independent_variable_names);
+    if (feature_names_.empty()) throw MalformedForest {ranger_forest, "no independent variables"};
+    if (meta.ordered_variable_indicators.size() != feature_names_.size()) {
+        throw MalformedForest {ranger_forest, "bad ordered variable indicators"};
+    }
+    is_ordered_feature_.assign(std::cbegin(meta.ordered_variable_indicators), std::cend(meta.ordered_variable_indicators));
+    ranger::TreeType tree_type;
+    file.read((char*) &tree_type, sizeof(tree_type));
+    if (tree_type != ranger::TREE_PROBABILITY) throw MalformedForest {ranger_forest, "not a probability forest"};
+    ranger::readVector1D(class_values_, file);
+    if (class_values_.empty()) throw MalformedForest {ranger_forest, "no classes"};
+    roots_.reserve(meta.num_trees);
+    for (std::size_t tree_idx {0}; tree_idx < meta.num_trees; ++tree_idx) {
+        std::vector<std::vector<std::size_t>> child_node_ids;
+        ranger::readVector2D(child_node_ids, file);
+        std::vector<std::size_t> split_var_ids;
+        ranger::readVector1D(split_var_ids, file);
+        std::vector<double> split_values;
+        ranger::readVector1D(split_values, file);
+        std::vector<std::size_t> terminal_nodes;
+        ranger::readVector1D(terminal_nodes, file);
+        std::vector<std::vector<double>> terminal_class_counts;
+        ranger::readVector2D(terminal_class_counts, file);
+        if (!file.good()) throw MalformedForest {ranger_forest, "truncated file"};
+        if (child_node_ids.size() != 2 || child_node_ids[0].size() != child_node_ids[1].size()
+            || split_var_ids.size() != child_node_ids[0].size() || split_values.size() != child_node_ids[0].size()
+            || terminal_nodes.size() != terminal_class_counts.size()) {
+            throw MalformedForest {ranger_forest, "bad tree " + std::to_string(tree_idx)};
+        }
+        const auto num_nodes = child_node_ids[0].size();
+        std::vector<const std::vector<double>*> node_class_counts(num_nodes, nullptr);
+        for (std::size_t i {0}; i < terminal_nodes.size(); ++i) {
+            if (terminal_nodes[i] >= num_nodes || terminal_class_counts[i].size() > class_values_.size()) {
+                throw MalformedForest {ranger_forest, "bad terminal node in tree " + std::to_string(tree_idx)};
+            }
+            node_class_counts[terminal_nodes[i]] = &terminal_class_counts[i];
+        }
+        const auto tree_offset = nodes_.size();
+        roots_.push_back(tree_offset);
+        for (std::size_t node {0}; node < num_nodes; ++node) {
+            const auto left = child_node_ids[0][node], right = child_node_ids[1][node];
+            if (left == 0 && right == 0) {
+                nodes_.push_back({0, terminal_, static_cast<std::uint32_t>(terminal_probabilities_.size()), 0});
+                const auto first_probability = terminal_probabilities_.size();
+                terminal_probabilities_.resize(first_probability + class_values_.size(), 0.0);
+                if (node_class_counts[node]) {
+                    std::copy(std::cbegin(*node_class_counts[node]), std::cend(*node_class_counts[node]),
+                              std::next(std::begin(terminal_probabilities_), first_probability));
+                }
+            } else {
+                if (left >= num_nodes || right >= num_nodes || split_var_ids[node] >= feature_names_.size()) {
+                    throw MalformedForest {ranger_forest, "bad split in tree " + std::to_string(tree_idx)};
+                }
+                nodes_.push_back({split_values[node], static_cast<std::uint32_t>(split_var_ids[node]),
+                                  static_cast<std::uint32_t>(tree_offset + left),
+                                  static_cast<std::uint32_t>(tree_offset + right)});
+            }
+        }
+    }
+    nodes_.shrink_to_fit();
+    terminal_probabilities_.shrink_to_fit();
+}
+
+std::size_t FlatForest::num_trees() const noexcept
+{
+    return roots_.size();
+}
+
+std::size_t FlatForest::num_features() const noexcept
+{
+    return feature_names_.size();
+}
+
+std::size_t FlatForest::num_classes() const noexcept
+{
+    return class_values_.size();
+}
+
+const std::vector<std::string>& FlatForest::feature_names() const noexcept
+{
+    return feature_names_;
+}
+
+const std::vector<double>& FlatForest::class_values() const noexcept
+{
+    return class_values_;
+}
+
+std::vector<double> FlatForest::predict(const std::vector<double>& rows, const unsigned max_threads) const
+{
+    if (rows.size() % num_features() != 0) {
+        throw std::invalid_argument {"FlatForest: rows must contain num_features values each"};
+    }
+    static constexpr std::size_t min_rows_per_thread {256};
+    const auto num_rows = rows.size() / num_features();
+    std::vector<double> result(num_rows * num_classes());
+    const auto max_tasks = std::max(std::min(static_cast<std::size_t>(max_threads), num_rows / min_rows_per_thread), std::size_t {1});
+    const HelperThreads helpers {max_tasks - 1};
+    const auto num_tasks = helpers.size() + 1;
+    const auto rows_per_task = (num_rows + num_tasks - 1) / num_tasks;
+    std::vector<std::future<void>> tasks {};
+    tasks.reserve(num_tasks - 1);
+    for (std::size_t task {1}; task < num_tasks; ++task) {
+        const auto first_row = std::min(task * rows_per_task, num_rows);
+        const auto task_rows = std::min(rows_per_task, num_rows - first_row);
+        tasks.push_back(helpers.push([this, &rows, &result, first_row, task_rows] () {
+            predict(rows.data() + first_row * num_features(), task_rows, result.data() + first_row * num_classes());
+        }));
+    }
+    predict(rows.data(), std::min(rows_per_task, num_rows), result.data());
+    for (auto& task : tasks) task.get();
+    return result;
+}
+
+// private methods
+
+std::size_t FlatForest::find_terminal(std::size_t node, const double* row) const noexcept
+{
+    // Same traversal as ranger::Tree::predict
+    while (nodes_[node].feature != terminal_) {
+        const auto& split = nodes_[node];
+        const auto value = row[split.feature];
+        if (is_ordered_feature_[split.feature]) {
+            node = value <= split.split_value ? split.left : split.right;
+        } else {
+            const auto factor_id = static_cast<std::size_t>(std::floor(value) - 1);
+            const auto split_id = static_cast<std::size_t>(std::floor(split.split_value));
+            node = !(split_id & (1ULL << factor_id)) ? split.left : split.right;
+        }
+    }
+    return nodes_[node].left;
+}
+
+void FlatForest::predict(const double* row, const std::size_t num_rows, double* result) const noexcept
+{
+    const auto num_classes = this->num_classes();
+    for (std::size_t i {0}; i < num_rows; ++i, row += num_features(), result += num_classes) {
+        // Sum in tree order then average, as ranger::ForestProbability does
+        for (const auto root : roots_) {
+            const auto probabilities = terminal_probabilities_.data() + find_terminal(root, row);
+            for (std::size_t k {0}; k < num_classes; ++k) {
+                result[k] += probabilities[k];
+            }
+        }
+        for (std::size_t k {0}; k < num_classes; ++k) {
+            result[k] /= num_trees();
+        }
+    }
+}
+
+} // namespace csr
+} // namespace octopus
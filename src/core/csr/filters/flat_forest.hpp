@@ -0,0 +1,73 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef flat_forest_hpp
+#define flat_forest_hpp
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/filesystem/path.hpp>
+
+namespace octopus { namespace csr {
+
+/*
+ FlatForest is an inference-only copy of a ranger probability forest (i.e. a .forest file).
+ 
+ The nodes of every tree are stored in one contiguous array, and the class probabilities of the
+ terminal nodes in another, so prediction does not need any of ranger's training data structures.
+ Predictions are identical to ranger::ForestProbability.
+ */
+class FlatForest
+{
+public:
+    using Path = boost::filesystem::path;
+    
+    FlatForest() = delete;
+    
+    FlatForest(const Path& ranger_forest);
+    
+    FlatForest(const FlatForest&)            = default;
+    FlatForest& operator=(const FlatForest&) = default;
+    FlatForest(FlatForest&&)                 = default;
+    FlatForest& operator=(FlatForest&&)      = default;
+    
+    ~FlatForest() = default;
+    
+    std::size_t num_trees() const noexcept;
+    std::size_t num_features() const noexcept;
+    std::size_t num_classes() const noexcept;
+    const std::vector<std::string>& feature_names() const noexcept;
+    const std::vector<double>& class_values() const noexcept;
+    
+    // rows is row-major with num_features() values per row. The result is row-major with num_classes()
+    // probabilities per row. Rows are split between up to max_threads threads, as the thread budget allows.
+    std::vector<double> predict(const std::vector<double>& rows, unsigned max_threads = 1) const;
+
+private:
+    struct Node
+    {
+        double split_value;
+        std::uint32_t feature;
+        std::uint32_t left, right; // for terminal nodes left is the offset of the class probabilities
+    };
+    
+    static constexpr std::uint32_t terminal_ {static_cast<std::uint32_t>(-1)};
+    
+    std::vector<Node> nodes_;
+    std::vector<std::size_t> roots_;
+    std::vector<double> terminal_probabilities_;
+    std::vector<std::string> feature_names_;
+    std::vector<char> is_ordered_feature_;
+    std::vector<double> class_values_;
+    
+    std::size_t find_terminal(std::size_t node, const double* row) const noexcept;
+    void predict(const double* first_row, std::size_t num_rows, double* result) const noexcept;
+};
+
+} // namespace csr
+} // namespace octopus
+
+#endif
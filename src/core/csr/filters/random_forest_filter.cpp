@@ -10,13 +10,15 @@
 #include <iostream>
 #include <cassert>
 #include <cmath>
-#include <limits>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
 
 #include <boost/variant.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem/operations.hpp>
 
-#include "ranger/ForestProbability.h"
+#include "ranger/Forest.h"
 
 #include "utils/concat.hpp"
 #include "utils/append.hpp"
@@ -111,6 +113,40 @@ auto concat(const std::vector<std::vector<MeasureWrapper>>& measures)
     return result;
 }
 
+class MalformedForestFile : public MalformedFileError
+{
+    std::string do_where() const override { return "RandomForestFilter"; }
+    std::string do_help() const override
+    {
+        return "make sure the forest was trained with the same measures and in the same order as the prediction measures";
+    }
+public:
+    MalformedForestFile(boost::filesystem::path file) : MalformedFileError {std::move(file)} {}
+};
+
+std::vector<FlatForest> load_forests(const std::vector<RandomForestFilter::Path>& forest_paths)
+{
+    std::vector<FlatForest> result {};
+    result.reserve(forest_paths.size());
+    for (const auto& path : forest_paths) {
+        try {
+            result.emplace_back(path);
+        } catch (const std::runtime_error& e) {
+            throw MalformedForestFile {path};
+        }
+    }
+    return result;
+}
+
+std::size_t get_false_class_index(const FlatForest& forest, const RandomForestFilter::Path& forest_path)
+{
+    // Forests are trained with TP = 1 for true calls and TP = 0 for false calls
+    const auto& class_values = forest.class_values();
+    const auto itr = std::find(std::cbegin(class_values), std::cend(class_values), 0.0);
+    if (itr == std::cend(class_values)) throw MalformedForestFile {forest_path};
+    return std::distance(std::cbegin(class_values), itr);
+}
+
 } // namespace
 
 RandomForestFilter::RandomForestFilter(FacetFactory facet_factory,
@@ -127,20 +163,31 @@ RandomForestFilter::RandomForestFilter(FacetFactory facet_factory,
                                concat(concat(forest_measures), chooser_measures),
                                std::move(output_config), threading, std::move(temp_directory), progress}
 , forest_paths_ {std::move(ranger_forests)}
+, forests_ {load_forests(forest_paths_)}
+, false_class_indices_ {}
 , chooser_ {std::move(chooser)}
 , forest_measure_info_ {}
 , num_chooser_measures_ {chooser_measures.size()}
 , options_ {std::move(options)}
 , threading_ {threading}
+, num_samples_ {0}
 , num_records_ {0}
-, data_buffer_ {}
+, pending_rows_ {}
+, predictions_ {}
 {
-    forest_measure_info_.reserve(ranger_forests.size());
+    forest_measure_info_.reserve(forest_paths_.size());
     std::size_t index {0};
     for (const auto& measures : forest_measures) {
         forest_measure_info_.push_back({index, measures.size()});
         index += measures.size();
     }
+    false_class_indices_.reserve(forests_.size());
+    for (std::size_t forest_idx {0}; forest_idx < forests_.size(); ++forest_idx) {
+        if (forests_[forest_idx].num_features() != forest_measure_info_[forest_idx].number) {
+            throw MalformedForestFile {forest_paths_[forest_idx]};
+        }
+        false_class_indices_.push_back(get_false_class_index(forests_[forest_idx], forest_paths_[forest_idx]));
+    }
 }
 
 std::string RandomForestFilter::do_name() const
@@ -151,11 +198,6 @@ std::string RandomForestFilter::do_name() const
 const std::string RandomForestFilter::genotype_quality_name_ = "RFGQ";
 const std::string RandomForestFilter::call_quality_name_ = "RFGQ_ALL";
 
-std::unique_ptr<ranger::Forest> RandomForestFilter::make_forest() const
-{
-    return std::make_unique<ranger::ForestProbability>();
-}
-
 boost::optional<std::string> RandomForestFilter::genotype_quality_name() const
 {
     return genotype_quality_name_;
@@ -189,37 +231,14 @@ std::int8_t RandomForestFilter::choose_forest(const MeasureVector& measures) con
     return chooser_(chooser_measures);
 }
 
-template <typename T>
-static void write_line(const std::vector<T>& data, std::ostream& out)
-{
-    std::copy(std::cbegin(data), std::prev(std::cend(data)), std::ostream_iterator<T> {out, " "});
-    out << data.back() << '\n';
-}
-
 void RandomForestFilter::prepare_for_registration(const SampleList& samples) const
 {
-    const auto num_forests = forest_paths_.size();
-    data_.resize(num_forests);
-    for (std::size_t forest_idx {0}; forest_idx < num_forests; ++forest_idx) {
-        const auto& info = forest_measure_info_[forest_idx];
-        std::vector<std::string> data_header {};
-        const auto first_measure = std::next(std::cbegin(measures_), info.start_index);
-        data_header.reserve(info.number + 1);
-        std::transform(first_measure, std::next(first_measure, info.number),
-                       std::back_inserter(data_header), [] (const auto& measure) { return measure.name(); });
-        data_header.push_back("TP");
-        data_[forest_idx].reserve(samples.size());
-        for (const auto& sample : samples) {
-            auto data_path = temp_directory();
-            Path fname {"octopus_ranger_temp_forest_data_" + std::to_string(forest_idx) + "_" + sample + ".dat"};
-            data_path /= fname;
-            data_[forest_idx].emplace_back(data_path.string(), data_path);
-            write_line(data_header, data_[forest_idx].back().handle);
-        }
+    num_samples_ = samples.size();
+    pending_rows_.resize(forests_.size());
+    for (std::size_t forest_idx {0}; forest_idx < forests_.size(); ++forest_idx) {
+        pending_rows_[forest_idx].features.reserve(max_pending_rows_ * forests_[forest_idx].num_features());
+        pending_rows_[forest_idx].prediction_indices.reserve(max_pending_rows_);
     }
-    data_buffer_.resize(num_forests);
-    for (auto& buffer : data_buffer_) buffer.resize(samples.size());
-    choices_.resize(samples.size());
 }
 
 namespace {
@@ -275,138 +294,152 @@ class NanMeasure : public ProgramError
     std::string do_help() const override { return "submit an error report"; }
 };
 
-void check_nan(const std::vector<double>& values)
+template <typename ForwardIt>
+void check_nan(ForwardIt first, ForwardIt last)
 {
-    if (std::any_of(std::cbegin(values), std::cend(values), [] (auto v) { return std::isnan(v); })) {
+    if (std::any_of(first, last, [] (auto v) { return std::isnan(v); })) {
         throw NanMeasure {};
     }
 }
 
-void skip_lines(std::istream& in, int n = 1)
+// Forests have always been trained on, and used to predict from, text data files written with the default
+// stream precision, so round features in the same way to make the same splits.
+double round_to_data_file_precision(const double value)
 {
-    for (; n > 0; --n) in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return std::strtod(buffer, nullptr);
 }
 
+struct ColumnDoubleVisitor : boost::static_visitor<double>
+{
+    ColumnDoubleVisitor(const MeasureWrapper& measure, std::size_t call_idx, std::size_t sample_idx)
+    : measure_ {measure}, call_idx_ {call_idx}, sample_idx_ {sample_idx} {}
+    double operator()(const Measure::Array<Measure::ResultType>& values) const
+    {
+        return cast_to_double(get_sample_value(values[call_idx_], measure_, sample_idx_, true), measure_);
+    }
+    template <typename T>
+    double operator()(const Measure::TypedColumn<T>& column) const
+    {
+        auto idx = call_idx_ * column.values_per_call;
+        if (is_per_sample(measure_.cardinality())) idx += sample_idx_;
+        if (!column.missing.empty() && column.missing[idx]) {
+            return MeasureDoubleVisitor::default_missing_values;
+        } else {
+            return lexical_cast_to_double(T {column.values[idx]});
+        }
+    }
+private:
+    const MeasureWrapper& measure_;
+    std::size_t call_idx_, sample_idx_;
+};
+
 } // namespace
 
+void RandomForestFilter::add_records(const std::size_t num_records) const
+{
+    if (num_records > num_records_) {
+        num_records_ = num_records;
+        predictions_.resize(num_records_ * num_samples_);
+    }
+}
+
+void RandomForestFilter::add_pending_row(const std::size_t forest_idx, const std::size_t first_feature,
+                                         const std::size_t call_idx, const std::size_t sample_idx) const
+{
+    auto& pending = pending_rows_[forest_idx];
+    check_nan(std::next(std::cbegin(pending.features), first_feature), std::cend(pending.features));
+    pending.prediction_indices.push_back(call_idx * num_samples_ + sample_idx);
+    if (pending.prediction_indices.size() == max_pending_rows_) {
+        predict_pending(forest_idx);
+    }
+}
+
 void RandomForestFilter::record(const std::size_t call_idx, std::size_t sample_idx, MeasureVector measures) const
 {
     assert(!measures.empty());
     const auto forest_idx = choose_forest(measures);
-    const auto num_forests = static_cast<std::remove_const_t<decltype(forest_idx)>>(data_buffer_.size());
+    const auto num_forests = static_cast<std::remove_const_t<decltype(forest_idx)>>(forests_.size());
+    add_records(call_idx + 1);
     if (forest_idx >= 0 && forest_idx < num_forests) {
-        auto& buffer = data_buffer_[forest_idx][sample_idx];
+        auto& pending = pending_rows_[forest_idx];
         const auto& info = forest_measure_info_[forest_idx];
         const auto first_measure = std::next(std::cbegin(measures), info.start_index);
-        buffer.reserve(info.number);
+        const auto first_feature = pending.features.size();
         std::transform(first_measure, std::next(first_measure, info.number),
                        std::next(std::cbegin(this->measures_), info.start_index),
-                       std::back_inserter(buffer), cast_to_double);
-        buffer.push_back(0); // dummy TP value
-        check_nan(buffer);
-        write_line(buffer, data_[forest_idx][sample_idx].handle);
-        buffer.clear();
+                       std::back_inserter(pending.features),
+                       [] (const auto& value, const auto& measure) { return round_to_data_file_precision(cast_to_double(value, measure)); });
+        add_pending_row(forest_idx, first_feature, call_idx, sample_idx);
     } else {
         hard_filtered_record_indices_.push_back(call_idx);
     }
-    if (call_idx >= num_records_) ++num_records_;
-    choices_[sample_idx].push_back(forest_idx);
 }
 
-void RandomForestFilter::close_data_files() const
+void RandomForestFilter::record_block(const std::size_t first_call_idx, const MeasureBlock& measures,
+                                      const std::size_t num_calls, const std::size_t num_samples) const
 {
-    for (auto& forest : data_) {
-        for (auto& sample : forest) {
-            sample.handle.close();
+    assert(num_samples == num_samples_);
+    const auto num_forests = static_cast<std::int8_t>(forests_.size());
+    const auto first_chooser_measure = this->measures_.size() - num_chooser_measures_;
+    add_records(first_call_idx + num_calls);
+    MeasureVector chooser_measures(num_chooser_measures_);
+    for (std::size_t call_idx {0}; call_idx < num_calls; ++call_idx) {
+        for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
+            for (std::size_t i {0}; i < num_chooser_measures_; ++i) {
+                const auto measure_idx = first_chooser_measure + i;
+                chooser_measures[i] = get_sample_value(get_column(measures, measure_idx), this->measures_[measure_idx], call_idx, sample_idx, true);
+            }
+            const auto forest_idx = chooser_(chooser_measures);
+            if (forest_idx >= 0 && forest_idx < num_forests) {
+                // Features are read straight from the measure columns
+                auto& pending = pending_rows_[forest_idx];
+                const auto& info = forest_measure_info_[forest_idx];
+                const auto first_feature = pending.features.size();
+                for (auto measure_idx = info.start_index; measure_idx < info.start_index + info.number; ++measure_idx) {
+                    ColumnDoubleVisitor vis {this->measures_[measure_idx], call_idx, sample_idx};
+                    pending.features.push_back(round_to_data_file_precision(boost::apply_visitor(vis, get_column(measures, measure_idx))));
+                }
+                add_pending_row(forest_idx, first_feature, first_call_idx + call_idx, sample_idx);
+            } else {
+                hard_filtered_record_indices_.push_back(first_call_idx + call_idx);
+            }
         }
     }
 }
 
-namespace {
-
-bool read_header(std::ifstream& prediction_file)
-{
-    skip_lines(prediction_file);
-    std::string order;
-    std::getline(prediction_file, order);
-    skip_lines(prediction_file);
-    return order.front() == '1';
-}
-
-static double get_prob_false(std::string& prediction_line, const bool tp_first)
+unsigned RandomForestFilter::max_prediction_threads() const noexcept
 {
-    using std::cbegin; using std::cend;
-    if (tp_first) {
-        prediction_line.erase(cbegin(prediction_line), std::next(std::find(cbegin(prediction_line), cend(prediction_line), ' ')));
-        prediction_line.erase(std::find(cbegin(prediction_line), cend(prediction_line), ' '), cend(prediction_line));
+    if (threading_.max_threads) {
+        return std::max(*threading_.max_threads, 1u);
     } else {
-        prediction_line.erase(std::find(cbegin(prediction_line), cend(prediction_line), ' '), cend(prediction_line));
+        return std::max(std::thread::hardware_concurrency(), 1u);
     }
-    return boost::lexical_cast<double>(prediction_line);
 }
-    
-} // namespace
 
-class MalformedForestFile : public MalformedFileError
+void RandomForestFilter::predict_pending(const std::size_t forest_idx) const
 {
-    std::string do_where() const override { return "RandomForestFilter"; }
-    std::string do_help() const override
-    {
-        return "make sure the forest was trained with the same measures and in the same order as the prediction measures";
+    auto& pending = pending_rows_[forest_idx];
+    if (pending.prediction_indices.empty()) return;
+    const auto& forest = forests_[forest_idx];
+    const auto probabilities = forest.predict(pending.features, max_prediction_threads());
+    const auto num_classes = forest.num_classes();
+    const auto false_class_idx = false_class_indices_[forest_idx];
+    for (std::size_t row_idx {0}; row_idx < pending.prediction_indices.size(); ++row_idx) {
+        predictions_[pending.prediction_indices[row_idx]] = probabilities[row_idx * num_classes + false_class_idx];
     }
-public:
-    MalformedForestFile(boost::filesystem::path file) : MalformedFileError {std::move(file)} {}
-};
+    pending.features.clear();
+    pending.prediction_indices.clear();
+}
 
 void RandomForestFilter::prepare_for_classification(boost::optional<Log>& log) const
 {
-    close_data_files();
-    if (num_records_ == 0) return;
-    const Path ranger_prefix {temp_directory() / "octopus_ranger_temp"};
-    const Path ranger_prediction_fname {ranger_prefix.string() + ".prediction"};
-    data_buffer_.resize(1);
-    auto& predictions = data_buffer_[0];
-    predictions.resize(num_records_);
-    const auto num_samples = choices_.size();
-    for (std::size_t forest_idx {0}; forest_idx < forest_paths_.size(); ++forest_idx) {
-        for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
-            auto forest_choice_itr = std::find(std::cbegin(choices_[sample_idx]), std::cend(choices_[sample_idx]), forest_idx);
-            if (forest_choice_itr != std::cend(choices_[sample_idx])) {
-                const auto& file = data_[forest_idx][sample_idx];
-                std::vector<std::string> tmp {}, cat_vars {};
-                const auto ranger_threads = threading_.max_threads ? *threading_.max_threads : 1u;
-                const auto forest = make_forest();
-                try {
-                    forest->initCpp("", ranger::MemoryMode::MEM_DOUBLE, file.path.string(), 0, ranger_prefix.string(),
-                                    1000, nullptr, 12, ranger_threads, forest_paths_[forest_idx].string(), ranger::ImportanceMode::IMP_GINI, 1, "",
-                                    tmp, "", true, cat_vars, false, ranger::SplitRule::LOGRANK, "", false, 1.0,
-                                    ranger::DEFAULT_ALPHA, ranger::DEFAULT_MINPROP, false,
-                                    ranger::PredictionType::RESPONSE, ranger::DEFAULT_NUM_RANDOM_SPLITS, ranger::DEFAULT_MAXDEPTH);
-                } catch (const std::runtime_error& e) {
-                    throw MalformedForestFile {forest_paths_[forest_idx]};
-                }
-                forest->run(false, false);
-                forest->writePredictionFile();
-                std::ifstream prediction_file {ranger_prediction_fname.string()};
-                const auto tp_first = read_header(prediction_file);
-                std::string line;
-                while (std::getline(prediction_file, line)) {
-                    if (!line.empty()) {
-                        const auto record_idx = std::distance(std::cbegin(choices_[sample_idx]), forest_choice_itr);
-                        predictions[record_idx].push_back(get_prob_false(line, tp_first));
-                        assert(forest_choice_itr != std::cend(choices_[sample_idx]));
-                        forest_choice_itr = std::find(std::next(forest_choice_itr), std::cend(choices_[sample_idx]), forest_idx);
-                    }
-                }
-                boost::filesystem::remove(file.path);
-            }
-        }
+    for (std::size_t forest_idx {0}; forest_idx < pending_rows_.size(); ++forest_idx) {
+        predict_pending(forest_idx);
     }
-    boost::filesystem::remove(ranger_prediction_fname);
-    data_.clear();
-    data_.shrink_to_fit();
-    choices_.clear();
-    choices_.shrink_to_fit();
+    pending_rows_.clear();
+    pending_rows_.shrink_to_fit();
     if (!hard_filtered_record_indices_.empty()) {
         hard_filtered_.resize(num_records_, false);
         for (auto idx : hard_filtered_record_indices_) {
@@ -417,18 +450,12 @@ void RandomForestFilter::prepare_for_classification(boost::optional<Log>& log) c
     }
 }
 
-std::size_t RandomForestFilter::get_forest_choice(std::size_t call_idx, std::size_t sample_idx) const
-{
-    return choices_.empty() ? 0 : choices_[sample_idx][call_idx];
-}
-
 VariantCallFilter::Classification RandomForestFilter::classify(const std::size_t call_idx, std::size_t sample_idx) const
 {
     Classification result {};
     if (hard_filtered_.empty() || !hard_filtered_[call_idx]) {
-        const auto& predictions = data_buffer_[0];
-        assert(call_idx < predictions.size() && sample_idx < predictions[call_idx].size());
-        const auto prob_false = predictions[call_idx][sample_idx];
+        assert(call_idx < num_records_ && sample_idx < num_samples_);
+        const auto prob_false = predictions_[call_idx * num_samples_ + sample_idx];
         result.quality = probability_false_to_phred(std::max(prob_false, 1e-10));
         if (*result.quality >= min_soft_genotype_quality()) {
             result.category = Classification::Category::unfiltered;
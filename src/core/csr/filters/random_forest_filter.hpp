@@ -5,19 +5,17 @@
 #define random_forest_filter_hpp
 
 #include <vector>
+#include <deque>
 #include <cstddef>
-#include <memory>
-#include <fstream>
+#include <cstdint>
 #include <functional>
-#include <cstddef>
 
 #include <boost/optional.hpp>
 #include <boost/filesystem.hpp>
 
-#include "ranger/Forest.h"
-
 #include "basics/phred.hpp"
 #include "double_pass_variant_call_filter.hpp"
+#include "flat_forest.hpp"
 
 namespace octopus { namespace csr {
 
@@ -65,33 +63,34 @@ protected:
     Phred<double> min_soft_call_quality() const noexcept;
 
 private:
-    struct File
-    {
-        std::ofstream handle;
-        Path path;
-        template <typename F, typename P>
-        File(F&& handle, P&& path) : handle {std::forward<F>(handle)}, path {std::forward<P>(path)} {};
-    };
     struct ForestMeasureInfo
     {
         std::size_t start_index, number;
     };
+    struct PendingRows
+    {
+        std::vector<double> features;
+        std::vector<std::size_t> prediction_indices;
+    };
     
     std::vector<Path> forest_paths_;
-    std::vector<std::unique_ptr<ranger::Forest>> forests_;
+    std::vector<FlatForest> forests_;
+    std::vector<std::size_t> false_class_indices_;
     std::function<std::int8_t(std::vector<Measure::ResultType>)> chooser_;
     std::vector<ForestMeasureInfo> forest_measure_info_;
     std::size_t num_chooser_measures_;
     Options options_;
     ConcurrencyPolicy threading_;
     
-    mutable std::vector<std::vector<File>> data_;
+    mutable std::size_t num_samples_;
     mutable std::size_t num_records_;
-    mutable std::vector<std::vector<std::vector<double>>> data_buffer_;
-    mutable std::vector<std::deque<std::int8_t>> choices_;
+    mutable std::vector<PendingRows> pending_rows_;
+    mutable std::vector<double> predictions_;
     mutable std::deque<std::size_t> hard_filtered_record_indices_;
     mutable std::vector<bool> hard_filtered_;
     
+    static constexpr std::size_t max_pending_rows_ {10000}; // per forest
+    
     const static std::string genotype_quality_name_;
     const static std::string call_quality_name_;
     
@@ -111,14 +110,16 @@ private:
     virtual bool is_soft_filtered(const ClassificationList& sample_classifications, boost::optional<Phred<double>> joint_quality,
                                   const MeasureVector& measures, std::vector<std::string>& reasons) const override;
     
-    std::unique_ptr<ranger::Forest> make_forest() const;
     boost::optional<std::string> genotype_quality_name() const override;
     std::int8_t choose_forest(const MeasureVector& measures) const;
     void prepare_for_registration(const SampleList& samples) const override;
     void record(std::size_t call_idx, std::size_t sample_idx, MeasureVector measures) const override;
-    void close_data_files() const;
+    void record_block(std::size_t first_call_idx, const MeasureBlock& measures, std::size_t num_calls, std::size_t num_samples) const override;
+    void add_records(std::size_t num_records) const;
+    void add_pending_row(std::size_t forest_idx, std::size_t first_feature, std::size_t call_idx, std::size_t sample_idx) const;
+    unsigned max_prediction_threads() const noexcept;
+    void predict_pending(std::size_t forest_idx) const;
     void prepare_for_classification(boost::optional<Log>& log) const override;
-    std::size_t get_forest_choice(std::size_t call_idx, std::size_t sample_idx) const;
     Classification classify(std::size_t call_idx, std::size_t sample_idx) const override;
 };
 
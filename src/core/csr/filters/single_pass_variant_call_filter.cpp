@@ -67,16 +67,26 @@ void SinglePassVariantCallFilter::filter(const std::vector<CallBlock>& blocks, V
 void SinglePassVariantCallFilter::filter(const CallBlock& block, const MeasureBlock& measures, VcfWriter& dest,
                                          const VcfHeader& dest_header, const SampleList& samples) const
 {
-    assert(measures.size() == block.size());
-    for (auto tup : boost::combine(block, measures)) {
-        filter(tup.get<0>(), tup.get<1>(), dest, dest_header, samples);
+    assert(measures.size() == measures_.size());
+    const auto sample_classifications = classify_block(measures, block.size(), samples);
+    assert(sample_classifications.size() == block.size());
+    // The call measures are only needed to merge samples or to annotate
+    const bool need_call_measures {samples.size() > 1 || measure_annotations_requested()};
+    for (std::size_t call_idx {0}; call_idx < block.size(); ++call_idx) {
+        const auto call_measures = need_call_measures ? get_call_measures(measures, call_idx) : MeasureVector {};
+        filter(block[call_idx], call_measures, sample_classifications[call_idx], dest, dest_header, samples);
     }
 }
 
 void SinglePassVariantCallFilter::filter(const VcfRecord& call, const MeasureVector& measures, VcfWriter& dest,
                                          const VcfHeader& dest_header, const SampleList& samples) const
 {
-    const auto sample_classifications = classify(measures, samples);
+    filter(call, measures, classify(measures, samples), dest, dest_header, samples);
+}
+
+void SinglePassVariantCallFilter::filter(const VcfRecord& call, const MeasureVector& measures, const ClassificationList& sample_classifications,
+                                         VcfWriter& dest, const VcfHeader& dest_header, const SampleList& samples) const
+{
     const auto call_classification = merge(sample_classifications, measures);
     if (measure_annotations_requested()) {
         VcfRecord::Builder annotation_builder {call};
@@ -98,6 +108,18 @@ SinglePassVariantCallFilter::classify(const MeasureVector& call_measures, const
     return result;
 }
 
+std::vector<VariantCallFilter::ClassificationList>
+SinglePassVariantCallFilter::classify_block(const MeasureBlock& measures, const std::size_t num_calls, const SampleList& samples) const
+{
+    std::vector<ClassificationList> result(num_calls, ClassificationList(samples.size()));
+    for (std::size_t call_idx {0}; call_idx < num_calls; ++call_idx) {
+        for (std::size_t sample_idx {0}; sample_idx < samples.size(); ++sample_idx) {
+            result[call_idx][sample_idx] = this->classify(get_sample_measures(measures, call_idx, sample_idx));
+        }
+    }
+    return result;
+}
+
 static auto expand_lhs_to_zero(const GenomicRegion& region)
 {
     return GenomicRegion {region.contig_name(), 0, region.end()};
@@ -5,6 +5,7 @@
 #define single_pass_variant_call_filter_hpp
 
 #include <vector>
+#include <cstddef>
 
 #include <boost/optional.hpp>
 
@@ -35,6 +36,9 @@ public:
 protected:
     std::vector<std::string> measure_names_;
     
+    // Classifies each sample of each call in the block. Classifies the sample measures of each call by default.
+    virtual std::vector<ClassificationList> classify_block(const MeasureBlock& measures, std::size_t num_calls, const SampleList& samples) const;
+    
 private:
     boost::optional<ProgressMeter&> progress_;
     mutable boost::optional<GenomicRegion::ContigName> current_contig_;
@@ -47,6 +51,8 @@ private:
     void filter(const std::vector<CallBlock>& blocks, VcfWriter& dest, const VcfHeader& dest_header, const SampleList& samples) const;
     void filter(const CallBlock& block, const MeasureBlock & measures, VcfWriter& dest, const VcfHeader& dest_header, const SampleList& samples) const;
     void filter(const VcfRecord& call, const MeasureVector& measures, VcfWriter& dest, const VcfHeader& dest_header, const SampleList& samples) const;
+    void filter(const VcfRecord& call, const MeasureVector& measures, const ClassificationList& sample_classifications,
+                VcfWriter& dest, const VcfHeader& dest_header, const SampleList& samples) const;
     ClassificationList classify(const MeasureVector& call_measures, const SampleList& samples) const;
     void log_progress(const GenomicRegion& region) const;
 };
@@ -8,6 +8,9 @@
 #include <functional>
 #include <iterator>
 #include <algorithm>
+#include <cassert>
+
+#include <boost/variant.hpp>
 
 #include "io/variant/vcf_header.hpp"
 #include "utils/append.hpp"
@@ -123,6 +126,109 @@ bool ThresholdVariantCallFilter::passes_all_soft_filters(const MeasureVector& me
                               std::cbegin(soft_thresholds_));
 }
 
+namespace {
+
+struct ColumnThresholdVisitor : public boost::static_visitor<std::vector<bool>>
+{
+    ColumnThresholdVisitor(const ThresholdVariantCallFilter::ThresholdWrapper& threshold, const MeasureWrapper& measure,
+                           std::size_t num_calls, std::size_t num_samples)
+    : threshold_ {threshold}, measure_ {measure}, num_calls_ {num_calls}, num_samples_ {num_samples} {}
+    std::vector<bool> operator()(const Measure::Array<Measure::ResultType>& values) const
+    {
+        std::vector<bool> result(num_calls_ * num_samples_);
+        for (std::size_t call_idx {0}; call_idx < num_calls_; ++call_idx) {
+            for (std::size_t sample_idx {0}; sample_idx < num_samples_; ++sample_idx) {
+                result[call_idx * num_samples_ + sample_idx] = threshold_(get_sample_value(values[call_idx], measure_, sample_idx));
+            }
+        }
+        return result;
+    }
+    template <typename T>
+    std::vector<bool> operator()(const Measure::TypedColumn<T>& column) const
+    {
+        std::vector<bool> result(num_calls_ * num_samples_);
+        if (is_per_sample(measure_.cardinality())) {
+            assert(column.values.size() == result.size());
+            for (std::size_t idx {0}; idx < result.size(); ++idx) {
+                result[idx] = test(column, idx);
+            }
+        } else {
+            assert(column.values.size() == num_calls_);
+            for (std::size_t call_idx {0}; call_idx < num_calls_; ++call_idx) {
+                const auto passes = test(column, call_idx);
+                std::fill_n(std::next(std::begin(result), call_idx * num_samples_), num_samples_, passes);
+            }
+        }
+        return result;
+    }
+private:
+    const ThresholdVariantCallFilter::ThresholdWrapper& threshold_;
+    const MeasureWrapper& measure_;
+    std::size_t num_calls_, num_samples_;
+    
+    template <typename T>
+    bool test(const Measure::TypedColumn<T>& column, const std::size_t idx) const
+    {
+        if (!column.missing.empty() && column.missing[idx]) {
+            return threshold_(Measure::Optional<Measure::ValueType> {});
+        } else {
+            return threshold_(Measure::ValueType {T {column.values[idx]}});
+        }
+    }
+};
+
+} // namespace
+
+std::vector<bool>
+ThresholdVariantCallFilter::test(const ThresholdWrapper& threshold, const std::size_t measure_idx, const MeasureBlock& measures,
+                                 const std::size_t num_calls, const std::size_t num_samples) const
+{
+    ColumnThresholdVisitor vis {threshold, measures_[measure_idx], num_calls, num_samples};
+    return boost::apply_visitor(vis, get_column(measures, measure_idx));
+}
+
+std::vector<VariantCallFilter::ClassificationList>
+ThresholdVariantCallFilter::classify_block(const MeasureBlock& measures, const std::size_t num_calls, const SampleList& samples) const
+{
+    // Each threshold is tested against its whole measure column before moving to the next
+    const auto num_samples = samples.size();
+    std::vector<bool> hard_passes(num_calls * num_samples, true);
+    for (std::size_t i {0}; i < hard_thresholds_.size(); ++i) {
+        const auto passes = test(hard_thresholds_[i], i, measures, num_calls, num_samples);
+        std::transform(std::cbegin(passes), std::cend(passes), std::cbegin(hard_passes), std::begin(hard_passes), std::logical_and<> {});
+    }
+    std::vector<std::vector<bool>> soft_passes {};
+    soft_passes.reserve(soft_thresholds_.size());
+    for (std::size_t i {0}; i < soft_thresholds_.size(); ++i) {
+        soft_passes.push_back(test(soft_thresholds_[i], hard_thresholds_.size() + i, measures, num_calls, num_samples));
+    }
+    std::vector<ClassificationList> result(num_calls, ClassificationList(num_samples));
+    for (std::size_t call_idx {0}; call_idx < num_calls; ++call_idx) {
+        for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
+            const auto idx = call_idx * num_samples + sample_idx;
+            auto& classification = result[call_idx][sample_idx];
+            if (hard_passes[idx]) {
+                for (std::size_t i {0}; i < soft_thresholds_.size(); ++i) {
+                    if (!soft_passes[i][idx]) classification.reasons.push_back(vcf_filter_keys_[i]);
+                }
+                if (classification.reasons.empty()) {
+                    classification.category = Classification::Category::unfiltered;
+                } else {
+                    classification.category = Classification::Category::soft_filtered;
+                    if (!all_unique_filter_keys_) {
+                        std::sort(std::begin(classification.reasons), std::end(classification.reasons));
+                        classification.reasons.erase(std::unique(std::begin(classification.reasons), std::end(classification.reasons)),
+                                                     std::end(classification.reasons));
+                    }
+                }
+            } else {
+                classification.category = Classification::Category::hard_filtered;
+            }
+        }
+    }
+    return result;
+}
+
 std::vector<std::string> ThresholdVariantCallFilter::get_failing_vcf_filter_keys(const MeasureVector& measures) const
 {
     std::vector<std::string> result {};
@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <cstddef>
 
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
@@ -85,6 +86,8 @@ protected:
     bool passes_all_filters(MeasureIterator first_measure, MeasureIterator last_measure,
                             ThresholdIterator first_threshold) const;
     
+    virtual std::vector<ClassificationList> classify_block(const MeasureBlock& measures, std::size_t num_calls, const SampleList& samples) const override;
+    
 private:
     std::string do_name() const override;
     virtual void annotate(VcfHeader::Builder& header) const override;
@@ -93,6 +96,9 @@ private:
     virtual bool passes_all_hard_filters(const MeasureVector& measures) const;
     virtual bool passes_all_soft_filters(const MeasureVector& measures) const;
     virtual std::vector<std::string> get_failing_vcf_filter_keys(const MeasureVector& measures) const;
+    
+    std::vector<bool> test(const ThresholdWrapper& threshold, std::size_t measure_idx, const MeasureBlock& measures,
+                           std::size_t num_calls, std::size_t num_samples) const;
 };
 
 template <typename M, typename... Args>
@@ -12,6 +12,7 @@
 #include <limits>
 #include <cmath>
 #include <thread>
+#include <cassert>
 
 #include <boost/range/combine.hpp>
 #include <boost/multiprecision/gmp.hpp>
@@ -68,18 +69,16 @@ VariantCallFilter::VariantCallFilter(FacetFactory facet_factory,
 , facet_factory_ {std::move(facet_factory)}
 , facet_names_ {get_all_requirements(measures_)}
 , output_config_ {output_config}
-, duplicate_measures_ {}
-, workers_ {get_pool_size(threading)}
-{
-    std::unordered_map<MeasureWrapper, int> measure_counts {};
-    measure_counts.reserve(measures_.size());
-    for (const auto& m : measures_) {
-        ++measure_counts[m];
-        if (measure_counts[m] == 2) {
-            duplicate_measures_.push_back(m);
-        }
+, measure_sources_ {}
+, helpers_ {num_helpers_for_pool(get_pool_size(threading))}
+, workers_ {helpers_.empty() ? 0 : helpers_.size() + 1}
+{
+    std::unordered_map<MeasureWrapper, std::size_t> first_indices {};
+    first_indices.reserve(measures_.size());
+    measure_sources_.reserve(measures_.size());
+    for (std::size_t i {0}; i < measures_.size(); ++i) {
+        measure_sources_.push_back(first_indices.emplace(measures_[i], i).first->second);
     }
-    duplicate_measures_.shrink_to_fit();
     logging::WarningLogger warn_log {};
     for (const auto& annotation : output_config_.annotations) {
         if (!contains(measures_, annotation)) {
@@ -238,24 +237,12 @@ VariantCallFilter::read_next_blocks(VcfIterator& first, const VcfIterator& last,
 VariantCallFilter::MeasureVector VariantCallFilter::measure(const VcfRecord& call) const
 {
     MeasureVector result(measures_.size());
-    if (duplicate_measures_.empty()) {
-        std::transform(std::cbegin(measures_), std::cend(measures_), std::begin(result),
-                       [&call] (const MeasureWrapper& m) { return m(call); });
-    } else {
-        std::unordered_map<MeasureWrapper, Measure::ResultType> result_buffer {};
-        result_buffer.reserve(duplicate_measures_.size());
-        for (const auto& m : duplicate_measures_) {
-            result_buffer.emplace(m, m(call));
+    for (std::size_t i {0}; i < measures_.size(); ++i) {
+        if (measure_sources_[i] == i) {
+            result[i] = measures_[i](call);
+        } else {
+            result[i] = result[measure_sources_[i]];
         }
-        std::transform(std::cbegin(measures_), std::cend(measures_), std::begin(result),
-                       [&call, &result_buffer] (const MeasureWrapper& m) -> Measure::ResultType {
-                           auto itr = result_buffer.find(m);
-                           if (itr != std::cend(result_buffer)) {
-                               return itr->second;
-                           } else {
-                               return m(call);
-                           }
-                       });
     }
     return result;
 }
@@ -288,6 +275,32 @@ std::vector<VariantCallFilter::MeasureBlock> VariantCallFilter::measure(const st
     return result;
 }
 
+const Measure::Column& VariantCallFilter::get_column(const MeasureBlock& measures, const std::size_t measure_idx) const noexcept
+{
+    return measures[measure_sources_[measure_idx]];
+}
+
+VariantCallFilter::MeasureVector VariantCallFilter::get_call_measures(const MeasureBlock& measures, const std::size_t call_idx) const
+{
+    MeasureVector result {};
+    result.reserve(measures_.size());
+    for (std::size_t i {0}; i < measures_.size(); ++i) {
+        result.push_back(get_call_value(get_column(measures, i), measures_[i], call_idx));
+    }
+    return result;
+}
+
+VariantCallFilter::MeasureVector
+VariantCallFilter::get_sample_measures(const MeasureBlock& measures, const std::size_t call_idx, const std::size_t sample_idx, const bool aggregate) const
+{
+    MeasureVector result {};
+    result.reserve(measures_.size());
+    for (std::size_t i {0}; i < measures_.size(); ++i) {
+        result.push_back(get_sample_value(get_column(measures, i), measures_[i], call_idx, sample_idx, aggregate));
+    }
+    return result;
+}
+
 void VariantCallFilter::write(const VcfRecord& call, const Classification& classification, VcfWriter& dest) const
 {
     if (!is_hard_filtered(classification)) {
@@ -495,69 +508,37 @@ void VariantCallFilter::annotate(VcfRecord::Builder& call, const Classification
     }
 }
 
-auto make_map(const std::vector<std::string>& names, std::vector<FacetWrapper>&& facets)
-{
-    assert(names.size() == facets.size());
-    Measure::FacetMap result {};
-    result.reserve(names.size());
-    for (auto tup : boost::combine(names, std::move(facets))) {
-        result.emplace(tup.get<0>(), std::move(tup.get<1>()));
-    }
-    return result;
-}
-
-Measure::FacetMap VariantCallFilter::compute_facets(const CallBlock& block) const
+VariantCallFilter::FacetBlock VariantCallFilter::compute_facets(const CallBlock& block) const
 {
-    return make_map(facet_names_, facet_factory_.make(facet_names_, block));
+    return facet_factory_.make(facet_names_, block);
 }
 
-std::vector<Measure::FacetMap> VariantCallFilter::compute_facets(const std::vector<CallBlock>& blocks) const
+std::vector<VariantCallFilter::FacetBlock> VariantCallFilter::compute_facets(const std::vector<CallBlock>& blocks) const
 {
     if (debug_log_ && !blocks.empty()) {
         const auto blocks_region = closed_region(blocks.front().front(), blocks.back().back());
         stream(*debug_log_) << "Computing facets in blocks region " << blocks_region << " containing " << blocks.size() << " blocks";
     }
-    auto facets = facet_factory_.make(facet_names_, blocks, workers_);
-    std::vector<Measure::FacetMap> result {};
-    result.reserve(blocks.size());
-    for (auto& block : facets) {
-        result.push_back(make_map(facet_names_, std::move(block)));
-    }
-    return result;
+    return facet_factory_.make(facet_names_, blocks, workers_);
 }
 
-VariantCallFilter::MeasureBlock VariantCallFilter::measure(const CallBlock& block, const Measure::FacetMap& facets) const
+VariantCallFilter::MeasureBlock VariantCallFilter::measure(const CallBlock& block, const FacetBlock& facets) const
 {
     if (debug_log_ && !block.empty()) {
         stream(*debug_log_) << "Measuring block " << encompassing_region(block) << " containing " << block.size() << " calls";
     }
-    MeasureBlock result(block.size());
-    std::transform(std::cbegin(block), std::cend(block), std::begin(result),
-                   [&] (const VcfRecord& call) { return this->measure(call, facets); });
-    return result;
-}
-
-VariantCallFilter::MeasureVector VariantCallFilter::measure(const VcfRecord& call, const Measure::FacetMap& facets) const
-{
-    MeasureVector result(measures_.size());
-    if (duplicate_measures_.empty()) {
-        std::transform(std::cbegin(measures_), std::cend(measures_), std::begin(result),
-                       [&] (const MeasureWrapper& m) { return m(call, facets); });
-    } else {
-        std::unordered_map<MeasureWrapper, Measure::ResultType> result_buffer {};
-        result_buffer.reserve(duplicate_measures_.size());
-        for (const auto& m : duplicate_measures_) {
-            result_buffer.emplace(m, m(call, facets));
+    assert(facets.size() == facet_names_.size());
+    Measure::FacetMap facet_map {};
+    facet_map.reserve(facets.size());
+    for (std::size_t i {0}; i < facets.size(); ++i) {
+        facet_map.emplace(facet_names_[i], facets[i]);
+    }
+    // Duplicate measures are not evaluated, see get_column
+    MeasureBlock result(measures_.size());
+    for (std::size_t i {0}; i < measures_.size(); ++i) {
+        if (measure_sources_[i] == i) {
+            result[i] = measures_[i](block, facet_map);
         }
-        std::transform(std::cbegin(measures_), std::cend(measures_), std::begin(result),
-                       [&] (const MeasureWrapper& m) -> Measure::ResultType {
-                           auto itr = result_buffer.find(m);
-                           if (itr != std::cend(result_buffer)) {
-                               return itr->second;
-                           } else {
-                               return m(call, facets);
-                           }
-                       });
     }
     return result;
 }
@@ -22,6 +22,7 @@
 #include "io/variant/vcf_record.hpp"
 #include "io/variant/vcf_reader.hpp"
 #include "utils/thread_pool.hpp"
+#include "utils/executor.hpp"
 #include "logging/logging.hpp"
 #include "../facets/facet.hpp"
 #include "../facets/facet_factory.hpp"
@@ -75,7 +76,7 @@ protected:
     using MeasureVector = std::vector<Measure::ResultType>;
     using VcfIterator   = VcfReader::RecordIterator;
     using CallBlock     = std::vector<VcfRecord>;
-    using MeasureBlock  = std::vector<MeasureVector>;
+    using MeasureBlock  = std::vector<Measure::Column>; // one column per measure
     
     struct Classification
     {
@@ -98,6 +99,9 @@ protected:
     MeasureVector measure(const VcfRecord& call) const;
     MeasureBlock measure(const CallBlock& block) const;
     std::vector<MeasureBlock> measure(const std::vector<CallBlock>& blocks) const;
+    const Measure::Column& get_column(const MeasureBlock& measures, std::size_t measure_idx) const noexcept;
+    MeasureVector get_call_measures(const MeasureBlock& measures, std::size_t call_idx) const;
+    MeasureVector get_sample_measures(const MeasureBlock& measures, std::size_t call_idx, std::size_t sample_idx, bool aggregate = false) const;
     void write(const VcfRecord& call, const Classification& classification, VcfWriter& dest) const;
     void write(const VcfRecord& call, const Classification& classification,
                const SampleList& samples, const ClassificationList& sample_classifications,
@@ -109,12 +113,14 @@ protected:
     
 private:
     using FacetNameSet = std::vector<std::string>;
+    using FacetBlock   = FacetFactory::FacetBlock; // in facet_names_ order
     
     FacetFactory facet_factory_;
     FacetNameSet facet_names_;
     OutputOptions output_config_;
-    std::vector<MeasureWrapper> duplicate_measures_;
+    std::vector<std::size_t> measure_sources_; // index of the first equal measure in measures_
     
+    HelperThreads helpers_; // the pool threads' share of the thread budget
     mutable ThreadPool workers_;
     
     virtual std::string do_name() const = 0;
@@ -127,10 +133,9 @@ private:
                                   const MeasureVector& measures, std::vector<std::string>& reasons) const;
     
     VcfHeader make_header(const VcfReader& source) const;
-    Measure::FacetMap compute_facets(const CallBlock& block) const;
-    std::vector<Measure::FacetMap> compute_facets(const std::vector<CallBlock>& blocks) const;
-    MeasureBlock measure(const CallBlock& block, const Measure::FacetMap& facets) const;
-    MeasureVector measure(const VcfRecord& call, const Measure::FacetMap& facets) const;
+    FacetBlock compute_facets(const CallBlock& block) const;
+    std::vector<FacetBlock> compute_facets(const std::vector<CallBlock>& blocks) const;
+    MeasureBlock measure(const CallBlock& block, const FacetBlock& facets) const;
     VcfRecord::Builder construct_template(const VcfRecord& call) const;
     bool is_requested_annotation(const MeasureWrapper& measure) const noexcept;
     bool is_hard_filtered(const Classification& classification) const noexcept;
@@ -32,17 +32,34 @@ Measure::ValueType Depth::get_value_type() const
     return std::size_t {};
 }
 
+namespace {
+
+std::size_t get_depth(const VcfRecord& call)
+{
+    return boost::lexical_cast<std::size_t>(call.info_value(vcfspec::info::combinedReadDepth).front());
+}
+
+std::size_t get_depth(const VcfRecord& call, const SampleName& sample)
+{
+    return boost::lexical_cast<std::size_t>(call.get_sample_value(sample, vcfspec::format::combinedReadDepth).front());
+}
+
+template <typename Reads>
+std::size_t count_depth(const Reads& reads, const VcfRecord& call)
+{
+    return static_cast<std::size_t>(count_overlapped(reads, call));
+}
+
+} // namespace
+
 Measure::ResultType Depth::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
 {
     if (aggregate_) {
-        ValueType result {};
         if (recalculate_) {
-            const auto& reads = get_value<OverlappingReads>(facets.at("OverlappingReads"));
-            result = static_cast<std::size_t>(count_overlapped(reads, call));
+            return ValueType {count_depth(get_value<OverlappingReads>(facets.at("OverlappingReads")), call)};
         } else {
-            result = boost::lexical_cast<std::size_t>(call.info_value(vcfspec::info::combinedReadDepth).front());
+            return ValueType {get_depth(call)};
         }
-        return result;
     } else {
         const auto& samples = get_value<Samples>(facets.at("Samples"));
         Array<ValueType> result {};
@@ -50,17 +67,39 @@ Measure::ResultType Depth::do_evaluate(const VcfRecord& call, const FacetMap& fa
         if (recalculate_) {
             const auto& reads = get_value<OverlappingReads>(facets.at("OverlappingReads"));
             for (const auto& sample : samples) {
-                result.emplace_back(static_cast<std::size_t>(count_overlapped(reads.at(sample), call)));
+                result.emplace_back(count_depth(reads.at(sample), call));
             }
         } else {
             for (const auto& sample : samples) {
-                result.emplace_back(boost::lexical_cast<std::size_t>(call.get_sample_value(sample, vcfspec::format::combinedReadDepth).front()));
+                result.emplace_back(get_depth(call, sample));
             }
         }
         return result;
     }
 }
 
+Measure::Column Depth::do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    if (aggregate_) {
+        if (recalculate_) {
+            const auto& reads = get_value<OverlappingReads>(facets.at("OverlappingReads"));
+            return make_column<std::size_t>(calls, [&] (const VcfRecord& call) { return count_depth(reads, call); });
+        } else {
+            return make_column<std::size_t>(calls, [] (const VcfRecord& call) { return get_depth(call); });
+        }
+    } else {
+        const auto& samples = get_value<Samples>(facets.at("Samples"));
+        if (recalculate_) {
+            const auto& reads = get_value<OverlappingReads>(facets.at("OverlappingReads"));
+            return make_column<std::size_t>(calls, samples, [&] (const VcfRecord& call, const SampleName& sample) {
+                return count_depth(reads.at(sample), call); });
+        } else {
+            return make_column<std::size_t>(calls, samples, [] (const VcfRecord& call, const SampleName& sample) {
+                return get_depth(call, sample); });
+        }
+    }
+}
+
 Measure::ResultCardinality Depth::do_cardinality() const noexcept
 {
     if (aggregate_) {
@@ -27,19 +27,35 @@ Measure::ValueType GenotypeQuality::get_value_type() const
     return double {};
 }
 
+namespace {
+
+boost::optional<double> get_genotype_quality(const VcfRecord& call, const SampleName& sample)
+{
+    static const std::string gq_field {vcfspec::format::conditionalQuality};
+    if (call.has_format(gq_field)) {
+        return std::stod(call.get_sample_value(sample, gq_field).front());
+    }
+    return boost::none;
+}
+
+} // namespace
+
 Measure::ResultType GenotypeQuality::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
 {
     const auto& samples = get_value<Samples>(facets.at("Samples"));
     Array<Optional<ValueType>> result(samples.size());
     for (std::size_t s {0}; s < samples.size(); ++s) {
-        static const std::string gq_field {vcfspec::format::conditionalQuality};
-        if (call.has_format(gq_field)) {
-            result[s] = std::stod(call.get_sample_value(samples[s], gq_field).front());
-        }
+        const auto gq = get_genotype_quality(call, samples[s]);
+        if (gq) result[s] = *gq;
     }
     return result;
 }
 
+Measure::Column GenotypeQuality::do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    return make_column<double>(calls, get_value<Samples>(facets.at("Samples")), get_genotype_quality);
+}
+
 Measure::ResultCardinality GenotypeQuality::do_cardinality() const noexcept
 {
     return ResultCardinality::samples;
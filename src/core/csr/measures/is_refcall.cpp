@@ -23,19 +23,37 @@ Measure::ValueType IsRefcall::get_value_type() const
     return bool {};
 }
 
+namespace {
+
+bool is_sample_refcall(const VcfRecord& call, const SampleName& sample)
+{
+    return call.is_homozygous_ref(sample);
+}
+
+} // namespace
+
 Measure::ResultType IsRefcall::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
 {
     if (report_sample_status_) {
         const auto& samples = get_value<Samples>(facets.at("Samples"));
         Array<ValueType> result(samples.size());
         std::transform(std::cbegin(samples), std::cend(samples), std::begin(result),
-                       [&call] (const auto& sample) { return call.is_homozygous_ref(sample); });
+                       [&call] (const auto& sample) { return is_sample_refcall(call, sample); });
         return result;
     } else {
         return ValueType {is_refcall(call)};
     }
 }
 
+Measure::Column IsRefcall::do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    if (report_sample_status_) {
+        return make_column<bool>(calls, get_value<Samples>(facets.at("Samples")), is_sample_refcall);
+    } else {
+        return make_column<bool>(calls, [] (const VcfRecord& call) { return is_refcall(call); });
+    }
+}
+
 Measure::ResultCardinality IsRefcall::do_cardinality() const noexcept
 {
     if (report_sample_status_) {
@@ -22,6 +22,7 @@ class IsRefcall : public Measure
     std::unique_ptr<Measure> do_clone() const override;
     ValueType get_value_type() const override;
     ResultType do_evaluate(const VcfRecord& call, const FacetMap& facets) const override;
+    Column do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const override;
     ResultCardinality do_cardinality() const noexcept override;
     const std::string& do_name() const override;
     std::string do_describe() const override;
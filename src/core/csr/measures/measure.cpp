@@ -26,6 +26,16 @@ void Measure::do_set_parameters(std::vector<std::string> params)
     }
 }
 
+Measure::Column Measure::do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    Array<ResultType> result {};
+    result.reserve(calls.size());
+    for (const auto& call : calls) {
+        result.push_back(do_evaluate(call, facets));
+    }
+    return result;
+}
+
 struct MeasureSerialiseVisitor : boost::static_visitor<>
 {
     std::ostringstream ss;
@@ -392,6 +402,50 @@ Measure::ResultType get_sample_value(const Measure::ResultType& value, const Mea
     return result;
 }
 
+struct ColumnCallValueVisitor : public boost::static_visitor<Measure::ResultType>
+{
+    ColumnCallValueVisitor(std::size_t call_idx, bool per_sample) : call_idx_ {call_idx}, per_sample_ {per_sample} {}
+    Measure::ResultType operator()(const Measure::Array<Measure::ResultType>& values) const
+    {
+        return values[call_idx_];
+    }
+    template <typename T>
+    Measure::ResultType operator()(const Measure::TypedColumn<T>& column) const
+    {
+        const auto first_idx = call_idx_ * column.values_per_call;
+        if (per_sample_) {
+            if (column.missing.empty()) {
+                Measure::Array<Measure::ValueType> result {};
+                result.reserve(column.values_per_call);
+                for (std::size_t i {first_idx}; i < first_idx + column.values_per_call; ++i) {
+                    result.emplace_back(T {column.values[i]});
+                }
+                return result;
+            } else {
+                Measure::Array<Measure::Optional<Measure::ValueType>> result(column.values_per_call);
+                for (std::size_t i {0}; i < column.values_per_call; ++i) {
+                    if (!column.missing[first_idx + i]) result[i] = Measure::ValueType {T {column.values[first_idx + i]}};
+                }
+                return result;
+            }
+        } else if (column.missing.empty()) {
+            return Measure::ValueType {T {column.values[first_idx]}};
+        } else {
+            Measure::Optional<Measure::ValueType> result {};
+            if (!column.missing[first_idx]) result = Measure::ValueType {T {column.values[first_idx]}};
+            return result;
+        }
+    }
+private:
+    std::size_t call_idx_;
+    bool per_sample_;
+};
+
+Measure::ResultType get_call_value(const Measure::Column& column, const MeasureWrapper& measure, const std::size_t call_idx)
+{
+    return boost::apply_visitor(ColumnCallValueVisitor {call_idx, is_per_sample(measure.cardinality())}, column);
+}
+
 std::vector<Measure::ResultType>
 get_sample_values(const std::vector<Measure::ResultType>& values, const std::vector<MeasureWrapper>& measures, std::size_t sample_idx, const bool aggregate)
 {
@@ -402,5 +456,39 @@ get_sample_values(const std::vector<Measure::ResultType>& values, const std::vec
     return result;
 }
 
+struct ColumnSampleValueVisitor : public boost::static_visitor<Measure::ResultType>
+{
+    ColumnSampleValueVisitor(const MeasureWrapper& measure, std::size_t call_idx, std::size_t sample_idx, bool aggregate)
+    : measure_ {measure}, call_idx_ {call_idx}, sample_idx_ {sample_idx}, aggregate_ {aggregate} {}
+    Measure::ResultType operator()(const Measure::Array<Measure::ResultType>& values) const
+    {
+        return get_sample_value(values[call_idx_], measure_, sample_idx_, aggregate_);
+    }
+    template <typename T>
+    Measure::ResultType operator()(const Measure::TypedColumn<T>& column) const
+    {
+        auto idx = call_idx_ * column.values_per_call;
+        if (is_per_sample(measure_.cardinality())) idx += sample_idx_;
+        if (column.missing.empty() && !(aggregate_ && measure_.aggregator())) {
+            return Measure::ValueType {T {column.values[idx]}};
+        } else {
+            // Aggregating a single value only makes it optional
+            Measure::Optional<Measure::ValueType> result {};
+            if (column.missing.empty() || !column.missing[idx]) result = Measure::ValueType {T {column.values[idx]}};
+            return result;
+        }
+    }
+private:
+    const MeasureWrapper& measure_;
+    std::size_t call_idx_, sample_idx_;
+    bool aggregate_;
+};
+
+Measure::ResultType get_sample_value(const Measure::Column& column, const MeasureWrapper& measure,
+                                     const std::size_t call_idx, const std::size_t sample_idx, const bool aggregate)
+{
+    return boost::apply_visitor(ColumnSampleValueVisitor {measure, call_idx, sample_idx, aggregate}, column);
+}
+
 } // namespace csr
 } // namespace octopus
@@ -9,6 +9,8 @@
 #include <memory>
 #include <utility>
 #include <unordered_map>
+#include <functional>
+#include <cstddef>
 
 #include <boost/variant.hpp>
 #include <boost/optional.hpp>
@@ -24,7 +26,7 @@ namespace octopus { namespace csr {
 class Measure : public Equitable<Measure>
 {
 public:
-    using FacetMap = std::unordered_map<std::string, FacetWrapper>;
+    using FacetMap = std::unordered_map<std::string, std::reference_wrapper<const FacetWrapper>>;
 
     using ValueType = boost::variant<bool, int, std::size_t, double>;
     template <typename T>
@@ -47,6 +49,24 @@ public:
             Array<Optional<Array<Optional<ValueType>>>>
         >;
 
+    // Values of one measure for a block of calls, call major. values_per_call is one, or the number of
+    // samples for per-sample measures, and missing is empty unless the values are optional.
+    template <typename T>
+    struct TypedColumn
+    {
+        std::size_t values_per_call = 1;
+        std::vector<T> values = {};
+        std::vector<bool> missing = {};
+    };
+    // Measures with one value per call or sample fill a typed column, others one ResultType per call
+    using Column = boost::variant<
+            Array<ResultType>,
+            TypedColumn<bool>,
+            TypedColumn<int>,
+            TypedColumn<std::size_t>,
+            TypedColumn<double>
+        >;
+    
     enum class ResultCardinality { one, alleles, alt_alleles, samples, samples_and_alleles, samples_and_alt_alleles, samples_and_haplotypes };
 
     enum class Aggregator { sum, min, min_tail, max, max_tail, mean };
@@ -65,6 +85,7 @@ public:
     void set_parameters(std::vector<std::string> params) { do_set_parameters(std::move(params)); }
     std::vector<std::string> parameters() const { return do_parameters(); }
     ResultType evaluate(const VcfRecord& call, const FacetMap& facets) const { return do_evaluate(call, facets); }
+    Column evaluate(const std::vector<VcfRecord>& calls, const FacetMap& facets) const { return do_evaluate_block(calls, facets); }
     ResultCardinality cardinality() const noexcept { return do_cardinality(); }
     const std::string& name() const { return do_name(); }
     std::string describe() const { return do_describe(); }
@@ -78,12 +99,53 @@ public:
         return lhs.name() == rhs.name() && lhs.is_equal(rhs);
     }
     
+protected:
+    // Make a typed column from value(call), or value(call, sample) for per-sample measures, which
+    // returns a T, or a boost::optional<T> if the value may be missing.
+    template <typename T, typename F>
+    static TypedColumn<T> make_column(const std::vector<VcfRecord>& calls, F value)
+    {
+        TypedColumn<T> result {};
+        result.values.reserve(calls.size());
+        for (const auto& call : calls) {
+            push_back<T>(value(call), result);
+        }
+        return result;
+    }
+    template <typename T, typename F>
+    static TypedColumn<T> make_column(const std::vector<VcfRecord>& calls, const std::vector<std::string>& samples, F value)
+    {
+        TypedColumn<T> result {samples.size()};
+        result.values.reserve(calls.size() * samples.size());
+        for (const auto& call : calls) {
+            for (const auto& sample : samples) {
+                push_back<T>(value(call, sample), result);
+            }
+        }
+        return result;
+    }
+    
 private:
+    template <typename T>
+    static void push_back(const T& value, TypedColumn<T>& column)
+    {
+        column.values.push_back(value);
+    }
+    template <typename T>
+    static void push_back(const boost::optional<T>& value, TypedColumn<T>& column)
+    {
+        column.values.push_back(value ? *value : T {});
+        column.missing.push_back(!value);
+    }
+    
+
     virtual std::unique_ptr<Measure> do_clone() const = 0;
     virtual void do_set_parameters(std::vector<std::string> params);
     virtual std::vector<std::string> do_parameters() const { return {}; }
     virtual ValueType get_value_type() const = 0;
     virtual ResultType do_evaluate(const VcfRecord& call, const FacetMap& facets) const = 0;
+    // Evaluates a block of calls sharing facets. Calls do_evaluate for each call by default.
+    virtual Column do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const;
     virtual ResultCardinality do_cardinality() const noexcept = 0;
     virtual const std::string& do_name() const = 0;
     virtual std::string do_describe() const = 0;
@@ -118,6 +180,7 @@ public:
     std::vector<std::string> parameters() const { return measure_->parameters(); }
     auto operator()(const VcfRecord& call) const { return measure_->evaluate(call, {}); }
     auto operator()(const VcfRecord& call, const Measure::FacetMap& facets) const { return measure_->evaluate(call, facets); }
+    auto operator()(const std::vector<VcfRecord>& calls, const Measure::FacetMap& facets) const { return measure_->evaluate(calls, facets); }
     Measure::ResultCardinality cardinality() const noexcept { return measure_->cardinality(); }
     const std::string& name() const { return measure_->name(); }
     std::string describe() const { return measure_->describe(); }
@@ -190,6 +253,10 @@ T get_value_type(const Measure::ResultType& value)
 
 std::vector<std::string> get_all_requirements(const std::vector<MeasureWrapper>& measures);
 
+bool is_per_sample(Measure::ResultCardinality cardinality) noexcept;
+
+Measure::ResultType get_call_value(const Measure::Column& column, const MeasureWrapper& measure, std::size_t call_idx);
+
 Measure::ResultType
  get_sample_value(const Measure::ResultType& value,
                   const MeasureWrapper& measure,
@@ -200,6 +267,12 @@ std::vector<Measure::ResultType>
                    const std::vector<MeasureWrapper>& measures, 
                    std::size_t sample_idx,
                    bool aggregate = false);
+Measure::ResultType
+ get_sample_value(const Measure::Column& column,
+                  const MeasureWrapper& measure,
+                  std::size_t call_idx,
+                  std::size_t sample_idx,
+                  bool aggregate = false);
 
 } // namespace csr
 } // namespace octopus
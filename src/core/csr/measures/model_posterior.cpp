@@ -3,6 +3,10 @@
 
 #include "model_posterior.hpp"
 
+#include <string>
+
+#include <boost/optional.hpp>
+
 #include "io/variant/vcf_record.hpp"
 #include "config/octopus_vcf.hpp"
 
@@ -20,16 +24,32 @@ Measure::ValueType ModelPosterior::get_value_type() const
     return double {};
 }
 
-Measure::ResultType ModelPosterior::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
+namespace {
+
+boost::optional<double> get_model_posterior(const VcfRecord& call)
 {
     namespace ovcf = octopus::vcf::spec;
-    Optional<ValueType> result {};
     if (!is_info_missing(ovcf::info::modelPosterior, call)) {
-        result = std::stod(call.info_value(ovcf::info::modelPosterior).front());
+        return std::stod(call.info_value(ovcf::info::modelPosterior).front());
     }
+    return boost::none;
+}
+
+} // namespace
+
+Measure::ResultType ModelPosterior::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
+{
+    Optional<ValueType> result {};
+    const auto mp = get_model_posterior(call);
+    if (mp) result = *mp;
     return result;
 }
 
+Measure::Column ModelPosterior::do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    return make_column<double>(calls, get_model_posterior);
+}
+
 Measure::ResultCardinality ModelPosterior::do_cardinality() const noexcept
 {
     return ResultCardinality::one;
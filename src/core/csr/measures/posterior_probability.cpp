@@ -3,6 +3,10 @@
 
 #include "posterior_probability.hpp"
 
+#include <string>
+
+#include <boost/optional.hpp>
+
 #include "io/variant/vcf_record.hpp"
 #include "io/variant/vcf_spec.hpp"
 
@@ -20,18 +24,34 @@ Measure::ValueType PosteriorProbability::get_value_type() const
     return double {};
 }
 
-Measure::ResultType PosteriorProbability::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
+namespace {
+
+boost::optional<double> get_posterior_probability(const VcfRecord& call)
 {
-    Optional<ValueType> result {};
     if (call.has_info("PP")) {
         const auto& pp = call.info_value("PP");
         if (pp.size() == 1 && pp.front() != vcfspec::missingValue) {
-            result = std::stod(pp.front());
+            return std::stod(pp.front());
         }
     }
+    return boost::none;
+}
+
+} // namespace
+
+Measure::ResultType PosteriorProbability::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
+{
+    Optional<ValueType> result {};
+    const auto pp = get_posterior_probability(call);
+    if (pp) result = *pp;
     return result;
 }
 
+Measure::Column PosteriorProbability::do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    return make_column<double>(calls, get_posterior_probability);
+}
+
 Measure::ResultCardinality PosteriorProbability::do_cardinality() const noexcept
 {
     return ResultCardinality::one;
@@ -3,6 +3,8 @@
 
 #include "quality.hpp"
 
+#include <boost/optional.hpp>
+
 #include "io/variant/vcf_record.hpp"
 
 namespace octopus { namespace csr {
@@ -19,15 +21,29 @@ Measure::ValueType Quality::get_value_type() const
     return double {};
 }
 
+namespace {
+
+boost::optional<double> get_quality(const VcfRecord& call)
+{
+    if (call.qual()) return static_cast<double>(*call.qual());
+    return boost::none;
+}
+
+} // namespace
+
 Measure::ResultType Quality::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
 {
     Optional<ValueType> result {};
-    if (call.qual()) {
-        result = static_cast<double>(*call.qual());
-    }
+    const auto quality = get_quality(call);
+    if (quality) result = *quality;
     return result;
 }
 
+Measure::Column Quality::do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    return make_column<double>(calls, get_quality);
+}
+
 Measure::ResultCardinality Quality::do_cardinality() const noexcept
 {
     return ResultCardinality::one;
@@ -5,6 +5,7 @@
 #define quality_hpp
 
 #include <string>
+#include <vector>
 
 #include "measure.hpp"
 
@@ -20,6 +21,7 @@ class Quality : public Measure
     std::unique_ptr<Measure> do_clone() const override;
     ValueType get_value_type() const override;
     ResultType do_evaluate(const VcfRecord& call, const FacetMap& facets) const override;
+    Column do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const override;
     ResultCardinality do_cardinality() const noexcept override;
     const std::string& do_name() const override;
     std::string do_describe() const override;
@@ -23,6 +23,19 @@ Measure::ValueType VariantLength::get_value_type() const
     return int {};
 }
 
+namespace {
+
+int max_called_allele_length(const Facet::AlleleMap& alleles, const VcfRecord& call, const SampleName& sample)
+{
+    int result {0};
+    for (const auto& allele : get_called(alleles, call, sample)) {
+        result = std::max({result, static_cast<int>(region_size(allele)), static_cast<int>(sequence_size(allele))});
+    }
+    return result;
+}
+
+} // namespace
+
 Measure::ResultType VariantLength::do_evaluate(const VcfRecord& call, const FacetMap& facets) const
 {
     const auto& samples = get_value<Samples>(facets.at("Samples"));
@@ -30,15 +43,18 @@ Measure::ResultType VariantLength::do_evaluate(const VcfRecord& call, const Face
     Array<ValueType> result {};
     result.reserve(samples.size());
     for (const auto& sample : samples) {
-        int sample_result {0};
-        for (const auto& allele : get_called(alleles, call, sample)) {
-            sample_result = std::max({sample_result, static_cast<int>(region_size(allele)), static_cast<int>(sequence_size(allele))});
-        }
-        result.emplace_back(sample_result);
+        result.emplace_back(max_called_allele_length(alleles, call, sample));
     }
     return result;
 }
 
+Measure::Column VariantLength::do_evaluate_block(const std::vector<VcfRecord>& calls, const FacetMap& facets) const
+{
+    const auto& alleles = get_value<Alleles>(facets.at("Alleles"));
+    return make_column<int>(calls, get_value<Samples>(facets.at("Samples")),
+                            [&] (const VcfRecord& call, const SampleName& sample) { return max_called_allele_length(alleles, call, sample); });
+}
+
 Measure::ResultCardinality VariantLength::do_cardinality() const noexcept
 {
     return ResultCardinality::samples;
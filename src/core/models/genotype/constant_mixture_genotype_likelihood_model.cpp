@@ -12,6 +12,7 @@
 #include <cassert>
 
 #include "utils/maths.hpp"
+#include "utils/simd_log_sum_exp.hpp"
 
 namespace octopus { namespace model {
 
@@ -61,6 +62,21 @@ static constexpr auto ln(const unsigned n)
     return lnLookup[n];
 }
 
+using LikelihoodVector = HaplotypeLikelihoodArray::LikelihoodVector;
+
+// sum {read} ln sum {k} exp(log_weights[k]) p(read | haplotype k) - ln ploidy
+template <std::size_t K>
+double sum_log_mixture(const std::array<const LikelihoodVector*, K>& likelihoods,
+                       const std::array<double, K>& log_weights,
+                       const unsigned ploidy) noexcept
+{
+    std::array<const double*, K> rows;
+    std::transform(std::cbegin(likelihoods), std::cend(likelihoods), std::begin(rows),
+                   [] (const LikelihoodVector* row) noexcept { return row->data(); });
+    const auto num_likelihoods = likelihoods[0]->size();
+    return maths::simd::sum_log_sum_exp(rows, log_weights, num_likelihoods) - num_likelihoods * ln(ploidy);
+}
+
 } // namespace
 
 ConstantMixtureGenotypeLikelihoodModel::LogProbability
@@ -92,72 +108,33 @@ ConstantMixtureGenotypeLikelihoodModel::evaluate_diploid(const Genotype<Haplotyp
     if (is_homozygous(genotype)) {
         return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
     }
-    const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-    return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                              std::cbegin(log_likelihoods2), LogProbability {0}, std::plus<> {},
-                              [] (const auto a, const auto b) -> LogProbability {
-                                  return maths::log_sum_exp(a, b) - ln<decltype(a)>(2);
-                              });
+    return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[1]]}, {0, 0}, 2);
 }
 
 ConstantMixtureGenotypeLikelihoodModel::LogProbability
 ConstantMixtureGenotypeLikelihoodModel::evaluate_triploid(const Genotype<Haplotype>& genotype) const
 {
-    using std::cbegin; using std::cend;
     const auto& log_likelihoods1 = likelihoods_[genotype[0]];
     if (is_homozygous(genotype)) {
-        return std::accumulate(cbegin(log_likelihoods1), cend(log_likelihoods1), LogProbability {0});
+        return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
     }
     if (zygosity(genotype) == 3) {
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        const auto& log_likelihoods3 = likelihoods_[genotype[2]];
-        return maths::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                                    cbegin(log_likelihoods2), cbegin(log_likelihoods3),
-                                    LogProbability {0}, std::plus<> {},
-                                    [] (const auto a, const auto b, const auto c) -> LogProbability {
-                                        return maths::log_sum_exp(a, b, c) - ln<decltype(a)>(3);
-                                    });
+        return sum_log_mixture<3>({&log_likelihoods1, &likelihoods_[genotype[1]], &likelihoods_[genotype[2]]}, {0, 0, 0}, 3);
     }
     if (genotype[0] != genotype[1]) {
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        return std::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                                  cbegin(log_likelihoods2), LogProbability {0}, std::plus<> {},
-                                  [] (const auto a, const auto b) -> LogProbability {
-                                      return maths::log_sum_exp(a, ln<decltype(a)>(2) + b) - ln<decltype(a)>(3);
-                                  });
+        return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[1]]}, {0, ln(2)}, 3);
     }
-    const auto& log_likelihoods3 = likelihoods_[genotype[2]];
-    return std::inner_product(cbegin(log_likelihoods1), cend(log_likelihoods1),
-                              cbegin(log_likelihoods3), LogProbability {0}, std::plus<> {},
-                              [] (const auto a, const auto b) -> LogProbability {
-                                  return maths::log_sum_exp(ln<decltype(a)>(2) + a, b) - ln<decltype(a)>(3);
-                              });
+    return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[2]]}, {ln(2), 0}, 3);
 }
 
 ConstantMixtureGenotypeLikelihoodModel::LogProbability
 ConstantMixtureGenotypeLikelihoodModel::evaluate_polyploid(const Genotype<Haplotype>& genotype) const
 {
-    const auto ploidy = genotype.ploidy();
-    const auto ln_ploidy = std::log(ploidy);
     const auto& log_likelihoods1 = likelihoods_[genotype[0]];
     if (is_homozygous(genotype)) {
         return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
     }
-    likelihood_refs_.reserve(ploidy);
-    likelihood_refs_.push_back(log_likelihoods1);
-    std::transform(std::next(std::cbegin(genotype)), std::cend(genotype), std::back_inserter(likelihood_refs_),
-                   [this] (const auto& haplotype) -> const HaplotypeLikelihoodArray::LikelihoodVector& {
-                       return likelihoods_[haplotype]; });
-    LogProbability result {0};
-    const auto num_likelihoods = likelihood_refs_.front().get().size();
-    buffer_.resize(ploidy);
-    for (std::size_t read_idx {0}; read_idx < num_likelihoods; ++read_idx) {
-        std::transform(std::cbegin(likelihood_refs_), std::cend(likelihood_refs_), std::begin(buffer_),
-                       [read_idx] (const auto& likelihoods) noexcept { return likelihoods.get()[read_idx]; });
-        result += maths::log_sum_exp(buffer_) - ln_ploidy;
-    }
-    likelihood_refs_.clear();
-    return result;
+    return evaluate_mixture(genotype);
 }
 
 ConstantMixtureGenotypeLikelihoodModel::LogProbability
@@ -174,131 +151,67 @@ ConstantMixtureGenotypeLikelihoodModel::evaluate_diploid(const Genotype<IndexedH
     if (is_homozygous(genotype)) {
         return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
     } else {
-        constexpr static auto ln2 = ln<HaplotypeLikelihoodArray::LogProbability>(2);
-        (void) ln2; // To silence bad GCC unused-but-set-variable warning
-        const auto& log_likelihoods2 = likelihoods_[genotype[1]];
-        return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                                  std::cbegin(log_likelihoods2), LogProbability {0}, std::plus<> {},
-                                  [] (const auto a, const auto b) -> LogProbability {
-                                      return maths::log_sum_exp(a, b) - ln2;
-                                  });
+        return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[1]]}, {0, 0}, 2);
     }
 }
 
 ConstantMixtureGenotypeLikelihoodModel::LogProbability
 ConstantMixtureGenotypeLikelihoodModel::evaluate_triploid(const Genotype<IndexedHaplotype<>>& genotype) const
 {
-    constexpr static auto ln2 = ln<HaplotypeLikelihoodArray::LogProbability>(2);
-    constexpr static auto ln3 = ln<HaplotypeLikelihoodArray::LogProbability>(3);
-    (void) ln2; (void) ln3; // To silence bad GCC unused-but-set-variable warning
+    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
     if (genotype[0] == genotype[1]) {
         if (genotype[1] == genotype[2]) {
             // homozygous
-            return std::accumulate(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]), LogProbability {0});
+            return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
         } else {
-            return std::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                      std::cbegin(likelihoods_[genotype[2]]),
-                                      LogProbability {0}, std::plus<> {},
-                                      [] (const auto a, const auto b) -> LogProbability {
-                                          return maths::log_sum_exp(ln2 + a, b) - ln3;
-                                      });
+            return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[2]]}, {ln(2), 0}, 3);
         }
     } else if (genotype[1] == genotype[2]) {
-        return std::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                  std::cbegin(likelihoods_[genotype[1]]),
-                                  LogProbability {0}, std::plus<> {},
-                                  [] (const auto a, const auto b) -> LogProbability {
-                                      return maths::log_sum_exp(a, ln2 + b) - ln3;
-                                  });
+        return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[1]]}, {0, ln(2)}, 3);
     } else {
         // zygosity = 3
-        return maths::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                    std::cbegin(likelihoods_[genotype[1]]), 
-                                    std::cbegin(likelihoods_[genotype[2]]),
-                                    LogProbability {0}, std::plus<> {},
-                                    [] (const auto a, const auto b, const auto c) -> LogProbability {
-                                        return maths::log_sum_exp(a, b, c) - ln3;
-                                    });
+        return sum_log_mixture<3>({&log_likelihoods1, &likelihoods_[genotype[1]], &likelihoods_[genotype[2]]}, {0, 0, 0}, 3);
     }
 }
 
 ConstantMixtureGenotypeLikelihoodModel::LogProbability
 ConstantMixtureGenotypeLikelihoodModel::evaluate_tetraploid(const Genotype<IndexedHaplotype<>>& genotype) const
 {
-    constexpr static auto ln2 = ln<HaplotypeLikelihoodArray::LogProbability>(2);
-    constexpr static auto ln3 = ln<HaplotypeLikelihoodArray::LogProbability>(3);
-    constexpr static auto ln4 = ln<HaplotypeLikelihoodArray::LogProbability>(4);
-    (void) ln2; (void) ln3; (void) ln4; // To silence bad GCC unused-but-set-variable warning
+    const auto& log_likelihoods1 = likelihoods_[genotype[0]];
     if (genotype[0] == genotype[1]) {
         if (genotype[1] == genotype[2]) {
             if (genotype[2] == genotype[3]) {
                 // homozygous
-                return std::accumulate(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]), LogProbability {0});
+                return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), LogProbability {0});
             } else {
                 // zygosity = 2
-                return std::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                          std::cbegin(likelihoods_[genotype[3]]),
-                                          LogProbability {0}, std::plus<> {},
-                                          [] (const auto a, const auto b) -> LogProbability {
-                                              return maths::log_sum_exp(ln3 + a, b) - ln4;
-                                          });
+                return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[3]]}, {ln(3), 0}, 4);
             }
         } else if (genotype[2] == genotype[3]) {
             // zygosity = 2
-            return std::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                      std::cbegin(likelihoods_[genotype[2]]),
-                                      LogProbability {0}, std::plus<> {},
-                                      [] (const auto a, const auto b) -> LogProbability {
-                                          return maths::log_sum_exp(a, b) - ln2;
-                                      });
+            return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[2]]}, {0, 0}, 2);
         } else {
             // zygosity = 3
-            return maths::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                        std::cbegin(likelihoods_[genotype[2]]), 
-                                        std::cbegin(likelihoods_[genotype[3]]),
-                                        LogProbability {0}, std::plus<> {},
-                                        [] (const auto a, const auto b, const auto c) -> LogProbability {
-                                            return maths::log_sum_exp(ln2 + a, b, c) - ln4;
-                                        });
+            return sum_log_mixture<3>({&log_likelihoods1, &likelihoods_[genotype[2]], &likelihoods_[genotype[3]]},
+                                      {ln(2), 0, 0}, 4);
         }
     } else if (genotype[1] == genotype[2]) {
         if (genotype[2] == genotype[3]) {
             // zygosity = 2
-            return std::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                      std::cbegin(likelihoods_[genotype[1]]),
-                                      LogProbability {0}, std::plus<> {},
-                                      [] (const auto a, const auto b) -> LogProbability {
-                                          return maths::log_sum_exp(a, ln3 + b) - ln4;
-                                      });
+            return sum_log_mixture<2>({&log_likelihoods1, &likelihoods_[genotype[1]]}, {0, ln(3)}, 4);
         } else {
             // zygosity = 3
-            return maths::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                        std::cbegin(likelihoods_[genotype[1]]), 
-                                        std::cbegin(likelihoods_[genotype[3]]),
-                                        LogProbability {0}, std::plus<> {},
-                                        [] (const auto a, const auto b, const auto c) -> LogProbability {
-                                            return maths::log_sum_exp(a, ln2 + b, c) - ln4;
-                                        });
+            return sum_log_mixture<3>({&log_likelihoods1, &likelihoods_[genotype[1]], &likelihoods_[genotype[3]]},
+                                      {0, ln(2), 0}, 4);
         }
     } else if (genotype[2] == genotype[3]) {
         // zygosity = 3
-        return maths::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                    std::cbegin(likelihoods_[genotype[1]]), 
-                                    std::cbegin(likelihoods_[genotype[2]]),
-                                    LogProbability {0}, std::plus<> {},
-                                    [] (const auto a, const auto b, const auto c) -> LogProbability {
-                                        return maths::log_sum_exp(a, b, ln2 + c) - ln4;
-                                    });
+        return sum_log_mixture<3>({&log_likelihoods1, &likelihoods_[genotype[1]], &likelihoods_[genotype[2]]},
+                                  {0, 0, ln(2)}, 4);
     } else {
         // zygosity = 4
-        return maths::inner_product(std::cbegin(likelihoods_[genotype[0]]), std::cend(likelihoods_[genotype[0]]),
-                                    std::cbegin(likelihoods_[genotype[1]]), 
-                                    std::cbegin(likelihoods_[genotype[2]]),
-                                    std::cbegin(likelihoods_[genotype[3]]),
-                                    LogProbability {0}, std::plus<> {},
-                                    [] (const auto a, const auto b, const auto c, const auto d) -> LogProbability {
-                                        return maths::log_sum_exp({a, b, c, d}) - ln4;
-                                    });
+        return sum_log_mixture<4>({&log_likelihoods1, &likelihoods_[genotype[1]], &likelihoods_[genotype[2]], &likelihoods_[genotype[3]]},
+                                  {0, 0, 0, 0}, 4);
     }
 }
 
@@ -306,17 +219,76 @@ ConstantMixtureGenotypeLikelihoodModel::LogProbability
 ConstantMixtureGenotypeLikelihoodModel::evaluate_polyploid(const Genotype<IndexedHaplotype<>>& genotype) const
 {
     assert(likelihoods_.is_primed());
-    const auto ln_ploidy = std::log(genotype.ploidy());
-    buffer_.resize(genotype.ploidy());
-    LogProbability result {0};
-    const auto num_likelihoods = likelihoods_.num_likelihoods();
-    for (std::size_t read_idx {0}; read_idx < num_likelihoods; ++read_idx) {
-        std::transform(std::cbegin(genotype), std::cend(genotype), std::begin(buffer_),
-                       [&] (const auto& haplotype) noexcept { return likelihoods_[haplotype][read_idx]; });
-        result += maths::log_sum_exp(buffer_) - ln_ploidy;
+    return evaluate_mixture(genotype);
+}
+
+template <typename H>
+ConstantMixtureGenotypeLikelihoodModel::LogProbability
+ConstantMixtureGenotypeLikelihoodModel::evaluate_mixture(const Genotype<H>& genotype) const
+{
+    // Genotypes are sorted so copies of a haplotype are adjacent; each distinct haplotype is
+    // evaluated once with weight ln(copies)
+    assert(likelihood_rows_.empty() && buffer_.empty());
+    for (auto first = std::cbegin(genotype); first != std::cend(genotype);) {
+        const auto last = std::find_if_not(std::next(first), std::cend(genotype),
+                                           [first] (const auto& haplotype) { return haplotype == *first; });
+        likelihood_rows_.push_back(likelihoods_[*first].data());
+        buffer_.push_back(std::log(static_cast<LogProbability>(std::distance(first, last))));
+        first = last;
     }
+    const auto num_likelihoods = likelihoods_[genotype[0]].size();
+    const auto result = maths::simd::sum_log_sum_exp(likelihood_rows_.data(), buffer_.data(), likelihood_rows_.size(), num_likelihoods)
+                        - num_likelihoods * std::log(genotype.ploidy());
+    likelihood_rows_.clear();
+    buffer_.clear();
     return result;
 }
 
+ConstantMixtureGenotypeLikelihoodModel::LogProbability
+ConstantMixtureGenotypeLikelihoodModel::evaluate_batched(const Genotype<Haplotype>& genotype) const
+{
+    return evaluate(genotype);
+}
+
+ConstantMixtureGenotypeLikelihoodModel::LogProbability
+ConstantMixtureGenotypeLikelihoodModel::evaluate_batched(const Genotype<IndexedHaplotype<>>& genotype) const
+{
+    const auto ploidy = genotype.ploidy();
+    if (ploidy < 3) return evaluate(genotype);
+    // batch_prefix_likelihoods_[l][read] = ln sum {j <= l} p(read | batch_prefix_[j]), so only the rows after the
+    // haplotypes shared with the previous genotype need updating, and the rest is a two row mixture.
+    const auto prefix_length = ploidy - 1;
+    std::size_t num_shared {0};
+    while (num_shared < std::min(prefix_length, static_cast<unsigned>(batch_prefix_.size()))
+           && batch_prefix_[num_shared] == index_of(genotype[num_shared])) {
+        ++num_shared;
+    }
+    batch_prefix_.resize(num_shared);
+    if (batch_prefix_likelihoods_.size() < prefix_length) batch_prefix_likelihoods_.resize(prefix_length);
+    for (auto l = num_shared; l < prefix_length; ++l) {
+        const auto& log_likelihoods = likelihoods_[genotype[l]];
+        auto& prefix_likelihoods = batch_prefix_likelihoods_[l];
+        if (l == 0) {
+            prefix_likelihoods.assign(std::cbegin(log_likelihoods), std::cend(log_likelihoods));
+        } else {
+            const auto& prev_prefix_likelihoods = batch_prefix_likelihoods_[l - 1];
+            prefix_likelihoods.resize(log_likelihoods.size());
+            std::transform(std::cbegin(prev_prefix_likelihoods), std::cend(prev_prefix_likelihoods), std::cbegin(log_likelihoods),
+                           std::begin(prefix_likelihoods), [] (auto a, auto b) { return maths::log_sum_exp(a, b); });
+        }
+        batch_prefix_.push_back(index_of(genotype[l]));
+    }
+    const auto& log_likelihoods = likelihoods_[genotype[prefix_length]];
+    const std::array<const double*, 2> rows {batch_prefix_likelihoods_[prefix_length - 1].data(), log_likelihoods.data()};
+    const auto num_likelihoods = log_likelihoods.size();
+    return maths::simd::sum_log_sum_exp(rows, {0, 0}, num_likelihoods) - num_likelihoods * std::log(ploidy);
+}
+
+void ConstantMixtureGenotypeLikelihoodModel::clear_batch() const noexcept
+{
+    // The primed sample may have changed
+    batch_prefix_.clear();
+}
+
 } // namespace model
 } // namespace octopus
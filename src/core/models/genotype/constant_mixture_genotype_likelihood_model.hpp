@@ -5,6 +5,8 @@
 #define constant_mixture_genotype_likelihood_model_hpp
 
 #include <vector>
+#include <iterator>
+#include <algorithm>
 
 #include "core/types/haplotype.hpp"
 #include "core/types/indexed_haplotype.hpp"
@@ -34,10 +36,17 @@ public:
     LogProbability evaluate(const Genotype<Haplotype>& genotype) const;
     LogProbability evaluate(const Genotype<IndexedHaplotype<>>& genotype) const;
     
+    // Evaluates a batch of genotypes for the primed sample. Consecutive polyploid genotypes that share
+    // leading haplotypes (e.g. sorted genotypes) share the per-read likelihoods of those haplotypes.
+    template <typename Container, typename OutputIterator>
+    OutputIterator evaluate(const Container& genotypes, OutputIterator result) const;
+    
 private:
     const HaplotypeLikelihoodArray& likelihoods_;
     mutable std::vector<HaplotypeLikelihoodArray::LogProbability> buffer_;
-    mutable std::vector<HaplotypeLikelihoodArray::LikelihoodVectorRef> likelihood_refs_;
+    mutable std::vector<const HaplotypeLikelihoodArray::LogProbability*> likelihood_rows_;
+    mutable std::vector<std::size_t> batch_prefix_;
+    mutable std::vector<std::vector<LogProbability>> batch_prefix_likelihoods_;
     
     // These are just for optimisation
     LogProbability evaluate_haploid(const Genotype<Haplotype>& genotype) const;
@@ -49,15 +58,27 @@ private:
     LogProbability evaluate_triploid(const Genotype<IndexedHaplotype<>>& genotype) const;
     LogProbability evaluate_tetraploid(const Genotype<IndexedHaplotype<>>& genotype) const;
     LogProbability evaluate_polyploid(const Genotype<IndexedHaplotype<>>& genotype) const;
+    template <typename H> LogProbability evaluate_mixture(const Genotype<H>& genotype) const;
+    LogProbability evaluate_batched(const Genotype<Haplotype>& genotype) const;
+    LogProbability evaluate_batched(const Genotype<IndexedHaplotype<>>& genotype) const;
+    void clear_batch() const noexcept;
 };
 
+template <typename Container, typename OutputIterator>
+OutputIterator
+ConstantMixtureGenotypeLikelihoodModel::evaluate(const Container& genotypes, OutputIterator result) const
+{
+    clear_batch();
+    return std::transform(std::cbegin(genotypes), std::cend(genotypes), result,
+                          [this] (const auto& genotype) { return this->evaluate_batched(genotype); });
+}
+
 template <typename Container1, typename Container2>
 Container2&
 evaluate(const Container1& genotypes, const ConstantMixtureGenotypeLikelihoodModel& model, Container2& result)
 {
     result.resize(genotypes.size());
-    std::transform(std::cbegin(genotypes), std::cend(genotypes), std::begin(result),
-                   [&] (const auto& genotype) { return model.evaluate(genotype); });
+    model.evaluate(genotypes, std::begin(result));
     return result;
 }
 
@@ -140,8 +140,7 @@ compute_genotype_log_likelihoods(const std::vector<SampleName>& samples,
     std::transform(std::cbegin(samples), std::cend(samples), std::back_inserter(result), [&] (const auto& sample) {
         GenotypeLogLikelihoodVector likelihoods(genotypes.size());
         haplotype_likelihoods.prime(sample);
-        std::transform(std::cbegin(genotypes), std::cend(genotypes), std::begin(likelihoods),
-                       [&] (const auto& genotype) { return likelihood_model.evaluate(genotype); });
+        likelihood_model.evaluate(genotypes, std::begin(likelihoods));
         return likelihoods;
     });
     return result;
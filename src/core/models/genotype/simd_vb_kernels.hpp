@@ -0,0 +1,209 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef simd_vb_kernels_hpp
+#define simd_vb_kernels_hpp
+
+#if __GNUC__ >= 6
+    #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+    #include "fmath.hpp"
+#endif
+
+namespace octopus { namespace model { namespace simd {
+
+/*
+    float32 kernels for the structure-of-arrays Variational Bayes updates. All arrays are
+    contiguous and need not be aligned. Sums are accumulated in float lanes and returned as double.
+ */
+
+namespace detail {
+
+#if defined(__AVX2__)
+
+static constexpr std::size_t blockSize {8};
+
+using FloatBlock = __m256;
+
+inline FloatBlock load(const float* x) noexcept { return _mm256_loadu_ps(x); }
+inline void store(float* x, const FloatBlock v) noexcept { _mm256_storeu_ps(x, v); }
+inline FloatBlock set1(const float x) noexcept { return _mm256_set1_ps(x); }
+inline FloatBlock zero() noexcept { return _mm256_setzero_ps(); }
+inline FloatBlock add(const FloatBlock a, const FloatBlock b) noexcept { return _mm256_add_ps(a, b); }
+inline FloatBlock sub(const FloatBlock a, const FloatBlock b) noexcept { return _mm256_sub_ps(a, b); }
+inline FloatBlock mul(const FloatBlock a, const FloatBlock b) noexcept { return _mm256_mul_ps(a, b); }
+inline FloatBlock div(const FloatBlock a, const FloatBlock b) noexcept { return _mm256_div_ps(a, b); }
+inline FloatBlock max(const FloatBlock a, const FloatBlock b) noexcept { return _mm256_max_ps(a, b); }
+inline FloatBlock exp(const FloatBlock x) noexcept { return fmath::exp_ps256(x); }
+
+inline FloatBlock fmadd(const FloatBlock a, const FloatBlock b, const FloatBlock c) noexcept
+{
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+inline FloatBlock log(const FloatBlock x) noexcept
+{
+    const auto lo = fmath::log_ps(_mm256_castps256_ps128(x));
+    const auto hi = fmath::log_ps(_mm256_extractf128_ps(x, 1));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+inline double hsum(const FloatBlock v) noexcept
+{
+    const auto lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+    const auto hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+    const auto sums = _mm256_add_pd(lo, hi);
+    const auto pairs = _mm_add_pd(_mm256_castpd256_pd128(sums), _mm256_extractf128_pd(sums, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+}
+
+#elif defined(__SSE2__)
+
+static constexpr std::size_t blockSize {4};
+
+using FloatBlock = __m128;
+
+inline FloatBlock load(const float* x) noexcept { return _mm_loadu_ps(x); }
+inline void store(float* x, const FloatBlock v) noexcept { _mm_storeu_ps(x, v); }
+inline FloatBlock set1(const float x) noexcept { return _mm_set1_ps(x); }
+inline FloatBlock zero() noexcept { return _mm_setzero_ps(); }
+inline FloatBlock add(const FloatBlock a, const FloatBlock b) noexcept { return _mm_add_ps(a, b); }
+inline FloatBlock sub(const FloatBlock a, const FloatBlock b) noexcept { return _mm_sub_ps(a, b); }
+inline FloatBlock mul(const FloatBlock a, const FloatBlock b) noexcept { return _mm_mul_ps(a, b); }
+inline FloatBlock div(const FloatBlock a, const FloatBlock b) noexcept { return _mm_div_ps(a, b); }
+inline FloatBlock max(const FloatBlock a, const FloatBlock b) noexcept { return _mm_max_ps(a, b); }
+inline FloatBlock exp(const FloatBlock x) noexcept { return fmath::exp_ps(x); }
+inline FloatBlock log(const FloatBlock x) noexcept { return fmath::log_ps(x); }
+inline FloatBlock fmadd(const FloatBlock a, const FloatBlock b, const FloatBlock c) noexcept { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+inline double hsum(const FloatBlock v) noexcept
+{
+    const auto sums = _mm_add_pd(_mm_cvtps_pd(v), _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    return _mm_cvtsd_f64(_mm_add_sd(sums, _mm_unpackhi_pd(sums, sums)));
+}
+
+#else
+
+static constexpr std::size_t blockSize {0};
+
+#endif
+
+#if defined(__SSE2__)
+inline std::size_t num_block_elements(const std::size_t n) noexcept { return n - n % blockSize; }
+#else
+inline std::size_t num_block_elements(const std::size_t) noexcept { return 0; }
+#endif
+
+} // namespace detail
+
+// y[i] += a * x[i] for i < n
+inline void axpy(const float a, const float* x, float* y, const std::size_t n) noexcept
+{
+    const auto m = detail::num_block_elements(n);
+#if defined(__SSE2__)
+    const auto av = detail::set1(a);
+    for (std::size_t i {0}; i < m; i += detail::blockSize) {
+        detail::store(y + i, detail::fmadd(av, detail::load(x + i), detail::load(y + i)));
+    }
+#endif
+    for (auto i = m; i < n; ++i) y[i] += a * x[i];
+}
+
+// sum_i x[i] * y[i] for i < n
+inline double dot(const float* x, const float* y, const std::size_t n) noexcept
+{
+    const auto m = detail::num_block_elements(n);
+    double result {0};
+#if defined(__SSE2__)
+    auto sums = detail::zero();
+    for (std::size_t i {0}; i < m; i += detail::blockSize) {
+        sums = detail::fmadd(detail::load(x + i), detail::load(y + i), sums);
+    }
+    result = detail::hsum(sums);
+#endif
+    for (auto i = m; i < n; ++i) result += x[i] * y[i];
+    return result;
+}
+
+/*
+    Normalises each of the n columns of the k x n matrix rows, i.e. rows[j][i] = exp(rows[j][i]) / sum_j exp(rows[j][i]),
+    in place. row_sums[j] is set to the sum of normalised row j, and the total entropy -sum p ln p is returned.
+    
+    As ln p = x - max - ln sum_j exp(x_j - max), only one log is needed per column. Exponents are
+    clamped below at ln(FLT_MIN), so underflowed or -inf inputs give vanishing probabilities with
+    finite p ln p terms rather than NaN entropies.
+ */
+inline double normalise_exp_columns(float* const* rows, const std::size_t k, const std::size_t n, double* row_sums) noexcept
+{
+    constexpr float minExponent {-87.33654f}; // ln(FLT_MIN)
+    auto m = detail::num_block_elements(n);
+    double neg_entropy {0};
+    std::fill_n(row_sums, k, 0.0);
+#if defined(__SSE2__)
+    constexpr std::size_t maxRows {8};
+    if (k <= maxRows) {
+        detail::FloatBlock sums[maxRows];
+        std::fill_n(sums, k, detail::zero());
+        auto neg_entropies = detail::zero();
+        const auto min_exponent = detail::set1(minExponent);
+        for (std::size_t i {0}; i < m; i += detail::blockSize) {
+            auto max = detail::load(rows[0] + i);
+            for (std::size_t j {1}; j < k; ++j) max = detail::max(detail::load(rows[j] + i), max);
+            detail::FloatBlock shifted[maxRows], exps[maxRows];
+            auto norm = detail::zero();
+            for (std::size_t j {0}; j < k; ++j) {
+                // min_exponent must be the second operand so NaN (from -inf - -inf) is also clamped
+                shifted[j] = detail::max(detail::sub(detail::load(rows[j] + i), max), min_exponent);
+                exps[j] = detail::exp(shifted[j]);
+                norm = detail::add(norm, exps[j]);
+            }
+            const auto ln_norm = detail::log(norm);
+            for (std::size_t j {0}; j < k; ++j) {
+                const auto p = detail::div(exps[j], norm);
+                detail::store(rows[j] + i, p);
+                sums[j] = detail::add(sums[j], p);
+                neg_entropies = detail::fmadd(p, detail::sub(shifted[j], ln_norm), neg_entropies);
+            }
+        }
+        for (std::size_t j {0}; j < k; ++j) row_sums[j] = detail::hsum(sums[j]);
+        neg_entropy = detail::hsum(neg_entropies);
+    } else {
+        m = 0; // fall through to the scalar loop
+    }
+#endif
+    for (auto i = m; i < n; ++i) {
+        float max {rows[0][i]};
+        for (std::size_t j {1}; j < k; ++j) max = std::max(rows[j][i], max);
+        float norm {0};
+        for (std::size_t j {0}; j < k; ++j) {
+            rows[j][i] = std::max(minExponent, rows[j][i] - max);
+            norm += std::exp(rows[j][i]);
+        }
+        const auto ln_norm = std::log(norm);
+        for (std::size_t j {0}; j < k; ++j) {
+            const auto ln_p = rows[j][i] - ln_norm;
+            const auto p = std::exp(ln_p);
+            rows[j][i] = p;
+            row_sums[j] += p;
+            neg_entropy += p * ln_p;
+        }
+    }
+    return -neg_entropy;
+}
+
+} // namespace simd
+} // namespace model
+} // namespace octopus
+
+#endif
@@ -37,6 +37,7 @@ public:
         unsigned max_seeds      = 12;
         boost::optional<MemoryFootprint> target_max_memory = boost::none;
         ExecutionPolicy execution_policy = ExecutionPolicy::seq;
+        bool double_precision_vb = false;
     };
     
     struct Priors
@@ -66,6 +67,7 @@ public:
         typename Latents::LogProbabilityVector genotype_log_priors;
         typename Latents::ProbabilityVector weighted_genotype_posteriors;
         double approx_log_evidence;
+        VBInferenceStatistics vb_statistics = {};
     };
     
     SubcloneModelBase() = delete;
@@ -275,7 +277,8 @@ expand(VBResultPacket<K>& vb_results, const std::vector<SampleName>& samples, Lo
     return {std::move(posterior_latents),
             std::move(genotype_log_priors),
             std::move(vb_results.evidence_weighted_genotype_posteriors),
-            vb_results.max_log_evidence};
+            vb_results.max_log_evidence,
+            vb_results.statistics};
 }
 
 template <std::size_t K, typename G, typename GPM>
@@ -289,6 +292,7 @@ run_variational_bayes_helper(const std::vector<SampleName>& samples,
                              std::vector<LogProbabilityVector>&& seeds)
 {
     VariationalBayesParameters vb_params {params.epsilon, params.max_iterations};
+    vb_params.double_precision = params.double_precision_vb;
     if (params.target_max_memory) {
         const auto estimated_memory_default = estimate_memory_requirement<K>(samples, haplotype_log_likelihoods, genotypes.size(), vb_params);
         if (estimated_memory_default > *params.target_max_memory) {
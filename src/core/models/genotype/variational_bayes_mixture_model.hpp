@@ -14,6 +14,10 @@
 #include <cassert>
 #include <limits>
 #include <type_traits>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <memory>
 
 #include <boost/optional.hpp>
 #include <boost/math/special_functions/digamma.hpp>
@@ -22,6 +26,8 @@
 #include "utils/maths.hpp"
 #include "utils/memory_footprint.hpp"
 #include "utils/parallel_transform.hpp"
+#include "utils/erase_if.hpp"
+#include "simd_vb_kernels.hpp"
 
 
 /**
@@ -41,6 +47,9 @@ struct VariationalBayesParameters
     unsigned max_iterations = 1000;
     bool save_memory = false;
     bool parallel_execution = false;
+    bool double_precision = false; // use the reference implementation rather than the float32 one, e.g. for verification
+    boost::optional<double> seed_pruning_margin = 20.0; // drop seeds projected to end this far below the best evidence
+    unsigned seed_pruning_round_iterations = 10;
 };
 
 using ProbabilityVector    = std::vector<double>;
@@ -100,6 +109,11 @@ struct VBLatents
     VBResponsibilityMatrix<K> responsibilities;
 };
 
+struct VBInferenceStatistics
+{
+    unsigned num_seeds = 0, num_pruned_seeds = 0, num_iterations = 0;
+};
+
 // Main VB method
 
 namespace detail {
@@ -453,60 +467,450 @@ auto calculate_evidence_lower_bound(const VBAlphaVector<K>& prior_alphas,
 }
 
 // Main algorithm - single seed
+//
+// Seeds are advanced one iteration at a time, so that several seeds can be run in rounds.
+
+struct VBSeedProgress
+{
+    double evidence = std::numeric_limits<double>::lowest();
+    double round_gain = std::numeric_limits<double>::infinity(), prev_round_gain = std::numeric_limits<double>::infinity();
+    unsigned num_iterations = 0;
+    bool converged = false, pruned = false;
+};
+
+// Returns true if the seed has not converged
+inline bool update_progress(VBSeedProgress& progress, const double curr_evidence, const double epsilon) noexcept
+{
+    ++progress.num_iterations;
+    if (curr_evidence <= progress.evidence || (curr_evidence - progress.evidence) < epsilon) {
+        progress.converged = true;
+    } else {
+        progress.evidence = curr_evidence;
+    }
+    return !progress.converged;
+}
+
+template <std::size_t K>
+struct VBSeedState
+{
+    ProbabilityVector genotype_posteriors;
+    LogProbabilityVector genotype_log_posteriors;
+    VBAlphaVector<K> posterior_alphas;
+    VBResponsibilityMatrix<K> responsibilities;
+    VBSeedProgress progress;
+};
 
 // Starting iteration with given genotype_log_posteriors
-template <std::size_t K, typename VBLikelihoodMatrix1, typename VBLikelihoodMatrix2>
-VBLatents<K>
-run_variational_bayes(const VBAlphaVector<K>& prior_alphas,
-                      const LogProbabilityVector& genotype_log_priors,
-                      const VBLikelihoodMatrix1& log_likelihoods1,
-                      const VBLikelihoodMatrix2& log_likelihoods2,
-                      LogProbabilityVector genotype_log_posteriors,
-                      const VariationalBayesParameters& params)
+template <std::size_t K, typename VBLikelihoodMatrix>
+VBSeedState<K>
+init_seed(const VBAlphaVector<K>& prior_alphas,
+          const VBLikelihoodMatrix& log_likelihoods,
+          LogProbabilityVector genotype_log_posteriors)
 {
     assert(!prior_alphas.empty());
-    assert(!genotype_log_priors.empty());
-    assert(!log_likelihoods1.empty());
+    assert(!log_likelihoods.empty());
+    assert(prior_alphas.size() == log_likelihoods.size()); // num samples
+    auto genotype_posteriors = exp(genotype_log_posteriors);
+    auto responsibilities = init_responsibilities<K>(prior_alphas, genotype_posteriors, log_likelihoods);
+    assert(responsibilities.size() == log_likelihoods.size()); // num samples
+    return {std::move(genotype_posteriors), std::move(genotype_log_posteriors), prior_alphas, std::move(responsibilities), {}};
+}
+
+// log_likelihoods2 may be an inverted copy of log_likelihoods1
+template <std::size_t K, typename VBLikelihoodMatrix1, typename VBLikelihoodMatrix2>
+void iterate(VBSeedState<K>& seed,
+             const VBAlphaVector<K>& prior_alphas,
+             const LogProbabilityVector& genotype_log_priors,
+             const VBLikelihoodMatrix1& log_likelihoods1,
+             const VBLikelihoodMatrix2& log_likelihoods2,
+             const VariationalBayesParameters& params)
+{
     assert(log_likelihoods1.size() == log_likelihoods2.size());
-    assert(prior_alphas.size() == log_likelihoods1.size()); // num samples
     assert(log_likelihoods1.front().size() == genotype_log_priors.size()); // num genotypes
-    assert(params.max_iterations > 0);
-    auto genotype_posteriors = exp(genotype_log_posteriors);
-    auto posterior_alphas = prior_alphas;
-    auto responsibilities = init_responsibilities<K>(posterior_alphas, genotype_posteriors, log_likelihoods2);
-    assert(responsibilities.size() == log_likelihoods1.size()); // num samples
-    auto prev_evidence = std::numeric_limits<double>::lowest();
-    for (unsigned i {0}; i < params.max_iterations; ++i) {
-        update_genotype_log_posteriors(genotype_log_posteriors, genotype_log_priors, responsibilities, log_likelihoods1);
-        exp(genotype_log_posteriors, genotype_posteriors);
-        update_alphas(posterior_alphas, prior_alphas, responsibilities);
-        auto curr_evidence = calculate_evidence_lower_bound(prior_alphas, posterior_alphas, genotype_log_priors,
-                                                            genotype_posteriors, genotype_log_posteriors, responsibilities,
-                                                            log_likelihoods1, 1e-10);
-        if (curr_evidence <= prev_evidence || (curr_evidence - prev_evidence) < params.epsilon) break;
-        prev_evidence = curr_evidence;
-        update_responsibilities(responsibilities, posterior_alphas, genotype_posteriors, log_likelihoods2);
+    update_genotype_log_posteriors(seed.genotype_log_posteriors, genotype_log_priors, seed.responsibilities, log_likelihoods1);
+    exp(seed.genotype_log_posteriors, seed.genotype_posteriors);
+    update_alphas(seed.posterior_alphas, prior_alphas, seed.responsibilities);
+    const auto curr_evidence = calculate_evidence_lower_bound(prior_alphas, seed.posterior_alphas, genotype_log_priors,
+                                                              seed.genotype_posteriors, seed.genotype_log_posteriors,
+                                                              seed.responsibilities, log_likelihoods1, 1e-10);
+    if (update_progress(seed.progress, curr_evidence, params.epsilon)) {
+        update_responsibilities(seed.responsibilities, seed.posterior_alphas, seed.genotype_posteriors, log_likelihoods2);
     }
+}
+
+template <std::size_t K>
+VBLatents<K> to_latents(VBSeedState<K>&& seed)
+{
     return VBLatents<K> {
-        std::move(genotype_posteriors), std::move(genotype_log_posteriors),
-        std::move(posterior_alphas), std::move(responsibilities)
+        std::move(seed.genotype_posteriors), std::move(seed.genotype_log_posteriors),
+        std::move(seed.posterior_alphas), std::move(seed.responsibilities)
     };
 }
 
-// Not using inverted log likelihoods
+// Main algorithm - single seed, float32
+//
+// The likelihoods of each sample are copied into one contiguous float (genotype x read) matrix per
+// haplotype in genotype, and responsibilities are kept as float (haplotype x read) arrays. Both
+// the responsibility update (a sum of likelihood rows weighted by genotype posteriors, followed
+// by a column-wise normalisation) and the genotype update (dot products of responsibilities and
+// likelihood rows) then run as SIMD kernels over reads. The alphas and responsibility entropies
+// are computed while normalising the responsibilities, and the genotype update marginals are
+// reused in the evidence lower bound.
+
 template <std::size_t K>
-VBLatents<K>
-run_variational_bayes(const VBAlphaVector<K>& prior_alphas,
-                      const LogProbabilityVector& genotype_log_priors,
-                      const VBReadLikelihoodMatrix<K>& log_likelihoods,
-                      LogProbabilityVector genotype_log_posteriors,
-                      const VariationalBayesParameters& params)
+struct VBFloatSampleLikelihoods
+{
+    std::size_t num_reads;
+    std::array<std::vector<float>, K> log_likelihoods; // One (genotype x read) matrix per haplotype in genotype
+    const float* row(unsigned k, std::size_t g) const noexcept { return log_likelihoods[k].data() + g * num_reads; }
+};
+template <std::size_t K>
+using VBFloatLikelihoodMatrix = std::vector<VBFloatSampleLikelihoods<K>>; // One element per sample
+
+using VBFloatTau = std::vector<float>; // One element per read
+template <std::size_t K>
+using VBFloatResponsibilityVector = std::array<VBFloatTau, K>; // One element per haplotype in genotype
+template <std::size_t K>
+using VBFloatResponsibilityMatrix = std::vector<VBFloatResponsibilityVector<K>>; // One element per sample
+
+template <std::size_t K>
+auto demote(const VBGenotypeVector<K>& likelihoods)
+{
+    const auto num_genotypes = likelihoods.size();
+    VBFloatSampleLikelihoods<K> result {count_reads(likelihoods), {}};
+    for (unsigned k {0}; k < K; ++k) {
+        auto& matrix = result.log_likelihoods[k];
+        matrix.resize(num_genotypes * result.num_reads);
+        for (std::size_t g {0}; g < num_genotypes; ++g) {
+            std::copy(std::cbegin(likelihoods[g][k]), std::cend(likelihoods[g][k]), std::next(std::begin(matrix), g * result.num_reads));
+        }
+    }
+    return result;
+}
+
+template <std::size_t K>
+auto demote(const VBReadLikelihoodMatrix<K>& matrix)
+{
+    VBFloatLikelihoodMatrix<K> result {};
+    result.reserve(matrix.size());
+    std::transform(std::cbegin(matrix), std::cend(matrix), std::back_inserter(result),
+                   [] (const auto& v) { return demote(v); });
+    return result;
+}
+
+// Genotypes with smaller posterior probability are ignored when updating responsibilities
+constexpr float vbMinGenotypePosterior {1e-10};
+
+template <std::size_t K>
+struct VBFloatResponsibilityStatistics
+{
+    VBAlphaVector<K> tau_sums; // One element per sample
+    double entropy;
+};
+
+template <std::size_t K>
+auto update_responsibilities(VBFloatResponsibilityVector<K>& result,
+                             const VBAlpha<K>& posterior_alphas,
+                             const std::vector<float>& genotype_probabilities,
+                             const VBFloatSampleLikelihoods<K>& read_likelihoods,
+                             VBAlpha<K>& tau_sums) noexcept
+{
+    const auto al = compute_digamma_diffs(posterior_alphas);
+    const auto N = read_likelihoods.num_reads;
+    const auto G = genotype_probabilities.size();
+    std::array<float*, K> rows;
+    for (unsigned k {0}; k < K; ++k) {
+        auto& ln_rho = result[k];
+        std::fill(std::begin(ln_rho), std::end(ln_rho), al[k]);
+        for (std::size_t g {0}; g < G; ++g) {
+            if (genotype_probabilities[g] >= vbMinGenotypePosterior) {
+                simd::axpy(genotype_probabilities[g], read_likelihoods.row(k, g), ln_rho.data(), N);
+            }
+        }
+        rows[k] = ln_rho.data();
+    }
+    std::array<double, K> row_sums;
+    const auto entropy = simd::normalise_exp_columns(rows.data(), K, N, row_sums.data());
+    std::copy(std::cbegin(row_sums), std::cend(row_sums), std::begin(tau_sums));
+    return entropy;
+}
+
+template <std::size_t K>
+void update_responsibilities(VBFloatResponsibilityMatrix<K>& result,
+                             VBFloatResponsibilityStatistics<K>& statistics,
+                             const VBAlphaVector<K>& posterior_alphas,
+                             const ProbabilityVector& genotype_probabilities,
+                             const VBFloatLikelihoodMatrix<K>& read_likelihoods)
+{
+    const std::vector<float> demoted_genotype_probabilities {std::cbegin(genotype_probabilities), std::cend(genotype_probabilities)};
+    const auto S = read_likelihoods.size();
+    statistics.entropy = 0;
+    for (std::size_t s {0}; s < S; ++s) {
+        statistics.entropy += update_responsibilities(result[s], posterior_alphas[s], demoted_genotype_probabilities,
+                                                      read_likelihoods[s], statistics.tau_sums[s]);
+    }
+}
+
+template <std::size_t K>
+void update_alphas(VBAlphaVector<K>& alphas, const VBAlphaVector<K>& prior_alphas,
+                   const VBFloatResponsibilityStatistics<K>& statistics) noexcept
+{
+    const auto S = alphas.size();
+    for (std::size_t s {0}; s < S; ++s) {
+        for (unsigned k {0}; k < K; ++k) {
+            alphas[s][k] = prior_alphas[s][k] + statistics.tau_sums[s][k];
+        }
+    }
+}
+
+// Sets marginals[g] = sum_s sum_k tau[s][k] . ln p(reads[s] | genotype[g][k])
+template <std::size_t K>
+void update_genotype_log_posteriors(LogProbabilityVector& result,
+                                    std::vector<double>& marginals,
+                                    const LogProbabilityVector& genotype_log_priors,
+                                    const VBFloatResponsibilityMatrix<K>& responsibilities,
+                                    const VBFloatLikelihoodMatrix<K>& read_likelihoods)
+{
+    const auto G = result.size();
+    const auto S = read_likelihoods.size();
+    for (std::size_t g {0}; g < G; ++g) {
+        double marginal {0};
+        for (std::size_t s {0}; s < S; ++s) {
+            for (unsigned k {0}; k < K; ++k) {
+                marginal += simd::dot(responsibilities[s][k].data(), read_likelihoods[s].row(k, g), read_likelihoods[s].num_reads);
+            }
+        }
+        marginals[g] = marginal;
+        result[g] = genotype_log_priors[g] + marginal;
+    }
+    maths::normalise_logs(result);
+}
+
+template <std::size_t K>
+auto calculate_evidence_lower_bound(const VBAlphaVector<K>& prior_alphas,
+                                    const VBAlphaVector<K>& posterior_alphas,
+                                    const LogProbabilityVector& genotype_log_priors,
+                                    const ProbabilityVector& genotype_posteriors,
+                                    const LogProbabilityVector& genotype_log_posteriors,
+                                    const std::vector<double>& marginals,
+                                    const VBFloatResponsibilityStatistics<K>& statistics) noexcept
+{
+    const auto G = genotype_log_priors.size();
+    const auto S = prior_alphas.size();
+    double result {statistics.entropy};
+    for (std::size_t g {0}; g < G; ++g) {
+        if (genotype_posteriors[g] >= 1e-10) {
+            result += genotype_posteriors[g] * (genotype_log_priors[g] - genotype_log_posteriors[g] + marginals[g]);
+        }
+    }
+    for (std::size_t s {0}; s < S; ++s) {
+        result += (maths::log_beta(posterior_alphas[s]) - maths::log_beta(prior_alphas[s]));
+    }
+    return result;
+}
+
+template <std::size_t K>
+VBResponsibilityMatrix<K> promote(const VBFloatResponsibilityMatrix<K>& responsibilities)
+{
+    VBResponsibilityMatrix<K> result(responsibilities.size());
+    for (std::size_t s {0}; s < responsibilities.size(); ++s) {
+        for (unsigned k {0}; k < K; ++k) {
+            result[s][k].assign(std::cbegin(responsibilities[s][k]), std::cend(responsibilities[s][k]));
+        }
+    }
+    return result;
+}
+
+template <std::size_t K>
+struct VBFloatSeedState
+{
+    ProbabilityVector genotype_posteriors;
+    LogProbabilityVector genotype_log_posteriors;
+    VBAlphaVector<K> posterior_alphas;
+    VBFloatResponsibilityMatrix<K> responsibilities;
+    VBFloatResponsibilityStatistics<K> statistics;
+    std::vector<double> marginals; // One element per genotype
+    VBSeedProgress progress;
+};
+
+template <std::size_t K>
+VBFloatSeedState<K>
+init_seed(const VBAlphaVector<K>& prior_alphas,
+          const VBFloatLikelihoodMatrix<K>& log_likelihoods,
+          LogProbabilityVector genotype_log_posteriors)
+{
+    assert(!prior_alphas.empty());
+    assert(prior_alphas.size() == log_likelihoods.size()); // num samples
+    const auto S = log_likelihoods.size();
+    const auto G = genotype_log_posteriors.size();
+    VBFloatSeedState<K> result {};
+    result.genotype_posteriors = exp(genotype_log_posteriors);
+    result.genotype_log_posteriors = std::move(genotype_log_posteriors);
+    result.posterior_alphas = prior_alphas;
+    result.responsibilities.resize(S);
+    for (std::size_t s {0}; s < S; ++s) {
+        for (auto& tau : result.responsibilities[s]) tau.resize(log_likelihoods[s].num_reads);
+    }
+    result.statistics.tau_sums.resize(S);
+    result.marginals.resize(G);
+    update_responsibilities(result.responsibilities, result.statistics, result.posterior_alphas,
+                            result.genotype_posteriors, log_likelihoods);
+    return result;
+}
+
+template <std::size_t K>
+void iterate(VBFloatSeedState<K>& seed,
+             const VBAlphaVector<K>& prior_alphas,
+             const LogProbabilityVector& genotype_log_priors,
+             const VBFloatLikelihoodMatrix<K>& log_likelihoods,
+             const VariationalBayesParameters& params)
+{
+    assert(seed.genotype_log_posteriors.size() == genotype_log_priors.size());
+    update_genotype_log_posteriors(seed.genotype_log_posteriors, seed.marginals, genotype_log_priors,
+                                   seed.responsibilities, log_likelihoods);
+    exp(seed.genotype_log_posteriors, seed.genotype_posteriors);
+    update_alphas(seed.posterior_alphas, prior_alphas, seed.statistics);
+    const auto curr_evidence = calculate_evidence_lower_bound(prior_alphas, seed.posterior_alphas, genotype_log_priors,
+                                                              seed.genotype_posteriors, seed.genotype_log_posteriors,
+                                                              seed.marginals, seed.statistics);
+    if (update_progress(seed.progress, curr_evidence, params.epsilon)) {
+        update_responsibilities(seed.responsibilities, seed.statistics, seed.posterior_alphas,
+                                seed.genotype_posteriors, log_likelihoods);
+    }
+}
+
+template <std::size_t K>
+VBLatents<K> to_latents(VBFloatSeedState<K>&& seed)
 {
-    return run_variational_bayes(prior_alphas, genotype_log_posteriors, log_likelihoods,
-                                 log_likelihoods, genotype_log_posteriors, params);
+    return VBLatents<K> {
+        std::move(seed.genotype_posteriors), std::move(seed.genotype_log_posteriors),
+        std::move(seed.posterior_alphas), promote(seed.responsibilities)
+    };
 }
 
 // Main algorithm - multiple seed
+//
+// Seeds are run in interleaved rounds of a few iterations. After each round, any seed whose
+// evidence lower bound is projected to converge well below the best seed's current lower bound is
+// dropped from the result, as it would have negligible weight in it. Seeds are otherwise run until
+// convergence, as before.
+//
+// The round driver only sees seed indices and progress, so it is compiled once rather than for
+// every ploidy and likelihood representation.
+
+inline bool is_active(const VBSeedProgress& progress, const unsigned max_iterations) noexcept
+{
+    return !(progress.converged || progress.pruned) && progress.num_iterations < max_iterations;
+}
+
+// Assumes the evidence gain of each round is a constant fraction of the gain of the previous round,
+// and makes no projection until the gains start falling.
+inline double projected_evidence(const VBSeedProgress& progress) noexcept
+{
+    const auto ratio = progress.round_gain / progress.prev_round_gain;
+    if (!std::isfinite(progress.prev_round_gain) || !(ratio < 1)) return std::numeric_limits<double>::infinity();
+    return progress.evidence + progress.round_gain * ratio / (1 - ratio);
+}
+
+using VBSeedFunction = std::function<void(std::size_t)>;
+
+inline void for_each_seed(const std::vector<std::size_t>& seeds, const VBSeedFunction& f, const bool parallel)
+{
+    if (parallel && seeds.size() > 1) {
+        std::vector<std::packaged_task<void()>> tasks {};
+        tasks.reserve(seeds.size());
+        std::vector<std::future<void>> results {};
+        results.reserve(seeds.size());
+        for (const auto seed : seeds) {
+            tasks.emplace_back([&f, seed] () { f(seed); });
+            results.push_back(tasks.back().get_future());
+        }
+        octopus::detail::run_tasks(tasks);
+        for (auto& result : results) result.get();
+    } else {
+        for (const auto seed : seeds) f(seed);
+    }
+}
+
+inline void run_round(VBSeedProgress& progress, const std::size_t seed, const VBSeedFunction& iterate,
+                      const unsigned num_iterations, const unsigned max_iterations)
+{
+    const auto start_evidence = progress.evidence;
+    for (unsigned i {0}; i < num_iterations && is_active(progress, max_iterations); ++i) {
+        iterate(seed);
+    }
+    progress.prev_round_gain = progress.round_gain;
+    if (start_evidence > std::numeric_limits<double>::lowest()) {
+        progress.round_gain = progress.evidence - start_evidence;
+    }
+}
+
+// iterate(i) runs one iteration of seed i, which updates *progresses[i]
+inline VBInferenceStatistics
+iterate_seeds(const std::vector<VBSeedProgress*>& progresses, const VBSeedFunction& iterate, const VariationalBayesParameters& params)
+{
+    const auto max_iterations = params.max_iterations;
+    const bool prune_seeds {params.seed_pruning_margin && progresses.size() > 1};
+    const auto round_iterations = prune_seeds ? std::max(params.seed_pruning_round_iterations, 1u) : max_iterations;
+    std::vector<std::size_t> active_seeds(progresses.size());
+    std::iota(std::begin(active_seeds), std::end(active_seeds), std::size_t {0});
+    const auto run_seed_round = [&] (const std::size_t seed) {
+        run_round(*progresses[seed], seed, iterate, round_iterations, max_iterations);
+    };
+    auto best_evidence = std::numeric_limits<double>::lowest();
+    while (!active_seeds.empty()) {
+        for_each_seed(active_seeds, run_seed_round, params.parallel_execution);
+        for (const auto seed : active_seeds) {
+            best_evidence = std::max(progresses[seed]->evidence, best_evidence);
+        }
+        if (prune_seeds) {
+            for (const auto seed : active_seeds) {
+                auto& progress = *progresses[seed];
+                if (is_active(progress, max_iterations)
+                    && projected_evidence(progress) < best_evidence - *params.seed_pruning_margin) {
+                    progress.pruned = true;
+                }
+            }
+        }
+        erase_if(active_seeds, [&] (const std::size_t seed) { return !is_active(*progresses[seed], max_iterations); });
+    }
+    VBInferenceStatistics result {};
+    result.num_seeds = progresses.size();
+    for (const auto progress : progresses) {
+        result.num_iterations += progress->num_iterations;
+        if (progress->pruned) ++result.num_pruned_seeds;
+    }
+    return result;
+}
+
+template <std::size_t K, typename VBLikelihoodMatrix, typename IterateFunction>
+std::vector<VBLatents<K>>
+run_seeds(const VBAlphaVector<K>& prior_alphas,
+          const VBLikelihoodMatrix& log_likelihoods,
+          std::vector<LogProbabilityVector>&& seeds,
+          const IterateFunction& iterate,
+          const VariationalBayesParameters& params,
+          VBInferenceStatistics& statistics)
+{
+    using VBSeedState_ = decltype(init_seed(prior_alphas, log_likelihoods, std::move(seeds.front())));
+    std::vector<VBSeedState_> states(seeds.size());
+    std::vector<std::size_t> seed_indices(seeds.size());
+    std::iota(std::begin(seed_indices), std::end(seed_indices), std::size_t {0});
+    for_each_seed(seed_indices, [&] (const std::size_t seed) {
+        states[seed] = init_seed(prior_alphas, log_likelihoods, std::move(seeds[seed]));
+    }, params.parallel_execution);
+    std::vector<VBSeedProgress*> progresses(states.size());
+    std::transform(std::begin(states), std::end(states), std::begin(progresses), [] (auto& state) { return std::addressof(state.progress); });
+    statistics = iterate_seeds(progresses, [&] (const std::size_t seed) { iterate(states[seed]); }, params);
+    // Pruned seeds stop part way through an iteration, so their latents are not a consistent
+    // variational solution and their lower bound can exceed the one they would converge to.
+    std::vector<VBLatents<K>> result {};
+    result.reserve(states.size() - statistics.num_pruned_seeds);
+    for (auto& state : states) {
+        if (!state.progress.pruned) result.push_back(to_latents(std::move(state)));
+    }
+    return result;
+}
 
 template <std::size_t K>
 bool run_vb_with_matrix_inversion(const VBReadLikelihoodMatrix<K>& log_likelihoods,
@@ -516,37 +920,37 @@ bool run_vb_with_matrix_inversion(const VBReadLikelihoodMatrix<K>& log_likelihoo
     return !params.save_memory;
 }
 
+template <std::size_t K>
+bool run_vb_with_float_likelihoods(const VBReadLikelihoodMatrix<K>& log_likelihoods,
+                                   const VariationalBayesParameters& params,
+                                   const std::vector<LogProbabilityVector>& seeds) noexcept
+{
+    return !params.double_precision && run_vb_with_matrix_inversion(log_likelihoods, params, seeds);
+}
+
 template <std::size_t K>
 std::vector<VBLatents<K>>
 run_variational_bayes(const VBAlphaVector<K>& prior_alphas,
                       const LogProbabilityVector& genotype_log_priors,
                       const VBReadLikelihoodMatrix<K>& log_likelihoods,
                       const VariationalBayesParameters& params,
-                      std::vector<LogProbabilityVector>&& seeds)
+                      std::vector<LogProbabilityVector>&& seeds,
+                      VBInferenceStatistics& statistics)
 {
-    std::vector<VBLatents<K>> result {};
-    result.reserve(seeds.size());
-    if (run_vb_with_matrix_inversion(log_likelihoods, params, seeds)) {
+    assert(params.max_iterations > 0);
+    assert(!genotype_log_priors.empty());
+    if (run_vb_with_float_likelihoods(log_likelihoods, params, seeds)) {
+        const auto float_log_likelihoods = demote(log_likelihoods);
+        const auto iterate_seed = [&] (auto& seed) { iterate(seed, prior_alphas, genotype_log_priors, float_log_likelihoods, params); };
+        return run_seeds(prior_alphas, float_log_likelihoods, std::move(seeds), iterate_seed, params, statistics);
+    } else if (run_vb_with_matrix_inversion(log_likelihoods, params, seeds)) {
         const auto inverted_log_likelihoods = invert(log_likelihoods);
-        const auto func = [&] (auto&& seed) { return detail::run_variational_bayes(prior_alphas, genotype_log_priors, log_likelihoods,
-                                                                                   inverted_log_likelihoods, std::move(seed), params); };
-        if (params.parallel_execution) {
-            parallel_transform(std::make_move_iterator(std::begin(seeds)), std::make_move_iterator(std::end(seeds)),
-                               std::back_inserter(result), func);
-        } else {
-            for (auto& seed : seeds) result.push_back(func(std::move(seed)));
-        }
+        const auto iterate_seed = [&] (auto& seed) { iterate(seed, prior_alphas, genotype_log_priors, log_likelihoods, inverted_log_likelihoods, params); };
+        return run_seeds(prior_alphas, inverted_log_likelihoods, std::move(seeds), iterate_seed, params, statistics);
     } else {
-        const auto func = [&] (auto&& seed) { return detail::run_variational_bayes(prior_alphas, genotype_log_priors, log_likelihoods,
-                                                                                   std::move(seed), params); };
-        if (params.parallel_execution) {
-            parallel_transform(std::make_move_iterator(std::begin(seeds)), std::make_move_iterator(std::end(seeds)),
-                               std::back_inserter(result), func);
-        } else {
-            for (auto& seed : seeds) result.push_back(func(std::move(seed)));
-        }
+        const auto iterate_seed = [&] (auto& seed) { iterate(seed, prior_alphas, genotype_log_priors, log_likelihoods, log_likelihoods, params); };
+        return run_seeds(prior_alphas, log_likelihoods, std::move(seeds), iterate_seed, params, statistics);
     }
-    return result;
 }
 
 // lower-bound calculation
@@ -652,6 +1056,7 @@ struct VBResultPacket
     VBLatents<K> map_latents;
     double max_log_evidence;
     ProbabilityVector evidence_weighted_genotype_posteriors;
+    VBInferenceStatistics statistics;
 };
 
 template <std::size_t K>
@@ -663,12 +1068,13 @@ run_variational_bayes(const VBAlphaVector<K>& prior_alphas,
                       std::vector<LogProbabilityVector> seeds)
 {
     assert(!seeds.empty());
-    auto latents = detail::run_variational_bayes(prior_alphas, genotype_log_priors, log_likelihoods, params, std::move(seeds));
+    VBInferenceStatistics statistics {};
+    auto latents = detail::run_variational_bayes(prior_alphas, genotype_log_priors, log_likelihoods, params, std::move(seeds), statistics);
     const auto log_evidences = detail::calculate_log_evidences(latents, prior_alphas, genotype_log_priors, log_likelihoods);
     auto weighted_genotype_posteriors = detail::compute_evidence_weighted_genotype_posteriors(latents, log_evidences);
     auto max_evidence_idx = detail::max_element_index(log_evidences);
     detail::check_normalisation(latents[max_evidence_idx]);
-    return {std::move(latents[max_evidence_idx]), log_evidences[max_evidence_idx], std::move(weighted_genotype_posteriors)};
+    return {std::move(latents[max_evidence_idx]), log_evidences[max_evidence_idx], std::move(weighted_genotype_posteriors), statistics};
 }
 
 inline VBReadLikelihoodArray::VBReadLikelihoodArray(const BaseType& underlying_likelihoods)
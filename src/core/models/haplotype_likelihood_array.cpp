@@ -6,8 +6,10 @@
 #include <utility>
 #include <cassert>
 #include <deque>
+#include <future>
+#include <exception>
 
-#include "utils/erase_if.hpp"
+#include "utils/executor.hpp"
 
 namespace octopus {
 
@@ -19,20 +21,42 @@ HaplotypeLikelihoodArray::HaplotypeLikelihoodArray(const unsigned num_haplotypes
 , haplotype_indices_ {num_haplotypes_hint}
 , sample_indices_ {samples.size()}
 , samples_ {samples}
-{
-    mapping_positions_.resize(maxMappingPositions);
-}
+{}
 
 HaplotypeLikelihoodArray::HaplotypeLikelihoodArray(HaplotypeLikelihoodModel likelihood_model,
                                                    unsigned num_haplotypes_hint,
-                                                   const std::vector<SampleName>& samples)
+                                                   const std::vector<SampleName>& samples,
+                                                   const unsigned max_helpers)
 : likelihood_model_ {std::move(likelihood_model)}
 , likelihoods_ {}
 , haplotype_indices_ {num_haplotypes_hint}
 , sample_indices_ {samples.size()}
 , samples_ {samples}
+, max_helpers_ {max_helpers}
+{}
+
+HaplotypeLikelihoodArray::HaplotypeLikelihoodArray(const HaplotypeLikelihoodArray& other)
+: likelihood_model_ {other.likelihood_model_}
+, likelihoods_ {other.likelihoods_}
+, num_sample_likelihoods_ {other.num_sample_likelihoods_}
+, likelihood_views_ {}
+, haplotype_indices_ {other.haplotype_indices_}
+, sample_indices_ {other.sample_indices_}
+, samples_ {other.samples_}
+, haplotypes_ {other.haplotypes_}
+, primed_sample_ {other.primed_sample_}
+, max_helpers_ {other.max_helpers_}
 {
-    mapping_positions_.resize(maxMappingPositions);
+    // The views must point into our own buffers
+    update_likelihood_views(other.num_haplotypes());
+}
+
+HaplotypeLikelihoodArray& HaplotypeLikelihoodArray::operator=(const HaplotypeLikelihoodArray& other)
+{
+    if (this != &other) {
+        *this = HaplotypeLikelihoodArray {other};
+    }
+    return *this;
 }
 
 HaplotypeLikelihoodArray::ReadPacket::ReadPacket(Iterator first, Iterator last)
@@ -63,39 +87,43 @@ void HaplotypeLikelihoodArray::populate(const ReadMap& reads,
     // Precompute all read hashes so we don't have to recompute for each haplotype
     std::vector<std::vector<KmerPerfectHashes>> read_hashes {};
     read_hashes.reserve(num_samples);
+    std::size_t num_reads {0};
     for (const auto& t : read_iterators_) {
         std::vector<KmerPerfectHashes> sample_read_hashes {};
         sample_read_hashes.reserve(t.num_reads);
         std::transform(t.first, t.last, std::back_inserter(sample_read_hashes),
                        [] (const AlignedRead& read) { return compute_kmer_hashes<mapperKmerSize>(read.sequence()); });
         read_hashes.emplace_back(std::move(sample_read_hashes));
+        num_reads += t.num_reads;
     }
-    auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
-    const auto first_mapping_position = std::begin(mapping_positions_);
-    likelihoods_.resize(haplotypes.size(), std::vector<LikelihoodVector>(num_samples));
-    for (std::size_t haplotype_idx {0}; haplotype_idx < haplotypes.size(); ++haplotype_idx) {
-        const auto& haplotype = haplotypes[haplotype_idx];
-        populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
-        auto haplotype_mapping_counts = init_mapping_counts(haplotype_hashes);
-        likelihood_model_.reset(haplotype, flank_state);
-        for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
-            auto& likelihoods = likelihoods_[haplotype_idx][sample_idx];
-            const auto& t = read_iterators_[sample_idx];
-            likelihoods.resize(t.num_reads);
-            std::transform(t.first, t.last, std::cbegin(read_hashes[sample_idx]), std::begin(likelihoods),
-                           [&] (const AlignedRead& read, const auto& read_hashes) {
-                               const auto last_mapping_position = map_query_to_target(read_hashes, haplotype_hashes,
-                                                                                      haplotype_mapping_counts,
-                                                                                      first_mapping_position,
-                                                                                      maxMappingPositions);
-                               reset_mapping_counts(haplotype_mapping_counts);
-                               return likelihood_model_.evaluate(read, first_mapping_position, last_mapping_position);
-                           });
+    num_sample_likelihoods_.resize(num_samples);
+    std::transform(std::cbegin(read_iterators_), std::cend(read_iterators_), std::begin(num_sample_likelihoods_),
+                   [] (const ReadPacket& t) noexcept { return t.num_reads; });
+    resize_likelihoods(haplotypes.size());
+    for_each_haplotype_range(haplotypes.size(), num_reads,
+                             [&] (const std::size_t first_haplotype_idx, const std::size_t last_haplotype_idx,
+                                  HaplotypeLikelihoodModel& likelihood_model) {
+        thread_local std::vector<HaplotypeLikelihoodModel::MappingPositionVector> mapping_positions {};
+        thread_local auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
+        thread_local MappedIndexCounts haplotype_mapping_counts {};
+        for (auto haplotype_idx = first_haplotype_idx; haplotype_idx < last_haplotype_idx; ++haplotype_idx) {
+            const auto& haplotype = haplotypes[haplotype_idx];
+            populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
+            init_mapping_counts(haplotype_hashes, haplotype_mapping_counts);
+            likelihood_model.reset(haplotype, flank_state);
+            for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
+                const auto& t = read_iterators_[sample_idx];
+                // Map all reads first so the likelihood model can evaluate the sample's reads as a batch
+                map_queries_to_target(read_hashes[sample_idx], haplotype_hashes, haplotype_mapping_counts,
+                                      mapping_positions, maxMappingPositions);
+                likelihood_model.evaluate(t.first, t.last, mapping_positions, likelihoods(haplotype_idx, sample_idx));
+            }
         }
-        clear_kmer_hash_table(haplotype_hashes);
-        haplotype_indices_.emplace(haplotype, haplotype_idx);
+        likelihood_model.clear();
+    });
+    for (std::size_t haplotype_idx {0}; haplotype_idx < haplotypes.size(); ++haplotype_idx) {
+        haplotype_indices_.emplace(haplotypes[haplotype_idx], haplotype_idx);
     }
-    likelihood_model_.clear();
     read_iterators_.clear();
     haplotypes_ = haplotypes;
 }
@@ -114,88 +142,89 @@ void HaplotypeLikelihoodArray::populate(const TemplateMap& reads,
     // Precompute all read hashes so we don't have to recompute for each haplotype
     std::vector<std::vector<std::vector<KmerPerfectHashes>>> template_hashes {};
     template_hashes.reserve(num_samples);
+    std::size_t num_reads {0};
     for (const auto& t : template_iterators_) {
         std::vector<std::vector<KmerPerfectHashes>> sample_read_hashes {};
         sample_read_hashes.reserve(t.num_templates);
-        std::transform(t.first, t.last, std::back_inserter(sample_read_hashes), [] (const AlignedTemplate& reads) {
+        std::transform(t.first, t.last, std::back_inserter(sample_read_hashes), [&num_reads] (const AlignedTemplate& reads) {
             std::vector<KmerPerfectHashes> result {};
             result.reserve(reads.size());
             for (const auto& read : reads) result.push_back(compute_kmer_hashes<mapperKmerSize>(read.sequence()));
+            num_reads += reads.size();
             return result;
         });
         template_hashes.emplace_back(std::move(sample_read_hashes));
     }
-    auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
-    thread_local std::vector<HaplotypeLikelihoodModel::MappingPositionVector> mapping_positions {};
-    likelihoods_.resize(haplotypes.size(), std::vector<LikelihoodVector>(num_samples));
-    for (std::size_t haplotype_idx {0}; haplotype_idx < haplotypes.size(); ++haplotype_idx) {
-        const auto& haplotype = haplotypes[haplotype_idx];
-        populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
-        auto haplotype_mapping_counts = init_mapping_counts(haplotype_hashes);
-        likelihood_model_.reset(haplotype, flank_state);
-        for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
-            auto& likelihoods = likelihoods_[haplotype_idx][sample_idx];
-            const auto& t = template_iterators_[sample_idx];
-            likelihoods.resize(t.num_templates);
-            std::transform(t.first, t.last, std::cbegin(template_hashes[sample_idx]), std::begin(likelihoods),
-                           [&] (const AlignedTemplate& read_template, const auto& template_hashes) {
-                               mapping_positions.resize(read_template.size());
-                               assert(read_template.size() == template_hashes.size());
-                               for (std::size_t i {0}; i < template_hashes.size(); ++i) {
-                                   mapping_positions[i].resize(maxMappingPositions);
-                                   mapping_positions[i].erase(map_query_to_target(template_hashes[i], haplotype_hashes,
-                                                                                  haplotype_mapping_counts,
-                                                                                  std::begin(mapping_positions[i]),
-                                                                                  maxMappingPositions),
-                                                              std::end(mapping_positions[i]));
-                                   reset_mapping_counts(haplotype_mapping_counts);
-                               }
-                               return likelihood_model_.evaluate(read_template, mapping_positions);
-                           });
+    num_sample_likelihoods_.resize(num_samples);
+    std::transform(std::cbegin(template_iterators_), std::cend(template_iterators_), std::begin(num_sample_likelihoods_),
+                   [] (const TemplatePacket& t) noexcept { return t.num_templates; });
+    resize_likelihoods(haplotypes.size());
+    for_each_haplotype_range(haplotypes.size(), num_reads,
+                             [&] (const std::size_t first_haplotype_idx, const std::size_t last_haplotype_idx,
+                                  HaplotypeLikelihoodModel& likelihood_model) {
+        thread_local std::vector<HaplotypeLikelihoodModel::MappingPositionVector> mapping_positions {};
+        thread_local auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
+        thread_local MappedIndexCounts haplotype_mapping_counts {};
+        for (auto haplotype_idx = first_haplotype_idx; haplotype_idx < last_haplotype_idx; ++haplotype_idx) {
+            const auto& haplotype = haplotypes[haplotype_idx];
+            populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
+            init_mapping_counts(haplotype_hashes, haplotype_mapping_counts);
+            likelihood_model.reset(haplotype, flank_state);
+            for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
+                const auto& t = template_iterators_[sample_idx];
+                std::transform(t.first, t.last, std::cbegin(template_hashes[sample_idx]), likelihoods(haplotype_idx, sample_idx),
+                               [&] (const AlignedTemplate& read_template, const auto& template_hashes) {
+                                   assert(read_template.size() == template_hashes.size());
+                                   map_queries_to_target(template_hashes, haplotype_hashes, haplotype_mapping_counts,
+                                                         mapping_positions, maxMappingPositions);
+                                   return likelihood_model.evaluate(read_template, mapping_positions);
+                               });
+            }
         }
-        clear_kmer_hash_table(haplotype_hashes);
-        haplotype_indices_.emplace(haplotype, haplotype_idx);
+        likelihood_model.clear();
+    });
+    for (std::size_t haplotype_idx {0}; haplotype_idx < haplotypes.size(); ++haplotype_idx) {
+        haplotype_indices_.emplace(haplotypes[haplotype_idx], haplotype_idx);
     }
-    likelihood_model_.clear();
     read_iterators_.clear();
     haplotypes_ = haplotypes;
 }
 
 std::size_t HaplotypeLikelihoodArray::num_likelihoods(const SampleName& sample) const
 {
-    return likelihoods_.front()[sample_indices_.at(sample)].size();
+    return num_sample_likelihoods_[sample_indices_.at(sample)];
 }
 
 std::size_t HaplotypeLikelihoodArray::num_likelihoods() const // if primed
 {
     assert(is_primed());
-    return likelihoods_.front()[*primed_sample_].size();
+    return num_sample_likelihoods_[*primed_sample_];
 }
 
 const HaplotypeLikelihoodArray::LikelihoodVector&
 HaplotypeLikelihoodArray::operator()(const SampleName& sample, const Haplotype& haplotype) const
 {
-    return likelihoods_[haplotype_indices_.at(haplotype)][sample_indices_.at(sample)];
+    return likelihood_view(haplotype_indices_.at(haplotype), sample_indices_.at(sample));
 }
 
 const HaplotypeLikelihoodArray::LikelihoodVector&
 HaplotypeLikelihoodArray::operator()(const SampleName& sample, const IndexedHaplotype<>& haplotype) const
 {
-    return likelihoods_[index_of(haplotype)][sample_indices_.at(sample)];
+    return likelihood_view(index_of(haplotype), sample_indices_.at(sample));
 }
 
 const HaplotypeLikelihoodArray::LikelihoodVector&
 HaplotypeLikelihoodArray::operator[](const Haplotype& haplotype) const
 {
     assert(is_primed());
-    return likelihoods_[haplotype_indices_.at(haplotype)][*primed_sample_];
+    return likelihood_view(haplotype_indices_.at(haplotype), *primed_sample_);
 }
 
 const HaplotypeLikelihoodArray::LikelihoodVector&
 HaplotypeLikelihoodArray::operator[](const IndexedHaplotype<>& haplotype) const noexcept
 {
     assert(is_primed());
-    return likelihoods_[index_of(haplotype)][*primed_sample_];
+    return likelihood_view(index_of(haplotype), *primed_sample_);
 }
 
 std::vector<SampleName> HaplotypeLikelihoodArray::samples() const
@@ -214,7 +243,7 @@ HaplotypeLikelihoodArray::extract_sample(const SampleName& sample) const
     const auto sample_index = sample_indices_.at(sample);
     SampleLikelihoodMap result {haplotype_indices_.size()};
     for (const auto& p : haplotype_indices_) {
-        result.emplace(p.first, likelihoods_[p.second][sample_index]);
+        result.emplace(p.first, likelihood_view(p.second, sample_index));
     }
     return result;
 }
@@ -226,12 +255,15 @@ bool HaplotypeLikelihoodArray::contains(const Haplotype& haplotype) const noexce
 
 bool HaplotypeLikelihoodArray::is_empty() const noexcept
 {
-    return likelihoods_.empty();
+    return likelihood_views_.empty();
 }
 
 void HaplotypeLikelihoodArray::clear() noexcept
 {
-    likelihoods_.clear();
+    // Keep the buffers' capacity for the next populate
+    for (auto& sample_likelihoods : likelihoods_) sample_likelihoods.clear();
+    num_sample_likelihoods_.clear();
+    likelihood_views_.clear();
     haplotype_indices_.clear();
     sample_indices_.clear();
     haplotypes_.clear();
@@ -255,6 +287,50 @@ void HaplotypeLikelihoodArray::unprime() const noexcept
 
 // private methods
 
+std::size_t HaplotypeLikelihoodArray::num_haplotype_ranges(const std::size_t num_haplotypes, const std::size_t num_reads) const noexcept
+{
+    if (max_helpers_ == 0 || num_haplotypes < 2 || num_haplotypes * num_reads < minParallelLikelihoods) {
+        return 1;
+    }
+    return std::min(std::size_t {max_helpers_} + 1, num_haplotypes);
+}
+
+void HaplotypeLikelihoodArray::for_each_haplotype_range(const std::size_t num_haplotypes, const std::size_t num_reads,
+                                                        const HaplotypeRangeFunction& f)
+{
+    // Only use as many workers as the thread budget currently allows
+    const HelperThreads helpers {num_haplotype_ranges(num_haplotypes, num_reads) - 1};
+    const auto num_ranges = helpers.size() + 1;
+    if (num_ranges == 1) {
+        f(0, num_haplotypes, likelihood_model_);
+        return;
+    }
+    // Each worker needs its own model as HaplotypeLikelihoodModel buffers the current haplotype
+    worker_likelihood_models_.assign(num_ranges - 1, likelihood_model_);
+    const auto range_size = num_haplotypes / num_ranges, num_larger_ranges = num_haplotypes % num_ranges;
+    const auto range_end = [=] (const std::size_t range_idx) noexcept {
+        return range_idx * range_size + std::min(range_idx, num_larger_ranges);
+    };
+    std::vector<std::future<void>> worker_results {};
+    worker_results.reserve(num_ranges - 1);
+    for (std::size_t range_idx {1}; range_idx < num_ranges; ++range_idx) {
+        worker_results.push_back(helpers.push([&, range_idx] () {
+            f(range_end(range_idx), range_end(range_idx + 1), worker_likelihood_models_[range_idx - 1]);
+        }));
+    }
+    // The calling thread evaluates the first range rather than just waiting
+    std::exception_ptr error {nullptr};
+    try {
+        f(0, range_end(1), likelihood_model_);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // Must wait for all workers before throwing as they reference local state
+    for (auto& result : worker_results) result.wait();
+    if (error) std::rethrow_exception(error);
+    for (auto& result : worker_results) result.get();
+}
+
 void HaplotypeLikelihoodArray::set_read_iterators_and_sample_indices(const ReadMap& reads)
 {
     read_iterators_.clear();
@@ -291,6 +367,44 @@ void HaplotypeLikelihoodArray::set_template_iterators_and_sample_indices(const T
     }
 }
 
+void HaplotypeLikelihoodArray::resize_likelihoods(const std::size_t num_haplotypes)
+{
+    const auto num_samples = num_sample_likelihoods_.size();
+    likelihoods_.resize(num_samples);
+    for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
+        likelihoods_[sample_idx].resize(num_haplotypes * num_sample_likelihoods_[sample_idx]);
+    }
+    update_likelihood_views(num_haplotypes);
+}
+
+void HaplotypeLikelihoodArray::update_likelihood_views(const std::size_t num_haplotypes)
+{
+    const auto num_samples = num_sample_likelihoods_.size();
+    likelihood_views_.resize(num_haplotypes * num_samples);
+    for (std::size_t haplotype_idx {0}; haplotype_idx < num_haplotypes; ++haplotype_idx) {
+        for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
+            likelihood_views_[haplotype_idx * num_samples + sample_idx] = {likelihoods(haplotype_idx, sample_idx), num_sample_likelihoods_[sample_idx]};
+        }
+    }
+}
+
+std::size_t HaplotypeLikelihoodArray::num_haplotypes() const noexcept
+{
+    return num_sample_likelihoods_.empty() ? 0 : likelihood_views_.size() / num_sample_likelihoods_.size();
+}
+
+HaplotypeLikelihoodArray::LogProbability*
+HaplotypeLikelihoodArray::likelihoods(const std::size_t haplotype_idx, const std::size_t sample_idx) noexcept
+{
+    return likelihoods_[sample_idx].data() + haplotype_idx * num_sample_likelihoods_[sample_idx];
+}
+
+const HaplotypeLikelihoodArray::LikelihoodVector&
+HaplotypeLikelihoodArray::likelihood_view(const std::size_t haplotype_idx, const std::size_t sample_idx) const noexcept
+{
+    return likelihood_views_[haplotype_idx * num_sample_likelihoods_.size() + sample_idx];
+}
+
 void HaplotypeLikelihoodArray::reset(MappableBlock<Haplotype> haplotypes)
 {
     assert(haplotypes.size() <= haplotypes_.size());
@@ -305,15 +419,25 @@ void HaplotypeLikelihoodArray::reset(MappableBlock<Haplotype> haplotypes)
         }
         assert(!indices_to_keep.empty());
         assert(std::is_sorted(std::cbegin(indices_to_keep), std::cend(indices_to_keep)));
-        std::size_t idx {0};
-        const auto remover = [&] (const auto&) noexcept {
-            if (indices_to_keep.empty()) return true;
-            if (idx++ != indices_to_keep.front()) return true;
-            indices_to_keep.pop_front();
-            return false;
-        };
-        erase_if(likelihoods_, remover);
+        // Kept rows only ever move towards the front so can be compacted in place. A row that moves
+        // starts at least one row before its source, so the ranges are disjoint; rows that stay put
+        // are skipped rather than copied onto themselves.
+        for (std::size_t sample_idx {0}; sample_idx < num_sample_likelihoods_.size(); ++sample_idx) {
+            const auto row_size = static_cast<std::ptrdiff_t>(num_sample_likelihoods_[sample_idx]);
+            auto& buffer = likelihoods_[sample_idx];
+            std::ptrdiff_t new_haplotype_idx {0};
+            for (const auto old_haplotype_idx : indices_to_keep) {
+                const auto old_idx = static_cast<std::ptrdiff_t>(old_haplotype_idx);
+                assert(old_idx >= new_haplotype_idx);
+                if (old_idx != new_haplotype_idx) {
+                    const auto src_itr = std::next(std::cbegin(buffer), old_idx * row_size);
+                    std::copy(src_itr, std::next(src_itr, row_size), std::next(std::begin(buffer), new_haplotype_idx * row_size));
+                }
+                ++new_haplotype_idx;
+            }
+        }
         haplotypes_ = std::move(haplotypes);
+        resize_likelihoods(haplotypes_.size());
     }
 }
 
@@ -330,11 +454,12 @@ HaplotypeLikelihoodArray::merge_samples(const std::vector<SampleName>& samples,
     for (const auto& sample : samples) {
         total_num_likelihoods += this->num_likelihoods(sample);
     }
-    result.likelihoods_.resize(haplotypes_.size(), std::vector<LikelihoodVector>(1, LikelihoodVector(total_num_likelihoods)));
+    result.num_sample_likelihoods_.assign(1, total_num_likelihoods);
+    result.resize_likelihoods(haplotypes_.size());
     for (std::size_t haplotype_idx {0}; haplotype_idx < haplotypes_.size(); ++haplotype_idx) {
-        auto dst_likelihood_itr = std::begin(result.likelihoods_[haplotype_idx][0]);
+        auto dst_likelihood_itr = result.likelihoods(haplotype_idx, 0);
         for (const auto& sample : samples) {
-            const auto& src_likelihoods = likelihoods_[haplotype_idx][sample_indices_.at(sample)];
+            const auto& src_likelihoods = likelihood_view(haplotype_idx, sample_indices_.at(sample));
             dst_likelihood_itr = std::copy(std::cbegin(src_likelihoods), std::cend(src_likelihoods), dst_likelihood_itr);
         }
     }
@@ -354,14 +479,15 @@ HaplotypeLikelihoodArray::merge_samples(boost::optional<SampleName> new_sample)
     HaplotypeLikelihoodArray result {static_cast<unsigned>(haplotypes_.size()), {std::move(*new_sample)}};
     result.haplotypes_ = haplotypes_;
     std::size_t total_num_likelihoods {0};
-    for (const auto& s : likelihoods_.front()) {
-        total_num_likelihoods += s.size();
+    for (const auto n : num_sample_likelihoods_) {
+        total_num_likelihoods += n;
     }
-    result.likelihoods_.resize(haplotypes_.size(), std::vector<LikelihoodVector>(1, LikelihoodVector(total_num_likelihoods)));
+    result.num_sample_likelihoods_.assign(1, total_num_likelihoods);
+    result.resize_likelihoods(haplotypes_.size());
     for (std::size_t haplotype_idx {0}; haplotype_idx < haplotypes_.size(); ++haplotype_idx) {
-        auto dst_likelihood_itr = std::begin(result.likelihoods_[haplotype_idx][0]);
-        for (std::size_t sample_idx {0}; sample_idx < samples_.size(); ++sample_idx) {
-            const auto& src_likelihoods = likelihoods_[haplotype_idx][sample_idx];
+        auto dst_likelihood_itr = result.likelihoods(haplotype_idx, 0);
+        for (std::size_t sample_idx {0}; sample_idx < num_sample_likelihoods_.size(); ++sample_idx) {
+            const auto& src_likelihoods = likelihood_view(haplotype_idx, sample_idx);
             dst_likelihood_itr = std::copy(std::cbegin(src_likelihoods), std::cend(src_likelihoods), dst_likelihood_itr);
         }
     }
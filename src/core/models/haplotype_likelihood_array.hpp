@@ -12,6 +12,7 @@
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <memory>
 
 #include <boost/optional.hpp>
 
@@ -32,6 +33,9 @@ namespace octopus {
  
     The matrix can be efficiently populated as the read mapping and alignment are
     done internally which allows minimal memory allocation.
+ 
+    The likelihoods for each sample are stored in a single row-major (haplotype x read)
+    buffer, which is reused between populate calls.
  */
 class HaplotypeLikelihoodArray
 {
@@ -39,7 +43,35 @@ public:
     using FlankState = HaplotypeLikelihoodModel::FlankState;
     
     using LogProbability       = HaplotypeLikelihoodModel::LogProbability;
-    using LikelihoodVector     = std::vector<LogProbability>;
+    
+    // A view of the likelihoods of one haplotype for one sample
+    class LikelihoodVector
+    {
+    public:
+        using value_type     = LogProbability;
+        using size_type      = std::size_t;
+        using const_iterator = const LogProbability*;
+        using iterator       = const_iterator;
+        
+        LikelihoodVector() = default;
+        LikelihoodVector(const LogProbability* data, std::size_t size) noexcept : data_ {data}, size_ {size} {}
+        
+        const LogProbability* data() const noexcept { return data_; }
+        std::size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+        const_iterator begin() const noexcept { return data_; }
+        const_iterator end() const noexcept { return data_ + size_; }
+        const_iterator cbegin() const noexcept { return data_; }
+        const_iterator cend() const noexcept { return data_ + size_; }
+        LogProbability operator[](std::size_t n) const noexcept { return data_[n]; }
+        LogProbability front() const noexcept { return data_[0]; }
+        LogProbability back() const noexcept { return data_[size_ - 1]; }
+        
+    private:
+        const LogProbability* data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+    
     using LikelihoodVectorRef  = std::reference_wrapper<const LikelihoodVector>;
     using HaplotypeRef         = std::reference_wrapper<const Haplotype>;
     using SampleLikelihoodMap  = std::unordered_map<HaplotypeRef, LikelihoodVectorRef>;
@@ -48,12 +80,15 @@ public:
     
     HaplotypeLikelihoodArray(unsigned num_haplotypes_hint, const std::vector<SampleName>& samples);
     
+    // If max_helpers is non-zero then large populate calls are split over haplotypes, using up
+    // to max_helpers threads leased from the thread budget
     HaplotypeLikelihoodArray(HaplotypeLikelihoodModel likelihood_model,
                              unsigned num_haplotypes_hint,
-                             const std::vector<SampleName>& samples);
+                             const std::vector<SampleName>& samples,
+                             unsigned max_helpers = 0);
     
-    HaplotypeLikelihoodArray(const HaplotypeLikelihoodArray&)            = default;
-    HaplotypeLikelihoodArray& operator=(const HaplotypeLikelihoodArray&) = default;
+    HaplotypeLikelihoodArray(const HaplotypeLikelihoodArray&);
+    HaplotypeLikelihoodArray& operator=(const HaplotypeLikelihoodArray&);
     HaplotypeLikelihoodArray(HaplotypeLikelihoodArray&&)                 = default;
     HaplotypeLikelihoodArray& operator=(HaplotypeLikelihoodArray&&)      = default;
     
@@ -97,6 +132,7 @@ public:
 private:
     static constexpr unsigned char mapperKmerSize {6};
     static constexpr std::size_t maxMappingPositions {10};
+    static constexpr std::size_t minParallelLikelihoods {20'000}; // haplotypes x reads
     
     HaplotypeLikelihoodModel likelihood_model_;
     
@@ -115,7 +151,9 @@ private:
         std::size_t num_templates;
     };
     
-    std::vector<std::vector<LikelihoodVector>> likelihoods_;
+    std::vector<std::vector<LogProbability>> likelihoods_; // one (haplotype x read) buffer per sample
+    std::vector<std::size_t> num_sample_likelihoods_;
+    std::vector<LikelihoodVector> likelihood_views_; // (haplotype x sample)
     std::unordered_map<Haplotype, std::size_t, HaplotypeHash> haplotype_indices_;
     std::unordered_map<SampleName, std::size_t> sample_indices_;
     std::vector<SampleName> samples_;
@@ -126,10 +164,21 @@ private:
     // Just to optimise population
     std::vector<ReadPacket> read_iterators_;
     std::vector<TemplatePacket> template_iterators_;
-    std::vector<std::size_t> mapping_positions_;
     
+    unsigned max_helpers_ = 0;
+    std::vector<HaplotypeLikelihoodModel> worker_likelihood_models_;
+    
+    using HaplotypeRangeFunction = std::function<void(std::size_t, std::size_t, HaplotypeLikelihoodModel&)>;
+    
+    std::size_t num_haplotype_ranges(std::size_t num_haplotypes, std::size_t num_reads) const noexcept;
+    void for_each_haplotype_range(std::size_t num_haplotypes, std::size_t num_reads, const HaplotypeRangeFunction& f);
     void set_read_iterators_and_sample_indices(const ReadMap& reads);
     void set_template_iterators_and_sample_indices(const TemplateMap& reads);
+    void resize_likelihoods(std::size_t num_haplotypes);
+    void update_likelihood_views(std::size_t num_haplotypes);
+    std::size_t num_haplotypes() const noexcept;
+    LogProbability* likelihoods(std::size_t haplotype_idx, std::size_t sample_idx) noexcept;
+    const LikelihoodVector& likelihood_view(std::size_t haplotype_idx, std::size_t sample_idx) const noexcept;
 };
 
 // non-member methods
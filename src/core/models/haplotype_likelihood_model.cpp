@@ -41,12 +41,8 @@ const HaplotypeLikelihoodModel::Config& HaplotypeLikelihoodModel::config() const
 
 void HaplotypeLikelihoodModel::set(Config config)
 {
-    if (config.use_int_scores) {
-        hmm_ = HMM {config.max_indel_error, HMM::ScoreType::int32};
-    } else {
-        hmm_ = HMM {config.max_indel_error};
-    }
     config_ = std::move(config);
+    reset_hmm();
     if (config_.mapping_quality_cap_trigger && *config_.mapping_quality_cap_trigger >= config_.mapping_quality_cap) {
         config_.mapping_quality_cap_trigger = boost::none;
     }
@@ -104,11 +100,7 @@ HaplotypeLikelihoodModel::HaplotypeLikelihoodModel(std::unique_ptr<SnvErrorModel
 , haplotype_gap_extend_penalities_ {}
 , config_ {config}
 {
-    if (config.use_int_scores) {
-        hmm_ = HMM {config.max_indel_error, HMM::ScoreType::int32};
-    } else {
-        hmm_ = HMM {config.max_indel_error};
-    }
+    reset_hmm();
     if (config_.mapping_quality_cap_trigger && *config_.mapping_quality_cap_trigger >= config_.mapping_quality_cap) {
         config_.mapping_quality_cap_trigger = boost::none;
     }
@@ -136,6 +128,7 @@ HaplotypeLikelihoodModel::HaplotypeLikelihoodModel(const HaplotypeLikelihoodMode
     haplotype_gap_extend_penalities_ = other.haplotype_gap_extend_penalities_;
     config_ = other.config_;
     hmm_ = other.hmm_;
+    batch_hmm_ = other.batch_hmm_;
 }
 
 HaplotypeLikelihoodModel& HaplotypeLikelihoodModel::operator=(const HaplotypeLikelihoodModel& other)
@@ -162,6 +155,8 @@ void swap(HaplotypeLikelihoodModel& lhs, HaplotypeLikelihoodModel& rhs) noexcept
     swap(lhs.haplotype_gap_extend_penalities_, rhs.haplotype_gap_extend_penalities_);
     swap(lhs.config_, rhs.config_);
     swap(lhs.hmm_, rhs.hmm_);
+    swap(lhs.batch_hmm_, rhs.batch_hmm_);
+    swap(lhs.batch_read_jobs_, rhs.batch_read_jobs_);
 }
 
 bool HaplotypeLikelihoodModel::can_use_flank_state() const noexcept
@@ -208,17 +203,15 @@ bool is_in_range(const std::size_t mapping_position, const AlignedRead& read, co
 
 } // namespace
 
-template <typename InputIt, typename pHMM>
-HaplotypeLikelihoodModel::LogProbability
-max_score(const AlignedRead& read, const Haplotype& haplotype,
-          InputIt first_mapping_position, InputIt last_mapping_position,
-          const pHMM& hmm)
+template <typename InputIt, typename pHMM, typename UnaryFunction>
+void
+for_each_candidate_mapping_position(const AlignedRead& read, const Haplotype& haplotype,
+                                    InputIt first_mapping_position, InputIt last_mapping_position,
+                                    const pHMM& hmm, UnaryFunction f)
 {
     assert(contains(haplotype, read));
-    using LogProbability = HaplotypeLikelihoodModel::LogProbability;
     using PositionType = typename std::iterator_traits<InputIt>::value_type;
     const auto original_mapping_position = static_cast<PositionType>(begin_distance(haplotype, read));
-    auto max_log_probability = std::numeric_limits<LogProbability>::lowest();
     bool is_original_position_mapped {false}, has_in_range_mapping_position {false};
     std::for_each(first_mapping_position, last_mapping_position, [&] (const auto position) {
         if (position == original_mapping_position) {
@@ -226,14 +219,12 @@ max_score(const AlignedRead& read, const Haplotype& haplotype,
         }
         if (is_in_range(position, read, haplotype, hmm)) {
             has_in_range_mapping_position = true;
-            auto p = hmm.evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), position);
-            max_log_probability = std::max(static_cast<LogProbability>(p), max_log_probability);
+            f(position);
         }
     });
     if (!is_original_position_mapped && is_in_range(original_mapping_position, read, haplotype, hmm)) {
         has_in_range_mapping_position = true;
-        auto p = hmm.evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), original_mapping_position);
-        max_log_probability = std::max(static_cast<LogProbability>(p), max_log_probability);
+        f(original_mapping_position);
     }
     if (!has_in_range_mapping_position) {
         const auto min_shift = num_out_of_range_bases(original_mapping_position, read, haplotype, hmm);
@@ -252,8 +243,22 @@ max_score(const AlignedRead& read, const Haplotype& haplotype,
                 throw HaplotypeLikelihoodModel::ShortHaplotypeError {haplotype, required_extension};
             }
         }
-        max_log_probability = hmm.evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), final_mapping_position);
+        f(final_mapping_position);
     }
+}
+
+template <typename InputIt, typename pHMM>
+HaplotypeLikelihoodModel::LogProbability
+max_score(const AlignedRead& read, const Haplotype& haplotype,
+          InputIt first_mapping_position, InputIt last_mapping_position,
+          const pHMM& hmm)
+{
+    using LogProbability = HaplotypeLikelihoodModel::LogProbability;
+    auto max_log_probability = std::numeric_limits<LogProbability>::lowest();
+    for_each_candidate_mapping_position(read, haplotype, first_mapping_position, last_mapping_position, hmm, [&] (const auto position) {
+        auto p = hmm.evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), position);
+        max_log_probability = std::max(static_cast<LogProbability>(p), max_log_probability);
+    });
     assert(max_log_probability > std::numeric_limits<LogProbability>::lowest() && max_log_probability <= 0);
     return max_log_probability;
 }
@@ -282,24 +287,69 @@ HaplotypeLikelihoodModel::evaluate(const AlignedRead& read,
     }
     hmm_.set(model);
     const auto ln_prob_given_mapped = max_score(read, *haplotype_, first_mapping_position, last_mapping_position, hmm_);
-    if (config_.use_mapping_quality) {
-        // This calculation is approximately
-        // p(read | hap) = p(read missmapped) p(read | hap, missmapped)
-        //                  + p(read correctly mapped) p(read | hap, correctly mapped)
-        // = p(read correctly mapped) p(read | hap, correctly mapped)
-        //      + p(read missmapped)
-        // assuming p(read | hap, missmapped) = 1
-        auto mapping_quality = read.mapping_quality();
-        if (config_.mapping_quality_cap_trigger && mapping_quality >= *config_.mapping_quality_cap_trigger) {
-            mapping_quality = config_.mapping_quality_cap;
-        }
-        using octopus::maths::constants::ln10Div10;
-        const auto ln_prob_missmapped = -ln10Div10<> * mapping_quality;
-        const auto ln_prob_mapped = std::log(1.0 - std::exp(ln_prob_missmapped));
-        const auto result = maths::log_sum_exp(ln_prob_mapped + ln_prob_given_mapped, ln_prob_missmapped);
-        return result > -1e-15 ? 0.0 : result;
+    return adjust_for_mapping_quality(read, ln_prob_given_mapped);
+}
+
+void
+HaplotypeLikelihoodModel::evaluate(ReadIterator first_read, ReadIterator last_read,
+                                   const std::vector<MappingPositionVector>& mapping_positions,
+                                   LogProbability* result) const
+{
+    const auto num_reads = static_cast<std::size_t>(std::distance(first_read, last_read));
+    assert(mapping_positions.size() >= num_reads);
+    if (!config_.use_batch_evaluation) {
+        std::transform(first_read, last_read, std::cbegin(mapping_positions), result,
+                       [this] (const AlignedRead& read, const MappingPositionVector& read_mapping_positions) {
+                           return this->evaluate(read, read_mapping_positions);
+                       });
+        return;
+    }
+    if (haplotype_ == nullptr) {
+        throw std::runtime_error {"HaplotypeLikelihoodModel: no buffered Haplotype"};
+    }
+    HMM::ParameterType forward_model {
+        haplotype_gap_open_penalities_,
+        haplotype_gap_extend_penalities_,
+        haplotype_snv_forward_mask_,
+        haplotype_snv_forward_priors_
+    };
+    HMM::ParameterType reverse_model {
+        haplotype_gap_open_penalities_,
+        haplotype_gap_extend_penalities_,
+        haplotype_snv_reverse_mask_,
+        haplotype_snv_reverse_priors_
+    };
+    if (haplotype_flank_state_) {
+        forward_model.lhs_flank_size = reverse_model.lhs_flank_size = haplotype_flank_state_->lhs_flank;
+        forward_model.rhs_flank_size = reverse_model.rhs_flank_size = haplotype_flank_state_->rhs_flank;
     } else {
-        return ln_prob_given_mapped  > -1e-15 ? 0.0 : ln_prob_given_mapped;
+        forward_model.lhs_flank_size = reverse_model.lhs_flank_size = 0;
+        forward_model.rhs_flank_size = reverse_model.rhs_flank_size = 0;
+    }
+    // Queue every candidate alignment of every read first, so the batch HMM can fill all SIMD lanes.
+    // The jobs for each read are contiguous, so only the first job of each read needs recording.
+    batch_hmm_.clear();
+    batch_read_jobs_.clear();
+    batch_read_jobs_.reserve(num_reads + 1);
+    auto read_mapping_positions_itr = std::cbegin(mapping_positions);
+    std::for_each(first_read, last_read, [&] (const AlignedRead& read) {
+        const auto& model = read.is_marked_reverse_mapped() ? reverse_model : forward_model;
+        batch_read_jobs_.push_back(batch_hmm_.size());
+        for_each_candidate_mapping_position(read, *haplotype_, std::cbegin(*read_mapping_positions_itr), std::cend(*read_mapping_positions_itr),
+                                            batch_hmm_, [&] (const auto position) {
+            batch_hmm_.add(read.sequence(), haplotype_->sequence(), read.base_qualities(), position, model);
+        });
+        ++read_mapping_positions_itr;
+    });
+    batch_read_jobs_.push_back(batch_hmm_.size());
+    batch_hmm_.evaluate();
+    for (std::size_t read_idx {0}; read_idx < num_reads; ++read_idx, ++first_read) {
+        auto ln_prob_given_mapped = std::numeric_limits<LogProbability>::lowest();
+        for (auto job = batch_read_jobs_[read_idx]; job < batch_read_jobs_[read_idx + 1]; ++job) {
+            ln_prob_given_mapped = std::max(batch_hmm_[job], ln_prob_given_mapped);
+        }
+        assert(ln_prob_given_mapped > std::numeric_limits<LogProbability>::lowest() && ln_prob_given_mapped <= 0);
+        result[read_idx] = adjust_for_mapping_quality(*first_read, ln_prob_given_mapped);
     }
 }
 
@@ -430,6 +480,43 @@ HaplotypeLikelihoodModel::align(const AlignedRead& read, MappingPositionItr firs
     return result;
 }
 
+// private methods
+
+void HaplotypeLikelihoodModel::reset_hmm()
+{
+    if (config_.use_int_scores) {
+        hmm_ = HMM {config_.max_indel_error, HMM::ScoreType::int32};
+        batch_hmm_ = BatchHMM {config_.max_indel_error, BatchHMM::ScoreType::int32};
+    } else {
+        hmm_ = HMM {config_.max_indel_error};
+        batch_hmm_ = BatchHMM {config_.max_indel_error};
+    }
+}
+
+HaplotypeLikelihoodModel::LogProbability
+HaplotypeLikelihoodModel::adjust_for_mapping_quality(const AlignedRead& read, const LogProbability ln_prob_given_mapped) const
+{
+    if (config_.use_mapping_quality) {
+        // This calculation is approximately
+        // p(read | hap) = p(read missmapped) p(read | hap, missmapped)
+        //                  + p(read correctly mapped) p(read | hap, correctly mapped)
+        // = p(read correctly mapped) p(read | hap, correctly mapped)
+        //      + p(read missmapped)
+        // assuming p(read | hap, missmapped) = 1
+        auto mapping_quality = read.mapping_quality();
+        if (config_.mapping_quality_cap_trigger && mapping_quality >= *config_.mapping_quality_cap_trigger) {
+            mapping_quality = config_.mapping_quality_cap;
+        }
+        using octopus::maths::constants::ln10Div10;
+        const auto ln_prob_missmapped = -ln10Div10<> * mapping_quality;
+        const auto ln_prob_mapped = std::log(1.0 - std::exp(ln_prob_missmapped));
+        const auto result = maths::log_sum_exp(ln_prob_mapped + ln_prob_given_mapped, ln_prob_missmapped);
+        return result > -1e-15 ? 0.0 : result;
+    } else {
+        return ln_prob_given_mapped  > -1e-15 ? 0.0 : ln_prob_given_mapped;
+    }
+}
+
 HaplotypeLikelihoodModel make_haplotype_likelihood_model(const std::string label, bool use_mapping_quality)
 {
     HaplotypeLikelihoodModel::Config config {};
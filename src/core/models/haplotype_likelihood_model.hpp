@@ -24,6 +24,7 @@
 #include "core/models/error/snv_error_model.hpp"
 #include "core/models/error/indel_error_model.hpp"
 #include "pairhmm/pair_hmm.hpp"
+#include "pairhmm/batch_pair_hmm.hpp"
 
 namespace octopus {
 
@@ -41,6 +42,7 @@ public:
         bool use_flank_state = true;
         unsigned max_indel_error = 8;
         bool use_int_scores = false;
+        bool use_batch_evaluation = true;
     };
     
     struct FlankState
@@ -53,6 +55,7 @@ public:
     using MappingPosition       = std::size_t;
     using MappingPositionVector = std::vector<MappingPosition>;
     using MappingPositionItr    = MappingPositionVector::const_iterator;
+    using ReadIterator          = ReadContainer::const_iterator;
     
     struct Alignment
     {
@@ -94,6 +97,12 @@ public:
     LogProbability evaluate(const AlignedRead& read, const MappingPositionVector& mapping_positions) const;
     LogProbability evaluate(const AlignedRead& read, MappingPositionItr first_mapping_position, MappingPositionItr last_mapping_position) const;
     
+    // ln p(read | haplotype, model) for each read in [first_read, last_read), written to result. If batch evaluation
+    // is enabled then the alignments for all reads are packed into the SIMD lanes of a batched pair HMM.
+    void evaluate(ReadIterator first_read, ReadIterator last_read,
+                  const std::vector<MappingPositionVector>& mapping_positions,
+                  LogProbability* result) const;
+    
     // ln p(read template | haplotype, model)
     LogProbability evaluate(const AlignedTemplate& reads) const;
     LogProbability evaluate(const AlignedTemplate& reads, const std::vector<MappingPositionVector>& mapping_positions) const;
@@ -104,6 +113,7 @@ public:
     
 private:
     using HMM = hmm::PairHMM<hmm::MutationModel>;
+    using BatchHMM = hmm::BatchPairHMM<hmm::MutationModel>;
     
     std::unique_ptr<SnvErrorModel> snv_error_model_;
     std::unique_ptr<IndelErrorModel> indel_error_model_;
@@ -118,6 +128,11 @@ private:
     std::vector<Penalty> haplotype_gap_open_penalities_, haplotype_gap_extend_penalities_;
     Config config_;
     mutable HMM hmm_;
+    mutable BatchHMM batch_hmm_;
+    mutable std::vector<BatchHMM::JobId> batch_read_jobs_;
+    
+    void reset_hmm();
+    LogProbability adjust_for_mapping_quality(const AlignedRead& read, LogProbability ln_prob_given_mapped) const;
 };
 
 class HaplotypeLikelihoodModel::ShortHaplotypeError : public std::runtime_error
@@ -0,0 +1,160 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef batch_pair_hmm_hpp
+#define batch_pair_hmm_hpp
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <cassert>
+
+#include "pair_hmm.hpp"
+#include "simd_batch_pair_hmm.hpp"
+
+namespace octopus { namespace hmm {
+
+/*
+    BatchPairHMM evaluates many (target, truth) pairs together. Alignments are queued with add,
+    and evaluated with evaluate, after which results can be retrieved with the ids returned by add.
+
+    Alignments that can be resolved naively, or that need the flank-adjusted score, are evaluated
+    immediately with the banded SIMD PairHMM; the rest are packed into the lanes of a
+    simd::BatchPairHMM. The results are the same as evaluating each pair with PairHMM::evaluate.
+ */
+template <typename Parameters,
+          typename BatchKernel = simd::FastestBatchPairHMM>
+class BatchPairHMM
+{
+public:
+    using ScoreType = simd::PairHMMWrapper::ScorePrecision;
+    using ParameterType = Parameters;
+    using JobId = std::size_t;
+
+    BatchPairHMM() = default;
+    BatchPairHMM(unsigned min_band_size, ScoreType score = ScoreType::int16)
+    : hmm_ {static_cast<int>(min_band_size), score}
+    , use_batch_kernel_ {score == ScoreType::int16}
+    {}
+
+    BatchPairHMM(const BatchPairHMM&)            = default;
+    BatchPairHMM& operator=(const BatchPairHMM&) = default;
+    BatchPairHMM(BatchPairHMM&&)                 = default;
+    BatchPairHMM& operator=(BatchPairHMM&&)      = default;
+
+    ~BatchPairHMM() = default;
+
+    int band_size() const noexcept { return hmm_.band_size(); }
+
+    static constexpr int lanes() noexcept { return BatchKernel::lanes(); }
+
+    template <typename Sequence1,
+              typename Sequence2>
+    JobId
+    add(const Sequence1& target,
+        const Sequence2& truth,
+        const std::vector<std::uint8_t>& target_base_qualities,
+        const std::size_t target_offset,
+        const Parameters& params)
+    {
+        const JobId result {results_.size()};
+        const auto naive = detail::try_naive_evaluate(truth, target, target_base_qualities, target_offset, params);
+        if (naive.second) {
+            results_.push_back(naive.first);
+        } else if (can_batch(truth, target, target_offset, params)) {
+            const auto alignment_offset = std::max(0, static_cast<int>(target_offset) - band_size());
+            simd::BatchPairHMMLane lane {
+                truth.data() + alignment_offset,
+                target.data(),
+                reinterpret_cast<const std::int8_t*>(target_base_qualities.data()),
+                params.snv_mask.data() + alignment_offset,
+                params.snv_priors.data() + alignment_offset,
+                params.gap_open.data() + alignment_offset,
+                params.gap_extend.data() + alignment_offset
+            };
+            pending_.push_back({lane, static_cast<int>(target.size()), params.nuc_prior, result});
+            results_.push_back(0);
+        } else {
+            results_.push_back(detail::simd_evaluate(truth, target, target_base_qualities, target_offset, hmm_, params));
+        }
+        return result;
+    }
+
+    void evaluate()
+    {
+        if (pending_.empty()) return;
+        // Only alignments with the same target length and nucleotide prior can share lanes
+        std::sort(std::begin(pending_), std::end(pending_), [] (const Job& lhs, const Job& rhs) noexcept {
+            return std::tie(lhs.target_len, lhs.nuc_prior) < std::tie(rhs.target_len, rhs.nuc_prior);
+        });
+        lanes_.resize(lanes());
+        scores_.resize(lanes());
+        for (auto first_job = std::cbegin(pending_); first_job != std::cend(pending_);) {
+            const auto max_lanes = std::min<std::ptrdiff_t>(lanes(), std::distance(first_job, std::cend(pending_)));
+            const auto last_job = std::find_if(first_job, std::next(first_job, max_lanes), [first_job] (const Job& job) noexcept {
+                return job.target_len != first_job->target_len || job.nuc_prior != first_job->nuc_prior;
+            });
+            const auto num_lanes = static_cast<int>(std::distance(first_job, last_job));
+            std::transform(first_job, last_job, std::begin(lanes_), [] (const Job& job) noexcept { return job.lane; });
+            kernel_.align(lanes_.data(), num_lanes, first_job->target_len, band_size(), first_job->nuc_prior, scores_.data());
+            for (int lane {0}; lane < num_lanes; ++lane, ++first_job) {
+                results_[first_job->id] = -ln10Div10<> * static_cast<double>(scores_[lane]);
+            }
+        }
+        pending_.clear();
+    }
+
+    double operator[](const JobId job) const noexcept
+    {
+        assert(job < results_.size());
+        return results_[job];
+    }
+
+    std::size_t size() const noexcept { return results_.size(); }
+
+    void clear() noexcept
+    {
+        pending_.clear();
+        results_.clear();
+    }
+
+private:
+    struct Job
+    {
+        simd::BatchPairHMMLane lane;
+        int target_len;
+        short nuc_prior;
+        JobId id;
+    };
+
+    simd::PairHMMWrapper hmm_;
+    BatchKernel kernel_;
+    bool use_batch_kernel_ = true;
+    std::vector<Job> pending_;
+    std::vector<double> results_;
+    std::vector<simd::BatchPairHMMLane> lanes_;
+    std::vector<int> scores_;
+
+    template <typename Sequence1,
+              typename Sequence2>
+    bool can_batch(const Sequence1& truth,
+                   const Sequence2& target,
+                   const std::size_t target_offset,
+                   const Parameters& params) const noexcept
+    {
+        if (!use_batch_kernel_) return false;
+        const auto pad = band_size();
+        const auto truth_alignment_size = static_cast<int>(target.size() + 2 * pad - 1);
+        const auto alignment_offset = std::max(0, static_cast<int>(target_offset) - pad);
+        return alignment_offset + truth_alignment_size <= static_cast<int>(truth.size())
+            && !detail::use_adjusted_alignment_score(truth, target, target_offset, hmm_, params);
+    }
+};
+
+} // namespace hmm
+} // namespace octopus
+
+#endif
@@ -0,0 +1,344 @@
+// Copyright (c) 2015-2020 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef simd_batch_pair_hmm_hpp
+#define simd_batch_pair_hmm_hpp
+
+#if __GNUC__ >= 6
+    #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <cassert>
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include "sse2_pair_hmm_impl.hpp"
+#include "avx2_pair_hmm_impl.hpp"
+#include "avx512_pair_hmm_impl.hpp"
+
+namespace octopus { namespace hmm { namespace simd {
+
+// The inputs for a single alignment in a batch. All pointers are already offset to the
+// start of the alignment window, so truth and the per-truth-base arrays must have
+// target_len + 2 * band_size - 1 elements.
+struct BatchPairHMMLane
+{
+    const char* truth;
+    const char* target;
+    const std::int8_t* qualities;
+    const char* snv_mask;
+    const std::int8_t* snv_prior;
+    const std::int8_t* gap_open;
+    const std::int8_t* gap_extend;
+};
+
+// Plain C++ lane instructions with identical (wrapping) semantics to the SIMD instruction sets.
+template <unsigned NumLanes = 8,
+          typename ScoreTp = short>
+class ScalarPairHMMInstructionSet
+{
+protected:
+    using ScoreType = ScoreTp;
+
+    static_assert(is_short_or_int<ScoreType>, "ScoreType not short or int");
+
+    constexpr static const char* name = "Scalar";
+
+    using VectorType = std::array<ScoreType, NumLanes>;
+
+    constexpr static int band_size = NumLanes;
+
+    static VectorType vectorise(ScoreType x) noexcept
+    {
+        VectorType result;
+        result.fill(x);
+        return result;
+    }
+    template <typename T>
+    static VectorType vectorise(const T* values) noexcept
+    {
+        VectorType result;
+        for (unsigned i {0}; i < NumLanes; ++i) result[i] = values[i];
+        return result;
+    }
+    static auto _extract(const VectorType& a, const int index) noexcept
+    {
+        assert(index >= 0 && index < band_size);
+        return a[index];
+    }
+private:
+    template <typename BinaryOperation>
+    static VectorType transform(BinaryOperation op, const VectorType& lhs, const VectorType& rhs) noexcept
+    {
+        VectorType result;
+        for (unsigned i {0}; i < NumLanes; ++i) result[i] = static_cast<ScoreType>(op(lhs[i], rhs[i]));
+        return result;
+    }
+protected:
+    static VectorType _add(const VectorType& lhs, const VectorType& rhs) noexcept
+    {
+        using UnsignedScoreType = std::make_unsigned_t<ScoreType>;
+        return transform([] (auto lhs, auto rhs) noexcept {
+            return static_cast<UnsignedScoreType>(static_cast<UnsignedScoreType>(lhs) + static_cast<UnsignedScoreType>(rhs));
+        }, lhs, rhs);
+    }
+    static VectorType _and(const VectorType& lhs, const VectorType& rhs) noexcept
+    {
+        return transform([] (auto lhs, auto rhs) noexcept { return lhs & rhs; }, lhs, rhs);
+    }
+    static VectorType _andnot(const VectorType& lhs, const VectorType& rhs) noexcept
+    {
+        return transform([] (auto lhs, auto rhs) noexcept { return ~lhs & rhs; }, lhs, rhs);
+    }
+    static VectorType _or(const VectorType& lhs, const VectorType& rhs) noexcept
+    {
+        return transform([] (auto lhs, auto rhs) noexcept { return lhs | rhs; }, lhs, rhs);
+    }
+    static VectorType _cmpeq(const VectorType& lhs, const VectorType& rhs) noexcept
+    {
+        return transform([] (auto lhs, auto rhs) noexcept { return lhs == rhs ? -1 : 0; }, lhs, rhs);
+    }
+    static VectorType _min(const VectorType& lhs, const VectorType& rhs) noexcept
+    {
+        return transform([] (auto lhs, auto rhs) noexcept { return std::min(lhs, rhs); }, lhs, rhs);
+    }
+};
+
+/*
+    BatchPairHMM evaluates the same banded recurrence as PairHMM, but the SIMD lanes hold
+    independent alignments of equal target length (i.e. different reads, or different
+    mapping positions of the same read) rather than the cells of a single band. This keeps
+    the vector units full for small band sizes, and avoids the word shifts, inserts, and
+    extracts needed to move a band along the anti-diagonal.
+
+    Only the alignment score is computed (no traceback), and the results are identical to
+    PairHMM::align with the same inputs.
+ */
+template <typename InstructionSet>
+class BatchPairHMM : private InstructionSet
+{
+public:
+    using ScoreType = typename InstructionSet::ScoreType;
+
+private:
+    using VectorType  = typename InstructionSet::VectorType;
+    using SmallVector = std::vector<VectorType, boost::alignment::aligned_allocator<VectorType>>;
+
+    using InstructionSet::vectorise;
+    using InstructionSet::_extract;
+    using InstructionSet::_add;
+    using InstructionSet::_and;
+    using InstructionSet::_andnot;
+    using InstructionSet::_or;
+    using InstructionSet::_cmpeq;
+    using InstructionSet::_min;
+
+    // Constants - these must match PairHMM
+    constexpr static const char* name_ = InstructionSet::name;
+    constexpr static int num_lanes_ {InstructionSet::band_size};
+    constexpr static ScoreType infinity_tolerance_ {0x7FF};
+    constexpr static ScoreType infinity_ {std::numeric_limits<ScoreType>::max() - infinity_tolerance_};
+    constexpr static int trace_bits_ {2};
+    constexpr static ScoreType n_score_ {2 << trace_bits_};
+    constexpr static ScoreType max_quality_score_ {64};
+    constexpr static ScoreType null_score_ {std::numeric_limits<ScoreType>::min()};
+
+    // Lane-transposed inputs. Target arrays are indexed by (target position + band_size - 1) and
+    // truth arrays by truth position, with one extra element for positions past the truth end.
+    mutable SmallVector target_, qualities_;
+    mutable SmallVector truth_, truthnqual_, snv_mask_, snv_prior_, gap_open_, gap_extend_;
+    mutable SmallVector m1_, i1_, d1_, m2_, i2_, d2_;
+
+    static ScoreType* lane_words(SmallVector& values) noexcept
+    {
+        static_assert(sizeof(VectorType) == num_lanes_ * sizeof(ScoreType), "VectorType must be a packed array of lane words");
+        return reinterpret_cast<ScoreType*>(values.data());
+    }
+    
+    void
+    transpose(const BatchPairHMMLane* lanes,
+              const int num_lanes,
+              const int target_len,
+              const int band_size) const
+    {
+        const auto truth_len = target_len + 2 * band_size - 1;
+        const auto target_window_len = target_len + 2 * band_size - 1;
+        const VectorType _max_quality = vectorise(static_cast<ScoreType>(max_quality_score_ << trace_bits_));
+        target_.resize(target_window_len);
+        qualities_.resize(target_window_len);
+        std::fill_n(std::begin(target_), band_size - 1, vectorise(infinity_));
+        std::fill_n(std::begin(qualities_), band_size - 1, _max_quality);
+        std::fill(std::next(std::begin(target_), band_size - 1 + target_len), std::end(target_), vectorise(static_cast<ScoreType>('0')));
+        std::fill(std::next(std::begin(qualities_), band_size - 1 + target_len), std::end(qualities_), _max_quality);
+        for (auto* values : {&truth_, &truthnqual_, &snv_mask_, &snv_prior_, &gap_open_, &gap_extend_}) {
+            values->resize(truth_len + 1);
+        }
+        auto target = lane_words(target_) + (band_size - 1) * num_lanes_;
+        auto qualities = lane_words(qualities_) + (band_size - 1) * num_lanes_;
+        auto truth = lane_words(truth_);
+        auto snv_mask = lane_words(snv_mask_), snv_prior = lane_words(snv_prior_);
+        auto gap_open = lane_words(gap_open_), gap_extend = lane_words(gap_extend_);
+        // unused lanes duplicate the last real lane so all arithmetic is well defined
+        std::array<const BatchPairHMMLane*, num_lanes_> inputs;
+        for (int lane {0}; lane < num_lanes_; ++lane) {
+            inputs[lane] = lanes + std::min(lane, num_lanes - 1);
+        }
+        // Fill one lane vector at a time so each is written in a single pass
+        for (int i {0}; i < target_len; ++i, target += num_lanes_, qualities += num_lanes_) {
+            for (int lane {0}; lane < num_lanes_; ++lane) {
+                target[lane]    = inputs[lane]->target[i];
+                qualities[lane] = inputs[lane]->qualities[i] << trace_bits_;
+            }
+        }
+        for (int pos {0}; pos < truth_len; ++pos) {
+            for (int lane {0}; lane < num_lanes_; ++lane) {
+                const auto& input = *inputs[lane];
+                truth[lane]      = input.truth[pos];
+                snv_mask[lane]   = input.snv_mask[pos];
+                snv_prior[lane]  = input.snv_prior[pos] << trace_bits_;
+                gap_open[lane]   = input.gap_open[pos] << trace_bits_;
+                gap_extend[lane] = input.gap_extend[pos] << trace_bits_;
+            }
+            truth += num_lanes_;
+            snv_mask += num_lanes_; snv_prior += num_lanes_;
+            gap_open += num_lanes_; gap_extend += num_lanes_;
+        }
+        // PairHMM pads the truth with 'N' and uses the last gap penalties past the truth end
+        truth_[truth_len]      = vectorise(static_cast<ScoreType>('N'));
+        snv_mask_[truth_len]   = vectorise(static_cast<ScoreType>('N'));
+        snv_prior_[truth_len]  = vectorise(static_cast<ScoreType>(infinity_ << trace_bits_));
+        gap_open_[truth_len]   = gap_open_[truth_len - 1];
+        gap_extend_[truth_len] = gap_extend_[truth_len - 1];
+        const VectorType _inf = vectorise(infinity_);
+        const VectorType _n = vectorise(static_cast<ScoreType>('N'));
+        const VectorType _n_score = vectorise(static_cast<ScoreType>(n_score_ - infinity_));
+        std::transform(std::cbegin(truth_), std::cend(truth_), std::begin(truthnqual_), [&] (const VectorType& _truth) noexcept {
+            return _add(_and(_cmpeq(_truth, _n), _n_score), _inf);
+        });
+    }
+    
+    void
+    update_match_state(VectorType& current,
+                       const VectorType& _target,
+                       const VectorType& _truth,
+                       const VectorType& _quality,
+                       const VectorType& _truthnqual,
+                       const VectorType& _snvmask,
+                       const VectorType& _snv_prior) const noexcept
+    {
+        const auto _snvmatch = _cmpeq(_target, _snvmask);
+        current = _add(current, _min(_andnot(_cmpeq(_target, _truth), _min(_quality, _or(_and(_snvmatch, _snv_prior), _andnot(_snvmatch, _quality)))), _truthnqual));
+    }
+
+public:
+    constexpr static const char* name() noexcept { return name_; }
+    constexpr static int lanes() noexcept { return num_lanes_; }
+
+    // Writes the alignment score of each lane into scores. The band in each lane spans
+    // target_len + 2 * band_size - 1 truth bases.
+    void
+    align(const BatchPairHMMLane* lanes,
+          const int num_lanes,
+          const int target_len,
+          const int band_size,
+          const short nuc_prior,
+          int* scores) const
+    {
+        assert(num_lanes > 0 && num_lanes <= num_lanes_);
+        assert(target_len > 0 && band_size > 0);
+        transpose(lanes, num_lanes, target_len, band_size);
+        const VectorType _inf = vectorise(infinity_);
+        const VectorType _null = vectorise(null_score_);
+        const VectorType _nuc_prior = vectorise(static_cast<ScoreType>(static_cast<std::int8_t>(nuc_prior) << trace_bits_));
+        for (auto* state : {&m1_, &i1_, &d1_, &m2_, &i2_, &d2_}) {
+            state->assign(band_size, _inf);
+        }
+        auto _minscore = _inf;
+        for (int t {0}; t < target_len + band_size; ++t) {
+            const auto target_idx = t + band_size - 1;
+            // s even. truth is current; target needs updating
+            if (t < band_size) {
+                m1_[t] = _null;
+                m2_[t] = _null;
+            }
+            for (int k {0}; k < band_size; ++k) {
+                m1_[k] = _min(m1_[k], _min(i1_[k], d1_[k]));
+            }
+            if (t >= target_len) {
+                _minscore = _min(_minscore, m1_[t - target_len]);
+            }
+            for (int k {0}; k < band_size; ++k) {
+                update_match_state(m1_[k], target_[target_idx - k], truth_[t + k], qualities_[target_idx - k],
+                                   truthnqual_[t + k], snv_mask_[t + k], snv_prior_[t + k]);
+            }
+            for (int k {band_size - 1}; k > 0; --k) {
+                d1_[k] = _min(_add(d2_[k - 1], gap_extend_[t + k]), _add(_min(m2_[k - 1], i2_[k - 1]), gap_open_[t + k]));
+            }
+            d1_[0] = _inf;
+            for (int k {0}; k < band_size; ++k) {
+                i1_[k] = _add(_min(_add(i2_[k], gap_extend_[t + k]), _add(m2_[k], gap_open_[t + k])), _nuc_prior);
+            }
+            // s odd. Truth needs updating; target is current
+            for (int k {0}; k < band_size; ++k) {
+                m2_[k] = _min(m2_[k], _min(i2_[k], d2_[k]));
+            }
+            if (t >= target_len) {
+                _minscore = _min(_minscore, m2_[t - target_len]);
+            }
+            for (int k {0}; k < band_size; ++k) {
+                update_match_state(m2_[k], target_[target_idx - k], truth_[t + 1 + k], qualities_[target_idx - k],
+                                   truthnqual_[t + 1 + k], snv_mask_[t + 1 + k], snv_prior_[t + 1 + k]);
+            }
+            for (int k {0}; k < band_size; ++k) {
+                d2_[k] = _min(_add(d1_[k], gap_extend_[t + 1 + k]), _add(_min(m1_[k], i1_[k]), gap_open_[t + 1 + k]));
+            }
+            for (int k {0}; k < band_size - 1; ++k) {
+                i2_[k] = _add(_min(_add(i1_[k + 1], gap_extend_[t + 1 + k]), _add(m1_[k + 1], gap_open_[t + 1 + k])), _nuc_prior);
+            }
+            i2_[band_size - 1] = _inf;
+        }
+        for (int lane {0}; lane < num_lanes; ++lane) {
+            const ScoreType minscore = _extract(_minscore, lane);
+            scores[lane] = (minscore - null_score_) >> trace_bits_;
+        }
+    }
+};
+
+template <unsigned NumLanes = 8, typename ScoreType = short>
+using ScalarBatchPairHMM = BatchPairHMM<ScalarPairHMMInstructionSet<NumLanes, ScoreType>>;
+
+template <unsigned NumLanes = 8, typename ScoreType = short>
+using SSE2BatchPairHMM = BatchPairHMM<SSE2PairHMMInstructionSet<NumLanes, ScoreType>>;
+
+#if defined(AVX512_PHMM)
+
+template <unsigned NumLanes = 32, typename ScoreType = short>
+using AVX512BatchPairHMM = BatchPairHMM<AVX512PairHMMInstructionSet<NumLanes, ScoreType>>;
+
+using FastestBatchPairHMM = AVX512BatchPairHMM<>;
+
+#elif defined(AVX2_PHMM)
+
+template <unsigned NumLanes = 16, typename ScoreType = short>
+using AVX2BatchPairHMM = BatchPairHMM<AVX2PairHMMInstructionSet<NumLanes, ScoreType>>;
+
+using FastestBatchPairHMM = AVX2BatchPairHMM<>;
+
+#else
+
+using FastestBatchPairHMM = SSE2BatchPairHMM<>;
+
+#endif
+
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
+
+#endif
@@ -15,10 +15,11 @@
 #include <cstddef>
 #include <typeinfo>
 #include <thread>
-#include <future>
 #include <condition_variable>
 #include <mutex>
 #include <atomic>
+#include <future>
+#include <exception>
 #include <chrono>
 #include <sstream>
 #include <iostream>
@@ -29,6 +30,7 @@
 #include "config/common.hpp"
 #include "basics/genomic_region.hpp"
 #include "basics/ploidy_map.hpp"
+#include "basics/aligned_read.hpp"
 #include "concepts/mappable.hpp"
 #include "containers/mappable_flat_multi_set.hpp"
 #include "containers/mappable_map.hpp"
@@ -39,6 +41,7 @@
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
 #include "utils/append.hpp"
+#include "utils/memory_footprint.hpp"
 #include "config/octopus_vcf.hpp"
 #include "core/callers/caller_factory.hpp"
 #include "core/callers/caller.hpp"
@@ -48,7 +51,10 @@
 #include "logging/error_handler.hpp"
 #include "core/tools/vcf_header_factory.hpp"
 #include "io/variant/vcf.hpp"
+#include "io/htslib_thread_pool.hpp"
 #include "utils/timing.hpp"
+#include "utils/work_stealing_thread_pool.hpp"
+#include "utils/executor.hpp"
 #include "exceptions/program_error.hpp"
 #include "exceptions/system_error.hpp"
 #include "csr/filters/variant_call_filter.hpp"
@@ -574,100 +580,6 @@ private:
 using TaskQueue = std::queue<Task>;
 using TaskMap   = std::map<ContigName, TaskQueue, ContigOrder>;
 
-auto count_tasks(const TaskMap& tasks) noexcept
-{
-    return std::accumulate(std::cbegin(tasks), std::cend(tasks), std::size_t {0},
-                           [] (auto curr, const auto& p) noexcept { return curr + p.second.size(); });
-}
-
-struct TaskMakerSyncPacket
-{
-    TaskMakerSyncPacket() : batch_size_hint {1}, waiting {true}, num_tasks {0}, finished {}, all_done {false} {}
-    std::condition_variable cv;
-    std::mutex mutex;
-    bool ready = true;
-    std::atomic_uint batch_size_hint; // Only read by task maker
-    std::atomic_bool waiting; // Only read by task maker
-    std::atomic_uint num_tasks;
-    std::unordered_map<ContigName, bool> finished;
-    std::atomic_bool all_done;
-};
-
-void make_region_tasks(const GenomicRegion& region,
-                       const ContigCallingComponents& components,
-                       const ExecutionPolicy policy,
-                       TaskQueue& result,
-                       TaskMakerSyncPacket& sync,
-                       const bool last_region_in_contig,
-                       const bool last_contig,
-                       const WindowConfig& window_config)
-{
-    std::unique_lock<std::mutex> lock {sync.mutex, std::defer_lock};
-    auto subregion = propose_call_subregion(components, region, window_config);
-    if (ends_equal(subregion, region)) {
-        lock.lock();
-        sync.cv.wait(lock, [&] () { return sync.ready; });
-        result.emplace(std::move(subregion), policy);
-        ++sync.num_tasks;
-        if (last_region_in_contig) {
-            sync.finished.at(region.contig_name()) = true;
-            if (last_contig) sync.all_done = true;
-        }
-        lock.unlock();
-        sync.cv.notify_one();
-    } else {
-        std::deque<GenomicRegion> batch {};
-        batch.push_back(subregion);
-        bool done {false};
-        while (true) {
-            while (batch.size() < std::max(sync.batch_size_hint.load(), 1u) || !sync.waiting) {
-                subregion = propose_call_subregion(components, subregion, region, window_config);
-                batch.push_back(subregion);
-                assert(!ends_before(region, subregion));
-                if (ends_equal(subregion, region)) {
-                    done = true;
-                    break;
-                }
-            }
-            assert(!batch.empty());
-            assert(!lock.owns_lock());
-            lock.lock();
-            sync.cv.wait(lock, [&] () { return sync.ready; });
-            for (auto&& r : batch) result.emplace(std::move(r), policy);
-            sync.num_tasks += batch.size();
-            if (done) {
-                if (last_region_in_contig) {
-                    sync.finished.at(region.contig_name()) = true;
-                    if (last_contig) sync.all_done = true;
-                } else {
-                    assert(!last_contig);
-                }
-                lock.unlock();
-                sync.cv.notify_one();
-                break;
-            } else {
-                batch.clear();
-                lock.unlock();
-                sync.cv.notify_one();
-            }
-        }
-    }
-}
-
-void make_contig_tasks(const ContigCallingComponents& components,
-                       const ExecutionPolicy policy,
-                       TaskQueue& result,
-                       TaskMakerSyncPacket& sync,
-                       const bool last_contig,
-                       const WindowConfig& window_config)
-{
-    if (components.regions.empty()) return;
-    std::for_each(std::cbegin(components.regions), std::prev(std::cend(components.regions)), [&] (const auto& region) {
-        make_region_tasks(region, components, policy, result, sync, false, last_contig, window_config);
-    });
-    make_region_tasks(components.regions.back(), components, policy, result, sync, true, last_contig, window_config);
-}
-
 ExecutionPolicy make_execution_policy(const GenomeCallingComponents& components)
 {
     if (components.num_threads()) {
@@ -683,93 +595,19 @@ auto make_contig_components(const ContigName& contig, GenomeCallingComponents& c
     return result;
 }
 
-void make_tasks_helper(TaskMap& tasks,
-                       std::vector<ContigName> contigs,
-                       GenomeCallingComponents& components,
-                       const unsigned num_threads,
-                       ExecutionPolicy execution_policy,
-                       TaskMakerSyncPacket& sync)
-{
-    const auto window_config = default_window_config;
-    try {
-        static auto debug_log = get_debug_log();
-        if (debug_log) stream(*debug_log) << "Making tasks for " << contigs.size() << " contigs";
-        for (std::size_t i {0}; i < contigs.size(); ++i) {
-            const auto& contig = contigs[i];
-            if (debug_log) stream(*debug_log) << "Making tasks for contig " << contig;
-            auto contig_components = make_contig_components(contig, components, num_threads);
-            make_contig_tasks(contig_components, execution_policy, tasks[contig], sync, i == contigs.size() - 1, window_config);
-            if (debug_log) stream(*debug_log) << "Finished making tasks for contig " << contig;
-        }
-        if (debug_log) *debug_log << "Finished making tasks";
-    } catch (const Error& e) {
-        log_error(e);
-        logging::FatalLogger fatal_log {};
-        fatal_log << "Encountered error in task maker thread. Calling terminate";
-        std::terminate();
-    } catch (const std::exception& e) {
-        log_error(e);
-        logging::FatalLogger fatal_log {};
-        fatal_log << "Encountered error in task maker thread. Calling terminate";
-        std::terminate();
-    } catch (...) {
-        logging::FatalLogger fatal_log {};
-        fatal_log << "Encountered error in task maker thread. Calling terminate";
-        std::terminate();
-    }
-}
-
-std::thread
-make_task_maker_thread(TaskMap& tasks,
-                       GenomeCallingComponents& components,
-                       const unsigned num_threads,
-                       TaskMakerSyncPacket& sync)
-{
-    auto contigs = components.contigs();
-    if (contigs.empty()) {
-        sync.all_done = true;
-        return std::thread {};
-    }
-    sync.finished.reserve(contigs.size());
-    for (const auto& contig : contigs) {
-        sync.finished.emplace(contig, false);
-    }
-    return std::thread {make_tasks_helper, std::ref(tasks), std::move(contigs), std::ref(components),
-                        num_threads, make_execution_policy(components), std::ref(sync)};
-}
-
 unsigned calculate_num_task_threads(const GenomeCallingComponents& components)
 {
+    unsigned result;
     if (components.num_threads()) {
-        return *components.num_threads();
-    }
-    const auto num_cores = hardware_concurrency();
-    if (num_cores == 0) {
-        throw UnknownHardwareConcurrency {};
+        result = *components.num_threads();
+    } else {
+        result = hardware_concurrency();
+        if (result == 0) {
+            throw UnknownHardwareConcurrency {};
+        }
     }
-    return num_cores;
-}
-
-Task pop(TaskMap& tasks, TaskMakerSyncPacket& sync)
-{
-    assert(!tasks.empty());
-    std::unique_lock<std::mutex> lock {sync.mutex};
-    sync.ready = false;
-    assert(sync.num_tasks > 0);
-    const auto contig_task_itr = std::begin(tasks);
-    assert(!contig_task_itr->second.empty());
-    const auto result = std::move(contig_task_itr->second.front());
-    contig_task_itr->second.pop();
-    if (sync.finished.at(contig_task_itr->first) && contig_task_itr->second.empty()) {
-        static auto debug_log = get_debug_log();
-        if (debug_log) stream(*debug_log) << "Finished calling contig " << contig_task_itr->first;
-        tasks.erase(contig_task_itr);
-    }
-    --sync.num_tasks;
-    sync.ready = true;
-    lock.unlock();
-    sync.cv.notify_one();
-    return result;
+    // The htslib decoding threads are leased from the same budget
+    return std::max(result - std::min(result, io::htslib_thread_pool_size()), 1u);
 }
 
 struct CompletedTask : public Task
@@ -792,49 +630,6 @@ std::ostream& operator<<(std::ostream& os, const CompletedTask& task)
     return os;
 }
 
-struct CallerSyncPacket
-{
-    CallerSyncPacket() : num_finished {0} {}
-    std::condition_variable cv;
-    std::mutex mutex;
-    std::atomic_uint num_finished;
-};
-
-template<typename R>
-bool is_ready(const std::future<R>& f)
-{
-    return f.valid() && f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
-}
-
-auto run(Task task, ContigCallingComponents components, CallerSyncPacket& sync)
-{
-    static auto debug_log = get_debug_log();
-    if (debug_log) stream(*debug_log) << "Spawning task " << task;
-    return std::async(std::launch::async, [task = std::move(task), components = std::move(components), &sync] () {
-        try {
-            CompletedTask result {task};
-            result.runtime.start = std::chrono::system_clock::now();
-            result.calls = components.caller->call(task.region, components.progress_meter);
-            result.runtime.end = std::chrono::system_clock::now();
-            std::unique_lock<std::mutex> lock {sync.mutex};
-            ++sync.num_finished;
-            lock.unlock();
-            sync.cv.notify_all();
-            return result;
-        } catch (const std::exception& e) {
-            logging::ErrorLogger error_log {};
-            stream(error_log) << "Encountered a problem whilst calling " << task << "(" << e.what() << ")";
-            using namespace std::chrono_literals;
-            std::this_thread::sleep_for(2s); // Try to make sure the error is logged before raising
-            std::unique_lock<std::mutex> lock {sync.mutex};
-            ++sync.num_finished;
-            lock.unlock();
-            sync.cv.notify_all();
-            throw;
-        }
-    });
-}
-
 using CompletedTaskMap = std::map<ContigName, std::map<ContigRegion, CompletedTask>>;
 using HoldbackTask = boost::optional<std::reference_wrapper<const CompletedTask>>;
 
@@ -1028,17 +823,8 @@ void wait_until_finished(TaskWriterSyncPacket& sync)
     sync.cv.notify_one();
 }
 
-using FutureCompletedTasks = std::vector<std::future<CompletedTask>>;
 using RemainingTaskMap = std::map<ContigName, std::deque<CompletedTask>>;
 
-void extract_remaining_future_tasks(FutureCompletedTasks& futures, std::deque<CompletedTask>& result)
-{
-    const auto itr = std::remove_if(std::begin(futures), std::end(futures), [] (const auto& f) { return !f.valid(); });
-    std::transform(std::begin(futures), itr, std::back_inserter(result), [] (auto& fut) { return fut.get(); });
-    futures.clear();
-    futures.shrink_to_fit();
-}
-
 void extract_buffered_tasks(CompletedTaskMap& buffered_tasks, std::deque<CompletedTask>& result)
 {
     for (auto& p : buffered_tasks) {
@@ -1065,10 +851,9 @@ RemainingTaskMap make_map(std::deque<CompletedTask>& tasks)
     return result;
 }
 
-RemainingTaskMap extract_remaining_tasks(FutureCompletedTasks& futures, CompletedTaskMap& buffered_tasks)
+RemainingTaskMap extract_remaining_tasks(CompletedTaskMap& buffered_tasks)
 {
     std::deque<CompletedTask> tasks {};
-    extract_remaining_future_tasks(futures, tasks);
     extract_buffered_tasks(buffered_tasks, tasks);
     return make_map(tasks);
 }
@@ -1088,12 +873,10 @@ void write(RemainingTaskMap&& remaining_tasks, TempVcfWriterMap& temp_vcfs)
     }
 }
 
-void write_remaining_tasks(FutureCompletedTasks& futures, CompletedTaskMap& buffered_tasks, TempVcfWriterMap& temp_vcfs,
+void write_remaining_tasks(CompletedTaskMap& buffered_tasks, TempVcfWriterMap& temp_vcfs,
                            const ContigCallingComponentFactoryMap& calling_components)
 {
-    static auto debug_log = get_debug_log();
-    if (debug_log) stream(*debug_log) << "Waiting for " << futures.size() << " running tasks to finish";
-    auto remaining_tasks = extract_remaining_tasks(futures, buffered_tasks);
+    auto remaining_tasks = extract_remaining_tasks(buffered_tasks);
     resolve_connecting_calls(remaining_tasks, calling_components);
     write(std::move(remaining_tasks), temp_vcfs);
 }
@@ -1122,27 +905,467 @@ void merge(TempVcfWriterMap&& temp_vcf_writers, GenomeCallingComponents& compone
     merge(temp_readers, components.output(), components.contigs());
 }
 
-void run_octopus_multi_threaded(GenomeCallingComponents& components)
+// Tasks for a contig are made sequentially by a single ContigTaskMaker, so the order in which tasks
+// are registered for writing does not depend on thread scheduling.
+struct ContigTaskMaker
 {
-    using namespace std::chrono_literals;
-    static auto debug_log = get_debug_log();
+    ContigTaskMaker(const ContigName& contig, GenomeCallingComponents& genome_components,
+                    unsigned num_threads, ExecutionPolicy policy)
+    : contig {contig}
+    , components {make_contig_components(contig, genome_components, num_threads)}
+    , policy {policy}
+    , next_region {std::cbegin(components.regions)}
+    , last_subregion {}
+    {}
     
-    const auto num_task_threads = calculate_num_task_threads(components);
+    ContigName contig;
+    ContigCallingComponents components;
+    ExecutionPolicy policy;
+    InputRegionMap::mapped_type::const_iterator next_region;
+    boost::optional<GenomicRegion> last_subregion;
     
-    TaskMap pending_tasks {components.contigs()};
-    TaskMakerSyncPacket task_maker_sync {};
-    task_maker_sync.batch_size_hint = 2 * num_task_threads;
-    std::unique_lock<std::mutex> pending_task_lock {task_maker_sync.mutex, std::defer_lock};
-    auto task_maker_thread = make_task_maker_thread(pending_tasks, components, num_task_threads, task_maker_sync);
-    if (!task_maker_thread.joinable()) {
-        logging::FatalLogger fatal_log {};
-        fatal_log << "Unable to make task maker thread";
+    bool done() const noexcept { return next_region == std::cend(components.regions); }
+};
+
+std::deque<Task> make_tasks(ContigTaskMaker& maker, const std::size_t max_tasks, const WindowConfig& window_config)
+{
+    std::deque<Task> result {};
+    while (result.size() < max_tasks && !maker.done()) {
+        const auto& region = *maker.next_region;
+        auto subregion = maker.last_subregion ? propose_call_subregion(maker.components, *maker.last_subregion, region, window_config)
+                                              : propose_call_subregion(maker.components, region, window_config);
+        assert(!ends_before(region, subregion));
+        if (ends_equal(subregion, region)) {
+            ++maker.next_region;
+            maker.last_subregion = boost::none;
+        } else {
+            maker.last_subregion = subregion;
+        }
+        result.emplace_back(std::move(subregion), maker.policy);
+    }
+    return result;
+}
+
+struct TaskSchedulerSyncPacket
+{
+    std::condition_variable cv;
+    std::mutex mutex;
+    std::deque<Task> made_tasks = {}; // made since the writer last took them, in the order they were made
+    std::deque<CompletedTask> completed_tasks = {};
+    std::set<std::size_t> parked_makers = {}; // waiting for running tasks to finish
+    std::size_t num_unfinished_makers = 0, num_unfinished_tasks = 0, max_unfinished_tasks = 0;
+    std::atomic<unsigned> num_prefetched_tasks {0}; // tasks holding reads that have not started calling
+    std::exception_ptr error = nullptr;
+    bool aborted = false;
+};
+
+struct WorkerCallingComponents
+{
+    ContigName contig;
+    std::unique_ptr<ContigCallingComponents> components;
+};
+
+/*
+ Fetches the reads of made tasks, in the order they were made, on a helper thread reserved from the
+ thread budget for the whole run. Made tasks are the calling path's read hints. Prefetching on whatever
+ helper happens to be idle rarely works, as task threads only go idle when they run out of tasks.
+ 
+ A task that is called before the prefetcher reaches it fetches its own reads, so calling never waits
+ behind the prefetch queue.
+ 
+ Prefetched reads that have not been taken by their task are counted against max_footprint. Like
+ BufferedReadPipe with prefetch_hints, the prefetcher stops before the next read set would exceed the
+ remaining footprint, and resumes as tasks take their reads.
+ */
+class ReadPrefetcher
+{
+public:
+    using Reads = Caller::PrefetchedReads;
+    
+    class Request
+    {
+    public:
+        Request(ReadPrefetcher& prefetcher, GenomicRegion region);
+        
+        Request(const Request&)            = delete;
+        Request& operator=(const Request&) = delete;
+        Request(Request&&)                 = delete;
+        Request& operator=(Request&&)      = delete;
+        
+        ~Request() noexcept;
+        
+        // Returns the prefetched reads, or fetches them on the calling thread if the prefetcher has
+        // not started on them
+        Reads get();
+    
+    private:
+        friend class ReadPrefetcher;
+        
+        std::reference_wrapper<ReadPrefetcher> prefetcher_;
+        GenomicRegion region_;
+        std::atomic<bool> claimed_;
+        std::promise<Reads> promise_;
+        std::future<Reads> result_;
+        MemoryFootprint footprint_; // of the prefetched reads until they are taken
+        
+        bool claim() noexcept { return !claimed_.exchange(true); }
+        Reads fetch() const;
+        void release() noexcept;
+    };
+    
+    ReadPrefetcher(const ReadPipe& read_pipe, HelperThreads thread, MemoryFootprint max_footprint);
+    
+    ReadPrefetcher(const ReadPrefetcher&)            = delete;
+    ReadPrefetcher& operator=(const ReadPrefetcher&) = delete;
+    ReadPrefetcher(ReadPrefetcher&&)                 = delete;
+    ReadPrefetcher& operator=(ReadPrefetcher&&)      = delete;
+    
+    ~ReadPrefetcher() noexcept;
+    
+    bool enabled() const noexcept;
+    
+    std::shared_ptr<Request> request(GenomicRegion region);
+    
+private:
+    std::reference_wrapper<const ReadPipe> read_pipe_;
+    HelperThreads thread_;
+    MemoryFootprint max_footprint_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::weak_ptr<Request>> requests_; // dropped requests expire, e.g. if calling is aborted
+    MemoryFootprint prefetched_footprint_ = 0, last_fetch_footprint_ = 0;
+    bool stop_ = false;
+    std::future<void> run_;
+    
+    bool can_prefetch() const noexcept;
+    void release(MemoryFootprint footprint) noexcept;
+    void run();
+};
+
+MemoryFootprint footprint(const ReadMap& reads) noexcept
+{
+    return std::accumulate(std::cbegin(reads), std::cend(reads), MemoryFootprint {0},
+                           [] (auto curr, const auto& p) noexcept { return curr + footprint(p.second); });
+}
+
+ReadPrefetcher::Request::Request(ReadPrefetcher& prefetcher, GenomicRegion region)
+: prefetcher_ {prefetcher}
+, region_ {std::move(region)}
+, claimed_ {false}
+, promise_ {}
+, result_ {promise_.get_future()}
+, footprint_ {0}
+{}
+
+ReadPrefetcher::Request::~Request() noexcept
+{
+    release(); // in case the prefetched reads were never taken
+}
+
+ReadPrefetcher::Reads ReadPrefetcher::Request::get()
+{
+    if (claim()) return fetch();
+    auto result = result_.get();
+    release();
+    return result;
+}
+
+ReadPrefetcher::Reads ReadPrefetcher::Request::fetch() const
+{
+    Reads result {};
+    result.reads = prefetcher_.get().read_pipe_.get().fetch_reads(region_, result.report);
+    return result;
+}
+
+void ReadPrefetcher::Request::release() noexcept
+{
+    if (footprint_.bytes() > 0) {
+        prefetcher_.get().release(footprint_);
+        footprint_ = 0;
+    }
+}
+
+ReadPrefetcher::ReadPrefetcher(const ReadPipe& read_pipe, HelperThreads thread, MemoryFootprint max_footprint)
+: read_pipe_ {read_pipe}
+, thread_ {std::move(thread)}
+, max_footprint_ {max_footprint}
+, mutex_ {}
+, cv_ {}
+, requests_ {}
+, run_ {}
+{
+    if (enabled()) run_ = thread_.push([this] () { run(); });
+}
+
+ReadPrefetcher::~ReadPrefetcher() noexcept
+{
+    if (run_.valid()) {
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            stop_ = true;
+        }
+        cv_.notify_one();
+        run_.wait();
+    }
+}
+
+bool ReadPrefetcher::enabled() const noexcept
+{
+    return !thread_.empty();
+}
+
+std::shared_ptr<ReadPrefetcher::Request> ReadPrefetcher::request(GenomicRegion region)
+{
+    auto result = std::make_shared<Request>(*this, std::move(region));
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        requests_.push_back(result);
+    }
+    cv_.notify_one();
+    return result;
+}
+
+// The next read set is assumed to be about the size of the last one, as consecutive tasks are sized alike.
+// A single read set is always allowed so prefetching cannot stall on a set larger than max_footprint.
+bool ReadPrefetcher::can_prefetch() const noexcept
+{
+    return prefetched_footprint_.bytes() == 0 || prefetched_footprint_ + last_fetch_footprint_ <= max_footprint_;
+}
+
+void ReadPrefetcher::release(const MemoryFootprint footprint) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        prefetched_footprint_ -= footprint;
+    }
+    cv_.notify_one();
+}
+
+void ReadPrefetcher::run()
+{
+    std::unique_lock<std::mutex> lock {mutex_};
+    while (true) {
+        cv_.wait(lock, [this] () { return stop_ || (!requests_.empty() && can_prefetch()); });
+        if (stop_) return;
+        const auto request = requests_.front().lock();
+        requests_.pop_front();
+        if (!request || !request->claim()) continue;
+        lock.unlock();
+        try {
+            auto reads = request->fetch();
+            const auto reads_footprint = footprint(reads.reads);
+            request->footprint_ = reads_footprint;
+            lock.lock();
+            prefetched_footprint_ += reads_footprint;
+            last_fetch_footprint_ = reads_footprint;
+            lock.unlock();
+            request->promise_.set_value(std::move(reads));
+        } catch (...) {
+            request->promise_.set_exception(std::current_exception());
+        }
+        lock.lock();
+    }
+}
+
+struct TaskScheduler
+{
+    WorkStealingThreadPool& pool;
+    GenomeCallingComponents& genome_components;
+    unsigned num_task_threads;
+    ExecutionPolicy execution_policy;
+    // A contig's maker is made when it is first resumed, and destroyed once it is done
+    std::vector<std::unique_ptr<ContigTaskMaker>>& makers;
+    const ContigCallingComponentFactoryMap& calling_components;
+    std::vector<WorkerCallingComponents>& worker_components;
+    TaskSchedulerSyncPacket& sync;
+    WindowConfig window_config;
+    ReadPrefetcher& prefetcher;
+};
+
+using ReadPrefetch = std::shared_ptr<ReadPrefetcher::Request>;
+
+void spawn_make_tasks(TaskScheduler& scheduler, std::size_t maker_idx);
+void spawn_call(TaskScheduler& scheduler, Task task, ReadPrefetch reads);
+
+boost::optional<std::size_t> pop_parked_maker(TaskSchedulerSyncPacket& sync)
+{
+    if (sync.aborted || sync.parked_makers.empty() || sync.num_unfinished_tasks >= sync.max_unfinished_tasks) {
+        return boost::none;
+    }
+    // Prefer the first contig so the writer can flush completed tasks early
+    const auto result = *std::cbegin(sync.parked_makers);
+    sync.parked_makers.erase(std::cbegin(sync.parked_makers));
+    return result;
+}
+
+// Queues the task's reads for prefetching, so they are ready when the task is called.
+// At most one task per task thread holds prefetched reads, and the prefetcher bounds their total bytes.
+ReadPrefetch prefetch_reads(TaskScheduler& scheduler, const ContigTaskMaker& maker, const Task& task)
+{
+    if (!scheduler.prefetcher.enabled()) return nullptr;
+    auto& sync = scheduler.sync;
+    auto read_region = maker.components.caller->read_region(task.region);
+    if (!read_region) return nullptr;
+    if (++sync.num_prefetched_tasks > scheduler.num_task_threads) {
+        --sync.num_prefetched_tasks;
+        return nullptr;
+    }
+    return scheduler.prefetcher.request(std::move(*read_region));
+}
+
+void make_tasks(TaskScheduler& scheduler, const std::size_t maker_idx)
+{
+    static auto debug_log = get_debug_log();
+    auto& sync = scheduler.sync;
+    auto& maker = scheduler.makers[maker_idx];
+    const auto& contig = scheduler.genome_components.contigs()[maker_idx];
+    std::unique_lock<std::mutex> lock {sync.mutex};
+    if (sync.aborted) return;
+    if (sync.num_unfinished_tasks >= sync.max_unfinished_tasks) {
+        sync.parked_makers.insert(maker_idx);
         return;
     }
-    task_maker_thread.detach();
+    // Make just enough tasks to keep idle workers busy, and reserve them so other makers don't overshoot
+    const auto max_tasks = std::min(sync.max_unfinished_tasks - sync.num_unfinished_tasks,
+                                    std::max(scheduler.pool.n_idle(), std::size_t {1}));
+    sync.num_unfinished_tasks += max_tasks;
+    lock.unlock();
+    std::deque<Task> tasks {};
+    std::vector<ReadPrefetch> prefetches {};
+    try {
+        if (!maker) {
+            maker = std::make_unique<ContigTaskMaker>(contig, scheduler.genome_components,
+                                                      scheduler.num_task_threads, scheduler.execution_policy);
+        }
+        tasks = make_tasks(*maker, max_tasks, scheduler.window_config);
+        prefetches.reserve(tasks.size());
+        for (const auto& task : tasks) {
+            prefetches.push_back(prefetch_reads(scheduler, *maker, task));
+        }
+    } catch (const std::exception& e) {
+        log_error(e);
+        lock.lock();
+        if (!sync.error) sync.error = std::current_exception();
+        lock.unlock();
+        sync.cv.notify_all();
+        return;
+    }
+    lock.lock();
+    sync.num_unfinished_tasks -= max_tasks - tasks.size();
+    sync.made_tasks.insert(std::cend(sync.made_tasks), std::cbegin(tasks), std::cend(tasks));
+    const auto done = maker->done();
+    boost::optional<std::size_t> next_maker {};
+    if (done) {
+        if (debug_log) stream(*debug_log) << "Finished making tasks for contig " << contig;
+        --sync.num_unfinished_makers;
+        next_maker = pop_parked_maker(sync);
+    }
+    lock.unlock();
+    if (done) {
+        maker = nullptr;
+        sync.cv.notify_all();
+        if (next_maker) spawn_make_tasks(scheduler, *next_maker);
+    } else {
+        // Spawned before the call tasks so it is stolen by the next idle worker
+        spawn_make_tasks(scheduler, maker_idx);
+    }
+    for (std::size_t i {0}; i < tasks.size(); ++i) {
+        spawn_call(scheduler, std::move(tasks[i]), std::move(prefetches[i]));
+    }
+}
+
+ContigCallingComponents& get_calling_components(TaskScheduler& scheduler, const ContigName& contig)
+{
+    // Each worker reuses its caller for consecutive tasks on the same contig
+    auto& cached = scheduler.worker_components.at(*scheduler.pool.this_worker());
+    if (!cached.components || cached.contig != contig) {
+        cached.components = nullptr;
+        cached.components = std::make_unique<ContigCallingComponents>(scheduler.calling_components.at(contig)());
+        cached.contig = contig;
+    }
+    return *cached.components;
+}
+
+void call(TaskScheduler& scheduler, CompletedTask task, ReadPrefetch prefetch)
+{
+    auto& sync = scheduler.sync;
+    std::exception_ptr error {nullptr};
+    try {
+        auto& components = get_calling_components(scheduler, contig_name(task));
+        task.runtime.start = std::chrono::system_clock::now();
+        boost::optional<Caller::PrefetchedReads> reads {};
+        if (prefetch) {
+            reads = prefetch->get();
+            prefetch = nullptr;
+            --sync.num_prefetched_tasks;
+        }
+        task.calls = components.caller->call(task.region, components.progress_meter, std::move(reads));
+        task.runtime.end = std::chrono::system_clock::now();
+    } catch (const std::exception& e) {
+        logging::ErrorLogger error_log {};
+        stream(error_log) << "Encountered a problem whilst calling " << task << "(" << e.what() << ")";
+        using namespace std::chrono_literals;
+        std::this_thread::sleep_for(2s); // Try to make sure the error is logged before raising
+        error = std::current_exception();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    std::unique_lock<std::mutex> lock {sync.mutex};
+    if (error) {
+        if (!sync.error) sync.error = error;
+    } else {
+        sync.completed_tasks.push_back(std::move(task));
+    }
+    --sync.num_unfinished_tasks;
+    const auto next_maker = pop_parked_maker(sync);
+    lock.unlock();
+    sync.cv.notify_all();
+    if (next_maker) spawn_make_tasks(scheduler, *next_maker);
+}
+
+void spawn_make_tasks(TaskScheduler& scheduler, const std::size_t maker_idx)
+{
+    scheduler.pool.spawn([&scheduler, maker_idx] () {
+        const WorkingThread working {};
+        make_tasks(scheduler, maker_idx);
+    });
+}
+
+void spawn_call(TaskScheduler& scheduler, Task task, ReadPrefetch reads)
+{
+    static auto debug_log = get_debug_log();
+    if (debug_log) stream(*debug_log) << "Spawning task " << task;
+    scheduler.pool.spawn([&scheduler, task = std::move(task), reads = std::move(reads)] () {
+        {
+            std::lock_guard<std::mutex> lock {scheduler.sync.mutex};
+            if (scheduler.sync.aborted) return;
+        }
+        const WorkingThread working {};
+        call(scheduler, CompletedTask {task}, reads);
+    });
+}
+
+bool all_tasks_finished(const TaskSchedulerSyncPacket& sync) noexcept
+{
+    return sync.num_unfinished_makers == 0 && sync.num_unfinished_tasks == 0 && sync.completed_tasks.empty();
+}
+
+void run_octopus_multi_threaded(GenomeCallingComponents& components)
+{
+    static auto debug_log = get_debug_log();
+    
+    auto num_task_threads = calculate_num_task_threads(components);
+    // Give read prefetching a thread of its own when there are enough task threads to spare one
+    HelperThreads prefetch_thread {num_task_threads > 2 ? 1u : 0u};
+    num_task_threads -= prefetch_thread.size();
+    const auto calling_components = make_contig_calling_component_factory_map(components);
     
-    FutureCompletedTasks futures(num_task_threads);
-    TaskMap running_tasks {ContigOrder {components.contigs()}};
+    std::vector<std::unique_ptr<ContigTaskMaker>> task_makers(components.contigs().size());
+    const auto execution_policy = make_execution_policy(components);
+    TaskSchedulerSyncPacket scheduler_sync {};
+    scheduler_sync.num_unfinished_makers = task_makers.size();
+    scheduler_sync.max_unfinished_tasks = 2 * num_task_threads;
+    TaskMap running_tasks {ContigOrder {components.contigs()}}; // made but not yet written, in the order they were made
     CompletedTaskMap buffered_tasks {};
     std::map<ContigName, HoldbackTask> holdbacks {};
     // Populate all the maps first so we can make unchecked accesses
@@ -1152,10 +1375,6 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
         holdbacks.emplace(contig, boost::none);
     }
     
-    CallerSyncPacket caller_sync {};
-    const auto calling_components = make_contig_calling_component_factory_map(components);
-    unsigned num_idle_futures {0};
-    
     auto temp_writers = make_temp_vcf_writers(components);
     TaskWriterSyncPacket task_writer_sync {};
     auto task_writer_thread = make_task_writer_thread(temp_writers, task_writer_sync);
@@ -1166,75 +1385,63 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     }
     task_writer_thread.detach();
     
-    // Wait for the first task to be made
-    const auto tasks_available = [&] () noexcept { return task_maker_sync.num_tasks > 0; };
-    while(task_maker_sync.num_tasks == 0) {
-        pending_task_lock.lock();
-        task_maker_sync.cv.wait(pending_task_lock, tasks_available);
-        pending_task_lock.unlock();
-    }
-    task_maker_sync.batch_size_hint = num_task_threads / 2;
-    
+    std::vector<WorkerCallingComponents> worker_components(num_task_threads);
     components.progress_meter().start();
-    
-    while (!task_maker_sync.all_done || task_maker_sync.num_tasks > 0) {
-        pending_task_lock.lock();
-        assert(count_tasks(pending_tasks) == task_maker_sync.num_tasks);
-        if (!task_maker_sync.all_done && task_maker_sync.num_tasks == 0) {
-            task_maker_sync.batch_size_hint = std::max(num_idle_futures, num_task_threads / 2);
-            if (num_idle_futures < futures.size()) {
-                // If there are running futures then it's good periodically check to see if
-                // any have finished and process them while we wait for the task maker.
-                while (task_maker_sync.num_tasks == 0 && caller_sync.num_finished == 0) {
-                    auto now = std::chrono::system_clock::now();
-                    task_maker_sync.cv.wait_until(pending_task_lock, now + 5s, tasks_available);
-                }
-            } else {
-                task_maker_sync.cv.wait(pending_task_lock, tasks_available);
-            }
+    {
+        // This thread just waits, so lends its share of the thread budget. Task threads only take a share
+        // while they have work, so idle task threads can be leased for nested parallelism.
+        const WaitingThread waiting {};
+        ReadPrefetcher prefetcher {components.read_pipe(), std::move(prefetch_thread), components.read_buffer_footprint()};
+        // The pool must be destroyed (i.e. joined) before anything its tasks reference
+        WorkStealingThreadPool pool {num_task_threads};
+        TaskScheduler scheduler {pool, components, num_task_threads, execution_policy, task_makers,
+                                 calling_components, worker_components, scheduler_sync, default_window_config,
+                                 prefetcher};
+        std::unique_lock<std::mutex> lock {scheduler_sync.mutex};
+        // Start with the first contig; makers for later contigs are resumed as tasks finish
+        for (std::size_t maker_idx {1}; maker_idx < task_makers.size(); ++maker_idx) {
+            scheduler_sync.parked_makers.insert(maker_idx);
         }
-        pending_task_lock.unlock();
-        num_idle_futures = 0;
-        for (auto& future : futures) {
-            if (is_ready(future)) {
-                auto completed_task = future.get();
+        if (!task_makers.empty()) spawn_make_tasks(scheduler, 0);
+        std::deque<CompletedTask> completed_tasks {};
+        while (true) {
+            scheduler_sync.cv.wait(lock, [&] () {
+                return !scheduler_sync.completed_tasks.empty() || scheduler_sync.error || all_tasks_finished(scheduler_sync);
+            });
+            if (scheduler_sync.error) {
+                scheduler_sync.aborted = true;
+                pool.clear();
+                break;
+            }
+            if (all_tasks_finished(scheduler_sync)) break;
+            std::swap(scheduler_sync.completed_tasks, completed_tasks);
+            // Every completed task was made before it completed, so is now in running_tasks
+            for (auto& task : scheduler_sync.made_tasks) {
+                running_tasks.at(contig_name(task)).push(std::move(task));
+            }
+            scheduler_sync.made_tasks.clear();
+            // Writing may resolve connecting calls, which can be slow, so don't block the task threads
+            lock.unlock();
+            for (auto& completed_task : completed_tasks) {
                 const auto& contig = contig_name(completed_task.region);
                 write_or_buffer(std::move(completed_task), buffered_tasks.at(contig),
                                 running_tasks.at(contig), holdbacks.at(contig),
                                 task_writer_sync, calling_components.at(contig));
-                --caller_sync.num_finished;
-            }
-            if (!future.valid()) {
-                pending_task_lock.lock();
-                if (task_maker_sync.num_tasks > 0) {
-                    pending_task_lock.unlock(); // As pop will need to lock the mutex too == deadlock
-                    auto task = pop(pending_tasks, task_maker_sync);
-                    future = run(task, calling_components.at(contig_name(task))(), caller_sync);
-                    running_tasks.at(contig_name(task)).push(std::move(task));
-                } else {
-                    pending_task_lock.unlock();
-                    ++num_idle_futures;
-                }
             }
+            completed_tasks.clear();
+            lock.lock();
         }
-        // If there are no idle futures then all threads are busy and we must wait for one to finish,
-        // otherwise we must have run out of tasks, so we should wait for new ones.
-        if (num_idle_futures == 0 && caller_sync.num_finished == 0) {
-            task_maker_sync.waiting = false;
-            std::unique_lock<std::mutex> lock {caller_sync.mutex};
-            caller_sync.cv.wait(lock, [&] () { return caller_sync.num_finished > 0; });
-            task_maker_sync.waiting = true;
-        } else {
-            if (debug_log) stream(*debug_log) << "There are " << num_idle_futures << " idle futures";
-        }
     }
-    assert(task_maker_sync.num_tasks == 0);
-    assert(pending_tasks.empty());
+    worker_components.clear();
+    if (scheduler_sync.error) {
+        std::rethrow_exception(scheduler_sync.error);
+    }
+    assert(scheduler_sync.parked_makers.empty());
     running_tasks.clear();
     holdbacks.clear(); // holdbacks are just references to buffered tasks
     if (debug_log) *debug_log << "Finished making new tasks. Waiting for task writer to complete existing jobs";
     wait_until_finished(task_writer_sync);
-    write_remaining_tasks(futures, buffered_tasks, temp_writers, calling_components);
+    write_remaining_tasks(buffered_tasks, temp_writers, calling_components);
     components.progress_meter().stop();
     merge(std::move(temp_writers), components);
 }
@@ -1344,6 +1551,7 @@ void run_csr(GenomeCallingComponents& components)
         BufferedReadPipe::Config buffer_config {components.read_buffer_size()};
         buffer_config.fetch_expansion = 100;
         buffer_config.max_hint_gap = 5'000;
+        buffer_config.prefetch_hints = true;
         BufferedReadPipe buffered_rp {filter_read_pipe, buffer_config};
         if (use_unfiltered_call_region_hints_for_filtering(components)) {
             buffered_rp.hint(extract_call_regions(*input_path));
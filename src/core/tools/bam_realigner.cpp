@@ -50,7 +50,8 @@ unsigned get_pool_size(const BAMRealigner::Config& config)
 
 BAMRealigner::BAMRealigner(Config config)
 : config_ {std::move(config)}
-, workers_ {get_pool_size(config_)}
+, helpers_ {num_helpers_for_pool(get_pool_size(config_))}
+, workers_ {helpers_.empty() ? 0 : helpers_.size() + 1}
 {}
 
 namespace {
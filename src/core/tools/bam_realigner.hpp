@@ -20,6 +20,7 @@
 #include "io/variant/vcf_reader.hpp"
 #include "utils/memory_footprint.hpp"
 #include "utils/thread_pool.hpp"
+#include "utils/executor.hpp"
 
 namespace octopus {
 
@@ -75,6 +76,7 @@ private:
     using BatchListRegionPair = std::pair<BatchList, boost::optional<GenomicRegion>>;
     
     Config config_;
+    HelperThreads helpers_; // the pool threads' share of the thread budget
     mutable ThreadPool workers_;
     
     CallBlock read_next_block(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const;
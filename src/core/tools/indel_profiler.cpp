@@ -46,13 +46,15 @@ unsigned get_pool_size(const IndelProfiler::PerformanceConfig& config)
 IndelProfiler::IndelProfiler(ProfileConfig config)
 : config_ {std::move(config)}
 , performance_config_ {}
-, workers_ {get_pool_size(performance_config_)}
+, helpers_ {num_helpers_for_pool(get_pool_size(performance_config_))}
+, workers_ {helpers_.empty() ? 0 : helpers_.size() + 1}
 {}
 
 IndelProfiler::IndelProfiler(ProfileConfig config, PerformanceConfig performance_config)
 : config_ {std::move(config)}
 , performance_config_ {}
-, workers_ {get_pool_size(performance_config_)}
+, helpers_ {num_helpers_for_pool(get_pool_size(performance_config_))}
+, workers_ {helpers_.empty() ? 0 : helpers_.size() + 1}
 {}
 
 IndelProfiler::IndelProfile
@@ -25,6 +25,7 @@
 #include "readpipe/read_pipe.hpp"
 #include "readpipe/buffered_read_pipe.hpp"
 #include "utils/thread_pool.hpp"
+#include "utils/executor.hpp"
 #include "read_assigner.hpp"
 
 namespace octopus {
@@ -85,6 +86,7 @@ private:
     
     ProfileConfig config_;
     PerformanceConfig performance_config_;
+    HelperThreads helpers_; // the pool threads' share of the thread budget
     mutable ThreadPool workers_;
     
     void check_samples(const SampleList& samples, const VcfReader& variants) const;
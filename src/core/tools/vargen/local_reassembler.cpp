@@ -7,8 +7,11 @@
 #include <iterator>
 #include <deque>
 #include <stdexcept>
-#include <thread>
-#include <future>
+#include <numeric>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 #include <cassert>
 
 #include "tandem/tandem.hpp"
@@ -23,6 +26,7 @@
 #include "utils/global_aligner.hpp"
 #include "utils/read_stats.hpp"
 #include "utils/free_memory.hpp"
+#include "utils/executor.hpp"
 #include "io/reference/reference_genome.hpp"
 #include "logging/logging.hpp"
 
@@ -65,6 +69,8 @@ LocalReassembler::LocalReassembler(const ReferenceGenome& reference, Options opt
 , min_bubble_score_ {options.min_bubble_score}
 , max_variant_size_ {options.max_variant_size}
 , cycle_tolerance_ {options.cycle_tolerance}
+, assembler_backend_ {options.assembler_backend}
+, max_helpers_ {options.max_helpers}
 {
     if (max_bin_size_ == 0) {
         throw std::runtime_error {"bin size must be greater than zero"};
@@ -349,46 +355,83 @@ std::vector<Variant> LocalReassembler::do_generate(const RegionSet& regions) con
     finalise_bins(bins, regions);
     if (bins.empty()) return {};
     std::deque<Variant> candidates {};
-    if (execution_policy_ == ExecutionPolicy::seq || bins.size() < 2) {
+    if (execution_policy_ == ExecutionPolicy::seq || (max_helpers_ && *max_helpers_ == 0) || bins.size() < 2) {
         for (auto& bin : bins) {
-            if (debug_log_) {
-                stream(*debug_log_) << "Assembling " << bin.size() << " reads in bin " << mapped_region(bin);
-            }
-            const auto num_default_failures = try_assemble_with_defaults(bin, candidates);
-            if (num_default_failures == default_kmer_sizes_.size()) {
-                try_assemble_with_fallbacks(bin, candidates);
-            }
-            bin.clear();
+            assemble(bin, candidates);
         }
     } else {
-        const std::size_t num_threads {4};
-        std::vector<std::future<std::deque<Variant>>> bin_futures(std::min(bins.size(), num_threads));
-        for (auto first_bin = std::begin(bins), last_bin = std::end(bins); first_bin != last_bin; ) {
-            const auto batch_size = std::min(num_threads, static_cast<std::size_t>(std::distance(first_bin, last_bin)));
-            const auto next_bin = std::next(first_bin, batch_size);
-            auto last_future = std::transform(first_bin, next_bin, std::begin(bin_futures), [&] (Bin& bin) {
-                if (debug_log_) {
-                    stream(*debug_log_) << "Assembling " << bin.size() << " reads in bin " << mapped_region(bin);
-                }
-                return std::async([&] () {
-                    std::deque<Variant> result {};
-                    const auto num_default_failures = try_assemble_with_defaults(bin, result);
-                    if (num_default_failures == default_kmer_sizes_.size()) {
-                        try_assemble_with_fallbacks(bin, result);
-                    }
-                    bin.clear();
-                    return result;
-                });
-            });
-            std::for_each(std::begin(bin_futures), last_future, [&] (auto& f) { utils::append(f.get(), candidates); });
-            first_bin = next_bin;
-        }
+        assemble_in_parallel(bins, candidates);
     }
     remove_duplicates(candidates);
     remove_larger_than(candidates, max_variant_size_);
     return {std::make_move_iterator(std::begin(candidates)), std::make_move_iterator(std::end(candidates))};
 }
 
+void LocalReassembler::assemble(Bin& bin, std::deque<Variant>& result) const
+{
+    if (debug_log_) {
+        stream(*debug_log_) << "Assembling " << bin.size() << " reads in bin " << mapped_region(bin);
+    }
+    const auto num_default_failures = try_assemble_with_defaults(bin, result);
+    if (num_default_failures == default_kmer_sizes_.size()) {
+        try_assemble_with_fallbacks(bin, result);
+    }
+    bin.clear();
+}
+
+void LocalReassembler::assemble_in_parallel(BinList& bins, std::deque<Variant>& result) const
+{
+    // Bins are claimed one at a time, largest first, by the calling thread and by pool tasks, so a
+    // slow bin only occupies one thread. Pool tasks that start after all bins are claimed only
+    // touch the shared state, so the calling thread just waits for the claimed bins to finish.
+    struct SharedState
+    {
+        std::size_t num_bins;
+        std::atomic<std::size_t> next_bin {0}, num_finished {0};
+        std::mutex mutex;
+        std::condition_variable all_finished;
+        std::exception_ptr error = nullptr;
+    };
+    auto state = std::make_shared<SharedState>();
+    state->num_bins = bins.size();
+    std::vector<std::size_t> schedule(bins.size());
+    std::iota(std::begin(schedule), std::end(schedule), 0);
+    std::stable_sort(std::begin(schedule), std::end(schedule),
+                     [&] (auto lhs, auto rhs) { return bins[lhs].size() > bins[rhs].size(); });
+    std::vector<std::deque<Variant>> bin_results(bins.size());
+    const auto assemble_remaining = [this, state, &bins, &schedule, &bin_results] () {
+        for (auto i = state->next_bin++; i < state->num_bins; i = state->next_bin++) {
+            const auto bin_idx = schedule[i];
+            try {
+                assemble(bins[bin_idx], bin_results[bin_idx]);
+            } catch (...) {
+                std::lock_guard<std::mutex> lk {state->mutex};
+                if (!state->error) state->error = std::current_exception();
+            }
+            if (++state->num_finished == state->num_bins) {
+                std::lock_guard<std::mutex> lk {state->mutex};
+                state->all_finished.notify_all();
+            }
+        }
+    };
+    // The thread budget, and max_helpers (--assembler-threads) if set, bound how many bins are assembled at once
+    const auto max_helpers = bins.size() - 1;
+    const HelperThreads helpers {max_helpers_ ? std::min(max_helpers, std::size_t {*max_helpers_}) : max_helpers};
+    const auto num_tasks = helpers.size();
+    for (std::size_t task {0}; task < num_tasks; ++task) {
+        helpers.push(assemble_remaining);
+    }
+    assemble_remaining();
+    {
+        std::unique_lock<std::mutex> lk {state->mutex};
+        state->all_finished.wait(lk, [&] () { return state->num_finished == state->num_bins; });
+        if (state->error) std::rethrow_exception(state->error);
+    }
+    for (auto& bin_result : bin_results) {
+        utils::append(std::move(bin_result), result);
+    }
+}
+
 void LocalReassembler::do_clear() noexcept
 {
     free_memory(read_buffer_);
@@ -573,7 +616,7 @@ LocalReassembler::assemble_bin(const unsigned kmer_size, const Bin& bin, std::de
     if (size(assemble_region) < kmer_size) return AssemblerStatus::failed;
     const auto reference_sequence = reference_.get().fetch_sequence(assemble_region);
     if (!utils::is_canonical_dna(reference_sequence)) return AssemblerStatus::failed;
-    Assembler assembler {{kmer_size, 0.01}, reference_sequence};
+    Assembler assembler {{kmer_size, 0.01, assembler_backend_}, reference_sequence};
     if (assembler.is_unique_reference()) {
         load(bin, assembler);
         return try_assemble_region(assembler, reference_sequence, assemble_region, result);
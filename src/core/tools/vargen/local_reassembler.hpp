@@ -49,6 +49,10 @@ public:
         BubbleScoreSetter min_bubble_score            = [] (const GenomicRegion&, const ReadBaseCountMap&) { return 2.0; };
         Variant::MappingDomain::Size max_variant_size = 5000;
         CyclicGraphTolerance cycle_tolerance          = CyclicGraphTolerance::high;
+        Assembler::Backend assembler_backend          = Assembler::Backend::compact;
+        // When the execution policy is par, bins are also assembled on up to this many helper
+        // threads leased from the thread budget (or as many as the budget allows if none)
+        boost::optional<unsigned> max_helpers         = boost::none;
     };
     
     LocalReassembler() = delete;
@@ -126,12 +130,16 @@ private:
     BubbleScoreSetter min_bubble_score_;
     Variant::MappingDomain::Size max_variant_size_;
     Options::CyclicGraphTolerance cycle_tolerance_;
+    Assembler::Backend assembler_backend_;
+    boost::optional<unsigned> max_helpers_;
     
     void prepare_bins(const GenomicRegion& active_region, BinList& bins) const;
     bool should_assemble_bin(const Bin& bin) const;
     void finalise_bins(BinList& bins, const RegionSet& active_regions) const;
     unsigned try_assemble_with_defaults(const Bin& bin, std::deque<Variant>& result) const;
     void try_assemble_with_fallbacks(const Bin& bin, std::deque<Variant>& result) const;
+    void assemble(Bin& bin, std::deque<Variant>& result) const;
+    void assemble_in_parallel(BinList& bins, std::deque<Variant>& result) const;
     GenomicRegion propose_assembler_region(const GenomicRegion& input_region, unsigned kmer_size) const;
     void load(const Bin& bin, Assembler& assembler) const;
     AssemblerStatus assemble_bin(unsigned kmer_size, const Bin& bin, std::deque<Variant>& result) const;
@@ -51,6 +51,233 @@ std::size_t count_kmers(const T& sequence, const unsigned kmer_size) noexcept
 
 } // namespace
 
+class Assembler::Impl
+{
+public:
+    virtual ~Impl() = default;
+    
+    virtual void insert_reference(const NucleotideSequence& sequence) = 0;
+    virtual void insert_read(const NucleotideSequence& sequence, const BaseQualityVector& base_qualities, Direction strand) = 0;
+    virtual std::size_t num_kmers() const noexcept = 0;
+    virtual bool is_empty() const noexcept = 0;
+    virtual bool is_acyclic() const = 0;
+    virtual void remove_nonreference_cycles(bool break_chains) = 0;
+    virtual bool is_all_reference() const = 0;
+    virtual bool is_unique_reference() const = 0;
+    virtual void try_recover_dangling_branches() = 0;
+    virtual void prune(unsigned min_weight) = 0;
+    virtual void cleanup() = 0;
+    virtual void clear() = 0;
+    virtual std::deque<Variant> extract_variants(unsigned max_bubbles, double min_bubble_score) = 0;
+    virtual void write_dot(std::ostream& out) const = 0;
+};
+
+// Implements the assembler for any BGL bidirectional graph type with bundled GraphNode and GraphEdge properties
+template <typename KmerGraph>
+class Assembler::GraphAssembler : public Assembler::Impl
+{
+public:
+    GraphAssembler() = delete;
+    
+    GraphAssembler(Parameters params);
+    GraphAssembler(Parameters params, const NucleotideSequence& reference);
+    
+    GraphAssembler(const GraphAssembler&)            = delete;
+    GraphAssembler& operator=(const GraphAssembler&) = delete;
+    
+    ~GraphAssembler() override = default;
+    
+    void insert_reference(const NucleotideSequence& sequence) override;
+    void insert_read(const NucleotideSequence& sequence, const BaseQualityVector& base_qualities, Direction strand) override;
+    std::size_t num_kmers() const noexcept override;
+    bool is_empty() const noexcept override;
+    bool is_acyclic() const override;
+    void remove_nonreference_cycles(bool break_chains) override;
+    bool is_all_reference() const override;
+    bool is_unique_reference() const override;
+    void try_recover_dangling_branches() override;
+    void prune(unsigned min_weight) override;
+    void cleanup() override;
+    void clear() override;
+    std::deque<Variant> extract_variants(unsigned max_bubbles, double min_bubble_score) override;
+    void write_dot(std::ostream& out) const override;
+    
+private:
+    using Vertex = typename boost::graph_traits<KmerGraph>::vertex_descriptor;
+    using Edge   = typename boost::graph_traits<KmerGraph>::edge_descriptor;
+    
+    using VertexIterator = typename boost::graph_traits<KmerGraph>::vertex_iterator;
+    using EdgeIterator   = typename boost::graph_traits<KmerGraph>::edge_iterator;
+    
+    using DominatorMap = std::unordered_map<Vertex, Vertex>;
+    
+    using Path = std::deque<Vertex>;
+    using EdgePath = std::vector<Edge>;
+    using PredecessorMap = std::unordered_map<Vertex, Vertex>;
+    
+    struct SubGraph
+    {
+        Vertex head, tail;
+        std::size_t reference_offset;
+    };
+    
+    using PathWeightDistribution = std::vector<float>;
+    
+    struct PathWeightStats
+    {
+        PathWeightDistribution distribution;
+        unsigned total, total_forward, total_reverse, min, max;
+        double mean, median, stdev;
+    };
+    
+    Parameters params_;
+    
+    unsigned kmer_size() const noexcept;
+    
+    std::deque<Kmer> reference_kmers_;
+    std::size_t reference_head_position_;
+    
+    KmerGraph graph_;
+    
+    std::unordered_map<Kmer, Vertex, KmerHash> vertex_cache_;
+    Path reference_vertices_;
+    std::deque<Edge> reference_edges_;
+    
+    // methods
+    
+    void insert_reference_into_empty_graph(const NucleotideSequence& reference);
+    void insert_reference_into_populated_graph(const NucleotideSequence& reference);
+    bool contains_kmer(const Kmer& kmer) const noexcept;
+    std::size_t count_kmer(const Kmer& kmer) const noexcept;
+    std::size_t reference_size() const noexcept;
+    void regenerate_vertex_indices();
+    bool is_reference_unique_path() const;
+    Vertex null_vertex() const;
+    boost::optional<Vertex> add_vertex(const Kmer& kmer, bool is_reference = false);
+    void remove_vertex(Vertex v);
+    void clear_and_remove_vertex(Vertex v);
+    void clear_and_remove_all(const std::unordered_set<Vertex>& vertices);
+    Edge add_edge(Vertex u, Vertex v,
+                  GraphEdge::WeightType weight, GraphEdge::WeightType forward_weight,
+                  int base_quality_sum,
+                  bool is_reference = false, bool is_artificial = false);
+    Edge add_reference_edge(Vertex u, Vertex v);
+    void remove_edge(Vertex u, Vertex v);
+    void remove_edge(Edge e);
+    void increment_weight(Edge e, bool is_forward, int base_quality);
+    void set_vertex_reference(Vertex v);
+    void set_vertex_reference(const Kmer& kmer);
+    void set_edge_reference(Edge e);
+    const Kmer& kmer_of(Vertex v) const;
+    char front_base_of(Vertex v) const;
+    char back_base_of(Vertex v) const;
+    const Kmer& source_kmer_of(Edge e) const;
+    const Kmer& target_kmer_of(Edge e) const;
+    bool is_reference(Vertex v) const;
+    bool is_source_reference(Edge e) const;
+    bool is_target_reference(Edge e) const;
+    bool is_reference(Edge e) const;
+    bool is_artificial(Edge e) const;
+    bool is_reference_empty() const noexcept;
+    Vertex reference_head() const;
+    Vertex reference_tail() const;
+    Vertex next_reference(Vertex u) const;
+    Vertex prev_reference(Vertex v) const;
+    bool is_dangling_branch(Vertex v) const;
+    boost::optional<Vertex> find_joining_kmer(Vertex v) const;
+    std::size_t num_reference_kmers() const;
+    NucleotideSequence make_sequence(const Path& path) const;
+    NucleotideSequence make_reference(Vertex from, Vertex to) const;
+    void remove_path(const Path& path);
+    bool is_bridge(Vertex v) const;
+    bool is_reference_bridge(Vertex v) const;
+    typename Path::const_iterator is_bridge_until(typename Path::const_iterator first, typename Path::const_iterator last) const;
+    typename Path::const_iterator is_bridge_until(const Path& path) const;
+    bool is_bridge(typename Path::const_iterator first, typename Path::const_iterator last) const;
+    bool is_bridge(const Path& path) const;
+    std::pair<bool, Vertex> is_bridge_to_reference(Vertex from) const;
+    bool joins_reference_only(Vertex v) const;
+    bool joins_reference_only(typename Path::const_iterator first, typename Path::const_iterator last) const;
+    bool is_trivial_cycle(Edge e) const;
+    bool graph_has_trivial_cycle() const;
+    bool graph_has_nontrivial_cycle() const;
+    void remove_trivial_nonreference_cycles();
+    void remove_nontrivial_nonreference_cycles();
+    void remove_all_nonreference_cycles(bool break_chains);
+    bool is_simple_deletion(Edge e) const;
+    bool is_on_path(Edge e, const Path& path) const;
+    bool connects_to_path(Edge e, const Path& path) const;
+    bool is_dependent_on_path(Edge e, const Path& path) const;
+    GraphEdge::WeightType weight(const Path& path) const;
+    GraphEdge::WeightType max_weight(const Path& path) const;
+    unsigned count_low_weights(const Path& path, unsigned low_weight) const;
+    bool has_low_weight_flanks(const Path& path, unsigned low_weight) const;
+    unsigned count_low_weight_flanks(const Path& path, unsigned low_weight) const;
+    PathWeightStats compute_weight_stats(const Path& path) const;
+    GraphEdge::WeightType sum_source_in_edge_weight(Edge e) const;
+    GraphEdge::WeightType sum_target_out_edge_weight(Edge e) const;
+    bool all_in_edges_low_weight(Vertex v, unsigned min_weight) const;
+    bool all_out_edges_low_weight(Vertex v, unsigned min_weight) const;
+    std::size_t low_weight_out_degree(Vertex v, unsigned min_weight) const;
+    std::size_t low_weight_in_degree(Vertex v, unsigned min_weight) const;
+    bool is_low_weight_source(Vertex v, unsigned min_weight) const;
+    bool is_low_weight_sink(Vertex v, unsigned min_weight) const;
+    bool is_low_weight(Vertex v, unsigned min_weight) const;
+    void remove_low_weight_edges(unsigned min_weight);
+    void remove_disconnected_vertices();
+    std::unordered_set<Vertex> find_reachable_kmers(Vertex from) const;
+    std::deque<Vertex> remove_vertices_that_cant_be_reached_from(Vertex v);
+    void remove_vertices_that_cant_reach(Vertex v);
+    void remove_vertices_past(Vertex v);
+    bool can_prune_reference_flanks() const;
+    void pop_reference_head();
+    void pop_reference_tail();
+    void prune_reference_flanks();
+    std::pair<Vertex, unsigned> find_bifurcation(Vertex from, Vertex to) const;
+    DominatorMap build_dominator_tree(Vertex from) const;
+    std::unordered_set<Vertex> extract_nondominants(Vertex from) const;
+    std::deque<Vertex> extract_nondominant_reference(const DominatorMap&) const;
+    void set_out_edge_transition_scores(Vertex v);
+    void set_all_edge_transition_scores_from(Vertex src);
+    void set_all_in_edge_transition_scores(Vertex v, GraphEdge::ScoreType score);
+    void block_all_in_edges(Vertex v);
+    PredecessorMap find_shortest_scoring_paths(Vertex from, bool use_weights = false) const;
+    bool is_on_path(Vertex v, const PredecessorMap& predecessors, Vertex from) const;
+    bool is_on_path(Edge e, const PredecessorMap& predecessors, Vertex from) const;
+    Path extract_full_path(const PredecessorMap& predecessors, Vertex from) const;
+    std::tuple<Vertex, Vertex, unsigned>
+    backtrack_until_nonreference(const PredecessorMap& predecessors, Vertex from) const;
+    Path extract_nonreference_path(const PredecessorMap& predecessors, Vertex from) const;
+    std::vector<EdgePath> extract_k_shortest_paths(Vertex src, Vertex dst, unsigned k) const;
+    Edge head_edge(const Path& path) const;
+    int head_mean_base_quality(const Path& path) const;
+    int tail_mean_base_quality(const Path& path) const;
+    double bubble_score(const Path& path) const;
+    std::deque<Variant> extract_bubble_paths(unsigned max_bubbles, double min_bubble_score);
+    std::deque<SubGraph> find_independent_subgraphs() const;
+    std::deque<Variant> extract_bubble_paths_with_ksp(unsigned k, double min_bubble_score);
+    
+    // for debug
+    
+    void print_reference_head() const;
+    void print_reference_tail() const;
+    void print_reference_path() const;
+    void print(Edge e) const;
+    void print(const Path& path) const;
+    void print_verbose(const Path& path) const;
+    void print_dominator_tree() const;
+};
+
+template <typename... Args>
+std::unique_ptr<Assembler::Impl> Assembler::make_impl(const Parameters params, const Args&... args)
+{
+    switch (params.backend) {
+        case Backend::adjacency_list: return std::make_unique<GraphAssembler<AdjacencyListKmerGraph>>(params, args...);
+        case Backend::compact:
+        default: return std::make_unique<GraphAssembler<CompactKmerGraph>>(params, args...);
+    }
+}
+
 // public methods
 
 Assembler::NonCanonicalReferenceSequence::NonCanonicalReferenceSequence(NucleotideSequence reference_sequence)
@@ -65,19 +292,19 @@ const char* Assembler::NonCanonicalReferenceSequence::what() const noexcept
 
 Assembler::Assembler(const Parameters params)
 : params_ {params}
-, reference_kmers_ {}
-, reference_head_position_ {0}
-, reference_vertices_ {}
+, impl_ {make_impl(params)}
 {}
 
 Assembler::Assembler(const Parameters params, const NucleotideSequence& reference)
 : params_ {params}
-, reference_kmers_ {}
-, reference_head_position_ {0}
-, reference_vertices_ {}
-{
-    insert_reference_into_empty_graph(reference);
-}
+, impl_ {make_impl(params, reference)}
+{}
+
+Assembler::Assembler(Assembler&&) = default;
+
+Assembler& Assembler::operator=(Assembler&&) = default;
+
+Assembler::~Assembler() = default;
 
 unsigned Assembler::kmer_size() const noexcept
 {
@@ -90,6 +317,103 @@ Assembler::Parameters Assembler::params() const
 }
 
 void Assembler::insert_reference(const NucleotideSequence& sequence)
+{
+    impl_->insert_reference(sequence);
+}
+
+void Assembler::insert_read(const NucleotideSequence& sequence,
+                            const BaseQualityVector& base_qualities,
+                            const Direction strand)
+{
+    impl_->insert_read(sequence, base_qualities, strand);
+}
+
+std::size_t Assembler::num_kmers() const noexcept
+{
+    return impl_->num_kmers();
+}
+
+bool Assembler::is_empty() const noexcept
+{
+    return impl_->is_empty();
+}
+
+bool Assembler::is_acyclic() const
+{
+    return impl_->is_acyclic();
+}
+
+void Assembler::remove_nonreference_cycles(bool break_chains)
+{
+    impl_->remove_nonreference_cycles(break_chains);
+}
+
+bool Assembler::is_all_reference() const
+{
+    return impl_->is_all_reference();
+}
+
+bool Assembler::is_unique_reference() const
+{
+    return impl_->is_unique_reference();
+}
+
+void Assembler::try_recover_dangling_branches()
+{
+    impl_->try_recover_dangling_branches();
+}
+
+void Assembler::prune(const unsigned min_weight)
+{
+    impl_->prune(min_weight);
+}
+
+void Assembler::cleanup()
+{
+    impl_->cleanup();
+}
+
+void Assembler::clear()
+{
+    impl_->clear();
+}
+
+std::deque<Assembler::Variant>
+Assembler::extract_variants(const unsigned max_bubbles, const double min_bubble_score)
+{
+    return impl_->extract_variants(max_bubbles, min_bubble_score);
+}
+
+void Assembler::write_dot(std::ostream& out) const
+{
+    impl_->write_dot(out);
+}
+
+// GraphAssembler public methods
+
+template <typename KmerGraph>
+Assembler::GraphAssembler<KmerGraph>::GraphAssembler(const Parameters params)
+: params_ {params}
+, reference_kmers_ {}
+, reference_head_position_ {0}
+, reference_vertices_ {}
+{}
+
+template <typename KmerGraph>
+Assembler::GraphAssembler<KmerGraph>::GraphAssembler(const Parameters params, const NucleotideSequence& reference)
+: GraphAssembler {params}
+{
+    insert_reference_into_empty_graph(reference);
+}
+
+template <typename KmerGraph>
+unsigned Assembler::GraphAssembler<KmerGraph>::kmer_size() const noexcept
+{
+    return params_.kmer_size;
+}
+
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::insert_reference(const NucleotideSequence& sequence)
 {
     if (sequence.size() >= kmer_size()) {
         if (is_empty()) {
@@ -104,9 +428,10 @@ void Assembler::insert_reference(const NucleotideSequence& sequence)
     }
 }
 
-void Assembler::insert_read(const NucleotideSequence& sequence,
-                            const BaseQualityVector& base_qualities,
-                            const Direction strand)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::insert_read(const NucleotideSequence& sequence,
+                                                       const BaseQualityVector& base_qualities,
+                                                       const Direction strand)
 {
     if (sequence.size() >= kmer_size()) {
         const bool is_forward_strand {strand == Direction::forward};
@@ -168,7 +493,7 @@ void Assembler::insert_read(const NucleotideSequence& sequence,
                     const auto u = vertex_cache_.at(prev_kmer);
                     const auto v = kmer_itr->second;
                     Edge e; bool e_in_graph;
-                    std::tie(e, e_in_graph) = boost::edge(u, v, graph_);
+                    std::tie(e, e_in_graph) = edge(u, v, graph_);
                     if (e_in_graph) {
                         increment_weight(e, is_forward_strand, *base_quality_itr);
                     } else {
@@ -209,40 +534,47 @@ void Assembler::insert_read(const NucleotideSequence& sequence,
     }
 }
 
-std::size_t Assembler::num_kmers() const noexcept
+template <typename KmerGraph>
+std::size_t Assembler::GraphAssembler<KmerGraph>::num_kmers() const noexcept
 {
     return vertex_cache_.size();
 }
 
-bool Assembler::is_empty() const noexcept
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_empty() const noexcept
 {
     return vertex_cache_.empty();
 }
 
-bool Assembler::is_acyclic() const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_acyclic() const
 {
     return !(graph_has_trivial_cycle() || graph_has_nontrivial_cycle());
 }
 
-void Assembler::remove_nonreference_cycles(bool break_chains)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_nonreference_cycles(bool break_chains)
 {
     remove_all_nonreference_cycles(break_chains);
 }
 
-bool Assembler::is_all_reference() const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_all_reference() const
 {
-    const auto p = boost::edges(graph_);
+    const auto p = edges(graph_);
     return std::all_of(p.first, p.second, [this] (const Edge& e) { return is_reference(e); });
 }
 
-bool Assembler::is_unique_reference() const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_unique_reference() const
 {
     return is_reference_unique_path();
 }
 
-void Assembler::try_recover_dangling_branches()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::try_recover_dangling_branches()
 {
-    const auto p = boost::vertices(graph_);
+    const auto p = vertices(graph_);
     std::for_each(p.first, p.second, [this] (const Vertex& v) {
         if (is_dangling_branch(v)) {
             const auto joining_kmer = find_joining_kmer(v);
@@ -253,21 +585,23 @@ void Assembler::try_recover_dangling_branches()
     });
 }
 
-void Assembler::prune(const unsigned min_weight)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::prune(const unsigned min_weight)
 {
     remove_low_weight_edges(min_weight);
 }
 
-void Assembler::cleanup()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::cleanup()
 {
     if (!is_reference_unique_path()) {
         throw NonUniqueReferenceSequence {};
     }
-    auto old_size = boost::num_vertices(graph_);
+    auto old_size = num_vertices(graph_);
     if (old_size < 2) return;
     assert(is_reference_unique_path());
     remove_disconnected_vertices();
-    auto new_size = boost::num_vertices(graph_);
+    auto new_size = num_vertices(graph_);
     if (new_size != old_size) {
         regenerate_vertex_indices();
         if (new_size < 2) return;
@@ -275,7 +609,7 @@ void Assembler::cleanup()
     }
     assert(is_reference_unique_path());
     remove_vertices_that_cant_be_reached_from(reference_head());
-    new_size = boost::num_vertices(graph_);
+    new_size = num_vertices(graph_);
     if (new_size != old_size) {
         regenerate_vertex_indices();
         if (new_size < 2) return;
@@ -283,7 +617,7 @@ void Assembler::cleanup()
     }
     assert(is_reference_unique_path());
     remove_vertices_past(reference_tail());
-    new_size = boost::num_vertices(graph_);
+    new_size = num_vertices(graph_);
     if (new_size != old_size) {
         regenerate_vertex_indices();
         if (new_size < 2) return;
@@ -291,7 +625,7 @@ void Assembler::cleanup()
     }
     assert(is_reference_unique_path());
     remove_vertices_that_cant_reach(reference_tail());
-    new_size = boost::num_vertices(graph_);
+    new_size = num_vertices(graph_);
     if (new_size != old_size) {
         regenerate_vertex_indices();
         if (new_size < 2) return;
@@ -304,16 +638,17 @@ void Assembler::cleanup()
         clear();
         return;
     }
-    new_size = boost::num_vertices(graph_);
+    new_size = num_vertices(graph_);
     assert(new_size != 0);
-    assert(!(boost::num_edges(graph_) == 0 && new_size > 1));
+    assert(!(num_edges(graph_) == 0 && new_size > 1));
     assert(is_reference_unique_path());
     if (new_size != old_size) {
         regenerate_vertex_indices();
     }
 }
 
-void Assembler::clear()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::clear()
 {
     graph_.clear();
     vertex_cache_.clear();
@@ -336,8 +671,8 @@ bool operator<(const Assembler::Variant& lhs, const Assembler::Variant& rhs) noe
     return lhs.begin_pos < rhs.begin_pos;
 }
 
-std::deque<Assembler::Variant>
-Assembler::extract_variants(const unsigned max_bubbles, const double min_bubble_score)
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::extract_variants(const unsigned max_bubbles, const double min_bubble_score) -> std::deque<Variant>
 {
     if (is_empty() || is_all_reference()) return {};
     set_all_edge_transition_scores_from(reference_head());
@@ -347,7 +682,8 @@ Assembler::extract_variants(const unsigned max_bubbles, const double min_bubble_
     return result;
 }
 
-void Assembler::write_dot(std::ostream& out) const
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::write_dot(std::ostream& out) const
 {
     const auto vertex_writer = [this] (std::ostream& out, Vertex v) {
         if (is_reference(v)) {
@@ -422,7 +758,8 @@ bool operator<(const Assembler::Kmer& lhs, const Assembler::Kmer& rhs) noexcept
 //
 // Assembler private methods
 //
-void Assembler::insert_reference_into_empty_graph(const NucleotideSequence& sequence)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::insert_reference_into_empty_graph(const NucleotideSequence& sequence)
 {
     assert(sequence.size() >= kmer_size());
     vertex_cache_.reserve(sequence.size() + std::pow(4, 5));
@@ -468,7 +805,8 @@ void Assembler::insert_reference_into_empty_graph(const NucleotideSequence& sequ
     reference_edges_.shrink_to_fit();
 }
 
-void Assembler::insert_reference_into_populated_graph(const NucleotideSequence& sequence)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::insert_reference_into_populated_graph(const NucleotideSequence& sequence)
 {
     assert(sequence.size() >= kmer_size());
     assert(reference_kmers_.empty());
@@ -506,7 +844,7 @@ void Assembler::insert_reference_into_populated_graph(const NucleotideSequence&
             reference_vertices_.push_back(v);
             set_vertex_reference(v);
             Edge e; bool e_in_graph;
-            std::tie(e, e_in_graph) = boost::edge(u, v, graph_);
+            std::tie(e, e_in_graph) = edge(u, v, graph_);
             if (e_in_graph) {
                 set_edge_reference(e);
             } else {
@@ -523,29 +861,34 @@ void Assembler::insert_reference_into_populated_graph(const NucleotideSequence&
     reference_head_position_ = 0;
 }
 
-bool Assembler::contains_kmer(const Kmer& kmer) const noexcept
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::contains_kmer(const Kmer& kmer) const noexcept
 {
     return vertex_cache_.count(kmer) == 1;
 }
 
-std::size_t Assembler::count_kmer(const Kmer& kmer) const noexcept
+template <typename KmerGraph>
+std::size_t Assembler::GraphAssembler<KmerGraph>::count_kmer(const Kmer& kmer) const noexcept
 {
     return vertex_cache_.count(kmer);
 }
 
-std::size_t Assembler::reference_size() const noexcept
+template <typename KmerGraph>
+std::size_t Assembler::GraphAssembler<KmerGraph>::reference_size() const noexcept
 {
     return sequence_length(reference_kmers_.size(), kmer_size());
 }
 
-void Assembler::regenerate_vertex_indices()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::regenerate_vertex_indices()
 {
-    const auto p = boost::vertices(graph_);
+    const auto p = vertices(graph_);
     unsigned idx {0};
     std::for_each(p.first, p.second, [this, &idx] (Vertex v) { graph_[v].index = idx++; });
 }
 
-bool Assembler::is_reference_unique_path() const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_reference_unique_path() const
 {
     if (is_reference_empty()) {
         return true;
@@ -554,80 +897,96 @@ bool Assembler::is_reference_unique_path() const
         const auto tail = reference_tail();
         const auto is_reference_edge = [this] (const Edge e) { return is_reference(e); };
         while (u != tail) {
-            const auto p = boost::out_edges(u, graph_);
+            const auto p = out_edges(u, graph_);
             const auto itr = std::find_if(p.first, p.second, is_reference_edge);
             assert(itr != p.second);
             if (std::any_of(boost::next(itr), p.second, is_reference_edge)) {
                 return false;
             }
-            u = boost::target(*itr, graph_);
+            u = target(*itr, graph_);
         }
-        const auto p = boost::out_edges(tail, graph_);
+        const auto p = out_edges(tail, graph_);
         return std::none_of(p.first, p.second, is_reference_edge);
     }
 }
 
-Assembler::Vertex Assembler::null_vertex() const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::null_vertex() const -> Vertex
 {
     return boost::graph_traits<KmerGraph>::null_vertex();
 }
 
-boost::optional<Assembler::Vertex> Assembler::add_vertex(const Kmer& kmer, const bool is_reference)
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::add_vertex(const Kmer& kmer, const bool is_reference) -> boost::optional<Vertex>
 {
     if (!utils::is_canonical_dna(kmer)) return boost::none;
-    const auto u = boost::add_vertex({boost::num_vertices(graph_), kmer, is_reference}, graph_);
+    using boost::add_vertex; // the member hides the graph functions, which are found by ADL
+    const auto u = add_vertex({num_vertices(graph_), kmer, is_reference}, graph_);
     vertex_cache_.emplace(kmer, u);
     return u;
 }
 
-void Assembler::remove_vertex(const Vertex v)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_vertex(const Vertex v)
 {
     const auto c = vertex_cache_.erase(kmer_of(v));
     assert(c == 1);
     _unused(c); // make production build happy
-    boost::remove_vertex(v, graph_);
+    using boost::remove_vertex;
+    remove_vertex(v, graph_);
 }
 
-void Assembler::clear_and_remove_vertex(const Vertex v)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::clear_and_remove_vertex(const Vertex v)
 {
     const auto c = vertex_cache_.erase(kmer_of(v));
     assert(c == 1);
     _unused(c); // make production build happy
-    boost::clear_vertex(v, graph_);
-    boost::remove_vertex(v, graph_);
+    clear_vertex(v, graph_);
+    using boost::remove_vertex;
+    remove_vertex(v, graph_);
 }
 
-void Assembler::clear_and_remove_all(const std::unordered_set<Vertex>& vertices)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::clear_and_remove_all(const std::unordered_set<Vertex>& vertices)
 {
     for (const Vertex v : vertices) {
         clear_and_remove_vertex(v);
     }
 }
 
-Assembler::Edge Assembler::add_edge(const Vertex u, const Vertex v,
-                                    const GraphEdge::WeightType weight, GraphEdge::WeightType forward_weight,
-                                    const int base_quality_sum,
-                                    const bool is_reference, const bool is_artificial)
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::add_edge(const Vertex u, const Vertex v,
+                                                    const GraphEdge::WeightType weight, GraphEdge::WeightType forward_weight,
+                                                    const int base_quality_sum,
+                                                    const bool is_reference, const bool is_artificial) -> Edge
 {
-    return boost::add_edge(u, v, {weight, forward_weight, base_quality_sum, is_reference, is_artificial}, graph_).first;
+    using boost::add_edge;
+    return add_edge(u, v, {weight, forward_weight, base_quality_sum, is_reference, is_artificial}, graph_).first;
 }
 
-Assembler::Edge Assembler::add_reference_edge(const Vertex u, const Vertex v)
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::add_reference_edge(const Vertex u, const Vertex v) -> Edge
 {
     return add_edge(u, v, 0, 0, 0, true);
 }
 
-void Assembler::remove_edge(const Vertex u, const Vertex v)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_edge(const Vertex u, const Vertex v)
 {
-    boost::remove_edge(u, v, graph_);
+    using boost::remove_edge;
+    remove_edge(u, v, graph_);
 }
 
-void Assembler::remove_edge(const Edge e)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_edge(const Edge e)
 {
-    boost::remove_edge(e, graph_);
+    using boost::remove_edge;
+    remove_edge(e, graph_);
 }
 
-void Assembler::increment_weight(const Edge e, const bool is_forward, const int base_quality)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::increment_weight(const Edge e, const bool is_forward, const int base_quality)
 {
     auto& edge = graph_[e];
     ++edge.weight;
@@ -635,114 +994,135 @@ void Assembler::increment_weight(const Edge e, const bool is_forward, const int
     if (is_forward) ++edge.forward_strand_weight;
 }
 
-void Assembler::set_vertex_reference(const Vertex v)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::set_vertex_reference(const Vertex v)
 {
     graph_[v].is_reference = true;
 }
 
-void Assembler::set_vertex_reference(const Kmer& kmer)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::set_vertex_reference(const Kmer& kmer)
 {
     set_vertex_reference(vertex_cache_.at(kmer));
 }
 
-void Assembler::set_edge_reference(const Edge e)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::set_edge_reference(const Edge e)
 {
     graph_[e].is_reference = true;
 }
 
-const Assembler::Kmer& Assembler::kmer_of(const Vertex v) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::kmer_of(const Vertex v) const -> const Kmer&
 {
     return graph_[v].kmer;
 }
 
-char Assembler::front_base_of(const Vertex v) const
+template <typename KmerGraph>
+char Assembler::GraphAssembler<KmerGraph>::front_base_of(const Vertex v) const
 {
     return kmer_of(v).front();
 }
 
-char Assembler::back_base_of(const Vertex v) const
+template <typename KmerGraph>
+char Assembler::GraphAssembler<KmerGraph>::back_base_of(const Vertex v) const
 {
     return kmer_of(v).back();
 }
 
-const Assembler::Kmer& Assembler::source_kmer_of(const Edge e) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::source_kmer_of(const Edge e) const -> const Kmer&
 {
-    return kmer_of(boost::source(e, graph_));
+    return kmer_of(source(e, graph_));
 }
 
-const Assembler::Kmer& Assembler::target_kmer_of(const Edge e) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::target_kmer_of(const Edge e) const -> const Kmer&
 {
-    return kmer_of(boost::target(e, graph_));
+    return kmer_of(target(e, graph_));
 }
 
-bool Assembler::is_reference(const Vertex v) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_reference(const Vertex v) const
 {
     return graph_[v].is_reference;
 }
 
-bool Assembler::is_source_reference(const Edge e) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_source_reference(const Edge e) const
 {
-    return is_reference(boost::source(e, graph_));
+    return is_reference(source(e, graph_));
 }
 
-bool Assembler::is_target_reference(const Edge e) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_target_reference(const Edge e) const
 {
-    return is_reference(boost::target(e, graph_));
+    return is_reference(target(e, graph_));
 }
 
-bool Assembler::is_reference(const Edge e) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_reference(const Edge e) const
 {
     return graph_[e].is_reference;
 }
 
-bool Assembler::is_artificial(const Edge e) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_artificial(const Edge e) const
 {
     return graph_[e].is_artificial;
 }
 
-bool Assembler::is_reference_empty() const noexcept
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_reference_empty() const noexcept
 {
     return reference_vertices_.empty();
 }
 
-Assembler::Vertex Assembler::reference_head() const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::reference_head() const -> Vertex
 {
     return reference_vertices_.front();
 }
 
-Assembler::Vertex Assembler::reference_tail() const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::reference_tail() const -> Vertex
 {
     return reference_vertices_.back();
 }
 
-Assembler::Vertex Assembler::next_reference(const Vertex u) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::next_reference(const Vertex u) const -> Vertex
 {
-    const auto p = boost::out_edges(u, graph_);
+    const auto p = out_edges(u, graph_);
     const auto itr = std::find_if(p.first, p.second, [this] (const Edge e) { return is_reference(e); });
     assert(itr != p.second);
-    return boost::target(*itr, graph_);
+    return target(*itr, graph_);
 }
 
-Assembler::Vertex Assembler::prev_reference(const Vertex v) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::prev_reference(const Vertex v) const -> Vertex
 {
-    const auto p = boost::in_edges(v, graph_);
+    const auto p = in_edges(v, graph_);
     const auto itr = std::find_if(p.first, p.second, [this] (const Edge e) { return is_reference(e); });
     assert(itr != p.second);
-    return boost::source(*itr, graph_);
+    return source(*itr, graph_);
 }
 
-std::size_t Assembler::num_reference_kmers() const
+template <typename KmerGraph>
+std::size_t Assembler::GraphAssembler<KmerGraph>::num_reference_kmers() const
 {
-    const auto p = boost::vertices(graph_);
+    const auto p = vertices(graph_);
     return std::count_if(p.first, p.second, [this] (const Vertex& v) { return is_reference(v); });
 }
 
-bool Assembler::is_dangling_branch(const Vertex v) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_dangling_branch(const Vertex v) const
 {
-    return !is_reference(v) && boost::in_degree(v, graph_) > 0 && boost::out_degree(v, graph_) == 0;
+    return !is_reference(v) && in_degree(v, graph_) > 0 && out_degree(v, graph_) == 0;
 }
 
-boost::optional<Assembler::Vertex> Assembler::find_joining_kmer(const Vertex v) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::find_joining_kmer(const Vertex v) const -> boost::optional<Vertex>
 {
     const auto& kmer = kmer_of(v);
     NucleotideSequence adjacent_kmer {std::next(std::cbegin(kmer)), std::cend(kmer)};
@@ -759,7 +1139,8 @@ boost::optional<Assembler::Vertex> Assembler::find_joining_kmer(const Vertex v)
     return boost::none;
 }
 
-Assembler::NucleotideSequence Assembler::make_sequence(const Path& path) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::make_sequence(const Path& path) const -> NucleotideSequence
 {
     assert(!path.empty());
     NucleotideSequence result(kmer_size() + path.size() - 1, 'N');
@@ -770,7 +1151,8 @@ Assembler::NucleotideSequence Assembler::make_sequence(const Path& path) const
     return result;
 }
 
-Assembler::NucleotideSequence Assembler::make_reference(Vertex from, const Vertex to) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::make_reference(Vertex from, const Vertex to) const -> NucleotideSequence
 {
     const auto null = null_vertex();
     
@@ -802,13 +1184,14 @@ Assembler::NucleotideSequence Assembler::make_reference(Vertex from, const Verte
     return result;
 }
 
-void Assembler::remove_path(const std::deque<Vertex>& path)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_path(const std::deque<Vertex>& path)
 {
     assert(!path.empty());
     if (path.size() == 1) {
         clear_and_remove_vertex(path.front());
     } else {
-        remove_edge(*boost::in_edges(path.front(), graph_).first);
+        remove_edge(*in_edges(path.front(), graph_).first);
         auto prev = path.front();
         std::for_each(std::next(std::cbegin(path)), std::cend(path),
                       [this, &prev] (const Vertex v) {
@@ -816,46 +1199,52 @@ void Assembler::remove_path(const std::deque<Vertex>& path)
                           remove_vertex(prev);
                           prev = v;
                       });
-        remove_edge(*boost::out_edges(path.back(), graph_).first);
+        remove_edge(*out_edges(path.back(), graph_).first);
         remove_vertex(path.back());
     }
 }
 
-bool Assembler::is_bridge(const Vertex v) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_bridge(const Vertex v) const
 {
-    return boost::in_degree(v, graph_) == 1 && boost::out_degree(v, graph_) == 1;
+    return in_degree(v, graph_) == 1 && out_degree(v, graph_) == 1;
 }
 
-bool Assembler::is_reference_bridge(const Vertex v) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_reference_bridge(const Vertex v) const
 {
     return is_reference(v) && is_bridge(v);
 }
 
-Assembler::Path::const_iterator
-Assembler::is_bridge_until(const Path::const_iterator first, const Path::const_iterator last) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::is_bridge_until(const typename Path::const_iterator first, const typename Path::const_iterator last) const -> typename Path::const_iterator
 {
     return std::find_if_not(first, last, [this] (const Vertex v) { return is_bridge(v); });
 }
 
-Assembler::Path::const_iterator Assembler::is_bridge_until(const Path& path) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::is_bridge_until(const Path& path) const -> typename Path::const_iterator
 {
     return is_bridge_until(std::cbegin(path), std::cend(path));
 }
 
-bool Assembler::is_bridge(Path::const_iterator first, Path::const_iterator last) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_bridge(typename Path::const_iterator first, typename Path::const_iterator last) const
 {
     return std::all_of(first, last, [this] (const Vertex v) { return is_bridge(v); });
 }
 
-bool Assembler::is_bridge(const Path& path) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_bridge(const Path& path) const
 {
     return is_bridge(std::cbegin(path), std::cend(path));
 }
 
-std::pair<bool, Assembler::Vertex> Assembler::is_bridge_to_reference(Vertex from) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::is_bridge_to_reference(Vertex from) const -> std::pair<bool, Vertex>
 {
     while (is_bridge(from)) {
-        from = *boost::adjacent_vertices(from, graph_).first;
+        from = *adjacent_vertices(from, graph_).first;
         if (is_reference(from)) {
             return std::make_pair(true, from);
         }
@@ -863,14 +1252,16 @@ std::pair<bool, Assembler::Vertex> Assembler::is_bridge_to_reference(Vertex from
     return std::make_pair(false, null_vertex());
 }
 
-bool Assembler::joins_reference_only(const Vertex v) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::joins_reference_only(const Vertex v) const
 {
-    return boost::out_degree(v, graph_) == 1 && is_reference(*boost::out_edges(v, graph_).first);
+    return out_degree(v, graph_) == 1 && is_reference(*out_edges(v, graph_).first);
 }
 
-bool Assembler::joins_reference_only(Path::const_iterator first, Path::const_iterator last) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::joins_reference_only(typename Path::const_iterator first, typename Path::const_iterator last) const
 {
-    const auto itr = std::find_if(first, last, [this] (Vertex v) { return is_reference(v) || boost::out_degree(v, graph_) != 1; });
+    const auto itr = std::find_if(first, last, [this] (Vertex v) { return is_reference(v) || out_degree(v, graph_) != 1; });
     return itr == last || is_reference(*itr);
 }
 
@@ -884,7 +1275,7 @@ struct CycleDetector : public boost::default_dfs_visitor
     template <typename Graph>
     void back_edge(typename boost::graph_traits<Graph>::edge_descriptor e, const Graph& g)
     {
-        if (boost::source(e, g) != boost::target(e, g) || !allow_self_edges_) {
+        if (source(e, g) != target(e, g) || !allow_self_edges_) {
             throw CycleDetectedException {};
         }
     }
@@ -901,7 +1292,7 @@ struct CyclicEdgeDetector : public boost::default_dfs_visitor
     template <typename Graph>
     void back_edge(typename boost::graph_traits<Graph>::edge_descriptor e, const Graph& g)
     {
-        if (boost::source(e, g) != boost::target(e, g) || include_self_edges_) {
+        if (source(e, g) != target(e, g) || include_self_edges_) {
             result_.push_back(e);
         }
     }
@@ -912,20 +1303,23 @@ protected:
     
 } // namespace
 
-bool Assembler::is_trivial_cycle(const Edge e) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_trivial_cycle(const Edge e) const
 {
-    return boost::source(e, graph_) == boost::target(e, graph_);
+    return source(e, graph_) == target(e, graph_);
 }
 
-bool Assembler::graph_has_trivial_cycle() const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::graph_has_trivial_cycle() const
 {
-    const auto p = boost::edges(graph_);
+    const auto p = edges(graph_);
     return std::any_of(p.first, p.second, [this] (const Edge& e) { return is_trivial_cycle(e); });
 }
 
-bool Assembler::graph_has_nontrivial_cycle() const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::graph_has_nontrivial_cycle() const
 {
-    const auto index_map = boost::get(&GraphNode::index, graph_);
+    const auto index_map = get(&GraphNode::index, graph_);
     try {
         boost::depth_first_search(graph_, boost::visitor(CycleDetector {}).root_vertex(reference_head()).vertex_index_map(index_map));
         return false;
@@ -934,14 +1328,16 @@ bool Assembler::graph_has_nontrivial_cycle() const
     }
 }
 
-void Assembler::remove_trivial_nonreference_cycles()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_trivial_nonreference_cycles()
 {
-    boost::remove_edge_if([this] (const Edge e) { return !is_reference(e) && is_trivial_cycle(e); }, graph_);
+    remove_edge_if([this] (const Edge e) { return !is_reference(e) && is_trivial_cycle(e); }, graph_);
 }
 
-void Assembler::remove_nontrivial_nonreference_cycles()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_nontrivial_nonreference_cycles()
 {
-    const auto index_map = boost::get(&GraphNode::index, graph_);
+    const auto index_map = get(&GraphNode::index, graph_);
     std::deque<Edge> cyclic_edges {};
     CyclicEdgeDetector<decltype(cyclic_edges)> vis {cyclic_edges, false};
     boost::depth_first_search(graph_, boost::visitor(vis).root_vertex(reference_head()).vertex_index_map(index_map));
@@ -952,9 +1348,10 @@ void Assembler::remove_nontrivial_nonreference_cycles()
     }
 }
 
-void Assembler::remove_all_nonreference_cycles(const bool break_chains)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_all_nonreference_cycles(const bool break_chains)
 {
-    const auto index_map = boost::get(&GraphNode::index, graph_);
+    const auto index_map = get(&GraphNode::index, graph_);
     std::deque<Edge> cyclic_edges {};
     CyclicEdgeDetector<decltype(cyclic_edges)> vis {cyclic_edges};
     boost::depth_first_search(graph_, boost::visitor(vis).root_vertex(reference_head()).vertex_index_map(index_map));
@@ -968,10 +1365,10 @@ void Assembler::remove_all_nonreference_cycles(const bool break_chains)
     for (const Edge& back_edge : cyclic_edges) {
         if (!is_reference(back_edge)) {
             if (break_chains) {
-                Vertex cycle_origin {boost::source(back_edge, graph_)};
+                Vertex cycle_origin {source(back_edge, graph_)};
                 while (!is_reference(cycle_origin) && is_bridge(cycle_origin) && bad_kmers.count(cycle_origin) == 0) {
                     bad_kmers.insert(cycle_origin);
-                    cycle_origin = *boost::inv_adjacent_vertices(cycle_origin, graph_).first;
+                    cycle_origin = *inv_adjacent_vertices(cycle_origin, graph_).first;
                 }
                 bool is_reference_origin {false};
                 if (is_reference(cycle_origin)) {
@@ -980,26 +1377,26 @@ void Assembler::remove_all_nonreference_cycles(const bool break_chains)
                 } else {
                     bad_kmers.insert(cycle_origin);
                 }
-                Vertex cycle_sink {boost::target(back_edge, graph_)};
+                Vertex cycle_sink {target(back_edge, graph_)};
                 while (!is_reference(cycle_sink) && is_bridge(cycle_sink) && bad_kmers.count(cycle_sink) == 0) {
                     bad_kmers.insert(cycle_origin);
-                    cycle_sink = *boost::adjacent_vertices(cycle_sink, graph_).first;
+                    cycle_sink = *adjacent_vertices(cycle_sink, graph_).first;
                 }
                 if (is_reference(cycle_sink)) {
                     reference_sinks.insert(cycle_sink);
                     if (is_reference_origin) {
                         cyclic_reference_segments.emplace_back(cycle_sink, cycle_origin);
-                    } else if (boost::out_degree(cycle_origin, graph_) > 1) {
-                        const auto p = boost::out_edges(cycle_origin, graph_);
+                    } else if (out_degree(cycle_origin, graph_) > 1) {
+                        const auto p = out_edges(cycle_origin, graph_);
                         std::vector<Vertex> reference_tails {};
                         reference_tails.reserve(std::distance(p.first, p.second));
                         std::for_each(p.first, p.second, [&] (Edge tail_edge) {
                             if (tail_edge != back_edge) {
-                                auto tail = boost::target(tail_edge, graph_);
-                                while (!is_reference(tail) && boost::out_degree(tail, graph_) == 1
+                                auto tail = target(tail_edge, graph_);
+                                while (!is_reference(tail) && out_degree(tail, graph_) == 1
                                        && bad_kmers.count(tail) == 0) {
                                     bad_kmers.insert(tail);
-                                    tail = *boost::adjacent_vertices(tail, graph_).first;
+                                    tail = *adjacent_vertices(tail, graph_).first;
                                 }
                                 if (is_reference(tail)) {
                                     reference_tails.push_back(tail);
@@ -1037,11 +1434,11 @@ void Assembler::remove_all_nonreference_cycles(const bool break_chains)
     }
     bool regenerate_indices {false};
     for (Vertex v : reference_origins) {
-        boost::remove_in_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
+        remove_in_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
         regenerate_indices = true;
     }
     for (Vertex v : reference_sinks) {
-        boost::remove_out_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
+        remove_out_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
         regenerate_indices = true;
     }
     if (!bad_kmers.empty()) {
@@ -1055,8 +1452,8 @@ void Assembler::remove_all_nonreference_cycles(const bool break_chains)
             const auto last_vertex_itr  = std::find(first_vertex_itr, std::cend(reference_vertices_), p.second);
             assert(last_vertex_itr != std::cend(reference_vertices_));
             std::for_each(first_vertex_itr, last_vertex_itr, [this] (Vertex v) {
-                boost::remove_in_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
-                boost::remove_out_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
+                remove_in_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
+                remove_out_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
             });
         }
         regenerate_indices = true;
@@ -1066,12 +1463,14 @@ void Assembler::remove_all_nonreference_cycles(const bool break_chains)
     }
 }
 
-bool Assembler::is_simple_deletion(Edge e) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_simple_deletion(Edge e) const
 {
     return !is_reference(e) && is_source_reference(e) && is_target_reference(e);
 }
 
-bool Assembler::is_on_path(const Edge e, const Path& path) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_on_path(const Edge e, const Path& path) const
 {
     if (path.size() < 2) return false;
     auto first_vertex = std::cbegin(path);
@@ -1079,24 +1478,27 @@ bool Assembler::is_on_path(const Edge e, const Path& path) const
     const auto last_vertex = std::cend(path);
     Edge path_edge; bool good;
     for (; next_vertex != last_vertex; ++first_vertex, ++next_vertex) {
-        std::tie(path_edge, good) = boost::edge(*first_vertex, *next_vertex, graph_);
+        std::tie(path_edge, good) = edge(*first_vertex, *next_vertex, graph_);
         assert(good);
         if (path_edge == e) return true;
     }
     return false;
 }
 
-bool Assembler::connects_to_path(Edge e, const Path& path) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::connects_to_path(Edge e, const Path& path) const
 {
-    return e == *boost::in_edges(path.front(), graph_).first || e == *boost::out_edges(path.back(), graph_).first;
+    return e == *in_edges(path.front(), graph_).first || e == *out_edges(path.back(), graph_).first;
 }
 
-bool Assembler::is_dependent_on_path(Edge e, const Path& path) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_dependent_on_path(Edge e, const Path& path) const
 {
     return connects_to_path(e, path) || is_on_path(e, path);
 }
 
-Assembler::GraphEdge::WeightType Assembler::weight(const Path& path) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::weight(const Path& path) const -> GraphEdge::WeightType
 {
     if (path.size() < 2) return 0;
     return std::inner_product(std::cbegin(path), std::prev(std::cend(path)),
@@ -1104,54 +1506,58 @@ Assembler::GraphEdge::WeightType Assembler::weight(const Path& path) const
                               std::plus<> {},
                               [this] (const auto& u, const auto& v) {
                                   Edge e; bool good;
-                                  std::tie(e, good) = boost::edge(u, v, graph_);
+                                  std::tie(e, good) = edge(u, v, graph_);
                                   assert(good);
                                   return graph_[e].weight;
                               });
 }
 
-Assembler::GraphEdge::WeightType Assembler::max_weight(const Path& path) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::max_weight(const Path& path) const -> GraphEdge::WeightType
 {
     GraphEdge::WeightType result {0};
     for (std::size_t u {0}, v {1}; v < path.size(); ++u, ++v) {
         Edge e; bool good;
-        std::tie(e, good) = boost::edge(path[u], path[v], graph_);
+        std::tie(e, good) = edge(path[u], path[v], graph_);
         assert(good);
         result = std::max(result, graph_[e].weight);
     }
     return result;
 }
 
-unsigned Assembler::count_low_weights(const Path& path, const unsigned low_weight) const
+template <typename KmerGraph>
+unsigned Assembler::GraphAssembler<KmerGraph>::count_low_weights(const Path& path, const unsigned low_weight) const
 {
     if (path.size() < 2) return 0;
     return std::inner_product(std::cbegin(path), std::prev(std::cend(path)), std::next(std::cbegin(path)), 0u, std::plus<> {},
                               [this, low_weight] (const auto& u, const auto& v) {
                                   Edge e; bool good;
-                                  std::tie(e, good) = boost::edge(u, v, graph_);
+                                  std::tie(e, good) = edge(u, v, graph_);
                                   assert(good);
                                   return graph_[e].weight <= low_weight ? 1 : 0;
                               });
 }
 
-bool Assembler::has_low_weight_flanks(const Path& path, const unsigned low_weight) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::has_low_weight_flanks(const Path& path, const unsigned low_weight) const
 {
     if (path.size() < 2) return false;
     Edge e; bool good;
-    std::tie(e, good) = boost::edge(path[0], path[1], graph_);
+    std::tie(e, good) = edge(path[0], path[1], graph_);
     assert(good);
     if (graph_[e].weight <= low_weight) return true;
-    std::tie(e, good) = boost::edge(std::crbegin(path)[1], std::crbegin(path)[0], graph_);
+    std::tie(e, good) = edge(std::crbegin(path)[1], std::crbegin(path)[0], graph_);
     assert(good);
     return graph_[e].weight <= low_weight;
 }
 
-unsigned Assembler::count_low_weight_flanks(const Path& path, unsigned low_weight) const
+template <typename KmerGraph>
+unsigned Assembler::GraphAssembler<KmerGraph>::count_low_weight_flanks(const Path& path, unsigned low_weight) const
 {
     if (path.size() < 2) return 0;
     const auto is_low_weight = [this, low_weight] (const auto& u, const auto& v) {
         Edge e; bool good;
-        std::tie(e, good) = boost::edge(u, v, graph_);
+        std::tie(e, good) = edge(u, v, graph_);
         assert(good);
         return graph_[e].weight > low_weight ? 1 : 0;
     };
@@ -1165,7 +1571,8 @@ unsigned Assembler::count_low_weight_flanks(const Path& path, unsigned low_weigh
     return static_cast<unsigned>(num_head_low_weight + num_tail_low_weight);
 }
 
-Assembler::PathWeightStats Assembler::compute_weight_stats(const Path& path) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::compute_weight_stats(const Path& path) const -> PathWeightStats
 {
     PathWeightStats result {};
     if (path.size() > 1) {
@@ -1175,7 +1582,7 @@ Assembler::PathWeightStats Assembler::compute_weight_stats(const Path& path) con
         std::vector<GraphEdge::WeightType> weights(path.size() - 1);
         for (std::size_t u {0}, v {1}; v < path.size(); ++u, ++v) {
             Edge e; bool good;
-            std::tie(e, good) = boost::edge(path[u], path[v], graph_);
+            std::tie(e, good) = edge(path[u], path[v], graph_);
             assert(good);
             const auto weight = graph_[e].weight;
             ++result.distribution[weight];
@@ -1196,9 +1603,10 @@ Assembler::PathWeightStats Assembler::compute_weight_stats(const Path& path) con
     return result;
 }
 
-Assembler::GraphEdge::WeightType Assembler::sum_source_in_edge_weight(const Edge e) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::sum_source_in_edge_weight(const Edge e) const -> GraphEdge::WeightType
 {
-    const auto p = boost::in_edges(boost::source(e, graph_), graph_);
+    const auto p = in_edges(source(e, graph_), graph_);
     using Weight = GraphEdge::WeightType;
     return std::accumulate(p.first, p.second, Weight {0},
                            [this] (const Weight curr, const Edge& e) {
@@ -1206,9 +1614,10 @@ Assembler::GraphEdge::WeightType Assembler::sum_source_in_edge_weight(const Edge
                            });
 }
 
-Assembler::GraphEdge::WeightType Assembler::sum_target_out_edge_weight(const Edge e) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::sum_target_out_edge_weight(const Edge e) const -> GraphEdge::WeightType
 {
-    const auto p = boost::out_edges(boost::target(e, graph_), graph_);
+    const auto p = out_edges(target(e, graph_), graph_);
     using Weight = GraphEdge::WeightType;
     return std::accumulate(p.first, p.second, Weight {0},
                            [this] (const Weight curr, const Edge& e) {
@@ -1216,47 +1625,54 @@ Assembler::GraphEdge::WeightType Assembler::sum_target_out_edge_weight(const Edg
                            });
 }
 
-bool Assembler::all_in_edges_low_weight(Vertex v, unsigned min_weight) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::all_in_edges_low_weight(Vertex v, unsigned min_weight) const
 {
-    const auto p = boost::in_edges(v, graph_);
+    const auto p = in_edges(v, graph_);
     return std::all_of(p.first, p.second, [this, min_weight] (Edge e) { return graph_[e].weight < min_weight; });
 }
 
-bool Assembler::all_out_edges_low_weight(Vertex v, unsigned min_weight) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::all_out_edges_low_weight(Vertex v, unsigned min_weight) const
 {
-    const auto p = boost::out_edges(v, graph_);
+    const auto p = out_edges(v, graph_);
     return std::all_of(p.first, p.second, [this, min_weight] (Edge e) { return graph_[e].weight < min_weight; });
 }
 
-bool Assembler::is_low_weight(const Vertex v, const unsigned min_weight) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_low_weight(const Vertex v, const unsigned min_weight) const
 {
     return !is_reference(v) && all_in_edges_low_weight(v, min_weight) && all_out_edges_low_weight(v, min_weight);
 }
 
-std::size_t Assembler::low_weight_out_degree(Vertex v, unsigned min_weight) const
+template <typename KmerGraph>
+std::size_t Assembler::GraphAssembler<KmerGraph>::low_weight_out_degree(Vertex v, unsigned min_weight) const
 {
-    const auto p = boost::out_edges(v, graph_);
+    const auto p = out_edges(v, graph_);
     const auto d = std::count_if(p.first, p.second, [this, min_weight] (Edge e) { return graph_[e].weight < min_weight; });
     return static_cast<std::size_t>(d);
 }
 
-std::size_t Assembler::low_weight_in_degree(Vertex v, unsigned min_weight) const
+template <typename KmerGraph>
+std::size_t Assembler::GraphAssembler<KmerGraph>::low_weight_in_degree(Vertex v, unsigned min_weight) const
 {
-    const auto p = boost::in_edges(v, graph_);
+    const auto p = in_edges(v, graph_);
     const auto d = std::count_if(p.first, p.second, [this, min_weight] (Edge e) { return graph_[e].weight < min_weight; });
     return static_cast<std::size_t>(d);
 }
 
-bool Assembler::is_low_weight_source(Vertex v, unsigned min_weight) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_low_weight_source(Vertex v, unsigned min_weight) const
 {
     const auto num_low_weight = low_weight_out_degree(v, min_weight);
-    return num_low_weight > 0 && num_low_weight < boost::out_degree(v, graph_);
+    return num_low_weight > 0 && num_low_weight < out_degree(v, graph_);
 }
 
-bool Assembler::is_low_weight_sink(Vertex v, unsigned min_weight) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_low_weight_sink(Vertex v, unsigned min_weight) const
 {
     const auto num_low_weight = low_weight_in_degree(v, min_weight);
-    return num_low_weight > 0 && num_low_weight < boost::in_degree(v, graph_);
+    return num_low_weight > 0 && num_low_weight < in_degree(v, graph_);
 }
 
 namespace {
@@ -1269,44 +1685,48 @@ bool all_in(Iterator first, Iterator last, const Set& values)
 
 } // namespace
 
-void Assembler::remove_low_weight_edges(const unsigned min_weight)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_low_weight_edges(const unsigned min_weight)
 {
-    boost::remove_edge_if([this, min_weight] (const Edge& e) {
+    remove_edge_if([this, min_weight] (const Edge& e) {
         return !is_reference(e) && graph_[e].weight < min_weight
                && sum_source_in_edge_weight(e) < min_weight
                && sum_target_out_edge_weight(e) < min_weight;
     }, graph_);
 }
 
-void Assembler::remove_disconnected_vertices()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_disconnected_vertices()
 {
     VertexIterator vi, vi_end, vi_next;
-    std::tie(vi, vi_end) = boost::vertices(graph_);
+    std::tie(vi, vi_end) = vertices(graph_);
     for (vi_next = vi; vi != vi_end; vi = vi_next) {
         ++vi_next;
-        if (boost::degree(*vi, graph_) == 0) {
+        if (degree(*vi, graph_) == 0) {
             remove_vertex(*vi);
         }
     }
 }
 
-std::unordered_set<Assembler::Vertex> Assembler::find_reachable_kmers(const Vertex from) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::find_reachable_kmers(const Vertex from) const -> std::unordered_set<Vertex>
 {
     std::unordered_set<Vertex> result {};
-    result.reserve(boost::num_vertices(graph_));
+    result.reserve(num_vertices(graph_));
     auto vis = boost::make_bfs_visitor(boost::write_property(boost::typed_identity_property_map<Vertex>(),
                                                              std::inserter(result, std::begin(result)),
                                                              boost::on_discover_vertex()));
     boost::breadth_first_search(graph_, from,
-                                boost::visitor(vis).vertex_index_map(boost::get(&GraphNode::index, graph_)));
+                                boost::visitor(vis).vertex_index_map(get(&GraphNode::index, graph_)));
     return result;
 }
 
-std::deque<Assembler::Vertex> Assembler::remove_vertices_that_cant_be_reached_from(const Vertex v)
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::remove_vertices_that_cant_be_reached_from(const Vertex v) -> std::deque<Vertex>
 {
     const auto reachables = find_reachable_kmers(v);
     VertexIterator vi, vi_end, vi_next;
-    std::tie(vi, vi_end) = boost::vertices(graph_);
+    std::tie(vi, vi_end) = vertices(graph_);
     std::deque<Vertex> result {};
     for (vi_next = vi; vi != vi_end; vi = vi_next) {
         ++vi_next;
@@ -1318,18 +1738,19 @@ std::deque<Assembler::Vertex> Assembler::remove_vertices_that_cant_be_reached_fr
     return result;
 }
 
-void Assembler::remove_vertices_that_cant_reach(const Vertex v)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_vertices_that_cant_reach(const Vertex v)
 {
     if (!is_reference_empty()) {
         const auto transpose = boost::make_reverse_graph(graph_);
-        const auto index_map = boost::get(&GraphNode::index, transpose);
+        const auto index_map = get(&GraphNode::index, transpose);
         std::unordered_set<Vertex> reachables {};
         auto vis = boost::make_bfs_visitor(boost::write_property(boost::typed_identity_property_map<Vertex>(),
                                                                  std::inserter(reachables, std::begin(reachables)),
                                                                  boost::on_discover_vertex()));
         boost::breadth_first_search(transpose, v, boost::visitor(vis).vertex_index_map(index_map));
         VertexIterator vi, vi_end, vi_next;
-        std::tie(vi, vi_end) = boost::vertices(graph_);
+        std::tie(vi, vi_end) = vertices(graph_);
         for (vi_next = vi; vi != vi_end; vi = vi_next) {
             ++vi_next;
             if (reachables.count(*vi) == 0) {
@@ -1339,22 +1760,23 @@ void Assembler::remove_vertices_that_cant_reach(const Vertex v)
     }
 }
 
-void Assembler::remove_vertices_past(const Vertex v)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::remove_vertices_past(const Vertex v)
 {
     auto reachables = find_reachable_kmers(v);
     reachables.erase(v);
-    boost::clear_out_edges(v, graph_);
+    clear_out_edges(v, graph_);
     std::deque<Vertex> cycle_tails {};
     // Must check for cycles that lead back to v
     for (auto u : reachables) {
         Edge e; bool present;
-        std::tie(e, present) = boost::edge(u, v, graph_);
+        std::tie(e, present) = edge(u, v, graph_);
         if (present) cycle_tails.push_back(u);
     }
     if (!cycle_tails.empty()) {
         // We can check reachable back edges as the links from v were cut previously
         const auto transpose = boost::make_reverse_graph(graph_);
-        const auto index_map = boost::get(&GraphNode::index, transpose);
+        const auto index_map = get(&GraphNode::index, transpose);
         std::unordered_set<Vertex> back_reachables {};
         auto vis = boost::make_bfs_visitor(boost::write_property(boost::typed_identity_property_map<Vertex>(),
                                                                  std::inserter(back_reachables, std::begin(back_reachables)),
@@ -1382,12 +1804,14 @@ void Assembler::remove_vertices_past(const Vertex v)
     clear_and_remove_all(reachables);
 }
 
-bool Assembler::can_prune_reference_flanks() const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::can_prune_reference_flanks() const
 {
-    return boost::out_degree(reference_head(), graph_) == 1 || boost::in_degree(reference_tail(), graph_) == 1;
+    return out_degree(reference_head(), graph_) == 1 || in_degree(reference_tail(), graph_) == 1;
 }
 
-void Assembler::pop_reference_head()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::pop_reference_head()
 {
     reference_kmers_.pop_front();
     reference_vertices_.pop_front();
@@ -1397,7 +1821,8 @@ void Assembler::pop_reference_head()
     ++reference_head_position_;
 }
 
-void Assembler::pop_reference_tail()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::pop_reference_tail()
 {
     reference_kmers_.pop_back();
     reference_vertices_.pop_back();
@@ -1406,26 +1831,27 @@ void Assembler::pop_reference_tail()
     }
 }
 
-void Assembler::prune_reference_flanks()
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::prune_reference_flanks()
 {
     if (!is_reference_empty()) {
         auto new_head_itr = std::cbegin(reference_vertices_);
         const auto is_bridge_vertex = [this] (const Vertex v) { return is_bridge(v); };
-        if (boost::in_degree(reference_head(), graph_) == 0 && boost::out_degree(reference_head(), graph_) == 1) {
+        if (in_degree(reference_head(), graph_) == 0 && out_degree(reference_head(), graph_) == 1) {
             new_head_itr = std::find_if_not(std::next(new_head_itr), std::cend(reference_vertices_), is_bridge_vertex);
             std::for_each(std::cbegin(reference_vertices_), new_head_itr, [this] (const Vertex u) {
-                remove_edge(u, *boost::adjacent_vertices(u, graph_).first);
+                remove_edge(u, *adjacent_vertices(u, graph_).first);
                 remove_vertex(u);
                 pop_reference_head();
             });
         }
-        if (new_head_itr != std::cend(reference_vertices_) && boost::in_degree(reference_tail(), graph_) == 1
-            && boost::out_degree(reference_tail(), graph_) == 0) {
+        if (new_head_itr != std::cend(reference_vertices_) && in_degree(reference_tail(), graph_) == 1
+            && out_degree(reference_tail(), graph_) == 0) {
             const auto new_tail_itr = std::find_if_not(std::next(std::crbegin(reference_vertices_)),
                                                        std::make_reverse_iterator(new_head_itr),
                                                        is_bridge_vertex);
             std::for_each(std::crbegin(reference_vertices_), new_tail_itr, [this] (const Vertex u) {
-                remove_edge(*boost::inv_adjacent_vertices(u, graph_).first, u);
+                remove_edge(*inv_adjacent_vertices(u, graph_).first, u);
                 remove_vertex(u);
                 pop_reference_tail();
             });
@@ -1433,11 +1859,11 @@ void Assembler::prune_reference_flanks()
     }
 }
 
-Assembler::DominatorMap
-Assembler::build_dominator_tree(const Vertex from) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::build_dominator_tree(const Vertex from) const -> DominatorMap
 {
     DominatorMap result;
-    result.reserve(boost::num_vertices(graph_));
+    result.reserve(num_vertices(graph_));
     boost::lengauer_tarjan_dominator_tree(graph_, from,  boost::make_assoc_property_map(result));
     auto it = std::cbegin(result);
     for (; it != std::cend(result);) {
@@ -1451,7 +1877,8 @@ Assembler::build_dominator_tree(const Vertex from) const
     return result;
 }
 
-std::unordered_set<Assembler::Vertex> Assembler::extract_nondominants(const Vertex from) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::extract_nondominants(const Vertex from) const -> std::unordered_set<Vertex>
 {
     const auto dom_tree = build_dominator_tree(from);
     std::unordered_set<Vertex> dominators {};
@@ -1469,7 +1896,8 @@ std::unordered_set<Assembler::Vertex> Assembler::extract_nondominants(const Vert
     return result;
 }
 
-std::deque<Assembler::Vertex> Assembler::extract_nondominant_reference(const DominatorMap& dominator_tree) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::extract_nondominant_reference(const DominatorMap& dominator_tree) const -> std::deque<Vertex>
 {
     std::unordered_set<Vertex> dominators {};
     dominators.reserve(dominator_tree.size());
@@ -1485,15 +1913,16 @@ std::deque<Assembler::Vertex> Assembler::extract_nondominant_reference(const Dom
     return result;
 }
 
-std::pair<Assembler::Vertex, unsigned> Assembler::find_bifurcation(Vertex from, const Vertex to) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::find_bifurcation(Vertex from, const Vertex to) const -> std::pair<Vertex, unsigned>
 {
     unsigned count {0};
     while (from != to) {
-        const auto d = boost::out_degree(from, graph_);
+        const auto d = out_degree(from, graph_);
         if (d == 0 || d > 1) {
             return std::make_pair(from, count);
         }
-        from = *boost::adjacent_vertices(from, graph_).first;
+        from = *adjacent_vertices(from, graph_).first;
         ++count;
     }
     return std::make_pair(from, count);
@@ -1503,7 +1932,7 @@ template <typename V, typename G>
 auto count_out_weight(const V& v, const G& g)
 {
     using T = decltype(g[typename boost::graph_traits<G>::edge_descriptor()].weight);
-    const auto p = boost::out_edges(v, g);
+    const auto p = out_edges(v, g);
     return std::accumulate(p.first, p.second, T {0},
                            [&g] (const auto curr, const auto& e) {
                                return curr + g[e].weight;
@@ -1524,10 +1953,11 @@ auto compute_transition_score(const T edge_weight, const T total_out_weight) noe
     }
 }
 
-void Assembler::set_out_edge_transition_scores(const Vertex v)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::set_out_edge_transition_scores(const Vertex v)
 {
     const auto total_out_weight = count_out_weight(v, graph_);
-    const auto p = boost::out_edges(v, graph_);
+    const auto p = out_edges(v, graph_);
     using R = GraphEdge::ScoreType;
     std::for_each(p.first, p.second, [this, total_out_weight] (const Edge& e) {
         graph_[e].transition_score = compute_transition_score<R>(graph_[e].weight, total_out_weight);
@@ -1546,58 +1976,63 @@ struct TransitionScorer : public boost::default_dfs_visitor
     void discover_vertex(Vertex v, const G& g)
     {
         const auto total_out_weight = count_out_weight(v, g);
-        const auto p = boost::out_edges(v, g);
+        const auto p = out_edges(v, g);
         std::for_each(p.first, p.second, [this, &g, total_out_weight] (const auto& e) {
             boost::put(map, e, compute_transition_score<R>(g[e].weight, total_out_weight));
         });
     }
 };
 
-void Assembler::set_all_edge_transition_scores_from(const Vertex src)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::set_all_edge_transition_scores_from(const Vertex src)
 {
-    auto score_map = boost::get(&GraphEdge::transition_score, graph_);
+    auto score_map = get(&GraphEdge::transition_score, graph_);
     TransitionScorer<GraphEdge::ScoreType, KmerGraph, decltype(score_map)> vis {score_map};
     boost::depth_first_search(graph_, boost::visitor(vis)
-                              .vertex_index_map(boost::get(&GraphNode::index, graph_)));
-    for (auto p = boost::edges(graph_); p.first != p.second; ++p.first) {
+                              .vertex_index_map(get(&GraphNode::index, graph_)));
+    for (auto p = edges(graph_); p.first != p.second; ++p.first) {
         graph_[*p.first].transition_score = score_map[*p.first];
     }
 }
 
-void Assembler::set_all_in_edge_transition_scores(const Vertex v, const GraphEdge::ScoreType score)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::set_all_in_edge_transition_scores(const Vertex v, const GraphEdge::ScoreType score)
 {
-    const auto p = boost::in_edges(v, graph_);
+    const auto p = in_edges(v, graph_);
     std::for_each(p.first, p.second, [this, score] (const Edge e) {
         graph_[e].transition_score = score;
     });
 }
 
-void Assembler::block_all_in_edges(const Vertex v)
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::block_all_in_edges(const Vertex v)
 {
     const auto total_out_weight = count_out_weight(v, graph_);
     set_all_in_edge_transition_scores(v, compute_transition_score<GraphEdge::ScoreType>(0u, total_out_weight));
 }
 
-Assembler::PredecessorMap Assembler::find_shortest_scoring_paths(const Vertex from, const bool use_weights) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::find_shortest_scoring_paths(const Vertex from, const bool use_weights) const -> PredecessorMap
 {
     assert(from != null_vertex());
     std::unordered_map<Vertex, Vertex> result {};
-    result.reserve(boost::num_vertices(graph_));
+    result.reserve(num_vertices(graph_));
     if (use_weights) {
         boost::dag_shortest_paths(graph_, from,
-                                  boost::weight_map(boost::get(&GraphEdge::weight, graph_))
+                                  boost::weight_map(get(&GraphEdge::weight, graph_))
                                   .predecessor_map(boost::make_assoc_property_map(result))
-                                  .vertex_index_map(boost::get(&GraphNode::index, graph_)));
+                                  .vertex_index_map(get(&GraphNode::index, graph_)));
     } else {
         boost::dag_shortest_paths(graph_, from,
-                                  boost::weight_map(boost::get(&GraphEdge::transition_score, graph_))
+                                  boost::weight_map(get(&GraphEdge::transition_score, graph_))
                                   .predecessor_map(boost::make_assoc_property_map(result))
-                                  .vertex_index_map(boost::get(&GraphNode::index, graph_)));
+                                  .vertex_index_map(get(&GraphNode::index, graph_)));
     }
     return result;
 }
 
-bool Assembler::is_on_path(const Vertex v, const PredecessorMap& predecessors, const Vertex from) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_on_path(const Vertex v, const PredecessorMap& predecessors, const Vertex from) const
 {
     if (v == from) return true;
     assert(predecessors.count(from) == 1);
@@ -1609,7 +2044,8 @@ bool Assembler::is_on_path(const Vertex v, const PredecessorMap& predecessors, c
     return false;
 }
 
-bool Assembler::is_on_path(const Edge e, const PredecessorMap& predecessors, const Vertex from) const
+template <typename KmerGraph>
+bool Assembler::GraphAssembler<KmerGraph>::is_on_path(const Edge e, const PredecessorMap& predecessors, const Vertex from) const
 {
     assert(predecessors.count(from) == 1);
     const auto last = std::cend(predecessors);
@@ -1618,7 +2054,7 @@ bool Assembler::is_on_path(const Edge e, const PredecessorMap& predecessors, con
     auto itr2 = predecessors.find(itr1->second);
     Edge path_edge; bool good;
     while (itr2 != last && itr1 != itr2) {
-        std::tie(path_edge, good) = boost::edge(itr2->second, itr1->second, graph_);
+        std::tie(path_edge, good) = edge(itr2->second, itr1->second, graph_);
         assert(good);
         if (path_edge == e) {
             return true;
@@ -1629,7 +2065,8 @@ bool Assembler::is_on_path(const Edge e, const PredecessorMap& predecessors, con
     return false;
 }
 
-Assembler::Path Assembler::extract_full_path(const PredecessorMap& predecessors, const Vertex from) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::extract_full_path(const PredecessorMap& predecessors, const Vertex from) const -> Path
 {
     assert(predecessors.count(from) == 1);
     Path result {from};
@@ -1641,8 +2078,8 @@ Assembler::Path Assembler::extract_full_path(const PredecessorMap& predecessors,
     return result;
 }
 
-std::tuple<Assembler::Vertex, Assembler::Vertex, unsigned>
-Assembler::backtrack_until_nonreference(const PredecessorMap& predecessors, Vertex from) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::backtrack_until_nonreference(const PredecessorMap& predecessors, Vertex from) const -> std::tuple<Vertex, Vertex, unsigned>
 {
     assert(predecessors.count(from) == 1);
     auto v = predecessors.at(from);
@@ -1650,7 +2087,7 @@ Assembler::backtrack_until_nonreference(const PredecessorMap& predecessors, Vert
     const auto head = reference_head();
     while (v != head) {
         assert(from != v); // was not reachable from source
-        const auto p = boost::edge(v, from, graph_);
+        const auto p = edge(v, from, graph_);
         assert(p.second);
         if (!is_reference(p.first)) break;
         from = v;
@@ -1661,7 +2098,8 @@ Assembler::backtrack_until_nonreference(const PredecessorMap& predecessors, Vert
     return std::make_tuple(v, from, count);
 }
 
-Assembler::Path Assembler::extract_nonreference_path(const PredecessorMap& predecessors, Vertex from) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::extract_nonreference_path(const PredecessorMap& predecessors, Vertex from) const -> Path
 {
     Path result {from};
     from = predecessors.at(from);
@@ -1696,27 +2134,30 @@ bool is_dominated_by_path(const V& vertex, const BidirectionalIt first, const Bi
     return std::find(rfirst, rlast, dominator) != rlast;
 }
 
-Assembler::Edge Assembler::head_edge(const Path& path) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::head_edge(const Path& path) const -> Edge
 {
     assert(path.size() > 1);
     Edge e; bool good;
-    std::tie(e, good) = boost::edge(path[0], path[1], graph_);
+    std::tie(e, good) = edge(path[0], path[1], graph_);
     assert(good);
     return e;
 }
 
-int Assembler::head_mean_base_quality(const Path& path) const
+template <typename KmerGraph>
+int Assembler::GraphAssembler<KmerGraph>::head_mean_base_quality(const Path& path) const
 {
     const auto& fork_edge = graph_[head_edge(path)];
     return fork_edge.weight > 0 ? fork_edge.base_quality_sum / fork_edge.weight : 0;
 }
-int Assembler::tail_mean_base_quality(const Path& path) const
+template <typename KmerGraph>
+int Assembler::GraphAssembler<KmerGraph>::tail_mean_base_quality(const Path& path) const
 {
     if (path.size() < 3) return 0;
     int base_quality_sum {0};
     const auto add_edge = [&] (const auto& u, const auto& v) {
         Edge e; bool good;
-        std::tie(e, good) = boost::edge(u, v, graph_);
+        std::tie(e, good) = edge(u, v, graph_);
         assert(good);
         base_quality_sum += graph_[e].base_quality_sum;
         return graph_[e].weight;
@@ -1737,7 +2178,8 @@ double base_quality_probability(const int base_quality)
 
 } // namespace
 
-double Assembler::bubble_score(const Path& path) const
+template <typename KmerGraph>
+double Assembler::GraphAssembler<KmerGraph>::bubble_score(const Path& path) const
 {
     if (path.size() < 2) return 0;
     const auto weight_stats = compute_weight_stats(path);
@@ -1755,10 +2197,11 @@ double Assembler::bubble_score(const Path& path) const
     return result;
 }
 
-std::vector<Assembler::EdgePath> Assembler::extract_k_shortest_paths(Vertex src, Vertex dst, unsigned k) const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::extract_k_shortest_paths(Vertex src, Vertex dst, unsigned k) const -> std::vector<EdgePath>
 {
-    auto weights = boost::get(&GraphEdge::transition_score, graph_);
-    auto indices = boost::get(&GraphNode::index, graph_);
+    auto weights = get(&GraphEdge::transition_score, graph_);
+    auto indices = get(&GraphNode::index, graph_);
     const auto ksps = boost::yen_ksp(graph_, src, dst, std::move(weights), std::move(indices), k);
     std::vector<EdgePath> result {};
     result.reserve(k);
@@ -1790,8 +2233,8 @@ auto make_bfs_searcher(Vertex v)
     return BfsSearcher<Vertex> {v};
 }
 
-std::deque<Assembler::Variant>
-Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::extract_bubble_paths(unsigned k, const double min_bubble_score) -> std::deque<Variant>
 {
     auto num_remaining_alt_kmers = num_kmers() - num_reference_kmers();
     std::deque<Variant> result {};
@@ -1840,7 +2283,7 @@ Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
             }
             --rhs_kmer_count; // because we padded one reference kmer to make ref_seq
             Edge edge_to_alt; bool good;
-            std::tie(edge_to_alt, good) = boost::edge(alt, ref, graph_);
+            std::tie(edge_to_alt, good) = edge(alt, ref, graph_);
             assert(good);
             if (alt_path.size() == 1 && is_simple_deletion(edge_to_alt)) {
                 remove_edge(alt_path.front(), ref);
@@ -1888,12 +2331,12 @@ Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
                     set_out_edge_transition_scores(vertex_before_bridge);
                     num_remaining_alt_kmers -= alt_path.size();
                     removed_bubble = true;
-                } else if (boost::in_degree(*bifurication_point_itr, graph_) == 1) {
+                } else if (in_degree(*bifurication_point_itr, graph_) == 1) {
                     const auto next_bifurication_point_itr = is_bridge_until(std::next(bifurication_point_itr), std::cend(alt_path));
                     if (next_bifurication_point_itr != std::cend(alt_path)) {
-                        if (boost::out_degree(*next_bifurication_point_itr, graph_) == 1) {
+                        if (out_degree(*next_bifurication_point_itr, graph_) == 1) {
                             if (joins_reference_only(next_bifurication_point_itr, std::cend(alt_path))) {
-                                const auto p = boost::adjacent_vertices(*bifurication_point_itr, graph_);
+                                const auto p = adjacent_vertices(*bifurication_point_itr, graph_);
                                 auto is_simple_bubble = std::all_of(p.first, p.second, [&] (Vertex v) {
                                     if (v == *std::next(bifurication_point_itr)) {
                                         return true;
@@ -1901,7 +2344,7 @@ Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
                                         try {
                                             boost::breadth_first_search(graph_, v,
                                                                         boost::visitor(make_bfs_searcher(*next_bifurication_point_itr)).
-                                                                        vertex_index_map(boost::get(&GraphNode::index, graph_)));
+                                                                        vertex_index_map(get(&GraphNode::index, graph_)));
                                         } catch (const BfsSearcherSuccess&) {
                                             return true;
                                         }
@@ -1969,8 +2412,8 @@ Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
         } else if (!removed_bubble) {
             use_weights = true;
         }
-        assert(boost::out_degree(reference_head(), graph_) > 0);
-        assert(boost::in_degree(reference_tail(), graph_) > 0);
+        assert(out_degree(reference_head(), graph_) > 0);
+        assert(in_degree(reference_tail(), graph_) > 0);
         if (can_prune_reference_flanks()) {
             prune_reference_flanks();
             regenerate_vertex_indices();
@@ -1979,11 +2422,12 @@ Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
     return result;
 }
 
-std::deque<Assembler::SubGraph> Assembler::find_independent_subgraphs() const
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::find_independent_subgraphs() const -> std::deque<SubGraph>
 {
     assert(!reference_vertices_.empty());
-    const auto diverges  = [this] (const Vertex& v) { return boost::out_degree(v, graph_) > 1; };
-    const auto coalesces = [this] (const Vertex& v) { return boost::in_degree(v, graph_) > 1; };
+    const auto diverges  = [this] (const Vertex& v) { return out_degree(v, graph_) > 1; };
+    const auto coalesces = [this] (const Vertex& v) { return in_degree(v, graph_) > 1; };
     auto subgraph_head_itr = std::find_if(std::cbegin(reference_vertices_), std::cend(reference_vertices_), diverges);
     if (subgraph_head_itr == std::cend(reference_vertices_)) {
         return {{reference_head(), reference_tail(), 0}};
@@ -2011,7 +2455,8 @@ std::deque<Assembler::SubGraph> Assembler::find_independent_subgraphs() const
     }
 }
 
-std::deque<Assembler::Variant> Assembler::extract_bubble_paths_with_ksp(const unsigned k, const double min_bubble_score)
+template <typename KmerGraph>
+auto Assembler::GraphAssembler<KmerGraph>::extract_bubble_paths_with_ksp(const unsigned k, const double min_bubble_score) -> std::deque<Variant>
 {
     const auto subgraphs = find_independent_subgraphs();
     std::deque<Variant> result {};
@@ -2023,17 +2468,17 @@ std::deque<Assembler::Variant> Assembler::extract_bubble_paths_with_ksp(const un
             auto alt_head_itr = std::find_if(std::cbegin(path), std::cend(path), is_alt_edge);
             auto lhs_kmer_count = std::distance(std::cbegin(path), alt_head_itr);
             while (alt_head_itr != std::cend(path)) {
-                const auto ref_before_bubble = boost::source(*alt_head_itr, graph_);
+                const auto ref_before_bubble = source(*alt_head_itr, graph_);
                 assert(is_reference(ref_before_bubble));
                 const auto alt_tail_itr = std::find_if(alt_head_itr, std::cend(path), [this] (Edge e) { return is_target_reference(e); });
                 assert(alt_tail_itr != std::cend(path));
-                const auto ref_after_bubble = boost::target(*alt_tail_itr, graph_);
+                const auto ref_after_bubble = target(*alt_tail_itr, graph_);
                 assert(!is_reference(*alt_tail_itr));
                 assert(is_reference(ref_after_bubble));
                 auto ref_seq = make_reference(ref_before_bubble, ref_after_bubble);
                 Path alt_path {};
                 std::transform(alt_head_itr, std::next(alt_tail_itr), std::back_inserter(alt_path),
-                               [this] (Edge e) { return boost::source(e, graph_); });
+                               [this] (Edge e) { return source(e, graph_); });
                 const auto num_ref_kmers = count_kmers(ref_seq, kmer_size());
                 const auto score = bubble_score(alt_path);
                 if (score >= min_bubble_score) {
@@ -2057,27 +2502,32 @@ std::ostream& operator<<(std::ostream& os, const Assembler::Kmer& kmer)
     return os;
 }
 
-void Assembler::print_reference_head() const
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::print_reference_head() const
 {
     std::cout << "reference head is " << kmer_of(reference_head()) << std::endl;
 }
 
-void Assembler::print_reference_tail() const
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::print_reference_tail() const
 {
     std::cout << "reference tail is " << kmer_of(reference_tail()) << std::endl;
 }
 
-void Assembler::print_reference_path() const
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::print_reference_path() const
 {
     print(reference_vertices_);
 }
 
-void Assembler::print(const Edge e) const
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::print(const Edge e) const
 {
-    std::cout << kmer_of(boost::source(e, graph_)) << "->" << kmer_of(boost::target(e, graph_));
+    std::cout << kmer_of(source(e, graph_)) << "->" << kmer_of(target(e, graph_));
 }
 
-void Assembler::print(const Path& path) const
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::print(const Path& path) const
 {
     assert(!path.empty());
     std::transform(std::cbegin(path), std::prev(std::cend(path)), std::ostream_iterator<Kmer> {std::cout, "->"},
@@ -2085,14 +2535,15 @@ void Assembler::print(const Path& path) const
     std::cout << kmer_of(path.back());
 }
 
-void Assembler::print_verbose(const Path& path) const
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::print_verbose(const Path& path) const
 {
     if (path.size() < 2) return;
     std::transform(std::cbegin(path), std::prev(std::cend(path)), std::next(std::cbegin(path)),
                    std::ostream_iterator<std::string> {std::cout, "->"},
                    [this] (const auto& u, const auto& v) {
                        Edge e; bool good;
-                       std::tie(e, good) = boost::edge(u, v, graph_);
+                       std::tie(e, good) = edge(u, v, graph_);
                        assert(good);
                        auto result = static_cast<std::string>(this->kmer_of(v));
                        result += "(";
@@ -2105,7 +2556,8 @@ void Assembler::print_verbose(const Path& path) const
     std::cout << kmer_of(path.back());
 }
 
-void Assembler::print_dominator_tree() const
+template <typename KmerGraph>
+void Assembler::GraphAssembler<KmerGraph>::print_dominator_tree() const
 {
     const auto dom_tree = build_dominator_tree(reference_head());
     for (const auto& p : dom_tree) {
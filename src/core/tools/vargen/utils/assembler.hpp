@@ -14,6 +14,7 @@
 #include <tuple>
 #include <stdexcept>
 #include <iosfwd>
+#include <memory>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/optional.hpp>
@@ -21,6 +22,8 @@
 #include "concepts/equitable.hpp"
 #include "concepts/comparable.hpp"
 
+#include "compact_graph.hpp"
+
 namespace octopus { namespace coretools { class Assembler; }}
 
 namespace boost {
@@ -39,6 +42,12 @@ public:
     using BaseQualityVector = std::vector<std::uint8_t>;
     enum class Direction { forward, reverse };
     
+    // The graph representation. The adjacency_list backend is the original node based
+    // implementation and is kept for validation; both produce the same results. The compact
+    // backend does not reclaim removed k-mers until clear, so reads should all be inserted
+    // before pruning.
+    enum class Backend { adjacency_list, compact };
+    
     struct Variant;
     class NonCanonicalReferenceSequence;
     class NonUniqueReferenceSequence {};
@@ -47,6 +56,7 @@ public:
     {
         unsigned kmer_size;
         boost::optional<double> strand_tail_mass = boost::none;
+        Backend backend = Backend::compact;
     };
     
     Assembler() = delete;
@@ -56,10 +66,10 @@ public:
     
     Assembler(const Assembler&)            = delete;
     Assembler& operator=(const Assembler&) = delete;
-    Assembler(Assembler&&)                 = default;
-    Assembler& operator=(Assembler&&)      = default;
+    Assembler(Assembler&&);
+    Assembler& operator=(Assembler&&);
     
-    ~Assembler() = default;
+    ~Assembler();
     
     unsigned kmer_size() const noexcept;
     Parameters params() const;
@@ -156,172 +166,22 @@ private:
         bool is_reference = false;
     };
     
-    using KmerGraph = boost::adjacency_list<boost::listS, boost::listS, boost::bidirectionalS, GraphNode, GraphEdge>;
-    
-    using Vertex = boost::graph_traits<KmerGraph>::vertex_descriptor;
-    using Edge   = boost::graph_traits<KmerGraph>::edge_descriptor;
+    using AdjacencyListKmerGraph = boost::adjacency_list<boost::listS, boost::listS, boost::bidirectionalS, GraphNode, GraphEdge>;
+    using CompactKmerGraph       = CompactGraph<GraphNode, GraphEdge>;
     
-    using VertexIterator = boost::graph_traits<KmerGraph>::vertex_iterator;
-    using EdgeIterator   = boost::graph_traits<KmerGraph>::edge_iterator;
-    
-    using DominatorMap = std::unordered_map<Vertex, Vertex>;
-    
-    using Path = std::deque<Vertex>;
-    using EdgePath = std::vector<Edge>;
-    using PredecessorMap = std::unordered_map<Vertex, Vertex>;
-    
-    struct SubGraph
-    {
-        Vertex head, tail;
-        std::size_t reference_offset;
-    };
-    
-    using PathWeightDistribution = std::vector<float>;
-    
-    struct PathWeightStats
-    {
-        PathWeightDistribution distribution;
-        unsigned total, total_forward, total_reverse, min, max;
-        double mean, median, stdev;
-    };
+    class Impl;
+    template <typename KmerGraph> class GraphAssembler;
     
     Parameters params_;
+    std::unique_ptr<Impl> impl_;
     
-    std::deque<Kmer> reference_kmers_;
-    std::size_t reference_head_position_;
-    
-    KmerGraph graph_;
-    
-    std::unordered_map<Kmer, Vertex, KmerHash> vertex_cache_;
-    Path reference_vertices_;
-    std::deque<Edge> reference_edges_;
-    
-    // methods
-    
-    void insert_reference_into_empty_graph(const NucleotideSequence& reference);
-    void insert_reference_into_populated_graph(const NucleotideSequence& reference);
-    bool contains_kmer(const Kmer& kmer) const noexcept;
-    std::size_t count_kmer(const Kmer& kmer) const noexcept;
-    std::size_t reference_size() const noexcept;
-    void regenerate_vertex_indices();
-    bool is_reference_unique_path() const;
-    Vertex null_vertex() const;
-    boost::optional<Vertex> add_vertex(const Kmer& kmer, bool is_reference = false);
-    void remove_vertex(Vertex v);
-    void clear_and_remove_vertex(Vertex v);
-    void clear_and_remove_all(const std::unordered_set<Vertex>& vertices);
-    Edge add_edge(Vertex u, Vertex v,
-                  GraphEdge::WeightType weight, GraphEdge::WeightType forward_weight,
-                  int base_quality_sum,
-                  bool is_reference = false, bool is_artificial = false);
-    Edge add_reference_edge(Vertex u, Vertex v);
-    void remove_edge(Vertex u, Vertex v);
-    void remove_edge(Edge e);
-    void increment_weight(Edge e, bool is_forward, int base_quality);
-    void set_vertex_reference(Vertex v);
-    void set_vertex_reference(const Kmer& kmer);
-    void set_edge_reference(Edge e);
-    const Kmer& kmer_of(Vertex v) const;
-    char front_base_of(Vertex v) const;
-    char back_base_of(Vertex v) const;
-    const Kmer& source_kmer_of(Edge e) const;
-    const Kmer& target_kmer_of(Edge e) const;
-    bool is_reference(Vertex v) const;
-    bool is_source_reference(Edge e) const;
-    bool is_target_reference(Edge e) const;
-    bool is_reference(Edge e) const;
-    bool is_artificial(Edge e) const;
-    bool is_reference_empty() const noexcept;
-    Vertex reference_head() const;
-    Vertex reference_tail() const;
-    Vertex next_reference(Vertex u) const;
-    Vertex prev_reference(Vertex v) const;
-    bool is_dangling_branch(Vertex v) const;
-    boost::optional<Vertex> find_joining_kmer(Vertex v) const;
-    std::size_t num_reference_kmers() const;
-    NucleotideSequence make_sequence(const Path& path) const;
-    NucleotideSequence make_reference(Vertex from, Vertex to) const;
-    void remove_path(const Path& path);
-    bool is_bridge(Vertex v) const;
-    bool is_reference_bridge(Vertex v) const;
-    Path::const_iterator is_bridge_until(Path::const_iterator first, Path::const_iterator last) const;
-    Path::const_iterator is_bridge_until(const Path& path) const;
-    bool is_bridge(Path::const_iterator first, Path::const_iterator last) const;
-    bool is_bridge(const Path& path) const;
-    std::pair<bool, Vertex> is_bridge_to_reference(Vertex from) const;
-    bool joins_reference_only(Vertex v) const;
-    bool joins_reference_only(Path::const_iterator first, Path::const_iterator last) const;
-    bool is_trivial_cycle(Edge e) const;
-    bool graph_has_trivial_cycle() const;
-    bool graph_has_nontrivial_cycle() const;
-    void remove_trivial_nonreference_cycles();
-    void remove_nontrivial_nonreference_cycles();
-    void remove_all_nonreference_cycles(bool break_chains);
-    bool is_simple_deletion(Edge e) const;
-    bool is_on_path(Edge e, const Path& path) const;
-    bool connects_to_path(Edge e, const Path& path) const;
-    bool is_dependent_on_path(Edge e, const Path& path) const;
-    GraphEdge::WeightType weight(const Path& path) const;
-    GraphEdge::WeightType max_weight(const Path& path) const;
-    unsigned count_low_weights(const Path& path, unsigned low_weight) const;
-    bool has_low_weight_flanks(const Path& path, unsigned low_weight) const;
-    unsigned count_low_weight_flanks(const Path& path, unsigned low_weight) const;
-    PathWeightStats compute_weight_stats(const Path& path) const;
-    GraphEdge::WeightType sum_source_in_edge_weight(Edge e) const;
-    GraphEdge::WeightType sum_target_out_edge_weight(Edge e) const;
-    bool all_in_edges_low_weight(Vertex v, unsigned min_weight) const;
-    bool all_out_edges_low_weight(Vertex v, unsigned min_weight) const;
-    std::size_t low_weight_out_degree(Vertex v, unsigned min_weight) const;
-    std::size_t low_weight_in_degree(Vertex v, unsigned min_weight) const;
-    bool is_low_weight_source(Vertex v, unsigned min_weight) const;
-    bool is_low_weight_sink(Vertex v, unsigned min_weight) const;
-    bool is_low_weight(Vertex v, unsigned min_weight) const;
-    void remove_low_weight_edges(unsigned min_weight);
-    void remove_disconnected_vertices();
-    std::unordered_set<Vertex> find_reachable_kmers(Vertex from) const;
-    std::deque<Vertex> remove_vertices_that_cant_be_reached_from(Vertex v);
-    void remove_vertices_that_cant_reach(Vertex v);
-    void remove_vertices_past(Vertex v);
-    bool can_prune_reference_flanks() const;
-    void pop_reference_head();
-    void pop_reference_tail();
-    void prune_reference_flanks();
-    std::pair<Vertex, unsigned> find_bifurcation(Vertex from, Vertex to) const;
-    DominatorMap build_dominator_tree(Vertex from) const;
-    std::unordered_set<Vertex> extract_nondominants(Vertex from) const;
-    std::deque<Vertex> extract_nondominant_reference(const DominatorMap&) const;
-    void set_out_edge_transition_scores(Vertex v);
-    void set_all_edge_transition_scores_from(Vertex src);
-    void set_all_in_edge_transition_scores(Vertex v, GraphEdge::ScoreType score);
-    void block_all_in_edges(Vertex v);
-    PredecessorMap find_shortest_scoring_paths(Vertex from, bool use_weights = false) const;
-    bool is_on_path(Vertex v, const PredecessorMap& predecessors, Vertex from) const;
-    bool is_on_path(Edge e, const PredecessorMap& predecessors, Vertex from) const;
-    Path extract_full_path(const PredecessorMap& predecessors, Vertex from) const;
-    std::tuple<Assembler::Vertex, Assembler::Vertex, unsigned>
-    backtrack_until_nonreference(const PredecessorMap& predecessors, Vertex from) const;
-    Path extract_nonreference_path(const PredecessorMap& predecessors, Vertex from) const;
-    std::vector<EdgePath> extract_k_shortest_paths(Vertex src, Vertex dst, unsigned k) const;
-    Edge head_edge(const Path& path) const;
-    int head_mean_base_quality(const Path& path) const;
-    int tail_mean_base_quality(const Path& path) const;
-    double bubble_score(const Path& path) const;
-    std::deque<Variant> extract_bubble_paths(unsigned max_bubbles, double min_bubble_score);
-    std::deque<SubGraph> find_independent_subgraphs() const;
-    std::deque<Variant> extract_bubble_paths_with_ksp(unsigned k, double min_bubble_score);
-    
-    // for debug
+    template <typename... Args>
+    static std::unique_ptr<Impl> make_impl(Parameters params, const Args&... args);
     
     friend std::ostream& operator<<(std::ostream& os, const Kmer& kmer);
-    void print_reference_head() const;
-    void print_reference_tail() const;
-    void print_reference_path() const;
-    void print(Edge e) const;
-    void print(const Path& path) const;
-    void print_verbose(const Path& path) const;
-    void print_dominator_tree() const;
     
-    friend struct boost::property_map<KmerGraph, boost::vertex_index_t>;
+    friend struct boost::property_map<AdjacencyListKmerGraph, boost::vertex_index_t>;
+    friend struct boost::property_map<CompactKmerGraph, boost::vertex_index_t>;
     template <typename G>
     friend decltype(auto) boost::get(boost::vertex_index_t, G&);
     template <typename G>
@@ -365,10 +225,17 @@ namespace boost {
 using Assembler = octopus::coretools::Assembler;
 
 template <>
-struct property_map<Assembler::KmerGraph, vertex_index_t>
+struct property_map<Assembler::AdjacencyListKmerGraph, vertex_index_t>
+{
+    using type       = property_map<Assembler::AdjacencyListKmerGraph, std::size_t Assembler::GraphNode::*>::type;
+    using const_type = property_map<Assembler::AdjacencyListKmerGraph, std::size_t Assembler::GraphNode::*>::const_type;
+};
+
+template <>
+struct property_map<Assembler::CompactKmerGraph, vertex_index_t>
 {
-    using type       = property_map<Assembler::KmerGraph, std::size_t Assembler::GraphNode::*>::type;
-    using const_type = property_map<Assembler::KmerGraph, std::size_t Assembler::GraphNode::*>::const_type;
+    using type       = property_map<Assembler::CompactKmerGraph, std::size_t Assembler::GraphNode::*>::type;
+    using const_type = property_map<Assembler::CompactKmerGraph, std::size_t Assembler::GraphNode::*>::const_type;
 };
 
 template <typename G>
@@ -0,0 +1,692 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef compact_graph_hpp
+#define compact_graph_hpp
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <type_traits>
+#include <functional>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+namespace octopus { namespace coretools {
+
+/*
+    A bidirectional graph with bundled vertex and edge properties that stores all vertices
+    and edges in two flat arrays, rather than allocating a node per vertex and per edge like
+    boost::adjacency_list<listS, listS, bidirectionalS>.
+
+    Descriptors are array indices. The in and out edges of each vertex are intrusive linked
+    lists threaded through the edge array, so vertex, edge, in-edge and out-edge iteration
+    orders are insertion orders, just like the list based adjacency_list. Live vertices and
+    edges are also threaded onto their own lists, so whole graph iteration is linear in the
+    number of live elements. Removed slots are unlinked but never reused (until clear), so
+    descriptors of live elements are stable and stale descriptors never alias new elements.
+    Storage is therefore proportional to the number of elements added since the last clear,
+    which suits graphs that are built and then only pruned, like the Assembler k-mer graph: all
+    reads are inserted before any pruning, and afterwards the only additions are dangling branch
+    joins (at most one edge per vertex), so the array sizes never exceed the peak graph size by
+    more than that. Graphs that repeatedly add and remove elements should be rebuilt instead.
+
+    Models the BGL VertexListGraph, EdgeListGraph, BidirectionalGraph, AdjacencyGraph and
+    MutableGraph concepts, and PropertyGraph for bundled member properties. The BGL free
+    functions are in this namespace and are found by argument dependent lookup.
+ */
+template <typename VertexProperty, typename EdgeProperty>
+class CompactGraph
+{
+    using Index = std::uint32_t;
+    static constexpr Index nullIndex {std::numeric_limits<Index>::max()};
+
+public:
+    using vertex_descriptor = Index;
+
+    struct edge_descriptor
+    {
+        Index source = nullIndex, target = nullIndex, index = nullIndex;
+        friend bool operator==(const edge_descriptor& lhs, const edge_descriptor& rhs) noexcept { return lhs.index == rhs.index; }
+        friend bool operator!=(const edge_descriptor& lhs, const edge_descriptor& rhs) noexcept { return lhs.index != rhs.index; }
+        friend bool operator<(const edge_descriptor& lhs, const edge_descriptor& rhs) noexcept { return lhs.index < rhs.index; }
+    };
+
+    class vertex_iterator;
+    class edge_iterator;
+    class out_edge_iterator;
+    class in_edge_iterator;
+    class adjacency_iterator;
+    class inv_adjacency_iterator;
+
+    using directed_category      = boost::bidirectional_tag;
+    using edge_parallel_category = boost::allow_parallel_edge_tag;
+    struct traversal_category
+    : public boost::bidirectional_graph_tag
+    , public boost::adjacency_graph_tag
+    , public boost::vertex_list_graph_tag
+    , public boost::edge_list_graph_tag {};
+
+    using vertices_size_type = std::size_t;
+    using edges_size_type    = std::size_t;
+    using degree_size_type   = std::size_t;
+
+    using vertex_bundled = VertexProperty;
+    using edge_bundled   = EdgeProperty;
+    using graph_bundled  = boost::no_property;
+
+    static vertex_descriptor null_vertex() noexcept { return nullIndex; }
+
+    CompactGraph() = default;
+
+    CompactGraph(const CompactGraph&)            = default;
+    CompactGraph& operator=(const CompactGraph&) = default;
+    CompactGraph(CompactGraph&&)                 = default;
+    CompactGraph& operator=(CompactGraph&&)      = default;
+
+    ~CompactGraph() = default;
+
+    VertexProperty& operator[](vertex_descriptor v) noexcept { return vertices_[v].property; }
+    const VertexProperty& operator[](vertex_descriptor v) const noexcept { return vertices_[v].property; }
+    EdgeProperty& operator[](const edge_descriptor& e) noexcept { return edges_[e.index].property; }
+    const EdgeProperty& operator[](const edge_descriptor& e) const noexcept { return edges_[e.index].property; }
+
+    std::size_t num_vertices() const noexcept { return num_vertices_; }
+    std::size_t num_edges() const noexcept { return num_edges_; }
+    std::size_t out_degree(vertex_descriptor v) const noexcept { return vertices_[v].out_degree; }
+    std::size_t in_degree(vertex_descriptor v) const noexcept { return vertices_[v].in_degree; }
+
+    std::pair<vertex_iterator, vertex_iterator> vertex_range() const noexcept;
+    std::pair<edge_iterator, edge_iterator> edge_range() const noexcept;
+    std::pair<out_edge_iterator, out_edge_iterator> out_edge_range(vertex_descriptor u) const noexcept;
+    std::pair<in_edge_iterator, in_edge_iterator> in_edge_range(vertex_descriptor v) const noexcept;
+    std::pair<adjacency_iterator, adjacency_iterator> adjacency_range(vertex_descriptor u) const noexcept;
+    std::pair<inv_adjacency_iterator, inv_adjacency_iterator> inv_adjacency_range(vertex_descriptor v) const noexcept;
+
+    vertex_descriptor add_vertex(VertexProperty property);
+    void remove_vertex(vertex_descriptor v) noexcept;
+
+    edge_descriptor add_edge(vertex_descriptor u, vertex_descriptor v, EdgeProperty property);
+    void remove_edge(const edge_descriptor& e) noexcept;
+
+    template <typename Predicate> void remove_out_edge_if(vertex_descriptor u, Predicate pred);
+    template <typename Predicate> void remove_in_edge_if(vertex_descriptor v, Predicate pred);
+    template <typename Predicate> void remove_edge_if(Predicate pred);
+
+    void clear() noexcept;
+
+private:
+    struct VertexRecord
+    {
+        VertexRecord(VertexProperty property) : property {std::move(property)} {}
+        VertexProperty property;
+        Index prev = nullIndex, next = nullIndex;
+        Index first_out = nullIndex, last_out = nullIndex, first_in = nullIndex, last_in = nullIndex;
+        Index out_degree = 0, in_degree = 0;
+    };
+    struct EdgeRecord
+    {
+        EdgeRecord(Index source, Index target, EdgeProperty property)
+        : property {std::move(property)}, source {source}, target {target} {}
+        EdgeProperty property;
+        Index source, target;
+        Index prev = nullIndex, next = nullIndex;
+        Index prev_out = nullIndex, next_out = nullIndex, prev_in = nullIndex, next_in = nullIndex;
+    };
+
+    std::vector<VertexRecord> vertices_;
+    std::vector<EdgeRecord> edges_;
+    Index first_vertex_ = nullIndex, last_vertex_ = nullIndex, first_edge_ = nullIndex, last_edge_ = nullIndex;
+    std::size_t num_vertices_ = 0, num_edges_ = 0;
+
+    edge_descriptor make_edge(Index e) const noexcept { return {edges_[e].source, edges_[e].target, e}; }
+    template <typename Records> static void link(Records& records, Index i, Index& first, Index& last) noexcept;
+    template <typename Records> static void unlink(Records& records, Index i, Index& first, Index& last) noexcept;
+};
+
+// iterators
+
+template <typename V, typename E>
+class CompactGraph<V, E>::vertex_iterator
+: public boost::iterator_facade<vertex_iterator, vertex_descriptor, std::forward_iterator_tag, vertex_descriptor>
+{
+public:
+    vertex_iterator() = default;
+    vertex_iterator(const CompactGraph* g, Index v) noexcept : g_ {g}, v_ {v} {}
+private:
+    friend class boost::iterator_core_access;
+    const CompactGraph* g_ = nullptr;
+    Index v_ = nullIndex;
+    vertex_descriptor dereference() const noexcept { return v_; }
+    bool equal(const vertex_iterator& other) const noexcept { return v_ == other.v_; }
+    void increment() noexcept { v_ = g_->vertices_[v_].next; }
+};
+
+template <typename V, typename E>
+class CompactGraph<V, E>::edge_iterator
+: public boost::iterator_facade<edge_iterator, edge_descriptor, std::forward_iterator_tag, edge_descriptor>
+{
+public:
+    edge_iterator() = default;
+    edge_iterator(const CompactGraph* g, Index e) noexcept : g_ {g}, e_ {e} {}
+private:
+    friend class boost::iterator_core_access;
+    const CompactGraph* g_ = nullptr;
+    Index e_ = nullIndex;
+    edge_descriptor dereference() const noexcept { return g_->make_edge(e_); }
+    bool equal(const edge_iterator& other) const noexcept { return e_ == other.e_; }
+    void increment() noexcept { e_ = g_->edges_[e_].next; }
+};
+
+template <typename V, typename E>
+class CompactGraph<V, E>::out_edge_iterator
+: public boost::iterator_facade<out_edge_iterator, edge_descriptor, std::forward_iterator_tag, edge_descriptor>
+{
+public:
+    out_edge_iterator() = default;
+    out_edge_iterator(const CompactGraph* g, Index e) noexcept : g_ {g}, e_ {e} {}
+private:
+    friend class boost::iterator_core_access;
+    const CompactGraph* g_ = nullptr;
+    Index e_ = nullIndex;
+    edge_descriptor dereference() const noexcept { return g_->make_edge(e_); }
+    bool equal(const out_edge_iterator& other) const noexcept { return e_ == other.e_; }
+    void increment() noexcept { e_ = g_->edges_[e_].next_out; }
+};
+
+template <typename V, typename E>
+class CompactGraph<V, E>::in_edge_iterator
+: public boost::iterator_facade<in_edge_iterator, edge_descriptor, std::forward_iterator_tag, edge_descriptor>
+{
+public:
+    in_edge_iterator() = default;
+    in_edge_iterator(const CompactGraph* g, Index e) noexcept : g_ {g}, e_ {e} {}
+private:
+    friend class boost::iterator_core_access;
+    const CompactGraph* g_ = nullptr;
+    Index e_ = nullIndex;
+    edge_descriptor dereference() const noexcept { return g_->make_edge(e_); }
+    bool equal(const in_edge_iterator& other) const noexcept { return e_ == other.e_; }
+    void increment() noexcept { e_ = g_->edges_[e_].next_in; }
+};
+
+template <typename V, typename E>
+class CompactGraph<V, E>::adjacency_iterator
+: public boost::iterator_facade<adjacency_iterator, vertex_descriptor, std::forward_iterator_tag, vertex_descriptor>
+{
+public:
+    adjacency_iterator() = default;
+    adjacency_iterator(const CompactGraph* g, Index e) noexcept : g_ {g}, e_ {e} {}
+private:
+    friend class boost::iterator_core_access;
+    const CompactGraph* g_ = nullptr;
+    Index e_ = nullIndex;
+    vertex_descriptor dereference() const noexcept { return g_->edges_[e_].target; }
+    bool equal(const adjacency_iterator& other) const noexcept { return e_ == other.e_; }
+    void increment() noexcept { e_ = g_->edges_[e_].next_out; }
+};
+
+template <typename V, typename E>
+class CompactGraph<V, E>::inv_adjacency_iterator
+: public boost::iterator_facade<inv_adjacency_iterator, vertex_descriptor, std::forward_iterator_tag, vertex_descriptor>
+{
+public:
+    inv_adjacency_iterator() = default;
+    inv_adjacency_iterator(const CompactGraph* g, Index e) noexcept : g_ {g}, e_ {e} {}
+private:
+    friend class boost::iterator_core_access;
+    const CompactGraph* g_ = nullptr;
+    Index e_ = nullIndex;
+    vertex_descriptor dereference() const noexcept { return g_->edges_[e_].source; }
+    bool equal(const inv_adjacency_iterator& other) const noexcept { return e_ == other.e_; }
+    void increment() noexcept { e_ = g_->edges_[e_].next_in; }
+};
+
+// CompactGraph methods
+
+template <typename V, typename E>
+auto CompactGraph<V, E>::vertex_range() const noexcept -> std::pair<vertex_iterator, vertex_iterator>
+{
+    return {vertex_iterator {this, first_vertex_}, vertex_iterator {this, nullIndex}};
+}
+
+template <typename V, typename E>
+auto CompactGraph<V, E>::edge_range() const noexcept -> std::pair<edge_iterator, edge_iterator>
+{
+    return {edge_iterator {this, first_edge_}, edge_iterator {this, nullIndex}};
+}
+
+template <typename V, typename E>
+auto CompactGraph<V, E>::out_edge_range(const vertex_descriptor u) const noexcept -> std::pair<out_edge_iterator, out_edge_iterator>
+{
+    return {out_edge_iterator {this, vertices_[u].first_out}, out_edge_iterator {this, nullIndex}};
+}
+
+template <typename V, typename E>
+auto CompactGraph<V, E>::in_edge_range(const vertex_descriptor v) const noexcept -> std::pair<in_edge_iterator, in_edge_iterator>
+{
+    return {in_edge_iterator {this, vertices_[v].first_in}, in_edge_iterator {this, nullIndex}};
+}
+
+template <typename V, typename E>
+auto CompactGraph<V, E>::adjacency_range(const vertex_descriptor u) const noexcept -> std::pair<adjacency_iterator, adjacency_iterator>
+{
+    return {adjacency_iterator {this, vertices_[u].first_out}, adjacency_iterator {this, nullIndex}};
+}
+
+template <typename V, typename E>
+auto CompactGraph<V, E>::inv_adjacency_range(const vertex_descriptor v) const noexcept -> std::pair<inv_adjacency_iterator, inv_adjacency_iterator>
+{
+    return {inv_adjacency_iterator {this, vertices_[v].first_in}, inv_adjacency_iterator {this, nullIndex}};
+}
+
+template <typename V, typename E>
+typename CompactGraph<V, E>::vertex_descriptor CompactGraph<V, E>::add_vertex(V property)
+{
+    const auto v = static_cast<Index>(vertices_.size());
+    vertices_.emplace_back(std::move(property));
+    link(vertices_, v, first_vertex_, last_vertex_);
+    ++num_vertices_;
+    return v;
+}
+
+template <typename V, typename E>
+void CompactGraph<V, E>::remove_vertex(const vertex_descriptor v) noexcept
+{
+    // Like adjacency_list, requires that v has no edges
+    unlink(vertices_, v, first_vertex_, last_vertex_);
+    --num_vertices_;
+}
+
+template <typename V, typename E>
+typename CompactGraph<V, E>::edge_descriptor
+CompactGraph<V, E>::add_edge(const vertex_descriptor u, const vertex_descriptor v, E property)
+{
+    const auto e = static_cast<Index>(edges_.size());
+    edges_.emplace_back(u, v, std::move(property));
+    link(edges_, e, first_edge_, last_edge_);
+    auto& edge = edges_.back();
+    auto& source = vertices_[u];
+    edge.prev_out = source.last_out;
+    if (source.last_out != nullIndex) {
+        edges_[source.last_out].next_out = e;
+    } else {
+        source.first_out = e;
+    }
+    source.last_out = e;
+    ++source.out_degree;
+    auto& target = vertices_[v];
+    edge.prev_in = target.last_in;
+    if (target.last_in != nullIndex) {
+        edges_[target.last_in].next_in = e;
+    } else {
+        target.first_in = e;
+    }
+    target.last_in = e;
+    ++target.in_degree;
+    ++num_edges_;
+    return {u, v, e};
+}
+
+template <typename V, typename E>
+void CompactGraph<V, E>::remove_edge(const edge_descriptor& e) noexcept
+{
+    auto& edge = edges_[e.index];
+    auto& source = vertices_[edge.source];
+    if (edge.prev_out != nullIndex) {
+        edges_[edge.prev_out].next_out = edge.next_out;
+    } else {
+        source.first_out = edge.next_out;
+    }
+    if (edge.next_out != nullIndex) {
+        edges_[edge.next_out].prev_out = edge.prev_out;
+    } else {
+        source.last_out = edge.prev_out;
+    }
+    --source.out_degree;
+    auto& target = vertices_[edge.target];
+    if (edge.prev_in != nullIndex) {
+        edges_[edge.prev_in].next_in = edge.next_in;
+    } else {
+        target.first_in = edge.next_in;
+    }
+    if (edge.next_in != nullIndex) {
+        edges_[edge.next_in].prev_in = edge.prev_in;
+    } else {
+        target.last_in = edge.prev_in;
+    }
+    --target.in_degree;
+    unlink(edges_, e.index, first_edge_, last_edge_);
+    --num_edges_;
+}
+
+template <typename V, typename E>
+template <typename Predicate>
+void CompactGraph<V, E>::remove_out_edge_if(const vertex_descriptor u, Predicate pred)
+{
+    for (auto e = vertices_[u].first_out; e != nullIndex;) {
+        const auto next = edges_[e].next_out;
+        if (pred(make_edge(e))) remove_edge(make_edge(e));
+        e = next;
+    }
+}
+
+template <typename V, typename E>
+template <typename Predicate>
+void CompactGraph<V, E>::remove_in_edge_if(const vertex_descriptor v, Predicate pred)
+{
+    for (auto e = vertices_[v].first_in; e != nullIndex;) {
+        const auto next = edges_[e].next_in;
+        if (pred(make_edge(e))) remove_edge(make_edge(e));
+        e = next;
+    }
+}
+
+template <typename V, typename E>
+template <typename Predicate>
+void CompactGraph<V, E>::remove_edge_if(Predicate pred)
+{
+    for (auto e = first_edge_; e != nullIndex;) {
+        const auto next = edges_[e].next;
+        if (pred(make_edge(e))) remove_edge(make_edge(e));
+        e = next;
+    }
+}
+
+template <typename V, typename E>
+void CompactGraph<V, E>::clear() noexcept
+{
+    vertices_.clear();
+    edges_.clear();
+    first_vertex_ = last_vertex_ = first_edge_ = last_edge_ = nullIndex;
+    num_vertices_ = 0;
+    num_edges_ = 0;
+}
+
+template <typename V, typename E>
+template <typename Records>
+void CompactGraph<V, E>::link(Records& records, const Index i, Index& first, Index& last) noexcept
+{
+    records[i].prev = last;
+    if (last != nullIndex) {
+        records[last].next = i;
+    } else {
+        first = i;
+    }
+    last = i;
+}
+
+template <typename V, typename E>
+template <typename Records>
+void CompactGraph<V, E>::unlink(Records& records, const Index i, Index& first, Index& last) noexcept
+{
+    auto& record = records[i];
+    if (record.prev != nullIndex) {
+        records[record.prev].next = record.next;
+    } else {
+        first = record.next;
+    }
+    if (record.next != nullIndex) {
+        records[record.next].prev = record.prev;
+    } else {
+        last = record.prev;
+    }
+}
+
+// BGL interface
+
+template <typename V, typename E>
+auto source(const typename CompactGraph<V, E>::edge_descriptor& e, const CompactGraph<V, E>&) noexcept
+{
+    return e.source;
+}
+
+template <typename V, typename E>
+auto target(const typename CompactGraph<V, E>::edge_descriptor& e, const CompactGraph<V, E>&) noexcept
+{
+    return e.target;
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::vertex_iterator, typename CompactGraph<V, E>::vertex_iterator>
+vertices(const CompactGraph<V, E>& g) noexcept
+{
+    return g.vertex_range();
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::edge_iterator, typename CompactGraph<V, E>::edge_iterator>
+edges(const CompactGraph<V, E>& g) noexcept
+{
+    return g.edge_range();
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::out_edge_iterator, typename CompactGraph<V, E>::out_edge_iterator>
+out_edges(const typename CompactGraph<V, E>::vertex_descriptor u, const CompactGraph<V, E>& g) noexcept
+{
+    return g.out_edge_range(u);
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::in_edge_iterator, typename CompactGraph<V, E>::in_edge_iterator>
+in_edges(const typename CompactGraph<V, E>::vertex_descriptor v, const CompactGraph<V, E>& g) noexcept
+{
+    return g.in_edge_range(v);
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::adjacency_iterator, typename CompactGraph<V, E>::adjacency_iterator>
+adjacent_vertices(const typename CompactGraph<V, E>::vertex_descriptor u, const CompactGraph<V, E>& g) noexcept
+{
+    return g.adjacency_range(u);
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::inv_adjacency_iterator, typename CompactGraph<V, E>::inv_adjacency_iterator>
+inv_adjacent_vertices(const typename CompactGraph<V, E>::vertex_descriptor v, const CompactGraph<V, E>& g) noexcept
+{
+    return g.inv_adjacency_range(v);
+}
+
+template <typename V, typename E>
+std::size_t out_degree(const typename CompactGraph<V, E>::vertex_descriptor u, const CompactGraph<V, E>& g) noexcept
+{
+    return g.out_degree(u);
+}
+
+template <typename V, typename E>
+std::size_t in_degree(const typename CompactGraph<V, E>::vertex_descriptor v, const CompactGraph<V, E>& g) noexcept
+{
+    return g.in_degree(v);
+}
+
+template <typename V, typename E>
+std::size_t degree(const typename CompactGraph<V, E>::vertex_descriptor v, const CompactGraph<V, E>& g) noexcept
+{
+    return g.in_degree(v) + g.out_degree(v);
+}
+
+template <typename V, typename E>
+std::size_t num_vertices(const CompactGraph<V, E>& g) noexcept
+{
+    return g.num_vertices();
+}
+
+template <typename V, typename E>
+std::size_t num_edges(const CompactGraph<V, E>& g) noexcept
+{
+    return g.num_edges();
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::edge_descriptor, bool>
+edge(const typename CompactGraph<V, E>::vertex_descriptor u, const typename CompactGraph<V, E>::vertex_descriptor v,
+     const CompactGraph<V, E>& g) noexcept
+{
+    const auto p = out_edges(u, g);
+    for (auto itr = p.first; itr != p.second; ++itr) {
+        if ((*itr).target == v) return {*itr, true};
+    }
+    return {typename CompactGraph<V, E>::edge_descriptor {}, false};
+}
+
+template <typename V, typename E>
+typename CompactGraph<V, E>::vertex_descriptor
+add_vertex(const typename CompactGraph<V, E>::vertex_bundled& property, CompactGraph<V, E>& g)
+{
+    return g.add_vertex(property);
+}
+
+template <typename V, typename E>
+void remove_vertex(const typename CompactGraph<V, E>::vertex_descriptor v, CompactGraph<V, E>& g) noexcept
+{
+    g.remove_vertex(v);
+}
+
+template <typename V, typename E>
+void clear_out_edges(const typename CompactGraph<V, E>::vertex_descriptor u, CompactGraph<V, E>& g) noexcept
+{
+    g.remove_out_edge_if(u, [] (const auto&) { return true; });
+}
+
+template <typename V, typename E>
+void clear_in_edges(const typename CompactGraph<V, E>::vertex_descriptor v, CompactGraph<V, E>& g) noexcept
+{
+    g.remove_in_edge_if(v, [] (const auto&) { return true; });
+}
+
+template <typename V, typename E>
+void clear_vertex(const typename CompactGraph<V, E>::vertex_descriptor v, CompactGraph<V, E>& g) noexcept
+{
+    clear_out_edges(v, g);
+    clear_in_edges(v, g);
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::edge_descriptor, bool>
+add_edge(const typename CompactGraph<V, E>::vertex_descriptor u, const typename CompactGraph<V, E>::vertex_descriptor v,
+         const typename CompactGraph<V, E>::edge_bundled& property, CompactGraph<V, E>& g)
+{
+    return {g.add_edge(u, v, property), true};
+}
+
+template <typename V, typename E>
+std::pair<typename CompactGraph<V, E>::edge_descriptor, bool>
+add_edge(const typename CompactGraph<V, E>::vertex_descriptor u, const typename CompactGraph<V, E>::vertex_descriptor v,
+         CompactGraph<V, E>& g)
+{
+    return {g.add_edge(u, v, E {}), true};
+}
+
+template <typename V, typename E>
+void remove_edge(const typename CompactGraph<V, E>::edge_descriptor& e, CompactGraph<V, E>& g) noexcept
+{
+    g.remove_edge(e);
+}
+
+// Removes all (parallel) edges u -> v
+template <typename V, typename E>
+void remove_edge(const typename CompactGraph<V, E>::vertex_descriptor u, const typename CompactGraph<V, E>::vertex_descriptor v,
+                 CompactGraph<V, E>& g) noexcept
+{
+    g.remove_out_edge_if(u, [v] (const auto& e) { return e.target == v; });
+}
+
+template <typename V, typename E, typename Predicate>
+void remove_edge_if(Predicate pred, CompactGraph<V, E>& g)
+{
+    g.remove_edge_if(std::move(pred));
+}
+
+template <typename V, typename E, typename Predicate>
+void remove_out_edge_if(const typename CompactGraph<V, E>::vertex_descriptor u, Predicate pred, CompactGraph<V, E>& g)
+{
+    g.remove_out_edge_if(u, std::move(pred));
+}
+
+template <typename V, typename E, typename Predicate>
+void remove_in_edge_if(const typename CompactGraph<V, E>::vertex_descriptor v, Predicate pred, CompactGraph<V, E>& g)
+{
+    g.remove_in_edge_if(v, std::move(pred));
+}
+
+// Bundled property maps
+
+namespace detail {
+
+template <typename Graph, typename Descriptor, typename Bundle, typename T>
+class CompactGraphBundleMap : public boost::put_get_helper<T&, CompactGraphBundleMap<Graph, Descriptor, Bundle, T>>
+{
+public:
+    using key_type   = Descriptor;
+    using value_type = std::remove_const_t<T>;
+    using reference  = T&;
+    using category   = boost::lvalue_property_map_tag;
+
+    CompactGraphBundleMap() = default;
+    CompactGraphBundleMap(Graph* g, T Bundle::* member) noexcept : g_ {g}, member_ {member} {}
+
+    reference operator[](const key_type& key) const noexcept { return (*g_)[key].*member_; }
+
+private:
+    Graph* g_ = nullptr;
+    T Bundle::* member_ = nullptr;
+};
+
+template <typename V, typename E, typename Bundle>
+using CompactGraphBundleDescriptor = std::conditional_t<std::is_base_of<Bundle, V>::value,
+                                                        typename CompactGraph<V, E>::vertex_descriptor,
+                                                        typename CompactGraph<V, E>::edge_descriptor>;
+
+} // namespace detail
+
+template <typename V, typename E, typename T, typename Bundle>
+auto get(T Bundle::* member, CompactGraph<V, E>& g) noexcept
+{
+    using Descriptor = detail::CompactGraphBundleDescriptor<V, E, Bundle>;
+    return detail::CompactGraphBundleMap<CompactGraph<V, E>, Descriptor, Bundle, T> {&g, member};
+}
+
+template <typename V, typename E, typename T, typename Bundle>
+auto get(T Bundle::* member, const CompactGraph<V, E>& g) noexcept
+{
+    using Descriptor = detail::CompactGraphBundleDescriptor<V, E, Bundle>;
+    return detail::CompactGraphBundleMap<const CompactGraph<V, E>, Descriptor, Bundle, const T> {&g, member};
+}
+
+template <typename V, typename E, typename T, typename Bundle, typename Key>
+decltype(auto) get(T Bundle::* member, const CompactGraph<V, E>& g, const Key& key) noexcept
+{
+    return g[key].*member;
+}
+
+} // namespace coretools
+} // namespace octopus
+
+namespace boost {
+
+template <typename V, typename E, typename T, typename Bundle>
+struct property_map<octopus::coretools::CompactGraph<V, E>, T Bundle::*>
+{
+    using Descriptor = octopus::coretools::detail::CompactGraphBundleDescriptor<V, E, Bundle>;
+    using type       = octopus::coretools::detail::CompactGraphBundleMap<octopus::coretools::CompactGraph<V, E>, Descriptor, Bundle, T>;
+    using const_type = octopus::coretools::detail::CompactGraphBundleMap<const octopus::coretools::CompactGraph<V, E>, Descriptor, Bundle, const T>;
+};
+
+template <typename V, typename E, typename T, typename Bundle>
+struct property_map<const octopus::coretools::CompactGraph<V, E>, T Bundle::*>
+{
+    using Descriptor = octopus::coretools::detail::CompactGraphBundleDescriptor<V, E, Bundle>;
+    using type       = octopus::coretools::detail::CompactGraphBundleMap<const octopus::coretools::CompactGraph<V, E>, Descriptor, Bundle, const T>;
+    using const_type = type;
+};
+
+} // namespace boost
+
+#endif
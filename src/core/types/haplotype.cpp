@@ -223,7 +223,8 @@ CigarString Haplotype::cigar() const
     using Flag = CigarOperation::Flag;
     CigarString result {};
     if (!explicit_alleles_.empty()) {
-        const auto reference = reference_.get().fetch_sequence(GenomicRegion {region_.contig_name(), explicit_allele_region_});
+        ReferenceGenome::GeneticSequence buffer {};
+        const auto reference = reference_.get().fetch_sequence_view(GenomicRegion {region_.contig_name(), explicit_allele_region_}, buffer);
         result.reserve(2 * explicit_alleles_.size() + 2);
         auto curr_op_size = begin_distance(region_.contig_region(), explicit_allele_region_);
         auto curr_op_flag = Flag::sequenceMatch;
@@ -652,7 +653,8 @@ Haplotype copy(const Haplotype& haplotype, const std::vector<GenomicRegion>& reg
 bool is_reference(const Haplotype& haplotype)
 {
     if (haplotype.explicit_alleles_.empty()) return true;
-    return haplotype.sequence() == haplotype.reference_.get().fetch_sequence(haplotype.mapped_region());
+    ReferenceGenome::GeneticSequence buffer {};
+    return haplotype.sequence() == haplotype.reference_.get().fetch_sequence_view(haplotype.mapped_region(), buffer);
 }
 
 Haplotype expand(const Haplotype& haplotype, Haplotype::MappingDomain::Size n)
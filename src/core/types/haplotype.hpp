@@ -158,7 +158,9 @@ namespace detail {
                 const GenomicRegion::ContigName& contig,
                 const ContigRegion& region)
     {
-        result.append(reference.fetch_sequence(GenomicRegion {contig, region}));
+        ReferenceGenome::GeneticSequence buffer {};
+        const auto sequence = reference.fetch_sequence_view(GenomicRegion {contig, region}, buffer);
+        result.append(sequence.data(), sequence.size());
     }
 }
 
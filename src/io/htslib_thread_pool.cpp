@@ -0,0 +1,56 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "htslib_thread_pool.hpp"
+
+#include <mutex>
+#include <atomic>
+
+#include <htslib/thread_pool.h>
+
+namespace octopus { namespace io {
+
+namespace {
+
+struct SharedHtslibThreadPool
+{
+    std::mutex mutex;
+    htsThreadPool pool {nullptr, 0};
+    std::atomic<unsigned> size {0};
+};
+
+SharedHtslibThreadPool& shared_pool()
+{
+    // Deliberately leaked, see header
+    static auto result = new SharedHtslibThreadPool {};
+    return *result;
+}
+
+} // namespace
+
+void set_htslib_thread_pool_size(const unsigned num_threads)
+{
+    if (num_threads == 0) return;
+    auto& shared = shared_pool();
+    std::lock_guard<std::mutex> lock {shared.mutex};
+    if (shared.pool.pool != nullptr) return;
+    shared.pool.pool = hts_tpool_init(static_cast<int>(num_threads));
+    if (shared.pool.pool != nullptr) {
+        shared.size.store(num_threads, std::memory_order_release);
+    }
+}
+
+unsigned htslib_thread_pool_size() noexcept
+{
+    return shared_pool().size.load(std::memory_order_acquire);
+}
+
+void attach_htslib_thread_pool(htsFile* file) noexcept
+{
+    if (file == nullptr || htslib_thread_pool_size() == 0) return;
+    auto& shared = shared_pool();
+    hts_set_thread_pool(file, &shared.pool);
+}
+
+} // namespace io
+} // namespace octopus
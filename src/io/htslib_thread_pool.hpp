@@ -0,0 +1,31 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef htslib_thread_pool_hpp
+#define htslib_thread_pool_hpp
+
+#include <htslib/hts.h>
+
+namespace octopus { namespace io {
+
+/*
+ A single htslib thread pool shared by every htslib file handle in the process. It is used for
+ BGZF block (de)compression and CRAM slice (de)coding, so the number of htslib threads is bounded
+ no matter how many handles are open.
+ 
+ The pool is disabled until set_htslib_thread_pool_size is called with a non-zero size. The size
+ can only be set once, and the pool lives until the process exits as handles may still be open
+ during static destruction.
+ */
+
+void set_htslib_thread_pool_size(unsigned num_threads);
+
+unsigned htslib_thread_pool_size() noexcept;
+
+// Attaches the shared pool to the file if the pool is enabled. Has no effect on uncompressed files.
+void attach_htslib_thread_pool(htsFile* file) noexcept;
+
+} // namespace io
+} // namespace octopus
+
+#endif
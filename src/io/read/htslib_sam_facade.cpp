@@ -25,6 +25,8 @@
 #include "exceptions/malformed_file_error.hpp"
 #include "exceptions/unwritable_file_error.hpp"
 #include "utils/string_utils.hpp"
+#include "logging/logging.hpp"
+#include "io/htslib_thread_pool.hpp"
 #include "annotated_aligned_read.hpp"
 
 #include <iostream>
@@ -164,10 +166,35 @@ private:
 
 namespace {
 
+// Invalid records are skipped so one bad read does not fail the whole fetch. They are counted and reported
+// once per fetch, so a badly corrupted file cannot flood the log with a warning per record.
+class SkippedRecords
+{
+public:
+    void add(const InvalidBamRecord& e)
+    {
+        if (count_++ == 0) first_error_ = e.what();
+    }
+    
+    void warn(const GenomicRegion& region) const
+    {
+        if (count_ == 0) return;
+        logging::WarningLogger log {};
+        stream(log) << "Skipped " << count_ << " invalid read" << (count_ > 1 ? "s" : "") << " in " << region
+                    << " (" << first_error_ << (count_ > 1 ? ", and others)" : ")");
+    }
+    
+private:
+    std::size_t count_ = 0;
+    std::string first_error_;
+};
+
 auto open_hts_file(const boost::filesystem::path& file)
 {
     hts_verbose = 0; // disable hts error reporting
-    return sam_open(file.c_str(), "r");
+    auto result = sam_open(file.c_str(), "r");
+    attach_htslib_thread_pool(result);
+    return result;
 }
 
 bool is_cram(const boost::filesystem::path& file)
@@ -225,6 +252,37 @@ HtslibSamFacade::HtslibSamFacade(Path file_path)
     std::sort(std::begin(samples_), std::end(samples_));
 }
 
+HtslibSamFacade::HtslibSamFacade(const HtslibSamFacade& other, DuplicateTag)
+: file_path_ {other.file_path_}
+, hts_file_ {open_hts_file(file_path_), HtsFileDeleter {}}
+, hts_header_ {(hts_file_) ? sam_hdr_read(hts_file_.get()) : nullptr, HtsHeaderDeleter {}}
+, hts_index_ {}
+, hts_targets_ {other.hts_targets_}
+, contig_names_ {other.contig_names_}
+, sample_names_ {other.sample_names_}
+, samples_ {other.samples_}
+{
+    if (!hts_file_ || !hts_header_) {
+        if (is_cram(file_path_)) {
+            throw MalformedCRAM {file_path_};
+        } else {
+            throw MalformedBAM {file_path_};
+        }
+    }
+    if (!hts_file_->is_cram && other.hts_index_) {
+        hts_index_ = other.hts_index_;
+    } else {
+        hts_index_.reset(sam_index_load(hts_file_.get(), file_path_.c_str()), HtsIndexDeleter {});
+        if (!hts_index_) {
+            if (hts_file_->is_cram) {
+                throw MissingCRAMIndex {file_path_};
+            } else {
+                throw MissingBAMIndex {file_path_};
+            }
+        }
+    }
+}
+
 auto open_hts_writable_file(const boost::filesystem::path& path)
 {
     std::string mode {"[w]"};
@@ -234,7 +292,9 @@ auto open_hts_writable_file(const boost::filesystem::path& path)
     } else if (extension == "cram") {
         mode += "c";
     }
-    return sam_open(path.c_str(), mode.c_str());
+    auto result = sam_open(path.c_str(), mode.c_str());
+    attach_htslib_thread_pool(result);
+    return result;
 }
 
 HtslibSamFacade::HtslibSamFacade(Path sam_out, Path sam_template)
@@ -262,6 +322,11 @@ HtslibSamFacade::~HtslibSamFacade()
     }
 }
 
+std::unique_ptr<IReadReaderImpl> HtslibSamFacade::duplicate() const
+{
+    return std::unique_ptr<HtslibSamFacade> {new HtslibSamFacade {*this, DuplicateTag {}}};
+}
+
 bool HtslibSamFacade::is_open() const noexcept
 {
     return hts_file_ != nullptr && hts_header_ != nullptr && hts_index_ != nullptr;
@@ -269,10 +334,10 @@ bool HtslibSamFacade::is_open() const noexcept
 
 void HtslibSamFacade::open()
 {
-    hts_file_.reset(sam_open(file_path_.string().c_str(), "r"));
+    hts_file_.reset(open_hts_file(file_path_));
     if (hts_file_) {
         hts_header_.reset(sam_hdr_read(hts_file_.get()));
-        hts_index_.reset(sam_index_load(hts_file_.get(), file_path_.c_str()));
+        hts_index_.reset(sam_index_load(hts_file_.get(), file_path_.c_str()), HtsIndexDeleter {});
     }
 }
 
@@ -280,7 +345,7 @@ void HtslibSamFacade::close()
 {
     hts_file_.reset(nullptr);
     hts_header_.reset(nullptr);
-    hts_index_.reset(nullptr);
+    hts_index_.reset();
 }
 
 GenomicRegion::Size HtslibSamFacade::reference_size(const GenomicRegion::ContigName& contig) const
@@ -648,6 +713,7 @@ HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const GenomicRegion&
         return {{samples_.front(), fetch_reads(samples_.front(), region)}};
     }
     HtslibIterator it {*this, region};
+    SkippedRecords skipped {};
     for (const auto& sample : samples_) {
         auto p = result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
         try_reserve(p.first->second, defaultReserve_, defaultReserve_ / 10);
@@ -656,12 +722,12 @@ HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const GenomicRegion&
         try {
             result.at(sample_names_.at(it.read_group())).emplace_back(*it);
         } catch (InvalidBamRecord& e) {
-            // TODO: Just ignore? Could log or something.
-            //std::clog << "Warning: " << e.what() << std::endl;
+            skipped.add(e);
         } catch (...) {
             throw;
         }
     }
+    skipped.warn(region);
     return result;
 }
 
@@ -670,6 +736,7 @@ HtslibSamFacade::ReadContainer HtslibSamFacade::fetch_reads(const SampleName& sa
     if (!contains(samples_, sample)) return {};
     if (samples_.size() == 1) return fetch_all_reads(region);
     HtslibIterator it {*this, region};
+    SkippedRecords skipped {};
     ReadContainer result {};
     try_reserve(result, defaultReserve_, defaultReserve_ / 10);
     while (++it) {
@@ -677,12 +744,13 @@ HtslibSamFacade::ReadContainer HtslibSamFacade::fetch_reads(const SampleName& sa
             try {
                 result.emplace_back(*it);
             } catch (InvalidBamRecord& e) {
-                // TODO
+                skipped.add(e);
             } catch (...) {
                 throw;
             }
         }
     }
+    skipped.warn(region);
     return result;
 }
 
@@ -694,6 +762,7 @@ HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const std::vector<Sa
     }
     if (is_subset(samples_, samples)) return fetch_reads(region);
     HtslibIterator it {*this, region};
+    SkippedRecords skipped {};
     SampleReadMap result {samples.size()};
     for (const auto& sample : samples) {
         if (contains(samples_, sample)) {
@@ -710,12 +779,13 @@ HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const std::vector<Sa
             try {
                 result.at(sample_names_.at(it.read_group())).emplace_back(*it);
             } catch (InvalidBamRecord& e) {
-                // TODO
+                skipped.add(e);
             } catch (...) {
                 throw;
             }
         }
     }
+    skipped.warn(region);
     return result;
 }
 
@@ -779,17 +849,19 @@ void HtslibSamFacade::write(const AnnotatedAlignedRead& read)
 HtslibSamFacade::ReadContainer HtslibSamFacade::fetch_all_reads(const GenomicRegion& region) const
 {
     HtslibIterator it {*this, region};
+    SkippedRecords skipped {};
     ReadContainer result {};
     try_reserve(result, defaultReserve_, defaultReserve_ / 10);
     while (++it) {
         try {
             result.emplace_back(*it);
         } catch (InvalidBamRecord& e) {
-            // TODO
+            skipped.add(e);
         } catch (...) {
             throw;
         }
     }
+    skipped.warn(region);
     return result;
 }
 
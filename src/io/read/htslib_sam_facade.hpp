@@ -57,6 +57,9 @@ public:
     
     ~HtslibSamFacade() override;
     
+    // BAM duplicates share the loaded index; CRAM indices are tied to the file handle so are reloaded
+    std::unique_ptr<IReadReaderImpl> duplicate() const override;
+    
     bool is_open() const noexcept override;
     void open() override;
     void close() override;
@@ -180,7 +183,7 @@ private:
     
     std::unique_ptr<htsFile, HtsFileDeleter> hts_file_;
     std::unique_ptr<bam_hdr_t, HtsHeaderDeleter> hts_header_;
-    std::unique_ptr<hts_idx_t, HtsIndexDeleter> hts_index_;
+    std::shared_ptr<hts_idx_t> hts_index_;
     
     std::unordered_map<GenomicRegion::ContigName, HtsTid> hts_targets_;
     std::unordered_map<HtsTid, GenomicRegion::ContigName> contig_names_;
@@ -188,6 +191,10 @@ private:
     
     std::vector<SampleName> samples_;
     
+    struct DuplicateTag {};
+    
+    HtslibSamFacade(const HtslibSamFacade& other, DuplicateTag);
+    
     void init_maps();
     HtsTid get_htslib_target(const GenomicRegion::ContigName& contig) const;
     const GenomicRegion::ContigName& get_contig_name(HtsTid target) const;
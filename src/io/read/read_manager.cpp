@@ -18,9 +18,10 @@
 
 namespace octopus { namespace io {
 
-ReadManager::ReadManager(std::vector<Path> read_file_paths, unsigned max_open_files)
+ReadManager::ReadManager(std::vector<Path> read_file_paths, unsigned max_open_files, unsigned max_handles_per_file)
 : max_open_files_ {max_open_files}
 , num_files_ {static_cast<unsigned>(read_file_paths.size())}
+, handles_per_reader_ {1}
 , all_readers_single_sample_ {true}
 , closed_readers_ {
     std::make_move_iterator(std::begin(read_file_paths)),
@@ -30,6 +31,9 @@ ReadManager::ReadManager(std::vector<Path> read_file_paths, unsigned max_open_fi
 , possible_regions_in_readers_ {}
 , samples_ {}
 {
+    if (num_files_ > 0 && num_files_ <= max_open_files_) {
+        handles_per_reader_ = std::max(std::min(max_handles_per_file, max_open_files_ / num_files_), 1u);
+    }
     setup_reader_samples_and_regions();
     open_initial_files();
     samples_.reserve(reader_paths_containing_sample_.size());
@@ -60,6 +64,7 @@ ReadManager::ReadManager(ReadManager&& other)
     using std::move;
     max_open_files_                 = move(other.max_open_files_);
     num_files_                      = move(other.num_files_);
+    handles_per_reader_             = move(other.handles_per_reader_);
     all_readers_single_sample_      = move(other.all_readers_single_sample_);
     closed_readers_                 = move(other.closed_readers_);
     open_readers_                   = move(other.open_readers_);
@@ -76,6 +81,7 @@ ReadManager& ReadManager::operator=(ReadManager&& other)
         using std::move;
         max_open_files_                 = move(other.max_open_files_);
         num_files_                      = move(other.num_files_);
+        handles_per_reader_             = move(other.handles_per_reader_);
         all_readers_single_sample_      = move(other.all_readers_single_sample_);
         closed_readers_                 = move(other.closed_readers_);
         open_readers_                   = move(other.open_readers_);
@@ -94,6 +100,7 @@ void swap(ReadManager& lhs, ReadManager& rhs) noexcept
     using std::swap;
     swap(lhs.max_open_files_,                 rhs.max_open_files_);
     swap(lhs.num_files_,                      rhs.num_files_);
+    swap(lhs.handles_per_reader_,             rhs.handles_per_reader_);
     swap(lhs.all_readers_single_sample_,             rhs.all_readers_single_sample_);
     swap(lhs.closed_readers_,                 rhs.closed_readers_);
     swap(lhs.open_readers_,                   rhs.open_readers_);
@@ -551,7 +558,7 @@ void ReadManager::open_initial_files()
 
 ReadReader ReadManager::make_reader(const Path& reader_path) const
 {
-    return ReadReader {reader_path};
+    return ReadReader {reader_path, handles_per_reader_};
 }
 
 bool ReadManager::all_readers_are_open() const noexcept
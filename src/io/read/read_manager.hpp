@@ -40,7 +40,9 @@ public:
     
     ReadManager() = default;
     
-    ReadManager(std::vector<Path> read_file_paths, unsigned max_open_files);
+    // Each file may be given up to max_handles_per_file handles, so concurrent requests to the same file
+    // don't block each other, as long as the total number of handles stays within max_open_files.
+    ReadManager(std::vector<Path> read_file_paths, unsigned max_open_files, unsigned max_handles_per_file = 1);
     ReadManager(std::initializer_list<Path> read_file_paths);
     
     ReadManager(const ReadManager&)            = delete;
@@ -113,6 +115,7 @@ private:
     
     unsigned max_open_files_ = 200;
     unsigned num_files_;
+    unsigned handles_per_reader_ = 1;
     bool all_readers_single_sample_;
     
     mutable ClosedReaderSet closed_readers_;
@@ -77,43 +77,78 @@ auto make_reader(const boost::filesystem::path& file_path)
 
 } //namespace
 
-ReadReader::ReadReader(const boost::filesystem::path& file_path)
+class ReadReader::HandleLease
+{
+public:
+    HandleLease(const ReadReader& reader) : reader_ {reader}, impl_ {reader.acquire_impl()} {}
+    HandleLease(const HandleLease&) = delete;
+    HandleLease& operator=(const HandleLease&) = delete;
+    ~HandleLease() { reader_.release_impl(impl_); }
+    IReadReaderImpl* operator->() const noexcept { return impl_; }
+private:
+    const ReadReader& reader_;
+    IReadReaderImpl* impl_;
+};
+
+ReadReader::ReadReader(const boost::filesystem::path& file_path, const unsigned max_handles)
 : file_path_ {file_path}
+, max_handles_ {std::max(max_handles, 1u)}
 , impl_ {make_reader(file_path_)}
+, duplicate_impls_ {}
+, idle_impls_ {impl_.get()}
+, num_impls_ {1}
 {}
 
 ReadReader::ReadReader(ReadReader&& other)
 {
-    std::lock_guard<std::mutex> lock {other.mutex_};
+    std::unique_lock<std::mutex> lock {other.mutex_};
+    other.wait_until_all_idle(lock);
     file_path_ = std::move(other.file_path_);
+    max_handles_ = other.max_handles_;
     impl_  = std::move(other.impl_);
+    duplicate_impls_ = std::move(other.duplicate_impls_);
+    idle_impls_ = std::move(other.idle_impls_);
+    num_impls_ = other.num_impls_;
+    other.idle_impls_.clear();
+    other.num_impls_ = 0;
 }
 
 void swap(ReadReader& lhs, ReadReader& rhs) noexcept
 {
     if (&lhs == &rhs) return;
-    std::lock(lhs.mutex_, rhs.mutex_);
-    std::lock_guard<std::mutex> lock_lhs {lhs.mutex_, std::adopt_lock}, lock_rhs {rhs.mutex_, std::adopt_lock};
+    std::unique_lock<std::mutex> lock_lhs {lhs.mutex_, std::defer_lock}, lock_rhs {rhs.mutex_, std::defer_lock};
+    std::lock(lock_lhs, lock_rhs);
+    lhs.wait_until_all_idle(lock_lhs);
+    rhs.wait_until_all_idle(lock_rhs);
     using std::swap;
     swap(lhs.file_path_, rhs.file_path_);
+    swap(lhs.max_handles_, rhs.max_handles_);
     swap(lhs.impl_, rhs.impl_);
+    swap(lhs.duplicate_impls_, rhs.duplicate_impls_);
+    swap(lhs.idle_impls_, rhs.idle_impls_);
+    swap(lhs.num_impls_, rhs.num_impls_);
 }
 
 bool ReadReader::is_open() const noexcept
 {
     std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->is_open();
+    return impl_->is_open(); // only changed by open and close
 }
 
 void ReadReader::open()
 {
-    std::lock_guard<std::mutex> lock {mutex_};
+    std::unique_lock<std::mutex> lock {mutex_};
+    wait_until_all_idle(lock);
     impl_->open();
 }
 
 void ReadReader::close()
 {
-    std::lock_guard<std::mutex> lock {mutex_};
+    std::unique_lock<std::mutex> lock {mutex_};
+    wait_until_all_idle(lock);
+    duplicate_impls_.clear();
+    idle_impls_.assign({impl_.get()});
+    num_impls_ = 1;
     impl_->close();
 }
 
@@ -122,165 +157,210 @@ const ReadReader::Path& ReadReader::path() const noexcept
     return file_path_;
 }
 
+unsigned ReadReader::max_handles() const noexcept
+{
+    return max_handles_;
+}
+
 std::vector<ReadReader::SampleName> ReadReader::extract_samples() const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->extract_samples();
+    HandleLease impl {*this};
+    return impl->extract_samples();
 }
 
 std::vector<std::string> ReadReader::extract_read_groups(const SampleName& sample) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->extract_read_groups(sample);
+    HandleLease impl {*this};
+    return impl->extract_read_groups(sample);
 }
 
 std::vector<GenomicRegion::ContigName> ReadReader::reference_contigs() const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->reference_contigs();
+    HandleLease impl {*this};
+    return impl->reference_contigs();
 }
 
 GenomicRegion::Size ReadReader::reference_size(const GenomicRegion::ContigName& contig) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->reference_size(contig);
+    HandleLease impl {*this};
+    return impl->reference_size(contig);
 }
 
 boost::optional<std::vector<GenomicRegion::ContigName>> ReadReader::mapped_contigs() const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->mapped_contigs();
+    HandleLease impl {*this};
+    return impl->mapped_contigs();
 }
 
 boost::optional<std::vector<GenomicRegion>> ReadReader::mapped_regions() const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->mapped_regions();
+    HandleLease impl {*this};
+    return impl->mapped_regions();
 }
 
 bool ReadReader::iterate(const GenomicRegion& region,
                          AlignedReadReadVisitor visitor) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->iterate(region, visitor);
+    HandleLease impl {*this};
+    return impl->iterate(region, visitor);
 }
 
 bool ReadReader::iterate(const SampleName& sample,
                          const GenomicRegion& region,
                          AlignedReadReadVisitor visitor) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->iterate(sample, region, visitor);
+    HandleLease impl {*this};
+    return impl->iterate(sample, region, visitor);
 }
 
 bool ReadReader::iterate(const std::vector<SampleName>& samples,
                          const GenomicRegion& region,
                          AlignedReadReadVisitor visitor) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->iterate(samples, region, visitor);
+    HandleLease impl {*this};
+    return impl->iterate(samples, region, visitor);
 }
 
 bool ReadReader::iterate(const GenomicRegion& region,
                          ContigRegionVisitor visitor) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->iterate(region, visitor);
+    HandleLease impl {*this};
+    return impl->iterate(region, visitor);
 }
 
 bool ReadReader::iterate(const SampleName& sample,
                          const GenomicRegion& region,
                          ContigRegionVisitor visitor) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->iterate(sample, region, visitor);
+    HandleLease impl {*this};
+    return impl->iterate(sample, region, visitor);
 }
 
 bool ReadReader::iterate(const std::vector<SampleName>& samples,
                          const GenomicRegion& region,
                          ContigRegionVisitor visitor) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->iterate(samples, region, visitor);
+    HandleLease impl {*this};
+    return impl->iterate(samples, region, visitor);
 }
 
 bool ReadReader::has_reads(const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->has_reads(region);
+    HandleLease impl {*this};
+    return impl->has_reads(region);
 }
 
 bool ReadReader::has_reads(const SampleName& sample, const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->has_reads(sample, region);
+    HandleLease impl {*this};
+    return impl->has_reads(sample, region);
 }
 
 bool ReadReader::has_reads(const std::vector<SampleName>& samples,
                            const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->has_reads(samples, region);
+    HandleLease impl {*this};
+    return impl->has_reads(samples, region);
 }
 
 std::size_t ReadReader::count_reads(const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->count_reads(region);
+    HandleLease impl {*this};
+    return impl->count_reads(region);
 }
 
 std::size_t ReadReader::count_reads(const SampleName& sample, const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->count_reads(sample, region);
+    HandleLease impl {*this};
+    return impl->count_reads(sample, region);
 }
 
 std::size_t ReadReader::count_reads(const std::vector<SampleName>& samples, const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->count_reads(samples, region);
+    HandleLease impl {*this};
+    return impl->count_reads(samples, region);
 }
 
 ReadReader::PositionList
 ReadReader::extract_read_positions(const GenomicRegion& region, std::size_t max_coverage) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->extract_read_positions(region, max_coverage);
+    HandleLease impl {*this};
+    return impl->extract_read_positions(region, max_coverage);
 }
 
 ReadReader::PositionList
 ReadReader::extract_read_positions(const SampleName& sample, const GenomicRegion& region,
                                    std::size_t max_coverage) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->extract_read_positions(sample, region, max_coverage);
+    HandleLease impl {*this};
+    return impl->extract_read_positions(sample, region, max_coverage);
 }
 
 ReadReader::PositionList
 ReadReader::extract_read_positions(const std::vector<SampleName>& samples,
                                    const GenomicRegion& region, std::size_t max_coverage) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->extract_read_positions(samples, region, max_coverage);
+    HandleLease impl {*this};
+    return impl->extract_read_positions(samples, region, max_coverage);
 }
 
 ReadReader::SampleReadMap ReadReader::fetch_reads(const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->fetch_reads(region);
+    HandleLease impl {*this};
+    return impl->fetch_reads(region);
 }
 
 ReadReader::ReadContainer ReadReader::fetch_reads(const SampleName& sample, const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->fetch_reads(sample, region);
+    HandleLease impl {*this};
+    return impl->fetch_reads(sample, region);
 }
 
 ReadReader::SampleReadMap ReadReader::fetch_reads(const std::vector<SampleName>& samples,
                                                   const GenomicRegion& region) const
 {
-    std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->fetch_reads(samples, region);
+    HandleLease impl {*this};
+    return impl->fetch_reads(samples, region);
+}
+
+// private methods
+
+IReadReaderImpl* ReadReader::acquire_impl() const
+{
+    std::unique_lock<std::mutex> lock {mutex_};
+    if (idle_impls_.empty() && num_impls_ < max_handles_ && impl_->is_open()) {
+        ++num_impls_;
+        lock.unlock();
+        std::unique_ptr<IReadReaderImpl> duplicate {};
+        try {
+            duplicate = impl_->duplicate(); // only reads state that is immutable while the file is open
+        } catch (...) {
+            lock.lock();
+            --num_impls_;
+            throw;
+        }
+        lock.lock();
+        duplicate_impls_.push_back(std::move(duplicate));
+        return duplicate_impls_.back().get();
+    }
+    impl_released_.wait(lock, [this] { return !idle_impls_.empty(); });
+    const auto result = idle_impls_.back();
+    idle_impls_.pop_back();
+    return result;
+}
+
+void ReadReader::release_impl(IReadReaderImpl* impl) const noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        idle_impls_.push_back(impl);
+    }
+    impl_released_.notify_one();
+}
+
+void ReadReader::wait_until_all_idle(std::unique_lock<std::mutex>& lock) const
+{
+    impl_released_.wait(lock, [this] { return idle_impls_.size() == num_impls_; });
 }
 
 bool operator==(const ReadReader& lhs, const ReadReader& rhs)
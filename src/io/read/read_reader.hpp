@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
 #include <utility>
 #include <functional>
 
@@ -25,7 +26,11 @@ class AlignedRead;
 namespace io {
 
 /*
- ReadReader is a simple RAII threadsafe wrapper around a IReadReaderImpl
+ ReadReader is a simple RAII threadsafe wrapper around a IReadReaderImpl.
+ 
+ Up to max_handles independent handles to the file are opened on demand, so requests from
+ different threads can proceed concurrently. Each request uses one handle exclusively, and
+ waits for a handle to become free if they are all in use.
  */
 class ReadReader : public Equitable<ReadReader>
 {
@@ -41,7 +46,7 @@ public:
     
     ReadReader() = default;
     
-    ReadReader(const Path& file_path);
+    ReadReader(const Path& file_path, unsigned max_handles = 1);
     
     ReadReader(const ReadReader&)            = delete;
     ReadReader& operator=(const ReadReader&) = delete;
@@ -58,6 +63,8 @@ public:
     
     const Path& path() const noexcept;
     
+    unsigned max_handles() const noexcept;
+    
     std::vector<SampleName> extract_samples() const;
     
     std::vector<std::string> extract_read_groups(const SampleName& sample) const;
@@ -113,10 +120,21 @@ public:
                               const GenomicRegion& region) const;
     
 private:
+    class HandleLease;
+    
     Path file_path_;
+    unsigned max_handles_ = 1;
     std::unique_ptr<IReadReaderImpl> impl_;
+    mutable std::vector<std::unique_ptr<IReadReaderImpl>> duplicate_impls_;
+    mutable std::vector<IReadReaderImpl*> idle_impls_;
+    mutable unsigned num_impls_ = 0;
     
     mutable std::mutex mutex_;
+    mutable std::condition_variable impl_released_;
+    
+    IReadReaderImpl* acquire_impl() const;
+    void release_impl(IReadReaderImpl* impl) const noexcept;
+    void wait_until_all_idle(std::unique_lock<std::mutex>& lock) const;
 };
 
 bool operator==(const ReadReader& lhs, const ReadReader& rhs);
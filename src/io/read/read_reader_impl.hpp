@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <utility>
 #include <functional>
+#include <memory>
 
 #include <boost/optional.hpp>
 
@@ -30,6 +31,9 @@ public:
     
     virtual ~IReadReaderImpl() noexcept = default;
     
+    // Opens a new independent handle to the same file, which may share immutable state (e.g. the index)
+    virtual std::unique_ptr<IReadReaderImpl> duplicate() const = 0;
+    
     virtual bool is_open() const noexcept = 0;
     virtual void open() = 0;
     virtual void close() = 0;
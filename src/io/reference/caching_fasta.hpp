@@ -5,17 +5,12 @@
 #define caching_fasta_hpp
 
 #include <unordered_map>
-#include <map>
-#include <list>
+#include <vector>
 #include <cstddef>
-#include <mutex>
 #include <memory>
 
 #include <boost/filesystem/path.hpp>
-#include <boost/range/iterator_range_core.hpp>
-#include <boost/optional.hpp>
 
-#include "basics/contig_region.hpp"
 #include "reference_reader.hpp"
 #include "fasta.hpp"
 
@@ -33,13 +28,17 @@ namespace io {
     2) Reading more sequence than requested. The assumption here is that sequence requests are
        clustered in nearby regions.
  
-       There are two parameters that control how these 'extended' regions are predicted
+       There are two parameters that control how much extra sequence is read
  
        - locality bias: the probability the next request region will be nearby the current request region. 
                         If this value is low then there will be little performance gain from using CachingFasta.
  
        - forward bias: the probability the next request region will be to the right hand side of
                        the current request region.
+ 
+ The cache is a set of fixed size sequence blocks. Each contig has a table of atomic block pointers,
+ so cache hits are lock-free and any number of threads can read concurrently. Only inserting
+ newly read blocks (and evicting old ones, with the CLOCK algorithm) takes a lock.
  */
 
 class CachingFasta : public ReferenceReader
@@ -63,21 +62,29 @@ public:
     CachingFasta(CachingFasta&&);
     CachingFasta& operator=(CachingFasta&&);
     
+    ~CachingFasta() override;
+    
 private:
-    using ContigSequenceCache = std::map<ContigRegion, GeneticSequence>;
-    using SequenceCache       = std::unordered_map<std::string, ContigSequenceCache>;
-    using CacheIterator       = ContigSequenceCache::const_iterator;
-    using OverlapRange        = boost::iterator_range<CacheIterator>;
+    class BlockCache;
+    
+    struct ContigInfo
+    {
+        std::size_t id;
+        GenomicSize size;
+    };
+    
+    static constexpr GenomicSize maxBlockSize {1 << 16};
+    static constexpr GenomicSize minBlockSize {1 << 10};
+    static constexpr unsigned maxReadaheadBlocks {16};
     
     std::unique_ptr<ReferenceReader> fasta_;
-    std::unordered_map<ContigName, GenomicSize> contig_sizes_;
-    mutable SequenceCache sequence_cache_;
-    mutable std::list<GenomicRegion> recently_used_regions_; // TODO: also make into map of contigs?
+    std::unordered_map<ContigName, ContigInfo> contigs_;
     GenomicSize genome_size_;
     GenomicSize max_cache_size_;
-    mutable GenomicSize current_cache_size_;
     double locality_bias_, forward_bias_;
-    mutable std::mutex mutex_;
+    GenomicSize block_size_;
+    unsigned lhs_readahead_blocks_, rhs_readahead_blocks_;
+    std::unique_ptr<BlockCache> cache_;
     
     std::unique_ptr<ReferenceReader> do_clone() const override;
     bool do_is_open() const noexcept override;
@@ -87,25 +94,9 @@ private:
     GeneticSequence do_fetch_sequence(const GenomicRegion& region) const override;
     
     void setup_cache();
-    GenomicSize get_remaining_cache_size() const;
-    GenomicSize get_lhs_extension_size(const GenomicRegion& requested_region) const;
-    GenomicSize get_rhs_extension_size(const GenomicRegion& requested_region) const;
-    GenomicRegion get_region_to_fetch(const GenomicRegion& requested_region) const;
-    GenomicRegion get_new_contig_chunk(const GenomicRegion& requested_region) const;
-    GenomicRegion get_partial_contig_chunk(const GenomicRegion& requested_region) const;
-    bool is_contig_cached(const GenomicRegion& region) const;
-    boost::optional<CacheIterator> find_cached(const GenomicRegion& request_region) const noexcept;
-    void add_sequence_to_cache(GeneticSequence&& sequence, GenomicRegion&& region) const;
-    void register_cache_hit(const GenomicRegion& region) const;
-    OverlapRange overlap_range(const GenomicRegion& region) const;
-    void remove_from_sequence_cache(const GenomicRegion& region) const;
-    void remove_from_usage_cache(const GenomicRegion& region) const;
-    void replace_in_usage_cache(const GenomicRegion& from, const GenomicRegion& to) const;
-    void recache_overlapped_regions(const GeneticSequence& sequence, const GenomicRegion& region) const;
-    void reduce_cache(std::size_t target_size) const;
-    GeneticSequence get_subsequence(const ContigRegion& requested_region,
-                                    const ContigRegion& sequence_region,
-                                    const GeneticSequence& sequence) const;
+    std::size_t block_index(GenomicSize position) const noexcept;
+    GenomicSize block_begin(std::size_t block) const noexcept;
+    GenomicSize block_end(std::size_t block, const ContigInfo& contig) const noexcept;
 };
 
 } // namespace io
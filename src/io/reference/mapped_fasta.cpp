@@ -0,0 +1,298 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "mapped_fasta.hpp"
+
+#include <fstream>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <stdexcept>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "exceptions/missing_file_error.hpp"
+#include "exceptions/malformed_file_error.hpp"
+
+namespace octopus { namespace io {
+
+class MissingMappedFasta : public MissingFileError
+{
+    std::string do_where() const override
+    {
+        return "MappedFasta";
+    }
+public:
+    MissingMappedFasta(MappedFasta::Path file) : MissingFileError {std::move(file), "mapped fasta"} {}
+};
+
+class MalformedMappedFasta : public MalformedFileError
+{
+    std::string do_where() const override
+    {
+        return "MappedFasta";
+    }
+public:
+    MalformedMappedFasta(MappedFasta::Path file) : MalformedFileError {std::move(file), "mapped fasta"} {}
+};
+
+namespace {
+
+/*
+ File layout (integers are in native byte order):
+
+    magic                       char[8]
+    options                     uint8[4] (capitalisation, IUPAC, fill policy, unused)
+    reference name length       uint32
+    reference name              char[reference name length] (the name of the source fasta)
+    number of contigs           uint32
+    for each contig:
+        name length             uint32
+        name                    char[name length]
+        size                    uint64
+        sequence offset         uint64
+    contig sequences
+ */
+
+static constexpr char magic[8] {'O', 'C', 'T', 'O', 'M', 'A', 'P', '2'};
+static constexpr std::size_t optionsSize {4};
+
+auto encode(const Fasta::Options& options) noexcept
+{
+    return std::array<std::uint8_t, optionsSize> {{
+        static_cast<std::uint8_t>(options.base_transform_policy),
+        static_cast<std::uint8_t>(options.iupac_ambiguity_symbol_policy),
+        static_cast<std::uint8_t>(options.base_fill_policy),
+        0
+    }};
+}
+
+Fasta::Options decode(const std::array<std::uint8_t, optionsSize>& encoded) noexcept
+{
+    Fasta::Options result {};
+    result.base_transform_policy = static_cast<Fasta::Options::CapitalisationPolicy>(encoded[0]);
+    result.iupac_ambiguity_symbol_policy = static_cast<Fasta::Options::IUPACAmbiguitySymbolPolicy>(encoded[1]);
+    result.base_fill_policy = static_cast<Fasta::Options::BaseFillPolicy>(encoded[2]);
+    return result;
+}
+
+template <typename T>
+void write(std::ofstream& out, const T value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+class HeaderReader
+{
+public:
+    HeaderReader(const char* data, std::size_t size) : data_ {data}, size_ {size}, pos_ {0} {}
+
+    template <typename T>
+    bool read(T& value) noexcept
+    {
+        if (size_ - pos_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool read(std::string& value, const std::size_t length)
+    {
+        if (size_ - pos_ < length) return false;
+        value.assign(data_ + pos_, length);
+        pos_ += length;
+        return true;
+    }
+
+private:
+    const char* data_;
+    std::size_t size_, pos_;
+};
+
+} // namespace
+
+MappedFasta::MappedFasta(Path mapped_fasta_path)
+: path_ {std::move(mapped_fasta_path)}
+, reference_name_ {}
+, file_ {}
+, contigs_ {}
+, contig_names_ {}
+, options_ {}
+{
+    if (!boost::filesystem::exists(path_)) {
+        throw MissingMappedFasta {path_};
+    }
+    auto file = std::make_shared<boost::iostreams::mapped_file_source>(path_.string());
+    HeaderReader header {file->data(), file->size()};
+    std::array<char, sizeof(magic)> file_magic;
+    std::array<std::uint8_t, optionsSize> encoded_options;
+    std::uint32_t reference_name_length, num_contigs;
+    if (!header.read(file_magic) || !std::equal(std::cbegin(file_magic), std::cend(file_magic), std::cbegin(magic))
+        || !header.read(encoded_options) || !header.read(reference_name_length)
+        || !header.read(reference_name_, reference_name_length) || !header.read(num_contigs)) {
+        throw MalformedMappedFasta {path_};
+    }
+    options_ = decode(encoded_options);
+    auto contigs = std::make_shared<std::unordered_map<ContigName, Contig>>();
+    auto contig_names = std::make_shared<std::vector<ContigName>>();
+    contigs->reserve(num_contigs);
+    contig_names->reserve(num_contigs);
+    for (std::uint32_t i {0}; i < num_contigs; ++i) {
+        std::uint32_t name_length;
+        ContigName name;
+        std::uint64_t size, offset;
+        if (!header.read(name_length) || !header.read(name, name_length) || !header.read(size) || !header.read(offset)
+            || offset > file->size() || size > file->size() - offset) {
+            throw MalformedMappedFasta {path_};
+        }
+        contigs->emplace(name, Contig {static_cast<GenomicSize>(size), static_cast<std::size_t>(offset)});
+        contig_names->push_back(std::move(name));
+    }
+    file_ = std::move(file);
+    contigs_ = std::move(contigs);
+    contig_names_ = std::move(contig_names);
+}
+
+Fasta::Options MappedFasta::options() const noexcept
+{
+    return options_;
+}
+
+// virtual private methods
+
+std::unique_ptr<ReferenceReader> MappedFasta::do_clone() const
+{
+    return std::make_unique<MappedFasta>(*this);
+}
+
+bool MappedFasta::do_is_open() const noexcept
+{
+    return file_ && file_->is_open();
+}
+
+std::string MappedFasta::do_fetch_reference_name() const
+{
+    return reference_name_;
+}
+
+std::vector<MappedFasta::ContigName> MappedFasta::do_fetch_contig_names() const
+{
+    return *contig_names_;
+}
+
+MappedFasta::GenomicSize MappedFasta::do_fetch_contig_size(const ContigName& contig) const
+{
+    return get_contig(contig).size;
+}
+
+MappedFasta::GeneticSequence MappedFasta::do_fetch_sequence(const GenomicRegion& region) const
+{
+    const auto& contig = get_contig(region.contig_name());
+    GeneticSequence result {};
+    if (region.begin() < contig.size) {
+        const auto end = std::min(region.end(), contig.size);
+        result.assign(file_->data() + contig.offset + region.begin(), end - region.begin());
+    }
+    if (result.size() < size(region)) {
+        if (options_.base_fill_policy == Fasta::Options::BaseFillPolicy::throw_exception) {
+            throw std::runtime_error {"region " + to_string(region) + " is out of bounds in mapped fasta \""
+                                      + path_.string() + "\""};
+        }
+        if (options_.base_fill_policy == Fasta::Options::BaseFillPolicy::fill_with_ns) {
+            result.resize(size(region), 'N');
+        }
+    }
+    return result;
+}
+
+boost::optional<MappedFasta::SequenceView> MappedFasta::do_fetch_sequence_view(const GenomicRegion& region) const
+{
+    const auto& contig = get_contig(region.contig_name());
+    if (region.end() > contig.size) return boost::none; // the fill policy may apply
+    return SequenceView {file_->data() + contig.offset + region.begin(), size(region)};
+}
+
+// non-virtual private methods
+
+const MappedFasta::Contig& MappedFasta::get_contig(const ContigName& contig) const
+{
+    const auto itr = contigs_->find(contig);
+    if (itr == std::cend(*contigs_)) {
+        throw std::runtime_error {"contig \"" + contig + "\" not found in mapped fasta \"" + path_.string() + "\""};
+    }
+    return itr->second;
+}
+
+// non-member methods
+
+void make_mapped_fasta(const Fasta::Path& fasta_path, const MappedFasta::Path& mapped_fasta_path,
+                       const Fasta::Options options)
+{
+    namespace fs = boost::filesystem;
+    static constexpr GenomicRegion::Size maxChunkSize {1u << 24};
+    const Fasta fasta {fasta_path, options};
+    const auto reference_name = fasta.fetch_reference_name();
+    const auto contig_names = fasta.fetch_contig_names();
+    std::vector<std::uint64_t> contig_sizes(contig_names.size());
+    std::uint64_t offset {sizeof(magic) + optionsSize + sizeof(std::uint32_t) + reference_name.size() + sizeof(std::uint32_t)};
+    for (std::size_t i {0}; i < contig_names.size(); ++i) {
+        contig_sizes[i] = fasta.fetch_contig_size(contig_names[i]);
+        offset += sizeof(std::uint32_t) + contig_names[i].size() + 2 * sizeof(std::uint64_t);
+    }
+    auto temp_path = mapped_fasta_path;
+    temp_path += fs::unique_path(".%%%%-%%%%-%%%%.tmp");
+    try {
+        std::ofstream out {temp_path.string(), std::ios::binary | std::ios::trunc};
+        out.exceptions(std::ios::failbit | std::ios::badbit);
+        out.write(magic, sizeof(magic));
+        for (const auto byte : encode(options)) write(out, byte);
+        write(out, static_cast<std::uint32_t>(reference_name.size()));
+        out.write(reference_name.data(), reference_name.size());
+        write(out, static_cast<std::uint32_t>(contig_names.size()));
+        for (std::size_t i {0}; i < contig_names.size(); ++i) {
+            write(out, static_cast<std::uint32_t>(contig_names[i].size()));
+            out.write(contig_names[i].data(), contig_names[i].size());
+            write(out, contig_sizes[i]);
+            write(out, offset);
+            offset += contig_sizes[i];
+        }
+        for (std::size_t i {0}; i < contig_names.size(); ++i) {
+            const auto contig_size = static_cast<GenomicRegion::Size>(contig_sizes[i]);
+            for (GenomicRegion::Position begin {0}, end; begin < contig_size; begin = end) {
+                end = begin + std::min(maxChunkSize, contig_size - begin);
+                const auto chunk = fasta.fetch_sequence(GenomicRegion {contig_names[i], begin, end});
+                if (chunk.size() != end - begin) {
+                    throw MalformedMappedFasta {fasta_path};
+                }
+                out.write(chunk.data(), chunk.size());
+            }
+        }
+        out.close();
+        fs::rename(temp_path, mapped_fasta_path);
+    } catch (...) {
+        boost::system::error_code ec;
+        fs::remove(temp_path, ec);
+        throw;
+    }
+}
+
+bool is_mapped_fasta_current(const MappedFasta::Path& mapped_fasta_path, const Fasta::Path& fasta_path,
+                             const Fasta::Options options)
+{
+    namespace fs = boost::filesystem;
+    try {
+        if (!fs::exists(mapped_fasta_path) || fs::last_write_time(mapped_fasta_path) < fs::last_write_time(fasta_path)) {
+            return false;
+        }
+        return encode(MappedFasta {mapped_fasta_path}.options()) == encode(options);
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace io
+} // namespace octopus
@@ -0,0 +1,97 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef mapped_fasta_hpp
+#define mapped_fasta_hpp
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <memory>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+
+#include "reference_reader.hpp"
+#include "fasta.hpp"
+
+namespace boost { namespace iostreams { class mapped_file_source; } }
+
+namespace octopus {
+
+class GenomicRegion;
+
+namespace io {
+
+/*
+ MappedFasta memory maps a preprocessed copy of a fasta file, which holds each contig sequence
+ contiguously (i.e. without line breaks) with the Fasta base transforms already applied.
+
+ Sequence requests never touch the original fasta, so there is no locking, and views of the
+ mapped sequence can be returned without any copying. Clones share the same mapping.
+
+ The preprocessed file is made once from the fasta and its index with make_mapped_fasta.
+ */
+class MappedFasta : public ReferenceReader
+{
+public:
+    using Path = boost::filesystem::path;
+
+    using ContigName      = ReferenceReader::ContigName;
+    using GenomicSize     = ReferenceReader::GenomicSize;
+    using GeneticSequence = ReferenceReader::GeneticSequence;
+    using SequenceView    = ReferenceReader::SequenceView;
+
+    MappedFasta() = delete;
+
+    MappedFasta(Path mapped_fasta_path);
+
+    MappedFasta(const MappedFasta&)            = default;
+    MappedFasta& operator=(const MappedFasta&) = default;
+    MappedFasta(MappedFasta&&)                 = default;
+    MappedFasta& operator=(MappedFasta&&)      = default;
+
+    ~MappedFasta() override = default;
+
+    // The Fasta options the mapped sequence was made with
+    Fasta::Options options() const noexcept;
+
+private:
+    struct Contig
+    {
+        GenomicSize size;
+        std::size_t offset;
+    };
+
+    Path path_;
+    std::string reference_name_;
+    std::shared_ptr<const boost::iostreams::mapped_file_source> file_;
+    std::shared_ptr<const std::unordered_map<ContigName, Contig>> contigs_;
+    std::shared_ptr<const std::vector<ContigName>> contig_names_;
+    Fasta::Options options_;
+
+    std::unique_ptr<ReferenceReader> do_clone() const override;
+    bool do_is_open() const noexcept override;
+    std::string do_fetch_reference_name() const override;
+    std::vector<ContigName> do_fetch_contig_names() const override;
+    GenomicSize do_fetch_contig_size(const ContigName& contig) const override;
+    GeneticSequence do_fetch_sequence(const GenomicRegion& region) const override;
+    boost::optional<SequenceView> do_fetch_sequence_view(const GenomicRegion& region) const override;
+
+    const Contig& get_contig(const ContigName& contig) const;
+};
+
+// Writes the sequence of fasta_path, read with the given options, to a file that MappedFasta can read.
+// The file is written to a temporary path first, so readers never see a partially written file.
+void make_mapped_fasta(const Fasta::Path& fasta_path, const MappedFasta::Path& mapped_fasta_path,
+                       Fasta::Options options);
+
+// True if mapped_fasta_path exists, is newer than fasta_path, and was made with the given options
+bool is_mapped_fasta_current(const MappedFasta::Path& mapped_fasta_path, const Fasta::Path& fasta_path,
+                             Fasta::Options options);
+
+} // namespace io
+} // namespace octopus
+
+#endif
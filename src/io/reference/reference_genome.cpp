@@ -7,10 +7,17 @@
 #include <iterator>
 #include <utility>
 #include <numeric>
+#include <string>
+#include <functional>
+#include <ios>
+
+#include <boost/optional.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include "fasta.hpp"
 #include "threadsafe_fasta.hpp"
 #include "caching_fasta.hpp"
+#include "mapped_fasta.hpp"
 
 namespace octopus {
 
@@ -92,13 +99,64 @@ ReferenceGenome::GeneticSequence ReferenceGenome::fetch_sequence(const GenomicRe
     return impl_->fetch_sequence(region);
 }
 
+ReferenceGenome::SequenceView ReferenceGenome::fetch_sequence_view(const GenomicRegion& region, GeneticSequence& buffer) const
+{
+    auto result = impl_->fetch_sequence_view(region);
+    if (result) return *result;
+    buffer = impl_->fetch_sequence(region);
+    return buffer;
+}
+
 // non-member functions
 
+namespace {
+
+// The mapped sequence is kept next to the reference if possible, otherwise in the temporary directory
+std::vector<boost::filesystem::path> get_mapped_fasta_paths(const boost::filesystem::path& reference_path)
+{
+    namespace fs = boost::filesystem;
+    std::vector<fs::path> result {};
+    auto local_path = reference_path;
+    local_path += ".octomap";
+    result.push_back(std::move(local_path));
+    boost::system::error_code ec {};
+    const auto temp_directory = fs::temp_directory_path(ec);
+    if (!ec) {
+        // Different references can have the same file name
+        const auto path_hash = std::hash<std::string> {}(fs::absolute(reference_path).string());
+        auto temp_path = temp_directory / reference_path.filename();
+        temp_path += "." + std::to_string(path_hash) + ".octomap";
+        result.push_back(std::move(temp_path));
+    }
+    return result;
+}
+
+boost::optional<boost::filesystem::path>
+find_or_make_mapped_fasta(const boost::filesystem::path& reference_path, const io::Fasta::Options& options)
+{
+    const auto mapped_paths = get_mapped_fasta_paths(reference_path);
+    for (const auto& mapped_path : mapped_paths) {
+        if (io::is_mapped_fasta_current(mapped_path, reference_path, options)) return mapped_path;
+    }
+    for (const auto& mapped_path : mapped_paths) {
+        try {
+            io::make_mapped_fasta(reference_path, mapped_path, options);
+            return mapped_path;
+        } catch (const std::ios::failure&) {
+            // e.g. the directory is read-only, so try the next location
+        } catch (const boost::filesystem::filesystem_error&) {}
+    }
+    return boost::none;
+}
+
+} // namespace
+
 ReferenceGenome make_reference(boost::filesystem::path reference_path,
                                const MemoryFootprint max_cache_size,
                                const bool is_threaded,
                                const bool capitalise_bases,
-                               const bool disambiguate_iupac_ambiguity_symbols)
+                               const bool disambiguate_iupac_ambiguity_symbols,
+                               const bool memory_map)
 {
     using namespace io;
     std::unique_ptr<ReferenceReader> impl_ {};
@@ -110,6 +168,14 @@ ReferenceGenome make_reference(boost::filesystem::path reference_path,
         options.iupac_ambiguity_symbol_policy = Fasta::Options::IUPACAmbiguitySymbolPolicy::disambiguate;
     }
     options.base_fill_policy = Fasta::Options::BaseFillPolicy::fill_with_ns;
+    if (memory_map) {
+        // The mapped sequence is shared by all threads and needs neither locking nor caching.
+        // If it can't be written anywhere then the fasta is read directly.
+        auto mapped_path = find_or_make_mapped_fasta(reference_path, options);
+        if (mapped_path) {
+            return ReferenceGenome {std::make_unique<MappedFasta>(std::move(*mapped_path))};
+        }
+    }
     if (is_threaded) {
         impl_ = std::make_unique<ThreadsafeFasta>(std::make_unique<Fasta>(reference_path, options));
     } else {
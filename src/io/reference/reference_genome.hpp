@@ -23,6 +23,7 @@ class ReferenceGenome
 public:
     using ContigName      = io::ReferenceReader::ContigName;
     using GeneticSequence = io::ReferenceReader::GeneticSequence;
+    using SequenceView    = io::ReferenceReader::SequenceView;
     
     ReferenceGenome() = delete;
     
@@ -46,6 +47,10 @@ public:
     
     GeneticSequence fetch_sequence(const GenomicRegion& region) const;
     
+    // Returns a view of the reference sequence without copying if the underlying reader supports
+    // it, otherwise the sequence is fetched into buffer and a view of buffer is returned.
+    SequenceView fetch_sequence_view(const GenomicRegion& region, GeneticSequence& buffer) const;
+    
 private:
     std::unique_ptr<io::ReferenceReader> impl_;
     std::string name_;
@@ -59,7 +64,8 @@ ReferenceGenome make_reference(boost::filesystem::path reference_path,
                                MemoryFootprint max_cache_size = 0,
                                bool is_threaded = false,
                                bool capitalise_bases = true,
-                               bool disambiguate_iupac_ambiguity_symbols = true);
+                               bool disambiguate_iupac_ambiguity_symbols = true,
+                               bool memory_map = false);
 
 std::vector<GenomicRegion> get_all_contig_regions(const ReferenceGenome& reference);
 
@@ -9,6 +9,9 @@
 #include <cstdint>
 #include <memory>
 
+#include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+
 #include "basics/genomic_region.hpp"
 
 namespace octopus { namespace io {
@@ -19,6 +22,7 @@ public:
     using ContigName      = GenomicRegion::ContigName;
     using GenomicSize     = GenomicRegion::Size;
     using GeneticSequence = std::string;
+    using SequenceView    = boost::string_ref;
     
     virtual ~ReferenceReader() = default;
     
@@ -52,6 +56,13 @@ public:
         return do_fetch_sequence(region);
     }
     
+    // Only readers that hold the sequence in memory can provide views, which are valid for
+    // the lifetime of the reader (and any of its clones)
+    boost::optional<SequenceView> fetch_sequence_view(const GenomicRegion& region) const
+    {
+        return do_fetch_sequence_view(region);
+    }
+    
 private:
     virtual std::unique_ptr<ReferenceReader> do_clone() const = 0;
     virtual bool do_is_open() const noexcept = 0;
@@ -59,6 +70,7 @@ private:
     virtual std::vector<ContigName> do_fetch_contig_names() const = 0;
     virtual GenomicSize do_fetch_contig_size(const ContigName& contig) const = 0;
     virtual GeneticSequence do_fetch_sequence(const GenomicRegion& region) const = 0;
+    virtual boost::optional<SequenceView> do_fetch_sequence_view(const GenomicRegion&) const { return boost::none; }
 };
 
 } // namespace io
@@ -0,0 +1,337 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "bcf_record.hpp"
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include "io/htslib_thread_pool.hpp"
+#include "vcf_spec.hpp"
+
+namespace octopus {
+
+namespace {
+
+template <typename T>
+T load(const std::uint8_t* data, const int i) noexcept
+{
+    T result;
+    std::memcpy(&result, data + i * sizeof(T), sizeof(T));
+    return result;
+}
+
+template <typename T>
+void append_ints(const std::uint8_t* data, const int n, const T missing, const T vector_end,
+                 const bool convert_missing, std::vector<BcfRecord::IntType>& result)
+{
+    for (int i {0}; i < n; ++i) {
+        const auto value = load<T>(data, i);
+        if (value == vector_end) break;
+        result.push_back(convert_missing && value == missing ? bcf_int32_missing : value);
+    }
+}
+
+auto decode_ints(const std::uint8_t* data, const int type, const int n, const bool convert_missing = true)
+{
+    std::vector<BcfRecord::IntType> result {};
+    result.reserve(n);
+    switch (type) {
+        case BCF_BT_INT8:
+            append_ints<std::int8_t>(data, n, bcf_int8_missing, bcf_int8_vector_end, convert_missing, result);
+            break;
+        case BCF_BT_INT16:
+            append_ints<std::int16_t>(data, n, bcf_int16_missing, bcf_int16_vector_end, convert_missing, result);
+            break;
+        case BCF_BT_INT32:
+            append_ints<std::int32_t>(data, n, bcf_int32_missing, bcf_int32_vector_end, convert_missing, result);
+            break;
+        default:
+            throw std::runtime_error {"BcfRecord: requested field is not an integer type"};
+    }
+    return result;
+}
+
+auto decode_floats(const std::uint8_t* data, const int type, const int n)
+{
+    if (type != BCF_BT_FLOAT) {
+        throw std::runtime_error {"BcfRecord: requested field is not a float type"};
+    }
+    std::vector<BcfRecord::FloatType> result {};
+    result.reserve(n);
+    for (int i {0}; i < n; ++i) {
+        const auto value = load<float>(data, i);
+        if (bcf_float_is_vector_end(value)) break;
+        result.push_back(bcf_float_is_missing(value) ? std::numeric_limits<float>::quiet_NaN() : value);
+    }
+    return result;
+}
+
+template <typename T>
+boost::optional<BcfRecord::IntType> load_int(const std::uint8_t* data, const T missing, const T vector_end) noexcept
+{
+    const auto value = load<T>(data, 0);
+    if (value == missing || value == vector_end) return boost::none;
+    return value;
+}
+
+boost::optional<BcfRecord::IntType> decode_first_int(const bcf_info_t* info) noexcept
+{
+    if (info == nullptr || info->vptr == nullptr || info->len < 1) return boost::none;
+    switch (info->type) {
+        case BCF_BT_INT8: return load_int<std::int8_t>(info->vptr, bcf_int8_missing, bcf_int8_vector_end);
+        case BCF_BT_INT16: return load_int<std::int16_t>(info->vptr, bcf_int16_missing, bcf_int16_vector_end);
+        case BCF_BT_INT32: return load_int<std::int32_t>(info->vptr, bcf_int32_missing, bcf_int32_vector_end);
+        default: return boost::none;
+    }
+}
+
+const std::uint8_t* sample_data(const bcf_fmt_t* fmt, const unsigned sample) noexcept
+{
+    return fmt->p + sample * static_cast<unsigned>(fmt->size);
+}
+
+} // namespace
+
+BcfRecord::BcfRecord(bcf_hdr_t* header, bcf1_t* record) noexcept
+: header_ {header}
+, record_ {record}
+{}
+
+const char* BcfRecord::chrom() const noexcept
+{
+    return bcf_hdr_id2name(header_, record_->rid);
+}
+
+BcfRecord::Position BcfRecord::pos() const noexcept
+{
+    return static_cast<Position>(record_->pos) + 1;
+}
+
+ContigRegion BcfRecord::mapped_contig_region() const noexcept
+{
+    // Regions must match VcfRecord::Builder so records are ordered the same: the REF allele, or up to (but
+    // excluding) INFO/END if present. rlen can't be used, as htslib takes it from INFO/END inclusively.
+    bcf_unpack(record_, BCF_UN_STR);
+    const auto begin = static_cast<ContigRegion::Position>(record_->pos);
+    const auto end = decode_first_int(bcf_get_info(header_, record_, vcfspec::info::endPosition));
+    if (end) {
+        return ContigRegion {begin, static_cast<ContigRegion::Position>(std::max<std::int64_t>(record_->pos, *end - 1))};
+    }
+    return ContigRegion {begin, begin + static_cast<ContigRegion::Size>(std::strlen(record_->d.allele[0]))};
+}
+
+GenomicRegion BcfRecord::mapped_region() const
+{
+    return GenomicRegion {chrom(), mapped_contig_region()};
+}
+
+boost::string_ref BcfRecord::id() const noexcept
+{
+    bcf_unpack(record_, BCF_UN_STR);
+    return record_->d.id;
+}
+
+boost::string_ref BcfRecord::ref() const noexcept
+{
+    bcf_unpack(record_, BCF_UN_STR);
+    return record_->d.allele[0];
+}
+
+unsigned BcfRecord::num_alt() const noexcept
+{
+    return record_->n_allele > 0 ? record_->n_allele - 1 : 0;
+}
+
+boost::string_ref BcfRecord::alt(const unsigned n) const noexcept
+{
+    bcf_unpack(record_, BCF_UN_STR);
+    return record_->d.allele[n + 1];
+}
+
+boost::optional<BcfRecord::QualityType> BcfRecord::qual() const noexcept
+{
+    if (std::isnan(record_->qual)) return boost::none;
+    return record_->qual;
+}
+
+bool BcfRecord::has_filter(const char* key) const noexcept
+{
+    return bcf_has_filter(header_, record_, const_cast<char*>(key)) == 1;
+}
+
+bool BcfRecord::is_filtered() const noexcept
+{
+    bcf_unpack(record_, BCF_UN_FLT);
+    return record_->d.n_flt > 0 && !has_filter(vcfspec::filter::pass);
+}
+
+bool BcfRecord::has_info(const char* key) const noexcept
+{
+    return bcf_get_info(header_, record_, key) != nullptr;
+}
+
+std::vector<BcfRecord::IntType> BcfRecord::info_ints(const char* key) const
+{
+    const auto info = bcf_get_info(header_, record_, key);
+    if (info == nullptr || info->vptr == nullptr) return {};
+    return decode_ints(info->vptr, info->type, info->len);
+}
+
+std::vector<BcfRecord::FloatType> BcfRecord::info_floats(const char* key) const
+{
+    const auto info = bcf_get_info(header_, record_, key);
+    if (info == nullptr || info->vptr == nullptr) return {};
+    return decode_floats(info->vptr, info->type, info->len);
+}
+
+unsigned BcfRecord::num_samples() const noexcept
+{
+    return record_->n_sample;
+}
+
+bool BcfRecord::has_format(const char* key) const noexcept
+{
+    return bcf_get_fmt(header_, record_, key) != nullptr;
+}
+
+std::vector<BcfRecord::IntType> BcfRecord::format_ints(const char* key, const unsigned sample) const
+{
+    const auto fmt = bcf_get_fmt(header_, record_, key);
+    if (fmt == nullptr || sample >= num_samples()) return {};
+    return decode_ints(sample_data(fmt, sample), fmt->type, fmt->n);
+}
+
+std::vector<BcfRecord::FloatType> BcfRecord::format_floats(const char* key, const unsigned sample) const
+{
+    const auto fmt = bcf_get_fmt(header_, record_, key);
+    if (fmt == nullptr || sample >= num_samples()) return {};
+    return decode_floats(sample_data(fmt, sample), fmt->type, fmt->n);
+}
+
+BcfRecord::Genotype BcfRecord::genotype(const unsigned sample) const
+{
+    Genotype result {{}, false};
+    const auto fmt = bcf_get_fmt(header_, record_, vcfspec::format::genotype);
+    if (fmt == nullptr || sample >= num_samples()) return result;
+    const auto gt = decode_ints(sample_data(fmt, sample), fmt->type, fmt->n, false);
+    result.indices.reserve(gt.size());
+    for (const auto g : gt) {
+        if (bcf_gt_is_missing(g) || bcf_gt_allele(g) >= record_->n_allele) {
+            result.indices.push_back(-1);
+        } else {
+            result.indices.push_back(static_cast<AlleleIndex>(bcf_gt_allele(g)));
+        }
+    }
+    result.phased = !gt.empty() && bcf_gt_is_phased(gt.back());
+    return result;
+}
+
+bcf_hdr_t* BcfRecord::header() const noexcept
+{
+    return header_;
+}
+
+bcf1_t* BcfRecord::get() const noexcept
+{
+    return record_;
+}
+
+// non-member methods
+
+bool operator<(const BcfRecord& lhs, const BcfRecord& rhs) noexcept
+{
+    const auto lhs_region = lhs.mapped_contig_region(), rhs_region = rhs.mapped_contig_region();
+    if (lhs_region != rhs_region) return lhs_region < rhs_region;
+    if (lhs.ref() != rhs.ref()) return lhs.ref() < rhs.ref();
+    const auto num_alts = std::min(lhs.num_alt(), rhs.num_alt());
+    for (unsigned i {0}; i < num_alts; ++i) {
+        if (lhs.alt(i) != rhs.alt(i)) return lhs.alt(i) < rhs.alt(i);
+    }
+    return lhs.num_alt() < rhs.num_alt();
+}
+
+// BcfRecordStream
+
+BcfRecordStream::BcfRecordStream(const Path& file_path, const GenomicRegion::ContigName& contig)
+: file_path_ {file_path}
+, file_ {hts_open(file_path.c_str(), "r"), HtsFileDeleter {}}
+, header_ {}
+, bcf_index_ {}
+, tbx_index_ {}
+, iterator_ {}
+, record_ {bcf_init(), HtsBcf1Deleter {}}
+, line_ {new kstring_t {0, 0, nullptr}, KStringDeleter {}}
+, done_ {true}
+{
+    if (file_ == nullptr) {
+        throw std::runtime_error {"BcfRecordStream: failed to open file " + file_path_.string()};
+    }
+    header_.reset(bcf_hdr_read(file_.get()));
+    if (header_ == nullptr) {
+        throw std::runtime_error {"BcfRecordStream: failed to read header of " + file_path_.string()};
+    }
+    if (record_ == nullptr) {
+        throw std::runtime_error {"BcfRecordStream: failed to allocate record for " + file_path_.string()};
+    }
+    // Contigs are queried by id, as region strings are ambiguous for contig names containing ':'
+    static constexpr int maxContigEnd {std::numeric_limits<int>::max()};
+    if (hts_get_format(file_.get())->format == bcf) {
+        bcf_index_.reset(bcf_index_load(file_path_.c_str()));
+        if (bcf_index_ == nullptr) {
+            throw std::runtime_error {"BcfRecordStream: failed to open index for file " + file_path_.string()};
+        }
+        const auto rid = bcf_hdr_name2id(header_.get(), contig.c_str());
+        if (rid < 0) return;
+        iterator_.reset(bcf_itr_queryi(bcf_index_.get(), rid, 0, maxContigEnd));
+    } else {
+        tbx_index_.reset(tbx_index_load(file_path_.c_str()));
+        if (tbx_index_ == nullptr) {
+            throw std::runtime_error {"BcfRecordStream: failed to open index for file " + file_path_.string()};
+        }
+        const auto tid = tbx_name2id(tbx_index_.get(), contig.c_str());
+        if (tid < 0) return;
+        iterator_.reset(tbx_itr_queryi(tbx_index_.get(), tid, 0, maxContigEnd));
+    }
+    if (iterator_ == nullptr) {
+        throw std::runtime_error {"BcfRecordStream: failed to query contig " + contig + " in " + file_path_.string()};
+    }
+    io::attach_htslib_thread_pool(file_.get());
+    next();
+}
+
+bool BcfRecordStream::done() const noexcept
+{
+    return done_;
+}
+
+BcfRecord BcfRecordStream::record() const noexcept
+{
+    return BcfRecord {header_.get(), record_.get()};
+}
+
+void BcfRecordStream::next()
+{
+    if (iterator_ == nullptr) {
+        done_ = true;
+        return;
+    }
+    int status;
+    if (bcf_index_) {
+        status = bcf_itr_next(file_.get(), iterator_.get(), record_.get());
+    } else {
+        status = tbx_itr_next(file_.get(), tbx_index_.get(), iterator_.get(), line_.get());
+        if (status >= 0 && vcf_parse(line_.get(), header_.get(), record_.get()) != 0) {
+            throw std::runtime_error {"BcfRecordStream: failed to parse record in " + file_path_.string()};
+        }
+    }
+    if (status < -1) {
+        throw std::runtime_error {"BcfRecordStream: failed to read record in " + file_path_.string()};
+    }
+    done_ = status < 0;
+}
+
+} // namespace octopus
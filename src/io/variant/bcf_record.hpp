@@ -0,0 +1,164 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef bcf_record_hpp
+#define bcf_record_hpp
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "htslib/hts.h"
+#include "htslib/vcf.h"
+#include "htslib/tbx.h"
+
+#include "basics/contig_region.hpp"
+#include "basics/genomic_region.hpp"
+
+namespace octopus {
+
+/*
+ BcfRecord is a typed view of a decoded htslib bcf1_t record. Unlike VcfRecord, which converts
+ every field to strings, values are read straight from the binary record, and the record can be
+ written back (see VcfWriter) without any string formatting. VcfReader decodes the numeric INFO and
+ FORMAT fields of the records it reads with these accessors.
+ 
+ A BcfRecord does not own the record or header it views, so is only valid while they are
+ (e.g. until the BcfRecordStream it came from is advanced).
+ */
+class BcfRecord
+{
+public:
+    using Position    = GenomicRegion::Position;
+    using QualityType = float;
+    using AlleleIndex = std::int8_t;
+    using IntType     = std::int32_t;
+    using FloatType   = float;
+    
+    struct Genotype
+    {
+        std::vector<AlleleIndex> indices; // missing alleles are -1, as in VcfRecord
+        bool phased;
+    };
+    
+    BcfRecord() = delete;
+    
+    BcfRecord(bcf_hdr_t* header, bcf1_t* record) noexcept;
+    
+    BcfRecord(const BcfRecord&)            = default;
+    BcfRecord& operator=(const BcfRecord&) = default;
+    BcfRecord(BcfRecord&&)                 = default;
+    BcfRecord& operator=(BcfRecord&&)      = default;
+    
+    ~BcfRecord() = default;
+    
+    const char* chrom() const noexcept;
+    Position pos() const noexcept; // One based!
+    ContigRegion mapped_contig_region() const noexcept;
+    GenomicRegion mapped_region() const;
+    boost::string_ref id() const noexcept;
+    boost::string_ref ref() const noexcept;
+    unsigned num_alt() const noexcept;
+    boost::string_ref alt(unsigned n) const noexcept;
+    boost::optional<QualityType> qual() const noexcept;
+    bool has_filter(const char* key) const noexcept;
+    bool is_filtered() const noexcept;
+    
+    // Missing integer values are bcf_int32_missing, and missing floats are NaN
+    bool has_info(const char* key) const noexcept;
+    std::vector<IntType> info_ints(const char* key) const;
+    std::vector<FloatType> info_floats(const char* key) const;
+    
+    unsigned num_samples() const noexcept;
+    bool has_format(const char* key) const noexcept;
+    std::vector<IntType> format_ints(const char* key, unsigned sample) const;
+    std::vector<FloatType> format_floats(const char* key, unsigned sample) const;
+    Genotype genotype(unsigned sample) const;
+    
+    bcf_hdr_t* header() const noexcept;
+    bcf1_t* get() const noexcept;
+
+private:
+    bcf_hdr_t* header_;
+    bcf1_t* record_;
+};
+
+// Orders records like VcfRecord
+bool operator<(const BcfRecord& lhs, const BcfRecord& rhs) noexcept;
+
+/*
+ BcfRecordStream reads the records of a contig from an indexed VCF or BCF file in order.
+ 
+ The contig is looked up by name in the index, rather than parsed as a region string, so
+ contig names containing ':' are handled.
+ */
+class BcfRecordStream
+{
+public:
+    using Path = boost::filesystem::path;
+    
+    BcfRecordStream() = delete;
+    
+    BcfRecordStream(const Path& file_path, const GenomicRegion::ContigName& contig);
+    
+    BcfRecordStream(const BcfRecordStream&)            = delete;
+    BcfRecordStream& operator=(const BcfRecordStream&) = delete;
+    BcfRecordStream(BcfRecordStream&&)                 = default;
+    BcfRecordStream& operator=(BcfRecordStream&&)      = default;
+    
+    ~BcfRecordStream() = default;
+    
+    bool done() const noexcept;
+    BcfRecord record() const noexcept;
+    void next();
+
+private:
+    struct HtsFileDeleter
+    {
+        void operator()(htsFile* file) const { hts_close(file); }
+    };
+    struct HtsHeaderDeleter
+    {
+        void operator()(bcf_hdr_t* header) const { bcf_hdr_destroy(header); }
+    };
+    struct HtsIndexDeleter
+    {
+        void operator()(hts_idx_t* index) const { hts_idx_destroy(index); }
+    };
+    struct HtsTbxDeleter
+    {
+        void operator()(tbx_t* index) const { tbx_destroy(index); }
+    };
+    struct HtsIteratorDeleter
+    {
+        void operator()(hts_itr_t* iterator) const { hts_itr_destroy(iterator); }
+    };
+    struct HtsBcf1Deleter
+    {
+        void operator()(bcf1_t* record) const { bcf_destroy(record); }
+    };
+    struct KStringDeleter
+    {
+        void operator()(kstring_t* str) const { std::free(str->s); delete str; }
+    };
+    
+    Path file_path_;
+    std::unique_ptr<htsFile, HtsFileDeleter> file_;
+    std::unique_ptr<bcf_hdr_t, HtsHeaderDeleter> header_;
+    std::unique_ptr<hts_idx_t, HtsIndexDeleter> bcf_index_; // BCF files
+    std::unique_ptr<tbx_t, HtsTbxDeleter> tbx_index_; // bgzipped VCF files
+    std::unique_ptr<hts_itr_t, HtsIteratorDeleter> iterator_;
+    std::unique_ptr<bcf1_t, HtsBcf1Deleter> record_;
+    std::unique_ptr<kstring_t, KStringDeleter> line_;
+    bool done_;
+};
+
+} // namespace octopus
+
+#endif
@@ -21,6 +21,7 @@
 #include "basics/genomic_region.hpp"
 #include "utils/string_utils.hpp"
 #include "exceptions/file_open_error.hpp"
+#include "io/htslib_thread_pool.hpp"
 #include "vcf_spec.hpp"
 #include "vcf_header.hpp"
 #include "vcf_record.hpp"
@@ -61,6 +62,23 @@ std::vector<std::string> extract_samples(const bcf_hdr_t* header)
     return result;
 }
 
+// bcf_translate remaps header ids but not sample columns, so the samples must match in order
+bool has_samples(const bcf_hdr_t* header, const std::vector<std::string>& samples) noexcept
+{
+    if (static_cast<std::size_t>(bcf_hdr_nsamples(header)) != samples.size()) return false;
+    for (std::size_t s {0}; s < samples.size(); ++s) {
+        if (samples[s] != header->samples[s]) return false;
+    }
+    return true;
+}
+
+void attach_htslib_thread_pool(bcf_srs_t* readers) noexcept
+{
+    for (int i {0}; i < readers->nreaders; ++i) {
+        io::attach_htslib_thread_pool(readers->readers[i].file);
+    }
+}
+
 // public methods
 
 std::string get_hts_mode(const HtslibBcfFacade::Path& file_path, const HtslibBcfFacade::Mode mode)
@@ -92,6 +110,7 @@ HtslibBcfFacade::HtslibBcfFacade()
     if (file_ == nullptr) {
         throw std::runtime_error {"HtslibBcfFacade: could not open stdout writer"};
     }
+    io::attach_htslib_thread_pool(file_.get());
     if (header_ == nullptr) {
         throw std::runtime_error {"HtslibBcfFacade: failed to initialise stdout header"};
     }
@@ -110,6 +129,7 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
             if (!file_) {
                 throw FileOpenError {file_path_};
             }
+            io::attach_htslib_thread_pool(file_.get());
             header_.reset(bcf_hdr_read(file_.get()));
             if (!header_) {
                 throw std::runtime_error {"HtslibBcfFacade: could not make header for file " + file_path_.string()};
@@ -123,6 +143,7 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
         if (!file_) {
             throw FileOpenError {file_path_};
         }
+        io::attach_htslib_thread_pool(file_.get());
         header_.reset(bcf_hdr_init(hts_mode.c_str()));
     } else {
         const auto hts_read_mode = get_hts_mode(file_path_, Mode::read);
@@ -136,6 +157,7 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
         if (!file_) {
             throw FileOpenError {file_path_};
         }
+        io::attach_htslib_thread_pool(file_.get());
         if (header_) {
             samples_ = extract_samples(header_.get());
         } else {
@@ -182,6 +204,7 @@ std::size_t HtslibBcfFacade::count_records() const
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr.get());
     return count_records(sr);
 }
 
@@ -196,6 +219,7 @@ std::size_t HtslibBcfFacade::count_records(const std::string& contig) const
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr.get());
     return count_records(sr);
 }
 
@@ -210,6 +234,7 @@ std::size_t HtslibBcfFacade::count_records(const GenomicRegion& region) const
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr.get());
     return count_records(sr);
 }
 
@@ -225,6 +250,7 @@ HtslibBcfFacade::RecordIteratorPtrPair HtslibBcfFacade::iterate(const UnpackPoli
             throw std::runtime_error {"failed to open file " + file_path_.string()};
         }
     }
+    attach_htslib_thread_pool(sr.get());
     return std::make_pair(std::make_unique<RecordIterator>(*this, std::move(sr), level),
                           std::make_unique<RecordIterator>(*this));
 }
@@ -245,6 +271,7 @@ HtslibBcfFacade::iterate(const std::string& contig, const UnpackPolicy level) co
             throw std::runtime_error {"failed to open file " + file_path_.string()};
         }
     }
+    attach_htslib_thread_pool(sr.get());
     return std::make_pair(std::make_unique<RecordIterator>(*this, std::move(sr), level),
                           std::make_unique<RecordIterator>(*this));
 }
@@ -266,6 +293,7 @@ HtslibBcfFacade::iterate(const GenomicRegion& region, const UnpackPolicy level)
             throw std::runtime_error {"failed to open file " + file_path_.string()};
         }
     }
+    attach_htslib_thread_pool(sr.get());
     return std::make_pair(std::make_unique<RecordIterator>(*this, std::move(sr), level),
                           std::make_unique<RecordIterator>(*this));
 }
@@ -280,6 +308,7 @@ HtslibBcfFacade::fetch_records(const UnpackPolicy level) const
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr.get());
     return fetch_records(sr.get(), level, n_records);
 }
 
@@ -296,6 +325,7 @@ HtslibBcfFacade::fetch_records(const std::string& contig, const UnpackPolicy lev
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr.get());
     return fetch_records(sr.get(), level, n_records);
 }
 
@@ -313,6 +343,7 @@ HtslibBcfFacade::fetch_records(const GenomicRegion& region, const UnpackPolicy l
         sr.release();
         throw std::runtime_error {"failed to open file " + file_path_.string()};
     }
+    attach_htslib_thread_pool(sr.get());
     return fetch_records(sr.get(), level, n_records);
 }
 
@@ -392,6 +423,57 @@ void HtslibBcfFacade::write(const VcfHeader& header)
     samples_ = extract_samples(header_.get());
 }
 
+void HtslibBcfFacade::write(const BcfRecord& record)
+{
+    if (file_ == nullptr) {
+        throw std::runtime_error {"HtslibBcfFacade: trying to write record to closed file"};
+    }
+    if (header_ == nullptr) {
+        throw std::runtime_error {"HtslibBcfFacade: trying to write record without a header"};
+    }
+    if (!has_samples(record.header(), samples_)) {
+        throw std::runtime_error {"HtslibBcfFacade: cannot write record as samples differ"};
+    }
+    if (bcf_translate(header_.get(), record.header(), record.get()) < 0
+        || bcf_write(file_.get(), header_.get(), record.get()) < 0) {
+        throw std::runtime_error {"HtslibBcfFacade: record write failed"};
+    }
+}
+
+void HtslibBcfFacade::write_records(const Path& src)
+{
+    if (file_ == nullptr) {
+        throw std::runtime_error {"HtslibBcfFacade: trying to write records to closed file"};
+    }
+    if (header_ == nullptr) {
+        throw std::runtime_error {"HtslibBcfFacade: trying to write records without a header"};
+    }
+    std::unique_ptr<htsFile, HtsFileDeleter> src_file {bcf_open(src.c_str(), "r"), HtsFileDeleter {}};
+    if (!src_file) {
+        throw FileOpenError {src};
+    }
+    io::attach_htslib_thread_pool(src_file.get());
+    std::unique_ptr<bcf_hdr_t, HtsHeaderDeleter> src_header {bcf_hdr_read(src_file.get()), HtsHeaderDeleter {}};
+    if (!src_header) {
+        throw std::runtime_error {"HtslibBcfFacade: could not make header for file " + src.string()};
+    }
+    if (extract_samples(src_header.get()) != samples_) {
+        throw std::runtime_error {"HtslibBcfFacade: cannot copy records from " + src.string() + " as samples differ"};
+    }
+    HtsBcf1Ptr record {bcf_init(), HtsBcf1Deleter {}};
+    int status;
+    while ((status = bcf_read(src_file.get(), src_header.get(), record.get())) == 0) {
+        // Header ids may differ even if the headers are equivalent
+        if (bcf_translate(header_.get(), src_header.get(), record.get()) < 0
+            || bcf_write(file_.get(), header_.get(), record.get()) < 0) {
+            throw std::runtime_error {"HtslibBcfFacade: record write failed"};
+        }
+    }
+    if (status < -1) {
+        throw std::runtime_error {"HtslibBcfFacade: could not read records from " + src.string()};
+    }
+}
+
 void set_chrom(const bcf_hdr_t* header, bcf1_t* record, const std::string& chrom);
 void set_pos(bcf1_t* record, GenomicRegion::Position pos);
 void set_id(bcf1_t* record, const std::string& id);
@@ -595,16 +677,37 @@ void set_filter(const bcf_hdr_t* header, bcf1_t* record, const std::vector<std::
     }
 }
 
-void extract_info(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& builder)
+std::string to_vcf_string(const BcfRecord::IntType value)
+{
+    return value != bcf_int32_missing ? std::to_string(value) : bcf_missing_str;
+}
+
+std::string to_vcf_string(const BcfRecord::FloatType value)
+{
+    return !std::isnan(value) ? std::to_string(value) : bcf_missing_str;
+}
+
+template <typename T>
+std::vector<std::string> to_vcf_strings(const std::vector<T>& values)
 {
-    int* intinfo {nullptr};
-    float* floatinfo {nullptr};
+    std::vector<std::string> result {};
+    result.reserve(values.size());
+    std::transform(std::cbegin(values), std::cend(values), std::back_inserter(result),
+                   [] (auto v) { return to_vcf_string(v); });
+    return result;
+}
+
+// Numeric values are decoded straight from the record with the BcfRecord accessors, rather than
+// copied into buffers allocated by the bcf_get_info functions
+void extract_info(const BcfRecord& record, VcfRecord::Builder& builder)
+{
+    const auto header = record.header();
+    const auto hts_record = record.get();
     char* stringinfo {nullptr};
-    int* flaginfo {nullptr}; // not actually populated
-    builder.reserve_info(record->n_info);
-    for (unsigned i {0}; i < record->n_info; ++i) {
-        int nintinfo {0}, nfloatinfo {0}, nstringinfo {0}, nflaginfo {0};
-        const auto key_id = record->d.info[i].key;
+    builder.reserve_info(hts_record->n_info);
+    for (unsigned i {0}; i < hts_record->n_info; ++i) {
+        int nstringinfo {0};
+        const auto key_id = hts_record->d.info[i].key;
         if (key_id >= header->n[BCF_DT_ID]) {
             throw std::runtime_error {"HtslibBcfFacade: found INFO key not present in header file"};
         }
@@ -612,29 +715,15 @@ void extract_info(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& b
         std::vector<std::string> values {};
         switch (bcf_hdr_id2type(header, BCF_HL_INFO, key_id)) {
             case BCF_HT_INT: {
-                const auto num_values_written = bcf_get_info_int32(header, record, key, &intinfo, &nintinfo);
-                if (num_values_written > 0) {
-                    values.reserve(num_values_written);
-                    std::transform(intinfo, intinfo + num_values_written, std::back_inserter(values),
-                                   [](auto v) {
-                                       return v != bcf_int32_missing ? std::to_string(v) : bcf_missing_str;
-                                   });
-                }
+                values = to_vcf_strings(record.info_ints(key));
                 break;
             }
             case BCF_HT_REAL: {
-                const auto num_values_written = bcf_get_info_float(header, record, key, &floatinfo, &nfloatinfo);
-                if (num_values_written > 0) {
-                    values.reserve(num_values_written);
-                    std::transform(floatinfo, floatinfo + num_values_written, std::back_inserter(values),
-                                   [] (auto v) {
-                                       return v != bcf_float_missing ? std::to_string(v) : bcf_missing_str;
-                                   });
-                }
+                values = to_vcf_strings(record.info_floats(key));
                 break;
             }
             case BCF_HT_STR: {
-                const auto nchars = bcf_get_info_string(header, record, key, &stringinfo, &nstringinfo);
+                const auto nchars = bcf_get_info_string(header, hts_record, key, &stringinfo, &nstringinfo);
                 if (nchars > 0) {
                     std::string tmp(stringinfo, nchars);
                     values = utils::split(tmp, vcfspec::info::valueSeperator);
@@ -643,16 +732,13 @@ void extract_info(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& b
             }
             case BCF_HT_FLAG: {
                 values.reserve(1);
-                values.emplace_back((bcf_get_info_flag(header, record, key, &flaginfo, &nflaginfo) == 1) ? "1" : "0");
+                values.emplace_back(record.has_info(key) ? "1" : "0");
                 break;
             }
         }
         builder.set_info(key, std::move(values));
     }
-    if (intinfo != nullptr) std::free(intinfo);
-    if (floatinfo != nullptr) std::free(floatinfo);
     if (stringinfo != nullptr) std::free(stringinfo);
-    if (flaginfo != nullptr) std::free(flaginfo);
 }
 
 float get_bcf_float_missing() noexcept
@@ -720,94 +806,51 @@ auto extract_format(const bcf_hdr_t* header, const bcf1_t* record)
     return result;
 }
 
-void extract_samples(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& builder)
+void extract_samples(const BcfRecord& record, VcfRecord::Builder& builder)
 {
-    auto format = extract_format(header, record);
-    const auto num_samples = record->n_sample;
+    const auto header = record.header();
+    const auto hts_record = record.get();
+    auto format = extract_format(header, hts_record);
+    const auto num_samples = record.num_samples();
     builder.reserve_samples(num_samples);
     auto first_format = std::cbegin(format);
     if (format.front() == vcfspec::format::genotype) { // the first key must be GT if present
-        int ngt {}, g {};
-        int* gt {nullptr};
-        bcf_get_genotypes(header, record, &gt, &ngt); // mallocs gt
-        const auto max_ploidy = static_cast<unsigned>(record->d.fmt->n);
-        for (unsigned sample {0}, i {0}; sample < num_samples; ++sample, i += max_ploidy) {
+        for (unsigned sample {0}; sample < num_samples; ++sample) {
+            const auto genotype = record.genotype(sample);
             std::vector<boost::optional<unsigned>> alleles {};
-            alleles.reserve(max_ploidy);
-            for (unsigned p {0}; p < max_ploidy; ++p) {
-                g = gt[i + p];
-                if (g == bcf_int32_vector_end) {
-                    alleles.shrink_to_fit();
-                    break;
-                } else if (bcf_gt_is_missing(g)) {
-                    alleles.push_back(boost::none);
+            alleles.reserve(genotype.indices.size());
+            for (const auto idx : genotype.indices) {
+                if (idx >= 0) {
+                    alleles.emplace_back(idx);
                 } else {
-                    const auto idx = bcf_gt_allele(g);
-                    if (idx < record->n_allele) {
-                        alleles.emplace_back(idx);
-                    } else {
-                        alleles.push_back(boost::none);
-                    }
+                    alleles.push_back(boost::none);
                 }
             }
             using Phasing = VcfRecord::Builder::Phasing;
             builder.set_genotype(header->samples[sample], std::move(alleles),
-                                 bcf_gt_is_phased(g) ? Phasing::phased : Phasing::unphased);
+                                 genotype.phased ? Phasing::phased : Phasing::unphased);
         }
-        std::free(gt);
         ++first_format;
     }
-    int* intformat {nullptr};
-    float* floatformat {nullptr};
     char** stringformat {nullptr};
-    int nintformat {}, nfloatformat {}, nstringformat {};
+    int nstringformat {};
     for (auto itr = first_format, end = std::cend(format); itr != end; ++itr) {
         const auto& key = *itr;
         std::vector<std::vector<std::string>> values(num_samples, std::vector<std::string> {});
         switch (bcf_hdr_id2type(header, BCF_HL_FMT, bcf_hdr_id2int(header, BCF_DT_ID, key.c_str()))) {
-            case BCF_HT_INT: {
-                const auto num_values_written = bcf_get_format_int32(header, record, key.c_str(), &intformat, &nintformat);
-                if (num_values_written > 0) {
-                    const auto num_values_per_sample = num_values_written / num_samples;
-                    auto ptr = intformat;
-                    for (unsigned sample {0}; sample < num_samples; ++sample, ptr += num_values_per_sample) {
-                        const static auto is_pad = [] (auto x) noexcept { return x == bcf_int32_vector_end; };
-                        const auto pad_ritr = std::find_if_not(std::make_reverse_iterator(ptr + num_values_per_sample), std::make_reverse_iterator(ptr), is_pad);
-                        const auto num_pad_values = std::distance(std::make_reverse_iterator(ptr + num_values_per_sample), pad_ritr);
-                        assert(num_pad_values <= num_values_per_sample);
-                        const auto num_sample_values = num_values_per_sample - num_pad_values;
-                        values[sample].reserve(num_sample_values);
-                        std::transform(ptr, ptr + num_sample_values, std::back_inserter(values[sample]),
-                                       [] (auto v) {
-                                           return v != bcf_int32_missing ? std::to_string(v) : bcf_missing_str;
-                                       });
-                    }
+            case BCF_HT_INT:
+                for (unsigned sample {0}; sample < num_samples; ++sample) {
+                    values[sample] = to_vcf_strings(record.format_ints(key.c_str(), sample));
                 }
                 break;
-            }
-            case BCF_HT_REAL: {
-                const auto num_values_written = bcf_get_format_float(header, record, key.c_str(), &floatformat, &nfloatformat);
-                if (num_values_written > 0) {
-                    const auto num_values_per_sample = num_values_written / num_samples;
-                    auto ptr = floatformat;
-                    for (unsigned sample {0}; sample < num_samples; ++sample, ptr += num_values_per_sample) {
-                        const static auto is_pad = [] (auto x) noexcept { return bcf_float_is_vector_end(x); };
-                        const auto pad_ritr = std::find_if_not(std::make_reverse_iterator(ptr + num_values_per_sample), std::make_reverse_iterator(ptr), is_pad);
-                        const auto num_pad_values = std::distance(std::make_reverse_iterator(ptr + num_values_per_sample), pad_ritr);
-                        assert(num_pad_values <= num_values_per_sample);
-                        const auto num_sample_values = num_values_per_sample - num_pad_values;
-                        values[sample].reserve(num_sample_values);
-                        std::transform(ptr, ptr + num_sample_values, std::back_inserter(values[sample]),
-                                       [] (auto v) {
-                                           return v != bcf_float_missing ? std::to_string(v) : bcf_missing_str;
-                                       });
-                    }
+            case BCF_HT_REAL:
+                for (unsigned sample {0}; sample < num_samples; ++sample) {
+                    values[sample] = to_vcf_strings(record.format_floats(key.c_str(), sample));
                 }
                 break;
-            }
             case BCF_HT_STR:
                 // TODO: Check this usage is correct. What if more than one value per sample?
-                if (bcf_get_format_string(header, record, key.c_str(), &stringformat, &nstringformat) > 0) {
+                if (bcf_get_format_string(header, hts_record, key.c_str(), &stringformat, &nstringformat) > 0) {
                     unsigned sample {0};
                     std::for_each(stringformat, stringformat + num_samples,
                                   [&values, &sample] (const char* str) {
@@ -821,8 +864,6 @@ void extract_samples(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder
         }
     }
     builder.set_format(std::move(format));
-    if (intformat != nullptr) std::free(intformat);
-    if (floatformat != nullptr) std::free(floatformat);
     if (stringformat != nullptr) {
         // bcf_get_format_string allocates two arrays
         std::free(stringformat[0]);
@@ -976,6 +1017,7 @@ VcfRecord HtslibBcfFacade::fetch_record(const bcf_srs_t* sr, UnpackPolicy level)
 {
     auto hts_record = bcf_sr_get_line(sr, 0);
     bcf_unpack(hts_record, level == UnpackPolicy::all ? BCF_UN_ALL : BCF_UN_SHR);
+    const BcfRecord record {header_.get(), hts_record};
     VcfRecord::Builder record_builder {};
     extract_chrom(header_.get(), hts_record, record_builder);
     extract_pos(hts_record, record_builder);
@@ -984,9 +1026,9 @@ VcfRecord HtslibBcfFacade::fetch_record(const bcf_srs_t* sr, UnpackPolicy level)
     extract_alt(hts_record, record_builder);
     extract_qual(hts_record, record_builder);
     extract_filter(header_.get(), hts_record, record_builder);
-    extract_info(header_.get(), hts_record, record_builder);
+    extract_info(record, record_builder);
     if (level == UnpackPolicy::all && has_samples(header_.get())) {
-        extract_samples(header_.get(), hts_record, record_builder);
+        extract_samples(record, record_builder);
     }
     return record_builder.build_once();
 }
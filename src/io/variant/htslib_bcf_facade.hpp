@@ -18,6 +18,7 @@
 
 #include "vcf_reader_impl.hpp"
 #include "vcf_record.hpp"
+#include "bcf_record.hpp"
 
 namespace octopus {
 
@@ -63,6 +64,10 @@ public:
     
     void write(const VcfHeader& header);
     void write(const VcfRecord& record);
+    // The record is translated in place to this file's header, so should not be read afterwards
+    void write(const BcfRecord& record);
+    // Copies the records in src without converting them to VcfRecord. src must have the same samples.
+    void write_records(const Path& src);
     
 private:
     struct HtsFileDeleter
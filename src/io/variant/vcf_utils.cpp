@@ -12,6 +12,9 @@
 #include <functional>
 #include <stdexcept>
 #include <numeric>
+#include <future>
+
+#include <boost/filesystem/operations.hpp>
 
 #include "htslib/vcf.h"
 #include "htslib/tbx.h"
@@ -19,6 +22,8 @@
 #include "basics/contig_region.hpp"
 #include "basics/genomic_region.hpp"
 #include "vcf_spec.hpp"
+#include "bcf_record.hpp"
+#include "utils/executor.hpp"
 
 namespace octopus {
 
@@ -82,29 +87,59 @@ void index_vcfs(const std::vector<VcfReader>& readers)
     for (const auto& reader : readers) index_vcf(reader);
 }
 
+VcfHeader fetch_header(VcfReader& reader);
+
+namespace {
+
+void destroy(std::vector<VcfWriter>&& writers)
+{
+    // Destroying a writer builds its index, which is independent for each file
+    const HelperThreads helpers {writers.size() > 1 ? writers.size() - 1 : 0};
+    if (helpers.empty()) {
+        writers.clear();
+        return;
+    }
+    const auto num_tasks = helpers.size() + 1;
+    const auto batch_size = (writers.size() + num_tasks - 1) / num_tasks;
+    const auto destroy_batch = [&writers, batch_size] (const std::size_t first) {
+        const auto last = std::min(first + batch_size, writers.size());
+        std::for_each(std::next(std::begin(writers), first), std::next(std::begin(writers), last),
+                      [] (VcfWriter& writer) { const VcfWriter tmp {std::move(writer)}; });
+    };
+    std::vector<std::future<void>> destroyed {};
+    destroyed.reserve(num_tasks - 1);
+    for (std::size_t first {batch_size}; first < writers.size(); first += batch_size) {
+        destroyed.push_back(helpers.push([&destroy_batch, first] () { destroy_batch(first); }));
+    }
+    destroy_batch(0);
+    for (auto& f : destroyed) f.get();
+    writers.clear();
+}
+
+} // namespace
+
 std::vector<VcfReader> writers_to_readers(std::vector<VcfWriter>&& writers, const bool keep_open)
 {
-    std::vector<VcfReader> result {};
-    result.reserve(writers.size());
-    for (auto&& writer : writers) {
+    std::vector<VcfWriter::Path> paths {};
+    paths.reserve(writers.size());
+    for (const auto& writer : writers) {
         auto path = writer.path();
-        writer.close();
-        if (path) {
-            result.emplace_back(std::move(*path));
-            if (!keep_open) result.back().close();
-        }
+        if (path) paths.push_back(std::move(*path));
+    }
+    destroy(std::move(writers));
+    std::vector<VcfReader> result {};
+    result.reserve(paths.size());
+    for (auto& path : paths) {
+        result.emplace_back(std::move(path));
+        if (!keep_open) result.back().close();
     }
-    writers.clear();
     return result;
 }
 
-void copy(VcfReader& src, VcfWriter& dst)
+namespace {
+
+void copy_records(const VcfReader& src, VcfWriter& dst)
 {
-    const bool is_closed {!src.is_open()};
-    if (is_closed) src.open();
-    if (!dst.is_header_written()) {
-        dst << src.fetch_header();
-    }
     constexpr std::size_t maxBufferSize {1000000};
     if (src.count_records() <= maxBufferSize) {
         dst << src.fetch_records();
@@ -112,20 +147,31 @@ void copy(VcfReader& src, VcfWriter& dst)
         auto p = src.iterate();
         std::copy(std::move(p.first), std::move(p.second), VcfWriterIterator {dst});
     }
-    if (is_closed) src.close();
+}
+
+} // namespace
+
+void copy(VcfReader& src, VcfWriter& dst)
+{
+    if (!dst.is_header_written()) {
+        // dst gets the same header as src, so records can be copied without parsing them
+        dst << fetch_header(src);
+        dst.write_records(src.path());
+    } else {
+        const bool is_closed {!src.is_open()};
+        if (is_closed) src.open();
+        copy_records(src, dst);
+        if (is_closed) src.close();
+    }
 }
 
 void copy(const VcfReader& src, VcfWriter& dst)
 {
     if (!dst.is_header_written()) {
         dst << src.fetch_header();
-    }
-    constexpr std::size_t maxBufferSize {1000000};
-    if (src.count_records() <= maxBufferSize) {
-        dst << src.fetch_records();
+        dst.write_records(src.path());
     } else {
-        auto p = src.iterate();
-        std::copy(std::move(p.first), std::move(p.second), VcfWriterIterator {dst});
+        copy_records(src, dst);
     }
 }
 
@@ -303,10 +349,12 @@ void merge_contig_unique(const std::vector<VcfReader>& sources, VcfWriter& dst,
                          const std::vector<std::string>& contigs,
                          const ReaderContigRecordCountMap& reader_contig_counts)
 {
+    // Each contig comes from one reader, so the merge is a concatenation of records in contig order
+    // and the records do not need to be parsed
     const auto contig_readers = extract_unique_readers(reader_contig_counts);
     for (const auto& contig : contigs) {
         if (contig_readers.count(contig) == 1) {
-            copy(contig_readers.at(contig), dst);
+            dst.write_records(contig_readers.at(contig).get().path());
         }
     }
 }
@@ -393,6 +441,57 @@ auto make_record_iterator_queue(const std::vector<VcfReader>& sources, const std
     return result;
 }
 
+bool is_indexed(const boost::filesystem::path& vcf_path)
+{
+    if (!is_indexable(vcf_path)) return false;
+    const auto index_exists = [&] (const char* extension) { return boost::filesystem::exists(vcf_path.string() + extension); };
+    return index_exists(".csi") || (vcf_path.extension() == ".gz" && index_exists(".tbi"));
+}
+
+bool all_indexed(const std::vector<VcfReader>& sources)
+{
+    return std::all_of(std::cbegin(sources), std::cend(sources),
+                       [] (const VcfReader& reader) { return is_indexed(reader.path()); });
+}
+
+struct BcfRecordStreamCompare
+{
+    bool operator()(const BcfRecordStream* lhs, const BcfRecordStream* rhs) const noexcept
+    {
+        return rhs->record() < lhs->record();
+    }
+};
+
+using BcfRecordStreamQueue = std::priority_queue<BcfRecordStream*, std::vector<BcfRecordStream*>, BcfRecordStreamCompare>;
+
+// Merges records as BcfRecords, so nothing is converted to or from strings
+void bcf_merge(std::vector<VcfReader>& sources, VcfWriter& dst,
+               const std::vector<std::string>& contigs,
+               ReaderContigRecordCountMap& reader_contig_counts)
+{
+    std::vector<BcfRecordStream> streams {};
+    streams.reserve(sources.size());
+    for (const auto& contig : contigs) {
+        streams.clear();
+        for (auto& reader : sources) {
+            if (reader_contig_counts[reader].at(contig) > 0) {
+                streams.emplace_back(reader.path(), contig);
+            }
+        }
+        BcfRecordStreamQueue stream_queue {};
+        for (auto& stream : streams) {
+            if (!stream.done()) stream_queue.push(&stream);
+        }
+        while (!stream_queue.empty()) {
+            auto stream = stream_queue.top();
+            stream_queue.pop();
+            dst << stream->record();
+            stream->next();
+            if (!stream->done()) stream_queue.push(stream);
+        }
+    }
+}
+
 void merge(std::vector<VcfReader>& sources, VcfWriter& dst, const std::vector<std::string>& contigs)
 {
     if (sources.empty()) return;
@@ -408,7 +507,9 @@ void merge(std::vector<VcfReader>& sources, VcfWriter& dst, const std::vector<st
         merge_contig_unique(sources, dst, contigs, reader_contig_counts);
     } else {
         static constexpr std::size_t maxBufferSize {100000};
-        if (count_records(reader_contig_counts) <= maxBufferSize) {
+        if (all_indexed(sources)) {
+            bcf_merge(sources, dst, contigs, reader_contig_counts);
+        } else if (count_records(reader_contig_counts) <= maxBufferSize) {
             one_step_merge(sources, dst, contigs, reader_contig_counts);
         } else if (sources.size() == 2) {
             merge_pair(sources.front(), sources.back(), dst, contigs, reader_contig_counts);
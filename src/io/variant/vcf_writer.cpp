@@ -11,6 +11,7 @@
 
 #include "vcf_header.hpp"
 #include "vcf_record.hpp"
+#include "bcf_record.hpp"
 #include "vcf_utils.hpp"
 
 namespace octopus {
@@ -175,6 +176,26 @@ void VcfWriter::write(const VcfRecord& record)
     }
 }
 
+void VcfWriter::write_records(const Path& path)
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (is_header_written_) {
+        writer_->write_records(path);
+    } else {
+        throw std::runtime_error {"VcfWriter::write_records: cannot write records as header has not been written"};
+    }
+}
+
+void VcfWriter::write(const BcfRecord& record)
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (is_header_written_) {
+        writer_->write(record);
+    } else {
+        throw std::runtime_error {"VcfWriter::write: cannot write record as header has not been written"};
+    }
+}
+
 bool VcfWriter::can_write_index() const noexcept
 {
     return file_path_ && is_header_written_
@@ -195,6 +216,12 @@ VcfWriter& operator<<(VcfWriter& dst, const VcfRecord& record)
     return dst;
 }
 
+VcfWriter& operator<<(VcfWriter& dst, const BcfRecord& record)
+{
+    dst.write(record);
+    return dst;
+}
+
 bool operator==(const VcfWriter& lhs, const VcfWriter& rhs)
 {
     return lhs.path() == rhs.path();
@@ -19,6 +19,7 @@ namespace octopus {
 
 class VcfHeader;
 class VcfRecord;
+class BcfRecord;
 class GenomicRegion;
 
 class VcfWriter
@@ -51,6 +52,9 @@ public:
     
     void write(const VcfHeader& header);
     void write(const VcfRecord& record);
+    void write(const BcfRecord& record);
+    // Copies all records in the VCF/BCF file at path, which must have a header compatible with this one
+    void write_records(const Path& path);
     
 private:
     boost::optional<Path> file_path_;
@@ -63,6 +67,7 @@ private:
 
 VcfWriter& operator<<(VcfWriter& dst, const VcfHeader& header);
 VcfWriter& operator<<(VcfWriter& dst, const VcfRecord& record);
+VcfWriter& operator<<(VcfWriter& dst, const BcfRecord& record);
 
 template <typename Container>
 void write(const Container& records, VcfWriter& dst)
@@ -23,6 +23,7 @@ BufferedReadPipe::BufferedReadPipe(const ReadPipe& source, Config config, std::v
 , buffer_ {}
 , buffered_region_ {}
 , hints_ {}
+, prefetched_buffer_ {}
 , debug_log_ {}
 {
     hint(std::move(hints));
@@ -36,6 +37,7 @@ const ReadPipe& BufferedReadPipe::source() const noexcept
 
 void BufferedReadPipe::clear() noexcept
 {
+    cancel_prefetch();
     buffer_.clear();
     buffered_region_ = boost::none;
     hints_.clear();
@@ -50,6 +52,7 @@ ReadMap BufferedReadPipe::fetch_reads(const GenomicRegion& region) const
 
 void BufferedReadPipe::hint(std::vector<GenomicRegion> hints) const
 {
+    cancel_prefetch();
     hints_.clear();
     for (auto& region : hints) {
         hints_[region.contig_name()].insert(std::move(region));
@@ -70,10 +73,20 @@ bool BufferedReadPipe::is_cached(const GenomicRegion& region) const noexcept
 
 // private methods
 
+std::size_t BufferedReadPipe::max_buffer_size() const noexcept
+{
+    return config_.prefetch_hints ? std::max(config_.max_buffer_size / 2, std::size_t {1}) : config_.max_buffer_size;
+}
+
 void BufferedReadPipe::setup_buffer(const GenomicRegion& request) const
 {
     if (!is_cached(request)) {
         if (debug_log_) stream(*debug_log_) << "Request " << request << " is not cached";
+        if (use_prefetched_buffer(request)) {
+            if (debug_log_) stream(*debug_log_) << "Using prefetched buffer " << *buffered_region_ << " for request " << request;
+            prefetch_next_hint();
+            return;
+        }
         auto max_region = get_max_fetch_region(request);
         if (debug_log_) stream(*debug_log_) << "Max fetch region for request " << request << " is " << max_region;
         bool unchecked_fetch {false};
@@ -81,13 +94,13 @@ void BufferedReadPipe::setup_buffer(const GenomicRegion& request) const
             buffered_region_ = std::move(max_region);
             unchecked_fetch = true;
         } else {
-            buffered_region_ = source_.get().read_manager().find_covered_subregion(max_region, config_.max_buffer_size);
+            buffered_region_ = source_.get().read_manager().find_covered_subregion(max_region, max_buffer_size());
         }
         if (debug_log_) stream(*debug_log_) << "Buffer region for request " << request << " is " << *buffered_region_;
         buffer_ = source_.get().fetch_reads(expand(*buffered_region_, config_.fetch_expansion));
         if (unchecked_fetch) {
             const auto fetch_size = count_reads(buffer_);
-            if (fetch_size > config_.max_buffer_size) {
+            if (fetch_size > max_buffer_size()) {
                 if (default_unchecked_fetch_overflowed_) {
                     adjusted_unchecked_fetch_overflowed_ = true;
                 } else {
@@ -107,11 +120,72 @@ void BufferedReadPipe::setup_buffer(const GenomicRegion& request) const
                 min_checked_fetch_size_ = size(*buffered_region_);
             }
         }
+        prefetch_next_hint();
     } else if (debug_log_) {
         stream(*debug_log_) << "Request " << request << " is already cached";
     }
 }
 
+bool BufferedReadPipe::use_prefetched_buffer(const GenomicRegion& request) const
+{
+    if (!prefetched_buffer_) return false;
+    std::shared_ptr<Buffer> result {};
+    try {
+        result = prefetched_buffer_->get();
+    } catch (...) {
+        prefetched_buffer_ = nullptr;
+        return false; // the synchronous fetch will report any persistent error
+    }
+    prefetched_buffer_ = nullptr;
+    auto& prefetched = *result;
+    if (!contains(prefetched.region, request)) return false;
+    buffer_ = std::move(prefetched.reads);
+    buffered_region_ = std::move(prefetched.region);
+    if (min_checked_fetch_size_) {
+        min_checked_fetch_size_ = std::min(size(*buffered_region_), *min_checked_fetch_size_);
+    } else {
+        min_checked_fetch_size_ = size(*buffered_region_);
+    }
+    return true;
+}
+
+void BufferedReadPipe::prefetch_next_hint() const
+{
+    if (!config_.prefetch_hints || !buffered_region_) return;
+    const auto next_request = next_hinted_request(*buffered_region_);
+    if (!next_request) return;
+    // The next request would fetch synchronously anyway, so only prefetch if there is a thread to spare
+    HelperThreads helper {1};
+    if (helper.empty()) return;
+    // Prefetches are always checked fetches so the two buffers together stay within max_buffer_size
+    const auto max_region = get_max_fetch_region(*next_request);
+    if (debug_log_) stream(*debug_log_) << "Prefetching up to " << max_region << " for hinted request " << *next_request;
+    prefetched_buffer_ = std::make_unique<HelperTask<std::shared_ptr<Buffer>>>(std::move(helper),
+                                    [&source = source_.get(), max_region, max_reads = max_buffer_size(),
+                                     expansion = config_.fetch_expansion] () {
+                                        auto result = std::make_shared<Buffer>();
+                                        result->region = source.read_manager().find_covered_subregion(max_region, max_reads);
+                                        result->reads = source.fetch_reads(expand(result->region, expansion));
+                                        return result;
+                                    });
+}
+
+void BufferedReadPipe::cancel_prefetch() const noexcept
+{
+    prefetched_buffer_ = nullptr; // waits for any running prefetch
+}
+
+boost::optional<GenomicRegion> BufferedReadPipe::next_hinted_request(const GenomicRegion& buffered_region) const
+{
+    const auto contig_hints_itr = hints_.find(buffered_region.contig_name());
+    if (contig_hints_itr == std::cend(hints_)) return boost::none;
+    const auto& contig_hints = contig_hints_itr->second;
+    const auto next_hint_itr = std::find_if(std::cbegin(contig_hints), std::cend(contig_hints),
+                                            [&] (const auto& hint) { return mapped_end(hint) > mapped_end(buffered_region); });
+    if (next_hint_itr == std::cend(contig_hints)) return boost::none;
+    return *next_hint_itr;
+}
+
 GenomicRegion BufferedReadPipe::get_max_fetch_region(const GenomicRegion& request) const
 {
     const auto default_max_region = get_default_max_fetch_region(request);
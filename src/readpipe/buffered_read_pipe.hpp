@@ -6,12 +6,14 @@
 
 #include <functional>
 #include <cstddef>
+#include <memory>
 
 #include <boost/optional.hpp>
 
 #include "read_pipe.hpp"
 #include "basics/genomic_region.hpp"
 #include "containers/mappable_map.hpp"
+#include "utils/executor.hpp"
 #include "logging/logging.hpp"
 
 namespace octopus {
@@ -26,6 +28,9 @@ public:
         boost::optional<GenomicRegion::Size> max_fetch_size = boost::none;
         boost::optional<GenomicRegion::Size> max_hint_gap = boost::none;
         bool allow_unchecked_fetches = true;
+        // Fetch the next hinted region on a helper thread, if one is free, while the current buffer is in use.
+        // The prefetched buffer and the current buffer each get half of max_buffer_size.
+        bool prefetch_hints = false;
     };
     
     BufferedReadPipe() = delete;
@@ -56,6 +61,12 @@ public:
 private:
     using RegionMap = MappableSetMap<GenomicRegion::ContigName, GenomicRegion>;
     
+    struct Buffer
+    {
+        ReadMap reads;
+        GenomicRegion region;
+    };
+    
     std::reference_wrapper<const ReadPipe> source_;
     Config config_;
     mutable ReadMap buffer_;
@@ -64,9 +75,15 @@ private:
     mutable bool default_unchecked_fetch_overflowed_ = false;
     mutable bool adjusted_unchecked_fetch_overflowed_ = false;
     mutable boost::optional<GenomicRegion::Size> min_checked_fetch_size_ = boost::none;
+    mutable std::unique_ptr<HelperTask<std::shared_ptr<Buffer>>> prefetched_buffer_;
     mutable boost::optional<logging::DebugLogger> debug_log_;
     
+    std::size_t max_buffer_size() const noexcept;
     void setup_buffer(const GenomicRegion& request) const;
+    bool use_prefetched_buffer(const GenomicRegion& request) const;
+    void prefetch_next_hint() const;
+    void cancel_prefetch() const noexcept;
+    boost::optional<GenomicRegion> next_hinted_request(const GenomicRegion& buffered_region) const;
     GenomicRegion get_max_fetch_region(const GenomicRegion& request) const;
     GenomicRegion get_default_max_fetch_region(const GenomicRegion& request) const;
     bool can_make_unchecked_fetch() const noexcept;
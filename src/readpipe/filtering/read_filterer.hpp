@@ -56,6 +56,11 @@ public:
     BidirIt remove(ReadIterator first, ReadIterator last) const;
     BidirIt remove(ReadIterator first, ReadIterator last, FilterCountMap& filter_counts) const;
     
+    // Like remove, but each read is first transformed by transform, so reads are transformed and checked
+    // by the basic filters in a single pass. Reads failing a basic filter are still transformed.
+    template <typename UnaryFunction>
+    BidirIt transform_remove(ReadIterator first, ReadIterator last, UnaryFunction transform) const;
+    
     // Like std::stable_partition
     BidirIt partition(ReadIterator first, ReadIterator last) const;
     BidirIt partition(ReadIterator first, ReadIterator last, FilterCountMap& filter_counts) const;
@@ -113,6 +118,32 @@ BidirIt ReadFilterer<BidirIt>::remove(BidirIt first, BidirIt last) const
     return last;
 }
 
+template <typename BidirIt>
+template <typename UnaryFunction>
+BidirIt ReadFilterer<BidirIt>::transform_remove(BidirIt first, BidirIt last, UnaryFunction transform) const
+{
+    if (basic_filters_.empty()) {
+        std::for_each(first, last, transform);
+    } else {
+        auto result = first;
+        for (auto it = first; it != last; ++it) {
+            transform(*it);
+            if (passes_all_basic_filters(*it)) {
+                if (result != it) *result = std::move(*it);
+                ++result;
+            }
+        }
+        last = result;
+    }
+    
+    std::for_each(cbegin(context_filters_), cend(context_filters_),
+                  [first, &last] (const auto& filter) {
+                      last = filter->remove(first, last);
+                  });
+    
+    return last;
+}
+
 template <typename BidirIt>
 BidirIt ReadFilterer<BidirIt>::partition(BidirIt first, BidirIt last) const
 {
@@ -307,6 +338,24 @@ filter(Map& reads, const ReadFilterer& f, OptionalFilterCountMap<Map, ReadFilter
     return result;
 }
 
+template <typename Container, typename ReadFilterer, typename UnaryFunction>
+auto transform_remove(Container& reads, const ReadFilterer& filter, UnaryFunction transform)
+{
+    return filter.transform_remove(std::begin(reads), std::end(reads), transform);
+}
+
+template <typename Map, typename ReadFilterer, typename UnaryFunction>
+FilterPointMap<Map> transform_filter(Map& reads, const ReadFilterer& f, UnaryFunction transform)
+{
+    FilterPointMap<Map> result {reads.size()};
+    
+    for (auto& p : reads) {
+        result.emplace(p.first, transform_remove(p.second, f, transform));
+    }
+    
+    return result;
+}
+
 template <typename Map>
 std::size_t erase_filtered_reads(Map& reads, const FilterPointMap<Map>& filter_points)
 {
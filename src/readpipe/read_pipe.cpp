@@ -7,10 +7,13 @@
 #include <iterator>
 #include <algorithm>
 #include <cassert>
+#include <future>
+#include <exception>
 
 #include "utils/read_stats.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/append.hpp"
+#include "utils/executor.hpp"
 
 namespace octopus {
 
@@ -64,13 +67,6 @@ ReadPipe::ReadPipe(const ReadManager& source, GenomicRegion::Size fragment_size,
     if (DEBUG_MODE) debug_log_ = logging::DebugLogger {};
 }
 
-std::vector<std::vector<SampleName>> batch_samples(std::vector<SampleName> samples)
-{
-    std::vector<std::vector<SampleName>> result {};
-    result.emplace_back(std::move(samples)); // TODO: find a better strategy for this
-    return result;
-}
-
 const ReadManager& ReadPipe::read_manager() const noexcept
 {
     return source_;
@@ -93,6 +89,24 @@ const std::vector<SampleName>& ReadPipe::samples() const noexcept
 
 namespace {
 
+std::vector<std::vector<SampleName>> batch_samples(const std::vector<SampleName>& samples, std::size_t max_batches)
+{
+    max_batches = std::max(std::min(max_batches, samples.size()), std::size_t {1});
+    std::vector<std::vector<SampleName>> result {};
+    result.reserve(max_batches);
+    const auto min_batch_size = samples.size() / max_batches;
+    auto num_larger_batches = samples.size() % max_batches;
+    for (auto first = std::cbegin(samples); first != std::cend(samples);) {
+        const auto batch_size = min_batch_size + (num_larger_batches > 0 ? 1 : 0);
+        if (num_larger_batches > 0) --num_larger_batches;
+        const auto last = std::next(first, batch_size);
+        result.emplace_back(first, last);
+        first = last;
+    }
+    if (result.empty()) result.emplace_back();
+    return result;
+}
+
 template <typename Map>
 void sort_each(Map& reads)
 {
@@ -182,93 +196,69 @@ struct IsMappingQualityZero
     bool operator()(const AlignedRead& read) const noexcept { return read.mapping_quality() == 0; }
 };
 
+ReadMap make_empty_read_map(const std::vector<SampleName>& samples)
+{
+    ReadMap result {samples.size()};
+    for (const auto& sample : samples) {
+        result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
+    }
+    return result;
+}
+
+void merge(ReadPipe::Report&& src, ReadPipe::Report& dst)
+{
+    dst.raw_depths.insert(std::make_move_iterator(std::begin(src.raw_depths)),
+                          std::make_move_iterator(std::end(src.raw_depths)));
+    dst.mapping_quality_zero_depths.insert(std::make_move_iterator(std::begin(src.mapping_quality_zero_depths)),
+                                           std::make_move_iterator(std::end(src.mapping_quality_zero_depths)));
+    dst.downsample_report.insert(std::make_move_iterator(std::begin(src.downsample_report)),
+                                 std::make_move_iterator(std::end(src.downsample_report)));
+}
+
 } // namespace
 
 ReadMap ReadPipe::fetch_reads(const GenomicRegion& region, boost::optional<Report&> report) const
 {
-    using namespace readpipe;
-    ReadMap result {samples_.size()};
-    for (const auto& sample : samples_) {
-        result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
-    }
+    auto result = make_empty_read_map(samples_);
     if (report) report->raw_depths.reserve(samples_.size());
-    for (const auto& batch : batch_samples(samples_)) {
-        auto batch_reads = fetch_batch(source_, batch, region);
-        if (debug_log_) {
-            stream(*debug_log_) << "Fetched " << count_reads(batch_reads) << " unfiltered reads from " << region;
-        }
-        if (report) {
-            for (const auto& p : batch_reads) {
-                report->raw_depths.emplace(p.first, make_coverage_tracker(p.second));
-                report->mapping_quality_zero_depths.emplace(p.first, make_coverage_tracker(p.second, IsMappingQualityZero {}));
-            }
-        }
-        transform_reads(batch_reads, prefilter_transformer_);
-        if (debug_log_) {
-            SampleFilterCountMap<SampleName, decltype(filterer_)> filter_counts {};
-            filter_counts.reserve(samples_.size());
-            for (const auto& sample : samples_) {
-                filter_counts[sample].reserve(filterer_.num_filters());
-            }
-            erase_filtered_reads(batch_reads, filter(batch_reads, filterer_, filter_counts));
-            if (filterer_.num_filters() > 0) {
-                for (const auto& p : filter_counts) {
-                    stream(*debug_log_) << "In sample " << p.first;
-                    if (!p.second.empty()) {
-                        for (const auto& c : p.second) {
-                            stream(*debug_log_) << c.second << " reads failed the " << c.first << " filter";
-                        }
-                    } else {
-                        *debug_log_ << "No reads were filtered";
-                    }
-                }
-            }
-        } else {
-            erase_filtered_reads(batch_reads, filter(batch_reads, filterer_));
-        }
-        if (postfilter_transformer_) {
-            transform_reads(batch_reads, *postfilter_transformer_);
-        }
-        if (debug_log_) {
-            stream(*debug_log_) << "There are " << count_reads(batch_reads) << " reads in " << region
-                            << " after filtering";
+    HelperThreads helpers {samples_.size() > 1 ? samples_.size() - 1 : 0};
+    const auto batches = batch_samples(samples_, helpers.size() + 1);
+    if (batches.size() == 1) {
+        process_batch(batches.front(), region, result, report, debug_log_);
+    } else {
+        // Samples are independent, so each batch is processed on its own thread into its own
+        // map, and merged in batch order so the result does not depend on scheduling.
+        struct BatchResult
+        {
+            ReadMap reads;
+            Report report;
+        };
+        std::vector<std::future<BatchResult>> batch_results {};
+        batch_results.reserve(batches.size() - 1);
+        const bool make_report {report};
+        std::transform(std::next(std::cbegin(batches)), std::cend(batches), std::back_inserter(batch_results),
+                       [&] (const auto& batch) {
+                           return helpers.push([&, make_report] () {
+                               BatchResult result {make_empty_read_map(batch), {}};
+                               boost::optional<logging::DebugLogger> debug_log {};
+                               if (debug_log_) debug_log = logging::DebugLogger {};
+                               process_batch(batch, region, result.reads, make_report ? boost::optional<Report&> {result.report} : boost::none, debug_log);
+                               return result;
+                           });
+                       });
+        // Helpers reference local state, so must finish before any error is thrown
+        std::exception_ptr error {nullptr};
+        try {
+            process_batch(batches.front(), region, result, report, debug_log_);
+        } catch (...) {
+            error = std::current_exception();
         }
-        if (fragment_size_) {
-            fragment(batch_reads, *fragment_size_, region);
-            if (debug_log_) {
-                stream(*debug_log_) << "Fragmented reads from " << region << " into " << count_reads(batch_reads) << " reads";
-                SampleFilterCountMap<SampleName, decltype(filterer_)> filter_counts {};
-                filter_counts.reserve(samples_.size());
-                for (const auto& sample : samples_) {
-                    filter_counts[sample].reserve(filterer_.num_filters());
-                }
-                erase_filtered_reads(batch_reads, filter(batch_reads, filterer_, filter_counts));
-                if (filterer_.num_filters() > 0) {
-                    for (const auto& p : filter_counts) {
-                        stream(*debug_log_) << "In sample " << p.first;
-                        if (!p.second.empty()) {
-                            for (const auto& c : p.second) {
-                                stream(*debug_log_) << c.second << " read fragments failed the " << c.first << " filter";
-                            }
-                        } else {
-                            *debug_log_ << "No read fragments were filtered";
-                        }
-                    }
-                }
-            } else {
-                erase_filtered_reads(batch_reads, filter(batch_reads, filterer_));
-            }
-        }
-        if (downsampler_) {
-            auto reads = make_mappable_map(std::move(batch_reads));
-            auto downsample_reports = downsample(reads, *downsampler_);
-            if (debug_log_) stream(*debug_log_) << "Downsampling removed " << count_downsampled_reads(downsample_reports) << " reads from " << region;
-            if (report) {
-                report->downsample_report = std::move(downsample_reports);
-            }
-            insert_each(std::move(reads), result);
-        } else {
-            insert_each(std::move(batch_reads), result);
+        for (auto& future : batch_results) future.wait();
+        if (error) std::rethrow_exception(error);
+        for (auto& future : batch_results) {
+            auto batch_result = future.get();
+            insert_each(std::move(batch_result.reads), result);
+            if (report) merge(std::move(batch_result.report), *report);
         }
     }
     shrink_to_fit(result); // TODO: should we make this conditional on extra capacity?
@@ -303,4 +293,95 @@ ReadMap ReadPipe::fetch_reads(const std::vector<GenomicRegion>& regions, boost::
     return result;
 }
 
+// private methods
+
+void ReadPipe::process_batch(const std::vector<SampleName>& batch, const GenomicRegion& region, ReadMap& result,
+                             boost::optional<Report&> report, boost::optional<logging::DebugLogger>& debug_log) const
+{
+    using namespace readpipe;
+    auto batch_reads = fetch_batch(source_, batch, region);
+    if (debug_log) {
+        stream(*debug_log) << "Fetched " << count_reads(batch_reads) << " unfiltered reads from " << region;
+    }
+    if (report) {
+        for (const auto& p : batch_reads) {
+            report->raw_depths.emplace(p.first, make_coverage_tracker(p.second));
+            report->mapping_quality_zero_depths.emplace(p.first, make_coverage_tracker(p.second, IsMappingQualityZero {}));
+        }
+    }
+    if (debug_log) {
+        transform_reads(batch_reads, prefilter_transformer_);
+        SampleFilterCountMap<SampleName, decltype(filterer_)> filter_counts {};
+        filter_counts.reserve(batch.size());
+        for (const auto& sample : batch) {
+            filter_counts[sample].reserve(filterer_.num_filters());
+        }
+        erase_filtered_reads(batch_reads, filter(batch_reads, filterer_, filter_counts));
+        if (filterer_.num_filters() > 0) {
+            for (const auto& p : filter_counts) {
+                stream(*debug_log) << "In sample " << p.first;
+                if (!p.second.empty()) {
+                    for (const auto& c : p.second) {
+                        stream(*debug_log) << c.second << " reads failed the " << c.first << " filter";
+                    }
+                } else {
+                    *debug_log << "No reads were filtered";
+                }
+            }
+        }
+    } else if (prefilter_transformer_.has_template_transforms()) {
+        transform_reads(batch_reads, prefilter_transformer_);
+        erase_filtered_reads(batch_reads, filter(batch_reads, filterer_));
+    } else {
+        // Transform and filter each read while it is in cache, rather than in separate passes over all reads
+        const auto transform = [this] (AlignedRead& read) { prefilter_transformer_.transform_read(read); };
+        erase_filtered_reads(batch_reads, transform_filter(batch_reads, filterer_, transform));
+    }
+    if (postfilter_transformer_) {
+        transform_reads(batch_reads, *postfilter_transformer_);
+    }
+    if (debug_log) {
+        stream(*debug_log) << "There are " << count_reads(batch_reads) << " reads in " << region
+                        << " after filtering";
+    }
+    if (fragment_size_) {
+        fragment(batch_reads, *fragment_size_, region);
+        if (debug_log) {
+            stream(*debug_log) << "Fragmented reads from " << region << " into " << count_reads(batch_reads) << " reads";
+            SampleFilterCountMap<SampleName, decltype(filterer_)> filter_counts {};
+            filter_counts.reserve(batch.size());
+            for (const auto& sample : batch) {
+                filter_counts[sample].reserve(filterer_.num_filters());
+            }
+            erase_filtered_reads(batch_reads, filter(batch_reads, filterer_, filter_counts));
+            if (filterer_.num_filters() > 0) {
+                for (const auto& p : filter_counts) {
+                    stream(*debug_log) << "In sample " << p.first;
+                    if (!p.second.empty()) {
+                        for (const auto& c : p.second) {
+                            stream(*debug_log) << c.second << " read fragments failed the " << c.first << " filter";
+                        }
+                    } else {
+                        *debug_log << "No read fragments were filtered";
+                    }
+                }
+            }
+        } else {
+            erase_filtered_reads(batch_reads, filter(batch_reads, filterer_));
+        }
+    }
+    if (downsampler_) {
+        auto reads = make_mappable_map(std::move(batch_reads));
+        auto downsample_reports = downsample(reads, *downsampler_);
+        if (debug_log) stream(*debug_log) << "Downsampling removed " << count_downsampled_reads(downsample_reports) << " reads from " << region;
+        if (report) {
+            report->downsample_report.insert(std::make_move_iterator(std::begin(downsample_reports)),
+                                             std::make_move_iterator(std::end(downsample_reports)));
+        }
+        insert_each(std::move(reads), result);
+    } else {
+        insert_each(std::move(batch_reads), result);
+    }
+}
+
 } // namespace octopus
@@ -99,6 +99,9 @@ private:
     std::vector<SampleName> samples_;
     boost::optional<GenomicRegion::Size> fragment_size_;
     mutable boost::optional<logging::DebugLogger> debug_log_;
+    
+    void process_batch(const std::vector<SampleName>& batch, const GenomicRegion& region, ReadMap& result,
+                       boost::optional<Report&> report, boost::optional<logging::DebugLogger>& debug_log) const;
 };
 
 } // namespace octopus
@@ -0,0 +1,134 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "executor.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cassert>
+
+namespace octopus {
+
+namespace {
+
+struct Executor
+{
+    std::atomic<unsigned> budget {std::max(std::thread::hardware_concurrency(), 1u)};
+    std::atomic<long> idle_threads {static_cast<long>(budget) - 1}; // the calling thread is working
+    std::once_flag make_pool;
+    std::unique_ptr<ThreadPool> pool;
+};
+
+Executor& executor()
+{
+    static Executor result {};
+    return result;
+}
+
+} // namespace
+
+void set_thread_budget(const unsigned num_threads)
+{
+    auto& exec = executor();
+    assert(!exec.pool); // the pool is sized by the budget
+    const auto budget = num_threads > 0 ? num_threads : std::max(std::thread::hardware_concurrency(), 1u);
+    const auto old_budget = exec.budget.exchange(budget);
+    // Keep any outstanding leases counted
+    exec.idle_threads += static_cast<long>(budget) - static_cast<long>(old_budget);
+}
+
+unsigned get_thread_budget() noexcept
+{
+    return executor().budget;
+}
+
+WaitingThread::WaitingThread() noexcept
+{
+    ++executor().idle_threads;
+}
+
+WaitingThread::~WaitingThread() noexcept
+{
+    --executor().idle_threads;
+}
+
+WorkingThread::WorkingThread() noexcept
+{
+    --executor().idle_threads;
+}
+
+WorkingThread::~WorkingThread() noexcept
+{
+    ++executor().idle_threads;
+}
+
+HelperThreads::HelperThreads() noexcept : size_ {0} {}
+
+HelperThreads::HelperThreads(const std::size_t max_helpers)
+: size_ {0}
+{
+    if (max_helpers == 0) return;
+    auto& idle_threads = executor().idle_threads;
+    auto num_idle = idle_threads.load();
+    long num_leased;
+    do {
+        num_leased = std::min(num_idle, static_cast<long>(max_helpers));
+        if (num_leased <= 0) return;
+    } while (!idle_threads.compare_exchange_weak(num_idle, num_idle - num_leased));
+    size_ = static_cast<std::size_t>(num_leased);
+}
+
+HelperThreads::HelperThreads(HelperThreads&& other) noexcept
+: size_ {other.size_}
+{
+    other.size_ = 0;
+}
+
+HelperThreads& HelperThreads::operator=(HelperThreads&& other) noexcept
+{
+    if (&other != this) {
+        release();
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+HelperThreads::~HelperThreads() noexcept
+{
+    release();
+}
+
+std::size_t HelperThreads::size() const noexcept
+{
+    return size_;
+}
+
+bool HelperThreads::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+// private methods
+
+ThreadPool& HelperThreads::pool()
+{
+    auto& exec = executor();
+    // Every pushed task is backed by a lease, so there can be at most budget at once (if the
+    // calling thread is a WaitingThread)
+    std::call_once(exec.make_pool, [&] () { exec.pool = std::make_unique<ThreadPool>(exec.budget); });
+    return *exec.pool;
+}
+
+void HelperThreads::release() noexcept
+{
+    if (size_ > 0) {
+        executor().idle_threads += static_cast<long>(size_);
+        size_ = 0;
+    }
+}
+
+} // namespace octopus
@@ -0,0 +1,180 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef executor_hpp
+#define executor_hpp
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "thread_pool.hpp"
+
+namespace octopus {
+
+/*
+ The executor is a process-wide pool of helper threads together with a thread budget: the maximum
+ number of threads that should be doing work at once (i.e. --threads).
+ 
+ Code that wants to parallelise some work leases helper threads from the budget with HelperThreads,
+ pushes at most size() tasks, and does any remaining work on the calling thread. As the lease may be
+ empty, nested parallelism (e.g. VB seeds inside calling tasks) never takes the number of working
+ threads over the budget. And as every pushed task is backed by a lease, there is always a free
+ helper to run it, so a thread that waits on its helpers cannot deadlock the pool.
+ */
+
+// Sets the number of threads in the budget, including the calling thread. If num_threads is
+// zero then the hardware concurrency is used. Outstanding leases stay counted against the new
+// budget, but it must be set before any helper task is pushed.
+void set_thread_budget(unsigned num_threads);
+
+unsigned get_thread_budget() noexcept;
+
+// The number of helpers to lease for a pool of pool_size threads whose owner just waits on the pool,
+// and so lends its own share of the budget.
+inline std::size_t num_helpers_for_pool(const std::size_t pool_size) noexcept
+{
+    return pool_size > 1 ? pool_size - 1 : 0;
+}
+
+class HelperThreads
+{
+public:
+    HelperThreads() noexcept;
+    
+    // Leases up to max_helpers threads from the budget.
+    explicit HelperThreads(std::size_t max_helpers);
+    
+    HelperThreads(const HelperThreads&)            = delete;
+    HelperThreads& operator=(const HelperThreads&) = delete;
+    HelperThreads(HelperThreads&& other) noexcept;
+    HelperThreads& operator=(HelperThreads&& other) noexcept;
+    
+    ~HelperThreads() noexcept;
+    
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    
+    // Runs f on a helper thread. Only size() tasks should be pushed at a time, and the lease must
+    // outlive them.
+    template <typename F>
+    auto push(F&& f) const -> std::future<std::result_of_t<std::decay_t<F>()>>;
+
+private:
+    std::size_t size_;
+    
+    static ThreadPool& pool();
+    
+    void release() noexcept;
+};
+
+/*
+ Scoped changes to whether the calling thread counts against the budget. A thread that waits on
+ workers outside the executor (e.g. the calling task pool) lends its share with WaitingThread, and
+ each of those workers takes a share with WorkingThread only while it has work. A WorkingThread
+ takes its share even if none are idle, in which case no helpers are leased until enough are released.
+ */
+class WaitingThread
+{
+public:
+    WaitingThread() noexcept;
+    
+    WaitingThread(const WaitingThread&)            = delete;
+    WaitingThread& operator=(const WaitingThread&) = delete;
+    WaitingThread(WaitingThread&&)                 = delete;
+    WaitingThread& operator=(WaitingThread&&)      = delete;
+    
+    ~WaitingThread() noexcept;
+};
+
+class WorkingThread
+{
+public:
+    WorkingThread() noexcept;
+    
+    WorkingThread(const WorkingThread&)            = delete;
+    WorkingThread& operator=(const WorkingThread&) = delete;
+    WorkingThread(WorkingThread&&)                 = delete;
+    WorkingThread& operator=(WorkingThread&&)      = delete;
+    
+    ~WorkingThread() noexcept;
+};
+
+/*
+ A single task that runs on a leased helper thread, or, if the lease is empty, on the calling thread
+ when its result is first requested. The lease is returned as soon as the task finishes. The destructor
+ waits for the task to finish, so anything the task references only needs to outlive the HelperTask.
+ */
+template <typename T>
+class HelperTask
+{
+public:
+    HelperTask() = delete;
+    
+    template <typename F>
+    HelperTask(HelperThreads helper, F&& f);
+    
+    HelperTask(const HelperTask&)            = delete;
+    HelperTask& operator=(const HelperTask&) = delete;
+    HelperTask(HelperTask&&)                 = delete;
+    HelperTask& operator=(HelperTask&&)      = delete;
+    
+    ~HelperTask() noexcept;
+    
+    // Waits for (or runs) the task and returns its result, or rethrows its exception
+    const T& get();
+
+private:
+    std::packaged_task<T()> task_;
+    std::shared_future<T> result_;
+    std::future<void> run_;
+    bool started_;
+};
+
+template <typename F>
+auto HelperThreads::push(F&& f) const -> std::future<std::result_of_t<std::decay_t<F>()>>
+{
+    return pool().push(std::forward<F>(f));
+}
+
+template <typename T>
+template <typename F>
+HelperTask<T>::HelperTask(HelperThreads helper, F&& f)
+: task_ {std::forward<F>(f)}
+, result_ {task_.get_future()}
+, run_ {}
+, started_ {false}
+{
+    if (!helper.empty()) {
+        auto lease = std::make_shared<HelperThreads>(std::move(helper));
+        run_ = lease->push([this, lease] () mutable {
+            task_();
+            lease = nullptr; // return the helper to the budget
+        });
+        started_ = true;
+    }
+}
+
+template <typename T>
+HelperTask<T>::~HelperTask() noexcept
+{
+    if (run_.valid()) run_.wait();
+}
+
+template <typename T>
+const T& HelperTask<T>::get()
+{
+    if (run_.valid()) {
+        run_.get();
+    } else if (!started_) {
+        started_ = true;
+        task_();
+    }
+    return result_.get();
+}
+
+} // namespace octopus
+
+#endif
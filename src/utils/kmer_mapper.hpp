@@ -13,6 +13,11 @@
 #include <algorithm>
 #include <numeric>
 #include <limits>
+#include <cassert>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
 
 namespace octopus {
 
@@ -54,47 +59,111 @@ constexpr auto perfect_kmer_hash(InputIt first)
 
 using KmerPerfectHashes = std::vector<KmerHashType>;
 
+namespace detail {
+
+// Writes the 2-bit code of each base (A = 0, C = 1, G = 2, T = 3, anything else = 0) to result
+inline void encode_bases(const char* first, const std::size_t n, std::uint8_t* result) noexcept
+{
+    std::size_t i {0};
+#if defined(__SSE2__)
+    // ((b >> 1) ^ (b >> 2)) & 3 is the code for A, C, G, and T; other bytes are masked to 0
+    const auto a = _mm_set1_epi8('A'), c = _mm_set1_epi8('C'), g = _mm_set1_epi8('G'), t = _mm_set1_epi8('T');
+    const auto mask = _mm_set1_epi8(3);
+    for (; i + 16 <= n; i += 16) {
+        const auto bases = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+        const auto is_acgt = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bases, a), _mm_cmpeq_epi8(bases, c)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(bases, g), _mm_cmpeq_epi8(bases, t)));
+        const auto codes = _mm_and_si128(_mm_xor_si128(_mm_srli_epi16(bases, 1), _mm_srli_epi16(bases, 2)), mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_and_si128(codes, is_acgt));
+    }
+#endif
+    for (; i < n; ++i) result[i] = perfect_hash<std::uint8_t>(first[i]);
+}
+
+// Rolling version of perfect_kmer_hash over all k-mers of the sequence. The first base of
+// a k-mer is the lowest order digit so the next hash is (hash >> 2) | (code << 2(K - 1)).
+template <unsigned char K, typename OutputIt>
+OutputIt rolling_kmer_hashes(const std::string& sequence, std::vector<std::uint8_t>& codes, OutputIt result)
+{
+    static_assert(K > 0 && 2 * K <= 8 * sizeof(KmerHashType), "");
+    if (sequence.size() < K) return result;
+    codes.resize(sequence.size());
+    encode_bases(sequence.data(), sequence.size(), codes.data());
+    constexpr auto high_shift = 2 * (K - 1);
+    KmerHashType hash {0};
+    for (std::size_t i {0}; i < K - 1; ++i) {
+        hash = (hash >> 2) | (static_cast<KmerHashType>(codes[i]) << high_shift);
+    }
+    for (std::size_t i {K - 1}; i < sequence.size(); ++i) {
+        hash = (hash >> 2) | (static_cast<KmerHashType>(codes[i]) << high_shift);
+        *result++ = hash;
+    }
+    return result;
+}
+
+} // namespace detail
+
 template <unsigned char K>
 auto compute_kmer_hashes(const std::string& sequence)
 {
     if (sequence.size() < K) {
         return KmerPerfectHashes {};
     }
+    thread_local std::vector<std::uint8_t> codes {};
     KmerPerfectHashes result(sequence.size() - K + 1);
-    auto result_it = std::begin(result);
-    for (auto it = std::cbegin(sequence); it != std::prev(std::cend(sequence), K - 1); ++it, ++result_it) {
-        *result_it = perfect_kmer_hash<K>(it);
-    }
+    detail::rolling_kmer_hashes<K>(sequence, codes, std::begin(result));
     return result;
 }
 
-using KmerHashTable = std::pair<std::vector<std::vector<std::size_t>>, std::size_t>;
+/*
+    A compressed sparse row index of k-mer positions in a target sequence. The positions of
+    k-mer h are positions[offsets[h]] ... positions[offsets[h + 1] - 1], in increasing order.
+    Re-populating a table only reallocates if the new target is longer than any before it.
+ */
+struct KmerHashTable
+{
+    using Position = std::uint32_t;
+    std::vector<Position> offsets, positions;
+    std::size_t num_positions; // number of k-mers in the target
+    std::vector<KmerHashType> hashes; // scratch
+    std::vector<std::uint8_t> codes; // scratch
+};
 
 template <unsigned char K>
 KmerHashTable init_kmer_hash_table()
 {
-    return std::make_pair(std::vector<std::vector<std::size_t>> {num_kmers(K), std::vector<std::size_t> {}}, 0);
+    return KmerHashTable {std::vector<KmerHashTable::Position>(num_kmers(K) + 1, 0), {}, 0, {}, {}};
 }
 
 inline void clear_kmer_hash_table(KmerHashTable& table)
 {
-    for (auto& bin : table.first) bin.clear();
-    table.second = 0;
+    std::fill(std::begin(table.offsets), std::end(table.offsets), 0);
+    table.positions.clear();
+    table.num_positions = 0;
 }
 
 template <unsigned char K>
 void populate_kmer_hash_table(const std::string& sequence, KmerHashTable& result)
 {
+    clear_kmer_hash_table(result);
     if (sequence.size() < K) {
         return;
     }
-    const auto last_index = sequence.size() - K;
-    auto it = std::cbegin(sequence);
-    for (std::size_t index {0}; index <= last_index; ++index, ++it) {
-        result.first[perfect_kmer_hash<K>(it)].push_back(index);
+    assert(result.offsets.size() == num_kmers(K) + 1);
+    const auto num_positions = sequence.size() - K + 1;
+    result.hashes.resize(num_positions);
+    detail::rolling_kmer_hashes<K>(sequence, result.codes, std::begin(result.hashes));
+    // Counting sort of positions by hash
+    for (const auto hash : result.hashes) ++result.offsets[hash + 1];
+    std::partial_sum(std::cbegin(result.offsets), std::cend(result.offsets), std::begin(result.offsets));
+    result.positions.resize(num_positions);
+    for (std::size_t index {0}; index < num_positions; ++index) {
+        result.positions[result.offsets[result.hashes[index]]++] = static_cast<KmerHashTable::Position>(index);
     }
-    for (auto& bin : result.first) bin.shrink_to_fit();
-    result.second = sequence.size() - K + 1;
+    // Each offset now holds the start of the next bin
+    std::copy_backward(std::cbegin(result.offsets), std::prev(std::cend(result.offsets)), std::end(result.offsets));
+    result.offsets.front() = 0;
+    result.num_positions = num_positions;
 }
 
 template <unsigned char K>
@@ -109,7 +178,12 @@ using MappedIndexCounts = std::vector<unsigned>;
 
 inline MappedIndexCounts init_mapping_counts(const KmerHashTable& target)
 {
-    return MappedIndexCounts(target.second, 0);
+    return MappedIndexCounts(target.num_positions, 0);
+}
+
+inline void init_mapping_counts(const KmerHashTable& target, MappedIndexCounts& mapping_counts)
+{
+    mapping_counts.assign(target.num_positions, 0);
 }
 
 inline void reset_mapping_counts(MappedIndexCounts& mapping_counts)
@@ -122,22 +196,25 @@ OutputIt map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable
                              MappedIndexCounts& mapping_counts, OutputIt result,
                              std::size_t max_mapping_positions = std::numeric_limits<std::size_t>::max())
 {
+    if (target.num_positions == 0) return result;
     unsigned max_hit_count {0};
     std::size_t first_max_hit_index {0};
     unsigned num_max_hits {0};
     for (std::size_t query_index {0}; query_index < query.size(); ++query_index) {
-        for (const auto target_index : target.first[query[query_index]]) {
-            if (target_index >= query_index) {
-                const auto mapping_begin = target_index - query_index;
-                if (++mapping_counts[mapping_begin] > max_hit_count) {
-                    max_hit_count = mapping_counts[mapping_begin];
+        const auto hash = query[query_index];
+        const auto first_target = std::next(std::cbegin(target.positions), target.offsets[hash]);
+        const auto last_target = std::next(std::cbegin(target.positions), target.offsets[hash + 1]);
+        // Positions are sorted so skip those that would map before the target start
+        for (auto itr = std::lower_bound(first_target, last_target, query_index); itr != last_target; ++itr) {
+            const auto mapping_begin = *itr - query_index;
+            if (++mapping_counts[mapping_begin] > max_hit_count) {
+                max_hit_count = mapping_counts[mapping_begin];
+                first_max_hit_index = mapping_begin;
+                num_max_hits = 1;
+            } else if (mapping_counts[mapping_begin] == max_hit_count) {
+                ++num_max_hits;
+                if (mapping_begin < first_max_hit_index) {
                     first_max_hit_index = mapping_begin;
-                    num_max_hits = 1;
-                } else if (mapping_counts[mapping_begin] == max_hit_count) {
-                    ++num_max_hits;
-                    if (mapping_begin < first_max_hit_index) {
-                        first_max_hit_index = mapping_begin;
-                    }
                 }
             }
         }
@@ -158,6 +235,24 @@ OutputIt map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable
     return result;
 }
 
+// Maps every query to the target in one pass, reusing the storage of result
+template <typename MappingPositionVector>
+void map_queries_to_target(const std::vector<KmerPerfectHashes>& queries, const KmerHashTable& target,
+                           MappedIndexCounts& mapping_counts, std::vector<MappingPositionVector>& result,
+                           const std::size_t max_mapping_positions)
+{
+    assert(mapping_counts.size() == target.num_positions);
+    result.resize(queries.size());
+    for (std::size_t i {0}; i < queries.size(); ++i) {
+        auto& mapping_positions = result[i];
+        mapping_positions.resize(max_mapping_positions);
+        mapping_positions.erase(map_query_to_target(queries[i], target, mapping_counts, std::begin(mapping_positions),
+                                                    max_mapping_positions),
+                                std::end(mapping_positions));
+        reset_mapping_counts(mapping_counts);
+    }
+}
+
 void map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target,
                          MappedIndexCounts& mapping_counts, std::vector<std::size_t>& result);
 
@@ -11,13 +11,37 @@
 #include <cstddef>
 #include <utility>
 #include <type_traits>
+#include <atomic>
 
 #include "thread_pool.hpp"
+#include "executor.hpp"
 
 namespace octopus {
 
 namespace detail {
 
+// Runs each task once, on the calling thread and whatever helper threads can be leased from the executor
+template <typename T>
+void run_tasks(std::vector<std::packaged_task<T()>>& tasks)
+{
+    HelperThreads helpers {tasks.empty() ? 0 : tasks.size() - 1};
+    if (helpers.empty()) {
+        for (auto& task : tasks) task();
+        return;
+    }
+    std::atomic<std::size_t> next_task {0};
+    const auto run_remaining = [&] () {
+        for (auto i = next_task++; i < tasks.size(); i = next_task++) tasks[i]();
+    };
+    std::vector<std::future<void>> helper_results {};
+    helper_results.reserve(helpers.size());
+    for (std::size_t i {0}; i < helpers.size(); ++i) {
+        helper_results.push_back(helpers.push(run_remaining));
+    }
+    run_remaining();
+    for (auto& helper : helper_results) helper.get();
+}
+
 template <typename InputIt,
           typename OutputIt,
           typename UnaryOp>
@@ -26,11 +50,16 @@ OutputIt parallel_transform(InputIt first, InputIt last, OutputIt result, UnaryO
 {
     using value_type  = typename std::iterator_traits<InputIt>::value_type;
     using result_type = std::result_of_t<UnaryOp(value_type)>;
-    std::vector<std::future<result_type>> results(std::distance(first, last));
-    std::transform(first, last, std::begin(results),
-                   [&op](const auto& value) {
-                       return std::async(std::launch::async, op, std::cref(value));
-                   });
+    std::vector<std::packaged_task<result_type()>> tasks {};
+    tasks.reserve(std::distance(first, last));
+    std::vector<std::future<result_type>> results {};
+    results.reserve(tasks.capacity());
+    for (; first != last; ++first) {
+        const value_type& value {*first};
+        tasks.emplace_back([&op, &value] () { return op(value); });
+        results.push_back(tasks.back().get_future());
+    }
+    run_tasks(tasks);
     return std::transform(std::begin(results), std::end(results), result,
                           [](auto& f) { return f.get(); });
 }
@@ -54,11 +83,17 @@ OutputIt parallel_transform(InputIt1 first1, InputIt1 last1, InputIt2 first2, Ou
     using value_type1  = typename std::iterator_traits<InputIt1>::value_type;
     using value_type2  = typename std::iterator_traits<InputIt2>::value_type;
     using result_type = std::result_of_t<BinaryOp(value_type1, value_type2)>;
-    std::vector<std::future<result_type>> results(std::distance(first1, last1));
-    std::transform(first1, last1, first2, std::begin(results),
-                   [&op](const auto& a, const auto& b) {
-                       return std::async(std::launch::async, op, std::cref(a), std::cref(b));
-                   });
+    std::vector<std::packaged_task<result_type()>> tasks {};
+    tasks.reserve(std::distance(first1, last1));
+    std::vector<std::future<result_type>> results {};
+    results.reserve(tasks.capacity());
+    for (; first1 != last1; ++first1, ++first2) {
+        const value_type1& a {*first1};
+        const value_type2& b {*first2};
+        tasks.emplace_back([&op, &a, &b] () { return op(a, b); });
+        results.push_back(tasks.back().get_future());
+    }
+    run_tasks(tasks);
     return std::transform(std::begin(results), std::end(results), result,
                           [](auto& f) { return f.get(); });
 }
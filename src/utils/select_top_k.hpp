@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <iterator>
 #include <queue>
+#include <numeric>
+#include <functional>
 #include <cstddef>
 #include <cmath>
 #include <utility>
@@ -198,6 +200,57 @@ select_top_k_tuples(const std::vector<std::vector<T>>& values, const std::size_t
     return result;
 }
 
+namespace detail {
+
+template <typename T>
+struct RankTupleScorePair
+{
+    IndexTuple ranks; // non-decreasing
+    T score;
+};
+
+template <typename T>
+bool operator<(const RankTupleScorePair<T>& lhs, const RankTupleScorePair<T>& rhs) noexcept
+{
+    return lhs.score < rhs.score;
+}
+
+} // namespace detail
+
+template <typename T>
+IndexTupleVector
+select_top_k_multisets(const std::vector<T>& values, const std::size_t size, const std::size_t k)
+{
+    // Best-first search over the multisets of values with the given size, scored by the sum of their
+    // values. A multiset is a non-decreasing tuple of ranks (i.e. indices into the sorted values), and the
+    // parent of a multiset decrements its first non-zero rank, so each multiset has one parent with a score
+    // no less than its own. Only the children of the k returned multisets are ever generated.
+    // Returns results in descending score order
+    IndexTupleVector result {};
+    if (values.empty() || size == 0 || k == 0) return result;
+    const auto sorted_values = detail::index_and_sort(values, values.size());
+    std::priority_queue<detail::RankTupleScorePair<T>> frontier {};
+    frontier.push({IndexTuple(size, 0), static_cast<T>(size) * sorted_values.front().first});
+    result.reserve(k);
+    while (result.size() < k && !frontier.empty()) {
+        auto best = frontier.top(); frontier.pop();
+        for (std::size_t i {0}; i < size; ++i) {
+            // Children may only increment ranks up to and including the first non-zero rank
+            if (i > 0 && best.ranks[i - 1] > 0) break;
+            const auto next_rank = best.ranks[i] + 1;
+            if (next_rank < sorted_values.size() && (i + 1 == size || next_rank <= best.ranks[i + 1])) {
+                auto child = best;
+                child.ranks[i] = next_rank;
+                child.score += sorted_values[next_rank].first - sorted_values[best.ranks[i]].first;
+                frontier.push(std::move(child));
+            }
+        }
+        for (auto& rank : best.ranks) rank = sorted_values[rank].second;
+        result.push_back(std::move(best.ranks));
+    }
+    return result;
+}
+
 } // namespace octopus
 
 #endif
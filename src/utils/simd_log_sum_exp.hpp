@@ -0,0 +1,206 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef simd_log_sum_exp_hpp
+#define simd_log_sum_exp_hpp
+
+#if __GNUC__ >= 6
+    #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+    #include "fmath.hpp"
+#endif
+
+namespace octopus { namespace maths { namespace simd {
+
+/*
+    Kernels for sum_i ln sum_k exp(logs[k][i] + offsets[k]), i.e. the summed log mixture of k
+    log-probability rows, as needed for genotype likelihoods.
+
+    The maximum of each column is computed exactly in double precision. Only the bounded term
+    ln sum_k exp(x_k - max), which is in [0, ln k], is computed with float32 SIMD exp and log,
+    so the absolute error per column is around 1e-7.
+ */
+
+namespace detail {
+
+#if defined(__AVX2__)
+
+inline __m256 fmadd(const __m256 a, const __m256 b, const __m256 c) noexcept
+{
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+// Cephes style expf for x <= 0
+inline __m256 exp(__m256 x) noexcept
+{
+    x = _mm256_max_ps(x, _mm256_set1_ps(-87.0f));
+    const auto n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    auto r = fmadd(n, _mm256_set1_ps(-0.693359375f), x);
+    r = fmadd(n, _mm256_set1_ps(2.12194440e-4f), r);
+    auto p = _mm256_set1_ps(1.9875691500e-4f);
+    p = fmadd(p, r, _mm256_set1_ps(1.3981999507e-3f));
+    p = fmadd(p, r, _mm256_set1_ps(8.3334519073e-3f));
+    p = fmadd(p, r, _mm256_set1_ps(4.1665795894e-2f));
+    p = fmadd(p, r, _mm256_set1_ps(1.6666665459e-1f));
+    p = fmadd(p, r, _mm256_set1_ps(5.0000001201e-1f));
+    p = _mm256_add_ps(fmadd(_mm256_mul_ps(p, r), r, r), _mm256_set1_ps(1.0f));
+    const auto pow2n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(pow2n));
+}
+
+// ln x for finite x >= 1, using ln m = 2 atanh((m - 1) / (m + 1)) for the mantissa m
+inline __m256 log(const __m256 x) noexcept
+{
+    const auto bits = _mm256_castps_si256(x);
+    auto e = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+    auto m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                 _mm256_set1_epi32(0x3f800000)));
+    const auto is_big = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+    m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), is_big);
+    e = _mm256_sub_epi32(e, _mm256_castps_si256(is_big)); // is_big lanes are -1
+    const auto z = _mm256_div_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_add_ps(m, _mm256_set1_ps(1.0f)));
+    const auto z2 = _mm256_mul_ps(z, z);
+    auto p = _mm256_set1_ps(1.0f / 9);
+    p = fmadd(p, z2, _mm256_set1_ps(1.0f / 7));
+    p = fmadd(p, z2, _mm256_set1_ps(1.0f / 5));
+    p = fmadd(p, z2, _mm256_set1_ps(1.0f / 3));
+    const auto two_z = _mm256_add_ps(z, z);
+    const auto ln_m = fmadd(_mm256_mul_ps(two_z, z2), p, two_z);
+    return fmadd(_mm256_cvtepi32_ps(e), _mm256_set1_ps(0.693147180559945f), ln_m);
+}
+
+static constexpr std::size_t blockSize {8};
+
+// Sums the first num_blocks * blockSize columns
+inline double sum_log_sum_exp_blocks(const double* const* logs, const double* offsets, const std::size_t k,
+                                     const std::size_t num_blocks) noexcept
+{
+    auto sums_lo = _mm256_setzero_pd(), sums_hi = _mm256_setzero_pd();
+    for (std::size_t block {0}; block < num_blocks; ++block) {
+        const auto i = block * blockSize;
+        auto offset = _mm256_set1_pd(offsets[0]);
+        auto max_lo = _mm256_add_pd(_mm256_loadu_pd(logs[0] + i), offset);
+        auto max_hi = _mm256_add_pd(_mm256_loadu_pd(logs[0] + i + 4), offset);
+        for (std::size_t j {1}; j < k; ++j) {
+            offset = _mm256_set1_pd(offsets[j]);
+            max_lo = _mm256_max_pd(_mm256_add_pd(_mm256_loadu_pd(logs[j] + i), offset), max_lo);
+            max_hi = _mm256_max_pd(_mm256_add_pd(_mm256_loadu_pd(logs[j] + i + 4), offset), max_hi);
+        }
+        auto exp_sums = _mm256_setzero_ps();
+        if (k == 2) {
+            // One of the two terms is always exp(0) = 1
+            const auto offset0 = _mm256_set1_pd(offsets[0]);
+            const auto min_lo = _mm256_min_pd(_mm256_add_pd(_mm256_loadu_pd(logs[0] + i), offset0),
+                                              _mm256_add_pd(_mm256_loadu_pd(logs[1] + i), offset));
+            const auto min_hi = _mm256_min_pd(_mm256_add_pd(_mm256_loadu_pd(logs[0] + i + 4), offset0),
+                                              _mm256_add_pd(_mm256_loadu_pd(logs[1] + i + 4), offset));
+            const auto lo = _mm256_cvtpd_ps(_mm256_sub_pd(min_lo, max_lo));
+            const auto hi = _mm256_cvtpd_ps(_mm256_sub_pd(min_hi, max_hi));
+            exp_sums = _mm256_add_ps(_mm256_set1_ps(1.0f), exp(_mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1)));
+        } else {
+            for (std::size_t j {0}; j < k; ++j) {
+                offset = _mm256_set1_pd(offsets[j]);
+                const auto lo = _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_add_pd(_mm256_loadu_pd(logs[j] + i), offset), max_lo));
+                const auto hi = _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_add_pd(_mm256_loadu_pd(logs[j] + i + 4), offset), max_hi));
+                exp_sums = _mm256_add_ps(exp_sums, exp(_mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1)));
+            }
+        }
+        const auto ln_exp_sums = log(exp_sums);
+        sums_lo = _mm256_add_pd(sums_lo, _mm256_add_pd(max_lo, _mm256_cvtps_pd(_mm256_castps256_ps128(ln_exp_sums))));
+        sums_hi = _mm256_add_pd(sums_hi, _mm256_add_pd(max_hi, _mm256_cvtps_pd(_mm256_extractf128_ps(ln_exp_sums, 1))));
+    }
+    const auto sums = _mm256_add_pd(sums_lo, sums_hi);
+    const auto pairs = _mm_add_pd(_mm256_castpd256_pd128(sums), _mm256_extractf128_pd(sums, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+}
+
+#elif defined(__SSE2__)
+
+static constexpr std::size_t blockSize {4};
+
+// Sums the first num_blocks * blockSize columns
+inline double sum_log_sum_exp_blocks(const double* const* logs, const double* offsets, const std::size_t k,
+                                     const std::size_t num_blocks) noexcept
+{
+    auto sums_lo = _mm_setzero_pd(), sums_hi = _mm_setzero_pd();
+    for (std::size_t block {0}; block < num_blocks; ++block) {
+        const auto i = block * blockSize;
+        auto offset = _mm_set1_pd(offsets[0]);
+        auto max_lo = _mm_add_pd(_mm_loadu_pd(logs[0] + i), offset);
+        auto max_hi = _mm_add_pd(_mm_loadu_pd(logs[0] + i + 2), offset);
+        for (std::size_t j {1}; j < k; ++j) {
+            offset = _mm_set1_pd(offsets[j]);
+            max_lo = _mm_max_pd(_mm_add_pd(_mm_loadu_pd(logs[j] + i), offset), max_lo);
+            max_hi = _mm_max_pd(_mm_add_pd(_mm_loadu_pd(logs[j] + i + 2), offset), max_hi);
+        }
+        auto exp_sums = _mm_setzero_ps();
+        for (std::size_t j {0}; j < k; ++j) {
+            offset = _mm_set1_pd(offsets[j]);
+            const auto lo = _mm_cvtpd_ps(_mm_sub_pd(_mm_add_pd(_mm_loadu_pd(logs[j] + i), offset), max_lo));
+            const auto hi = _mm_cvtpd_ps(_mm_sub_pd(_mm_add_pd(_mm_loadu_pd(logs[j] + i + 2), offset), max_hi));
+            exp_sums = _mm_add_ps(exp_sums, fmath::exp_ps(_mm_movelh_ps(lo, hi)));
+        }
+        const auto ln_exp_sums = fmath::log_ps(exp_sums);
+        sums_lo = _mm_add_pd(sums_lo, _mm_add_pd(max_lo, _mm_cvtps_pd(ln_exp_sums)));
+        sums_hi = _mm_add_pd(sums_hi, _mm_add_pd(max_hi, _mm_cvtps_pd(_mm_movehl_ps(ln_exp_sums, ln_exp_sums))));
+    }
+    const auto pairs = _mm_add_pd(sums_lo, sums_hi);
+    return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+}
+
+#else
+
+static constexpr std::size_t blockSize {1};
+
+inline double sum_log_sum_exp_blocks(const double* const*, const double*, std::size_t, std::size_t) noexcept
+{
+    return 0;
+}
+
+#endif
+
+} // namespace detail
+
+inline double sum_log_sum_exp(const double* const* logs, const double* offsets, const std::size_t k, const std::size_t n) noexcept
+{
+#if defined(__SSE2__)
+    const auto num_blocks = n / detail::blockSize;
+#else
+    const std::size_t num_blocks {0};
+#endif
+    auto result = detail::sum_log_sum_exp_blocks(logs, offsets, k, num_blocks);
+    for (auto i = num_blocks * detail::blockSize; i < n; ++i) {
+        auto max = logs[0][i] + offsets[0];
+        for (std::size_t j {1}; j < k; ++j) max = std::max(logs[j][i] + offsets[j], max);
+        double sum {0};
+        for (std::size_t j {0}; j < k; ++j) sum += std::exp(logs[j][i] + offsets[j] - max);
+        result += max + std::log(sum);
+    }
+    return result;
+}
+
+template <std::size_t K>
+double sum_log_sum_exp(const std::array<const double*, K>& logs, const std::array<double, K>& offsets, const std::size_t n) noexcept
+{
+    static_assert(K > 0, "");
+    return sum_log_sum_exp(logs.data(), offsets.data(), K, n);
+}
+
+} // namespace simd
+} // namespace maths
+} // namespace octopus
+
+#endif
@@ -0,0 +1,178 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "work_stealing_thread_pool.hpp"
+
+namespace octopus {
+
+namespace {
+
+thread_local const WorkStealingThreadPool* this_pool {nullptr};
+thread_local std::size_t this_worker_index {0};
+
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool() : WorkStealingThreadPool {0} {}
+
+WorkStealingThreadPool::WorkStealingThreadPool(const std::size_t n_threads)
+: stop_ {false}
+, n_idle_ {n_threads}
+, n_pending_ {0}
+, next_queue_ {0}
+, epoch_ {0}
+{
+    queues_.reserve(n_threads);
+    for (std::size_t i {0}; i < n_threads; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    workers_.reserve(n_threads);
+    for (std::size_t i {0}; i < n_threads; ++i) {
+        workers_.emplace_back([this, i] { run(i); });
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lk {mutex_};
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+std::size_t WorkStealingThreadPool::size() const noexcept
+{
+    return workers_.size();
+}
+
+bool WorkStealingThreadPool::empty() const noexcept
+{
+    return workers_.empty();
+}
+
+std::size_t WorkStealingThreadPool::n_idle() const noexcept
+{
+    return n_idle_;
+}
+
+std::size_t WorkStealingThreadPool::n_pending() const noexcept
+{
+    return n_pending_;
+}
+
+boost::optional<std::size_t> WorkStealingThreadPool::this_worker() const noexcept
+{
+    if (this_pool == this) {
+        return this_worker_index;
+    } else {
+        return boost::none;
+    }
+}
+
+void WorkStealingThreadPool::clear() noexcept
+{
+    for (auto& queue : queues_) {
+        std::lock_guard<std::mutex> queue_lk {queue->mutex};
+        std::lock_guard<std::mutex> lk {mutex_};
+        n_pending_ -= queue->tasks.size();
+        queue->tasks.clear();
+    }
+}
+
+// private methods
+
+void WorkStealingThreadPool::enqueue(std::function<void()> task)
+{
+    if (workers_.empty()) throw std::runtime_error {"WorkStealingThreadPool: calling push on empty pool"};
+    // n_pending_ is incremented before the task is visible so it never underflows when the task is taken
+    ++n_pending_;
+    const auto worker = this_worker();
+    auto& queue = worker ? *queues_[*worker] : *queues_[next_queue_++ % queues_.size()];
+    {
+        std::lock_guard<std::mutex> queue_lk {queue.mutex};
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        // The epoch must only change once the task is visible, see run
+        std::lock_guard<std::mutex> lk {mutex_};
+        ++epoch_;
+    }
+    cv_.notify_one();
+}
+
+bool WorkStealingThreadPool::try_pop(const std::size_t worker, std::function<void()>& task)
+{
+    auto& queue = *queues_[worker];
+    std::lock_guard<std::mutex> queue_lk {queue.mutex};
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingThreadPool::try_steal(const std::size_t thief, std::function<void()>& task, const bool wait_for_lock)
+{
+    for (std::size_t i {1}; i < queues_.size(); ++i) {
+        auto& queue = *queues_[(thief + i) % queues_.size()];
+        std::unique_lock<std::mutex> queue_lk {queue.mutex, std::defer_lock};
+        if (wait_for_lock) {
+            queue_lk.lock();
+        } else {
+            queue_lk.try_lock();
+        }
+        if (queue_lk.owns_lock() && !queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingThreadPool::execute(std::function<void()>& task)
+{
+    --n_pending_;
+    --n_idle_;
+    task();
+    task = nullptr;
+    ++n_idle_;
+}
+
+void WorkStealingThreadPool::run(const std::size_t worker)
+{
+    static constexpr unsigned maxSpins {64};
+    this_pool = this;
+    this_worker_index = worker;
+    std::function<void()> task;
+    unsigned num_spins {0};
+    while (true) {
+        if (try_pop(worker, task) || try_steal(worker, task)) {
+            execute(task);
+            num_spins = 0;
+        } else if (num_spins < maxSpins) {
+            // Work often arrives in bursts, so spin briefly before paying for a sleep
+            ++num_spins;
+            std::this_thread::yield();
+        } else {
+            num_spins = 0;
+            // Eventcount: read the epoch, then look at every queue without skipping contended ones.
+            // A task pushed after the scan bumps the epoch after it is visible, so the wait below
+            // cannot miss it.
+            std::unique_lock<std::mutex> lk {mutex_};
+            if (stop_ && n_pending_ == 0) return;
+            const auto epoch = epoch_;
+            lk.unlock();
+            if (try_pop(worker, task) || try_steal(worker, task, true)) {
+                execute(task);
+            } else {
+                lk.lock();
+                cv_.wait(lk, [this, epoch] () { return stop_ || epoch_ != epoch; });
+            }
+        }
+    }
+}
+
+} // namespace octopus
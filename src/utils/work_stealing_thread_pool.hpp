@@ -0,0 +1,104 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef work_stealing_thread_pool_hpp
+#define work_stealing_thread_pool_hpp
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+
+#include <boost/optional.hpp>
+
+namespace octopus {
+
+/*
+    A persistent thread pool where each worker owns a task deque. Tasks pushed from a worker
+    go onto the back of that worker's own deque, and are popped LIFO by the owner so recently
+    spawned (cache-hot) work is done first. Idle workers steal FIFO from the front of other
+    workers' deques, which tends to take the oldest (usually largest) pending work.
+
+    Tasks pushed from outside the pool are distributed round-robin over the worker deques.
+ */
+class WorkStealingThreadPool
+{
+public:
+    WorkStealingThreadPool();
+    explicit WorkStealingThreadPool(std::size_t n_threads);
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&)             = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&)  = delete;
+    WorkStealingThreadPool(WorkStealingThreadPool&& other) noexcept   = delete;
+    WorkStealingThreadPool& operator=(WorkStealingThreadPool&& other) = delete;
+
+    ~WorkStealingThreadPool() noexcept;
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::size_t n_idle() const noexcept;
+    std::size_t n_pending() const noexcept;
+
+    // The index of the calling thread if it is a worker of this pool
+    boost::optional<std::size_t> this_worker() const noexcept;
+
+    // Removes all pending (not yet started) tasks
+    void clear() noexcept;
+
+    template <typename F, typename... Args>
+    auto push(F&& f, Args&&... args) -> std::future<std::result_of_t<F(Args...)>>;
+
+    // Like push but without a future. The task must not throw.
+    template <typename F>
+    void spawn(F&& f);
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> stop_;
+    std::atomic<std::size_t> n_idle_, n_pending_, next_queue_;
+    std::size_t epoch_; // guarded by mutex_, bumped after each task becomes visible
+
+    void enqueue(std::function<void()> task);
+    bool try_pop(std::size_t worker, std::function<void()>& task);
+    bool try_steal(std::size_t thief, std::function<void()>& task, bool wait_for_lock = false);
+    void execute(std::function<void()>& task);
+    void run(std::size_t worker);
+};
+
+template <typename F, typename... Args>
+auto WorkStealingThreadPool::push(F&& f, Args&&... args) -> std::future<std::result_of_t<F(Args...)>>
+{
+    using f_result_type = std::result_of_t<F(Args...)>;
+    auto task = std::make_shared<std::packaged_task<f_result_type()>>(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    auto result = task->get_future();
+    enqueue([task] () { (*task)(); });
+    return result;
+}
+
+template <typename F>
+void WorkStealingThreadPool::spawn(F&& f)
+{
+    enqueue(std::function<void()> {std::forward<F>(f)});
+}
+
+} // namespace octopus
+
+#endif
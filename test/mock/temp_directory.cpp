@@ -0,0 +1,42 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "temp_directory.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/filesystem/operations.hpp>
+
+namespace octopus { namespace test {
+
+namespace fs = boost::filesystem;
+
+TempDirectory::TempDirectory()
+: path_ {fs::temp_directory_path() / fs::unique_path("octopus-test-%%%%-%%%%-%%%%")}
+{
+    fs::create_directories(path_);
+}
+
+TempDirectory::~TempDirectory()
+{
+    boost::system::error_code ec {};
+    fs::remove_all(path_, ec);
+}
+
+const TempDirectory::Path& TempDirectory::path() const noexcept
+{
+    return path_;
+}
+
+TempDirectory::Path TempDirectory::write(const std::string& name, const std::string& contents) const
+{
+    auto result = path_ / name;
+    std::ofstream file {result.string()};
+    file << contents;
+    if (!file) throw std::runtime_error {"TempDirectory: could not write " + result.string()};
+    return result;
+}
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,40 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef temp_directory_hpp
+#define temp_directory_hpp
+
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+
+namespace octopus { namespace test {
+
+// A fresh directory for the files a test writes, which is removed, with its contents, on destruction
+class TempDirectory
+{
+public:
+    using Path = boost::filesystem::path;
+    
+    TempDirectory();
+    
+    TempDirectory(const TempDirectory&)            = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+    TempDirectory(TempDirectory&&)                 = delete;
+    TempDirectory& operator=(TempDirectory&&)      = delete;
+    
+    ~TempDirectory();
+    
+    const Path& path() const noexcept;
+    
+    // Writes a file with the given contents to the directory, and returns its path
+    Path write(const std::string& name, const std::string& contents) const;
+    
+private:
+    Path path_;
+};
+
+} // namespace test
+} // namespace octopus
+
+#endif
@@ -0,0 +1,180 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <cmath>
+#include <cstddef>
+
+#include <boost/filesystem.hpp>
+
+#include "ranger/ForestProbability.h"
+
+#include "core/csr/filters/flat_forest.hpp"
+#include "mock/temp_directory.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(flat_forest)
+
+namespace fs = boost::filesystem;
+
+using ::octopus::csr::FlatForest;
+
+namespace {
+
+// The value RandomForestFilter gives missing measures
+constexpr double missingValue {-1.0};
+
+const std::vector<std::string> feature_names {"A", "B", "C"};
+const std::vector<std::string> unordered_feature_names {"C"};
+constexpr std::size_t numFeatures {3};
+
+// A is continuous on a half-unit grid, B is a count, and C is an unordered factor with levels 1-4.
+// A and B are sometimes missing.
+std::vector<double> make_random_row(std::mt19937& generator)
+{
+    std::uniform_int_distribution<int> a_dist {0, 20}, b_dist {0, 30}, c_dist {1, 4};
+    std::bernoulli_distribution missing_dist {0.15};
+    std::vector<double> result(numFeatures);
+    result[0] = missing_dist(generator) ? missingValue : a_dist(generator) / 2.0;
+    result[1] = missing_dist(generator) ? missingValue : b_dist(generator);
+    result[2] = c_dist(generator);
+    return result;
+}
+
+int classify(const std::vector<double>& row, std::mt19937& generator)
+{
+    std::bernoulli_distribution noise_dist {0.1};
+    const bool truth {(row[0] > 5 && row[2] != 2) || row[1] > 20 || (row[0] == missingValue && row[2] == 3)};
+    return truth != noise_dist(generator) ? 1 : 0;
+}
+
+void write_data(const std::vector<std::vector<double>>& rows, const std::vector<int>& classes, const fs::path& file)
+{
+    std::ofstream out {file.string()};
+    out << std::setprecision(std::numeric_limits<double>::max_digits10); // boundary values must round trip
+    for (const auto& name : feature_names) out << name << ' ';
+    out << "TP\n";
+    for (std::size_t i {0}; i < rows.size(); ++i) {
+        for (const auto value : rows[i]) out << value << ' ';
+        out << classes[i] << '\n';
+    }
+}
+
+// Returns the path of the saved forest
+fs::path train_forest(const TempDirectory& directory, std::vector<std::vector<double>>& ordered_split_values)
+{
+    std::mt19937 generator {42};
+    std::vector<std::vector<double>> rows {};
+    std::vector<int> classes {};
+    for (int i {0}; i < 500; ++i) {
+        rows.push_back(make_random_row(generator));
+        classes.push_back(classify(rows.back(), generator));
+    }
+    const auto data_path = directory.path() / "training.dat";
+    write_data(rows, classes, data_path);
+    const auto prefix = directory.path() / "trained";
+    ranger::ForestProbability forest {};
+    forest.initCpp("TP", ranger::MemoryMode::MEM_DOUBLE, data_path.string(), 0, prefix.string(),
+                   20, nullptr, 7, 1, "", ranger::ImportanceMode::IMP_NONE, 1, "",
+                   {}, "", true, unordered_feature_names, false, ranger::SplitRule::LOGRANK, "", false, 0,
+                   ranger::DEFAULT_ALPHA, ranger::DEFAULT_MINPROP, false,
+                   ranger::PredictionType::RESPONSE, ranger::DEFAULT_NUM_RANDOM_SPLITS, ranger::DEFAULT_MAXDEPTH);
+    forest.run(false, false);
+    forest.saveToFile();
+    ordered_split_values.assign(numFeatures, {});
+    const auto child_node_ids = forest.getChildNodeIDs();
+    const auto split_var_ids = forest.getSplitVarIDs();
+    const auto split_values = forest.getSplitValues();
+    for (std::size_t tree {0}; tree < split_values.size(); ++tree) {
+        for (std::size_t node {0}; node < split_values[tree].size(); ++node) {
+            const auto is_terminal = child_node_ids[tree][0][node] == 0 && child_node_ids[tree][1][node] == 0;
+            const auto feature = split_var_ids[tree][node];
+            if (!is_terminal && forest.getIsOrderedVariable()[feature]) {
+                ordered_split_values[feature].push_back(split_values[tree][node]);
+            }
+        }
+    }
+    fs::path result {prefix.string() + ".forest"};
+    BOOST_REQUIRE(fs::exists(result));
+    return result;
+}
+
+// Random rows, including missing values, and rows with each ordered feature exactly on, and either
+// side of, every split value.
+std::vector<std::vector<double>> make_test_rows(const std::vector<std::vector<double>>& ordered_split_values)
+{
+    std::mt19937 generator {13};
+    std::vector<std::vector<double>> result {};
+    for (int i {0}; i < 300; ++i) result.push_back(make_random_row(generator));
+    for (std::size_t feature {0}; feature < numFeatures; ++feature) {
+        for (const auto split_value : ordered_split_values[feature]) {
+            for (const auto value : {split_value, std::nextafter(split_value, -INFINITY), std::nextafter(split_value, INFINITY)}) {
+                auto row = make_random_row(generator);
+                row[feature] = value;
+                result.push_back(std::move(row));
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<std::vector<double>>
+ranger_predict(const fs::path& forest_path, const std::vector<std::vector<double>>& rows, const TempDirectory& directory)
+{
+    const auto data_path = directory.path() / "prediction.dat";
+    write_data(rows, std::vector<int>(rows.size(), 0), data_path);
+    const auto prefix = directory.path() / "predicted";
+    ranger::ForestProbability forest {};
+    forest.initCpp("", ranger::MemoryMode::MEM_DOUBLE, data_path.string(), 0, prefix.string(),
+                   1000, nullptr, 12, 1, forest_path.string(), ranger::ImportanceMode::IMP_GINI, 1, "",
+                   {}, "", true, {}, false, ranger::SplitRule::LOGRANK, "", false, 1.0,
+                   ranger::DEFAULT_ALPHA, ranger::DEFAULT_MINPROP, false,
+                   ranger::PredictionType::RESPONSE, ranger::DEFAULT_NUM_RANDOM_SPLITS, ranger::DEFAULT_MAXDEPTH);
+    forest.run(false, false);
+    return forest.getPredictions().front();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(flat_forest_predictions_match_ranger)
+{
+    const TempDirectory directory {};
+    std::vector<std::vector<double>> ordered_split_values {};
+    const auto forest_path = train_forest(directory, ordered_split_values);
+    BOOST_REQUIRE(!ordered_split_values[0].empty() && !ordered_split_values[1].empty());
+    const auto rows = make_test_rows(ordered_split_values);
+    const auto expected = ranger_predict(forest_path, rows, directory);
+    BOOST_REQUIRE_EQUAL(expected.size(), rows.size());
+    
+    const FlatForest forest {forest_path};
+    BOOST_CHECK_EQUAL(forest.num_trees(), 20);
+    BOOST_CHECK(forest.feature_names() == feature_names);
+    BOOST_REQUIRE_EQUAL(forest.num_classes(), 2);
+    std::vector<double> flat_rows {};
+    for (const auto& row : rows) flat_rows.insert(std::cend(flat_rows), std::cbegin(row), std::cend(row));
+    const auto predictions = forest.predict(flat_rows);
+    BOOST_REQUIRE_EQUAL(predictions.size(), rows.size() * forest.num_classes());
+    for (std::size_t i {0}; i < rows.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(expected[i].size(), forest.num_classes());
+        for (std::size_t k {0}; k < forest.num_classes(); ++k) {
+            BOOST_CHECK_EQUAL(predictions[i * forest.num_classes() + k], expected[i][k]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
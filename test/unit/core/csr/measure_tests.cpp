@@ -0,0 +1,191 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstddef>
+
+#include <boost/variant.hpp>
+
+#include "basics/aligned_read.hpp"
+#include "basics/cigar_string.hpp"
+#include "basics/genomic_region.hpp"
+#include "config/common.hpp"
+#include "io/variant/vcf_record.hpp"
+#include "core/csr/facets/samples.hpp"
+#include "core/csr/facets/alleles.hpp"
+#include "core/csr/facets/overlapping_reads.hpp"
+#include "core/csr/measures/measure.hpp"
+#include "core/csr/measures/depth.hpp"
+#include "core/csr/measures/genotype_quality.hpp"
+#include "core/csr/measures/is_refcall.hpp"
+#include "core/csr/measures/model_posterior.hpp"
+#include "core/csr/measures/posterior_probability.hpp"
+#include "core/csr/measures/quality.hpp"
+#include "core/csr/measures/variant_length.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(measures)
+
+using namespace ::octopus::csr;
+
+namespace {
+
+const std::vector<SampleName> samples {"A", "B"};
+
+using Phasing = VcfRecord::Builder::Phasing;
+using AlleleList = std::vector<VcfRecord::NucleotideSequence>;
+
+// Three calls covering present, missing and absent fields
+std::vector<VcfRecord> make_calls()
+{
+    std::vector<VcfRecord> result {};
+    result.push_back(VcfRecord::Builder {}
+                     .set_chrom("1").set_pos(100).set_ref("A").set_alt("C").set_qual(30)
+                     .set_info("DP", "20").set_info("MP", "5.5").set_info("PP", "40")
+                     .set_format({"GT", "GQ", "DP"})
+                     .set_genotype("A", AlleleList {"A", "C"}, Phasing::unphased).set_format("A", "GQ", "25").set_format("A", "DP", "10")
+                     .set_genotype("B", AlleleList {"A", "A"}, Phasing::unphased).set_format("B", "GQ", "40").set_format("B", "DP", "10")
+                     .build_once());
+    result.push_back(VcfRecord::Builder {}
+                     .set_chrom("1").set_pos(200).set_ref("AT").set_alt("A")
+                     .set_info("DP", "5").set_info_missing("MP")
+                     .set_format({"GT", "DP"})
+                     .set_genotype("A", AlleleList {"A", "A"}, Phasing::unphased).set_format("A", "DP", "3")
+                     .set_genotype("B", AlleleList {"AT", "A"}, Phasing::unphased).set_format("B", "DP", "2")
+                     .build_once());
+    result.push_back(VcfRecord::Builder {}
+                     .set_chrom("1").set_pos(300).set_ref("G").set_alt("TTT").set_qual(10)
+                     .set_info("DP", "8").set_info("MP", "1").set_info("PP", ".")
+                     .set_format({"GT", "GQ", "DP"})
+                     .set_genotype("A", AlleleList {"G", "G"}, Phasing::unphased).set_format("A", "GQ", "12").set_format("A", "DP", "4")
+                     .set_genotype("B", AlleleList {"TTT", "TTT"}, Phasing::phased).set_format("B", "GQ", "7").set_format("B", "DP", "4")
+                     .build_once());
+    return result;
+}
+
+AlignedRead make_read(const GenomicRegion::Position begin)
+{
+    return AlignedRead {
+        "read", GenomicRegion {"1", begin, begin + 10}, "ACGTACGTAC", AlignedRead::BaseQualityVector(10, 30),
+        parse_cigar("10M"), 60, AlignedRead::Flags {}, "", ""
+    };
+}
+
+ReadMap make_reads()
+{
+    ReadMap result {};
+    result[samples[0]].insert(make_read(95));
+    result[samples[0]].insert(make_read(195));
+    result[samples[0]].insert(make_read(290));
+    result[samples[1]].insert(make_read(92));
+    result[samples[1]].insert(make_read(500));
+    return result;
+}
+
+struct Facets
+{
+    FacetWrapper samples_facet, alleles_facet, reads_facet;
+    Measure::FacetMap map;
+
+    Facets(const std::vector<VcfRecord>& calls)
+    : samples_facet {std::make_unique<Samples>(samples)}
+    , alleles_facet {std::make_unique<Alleles>(samples, calls)}
+    , reads_facet {std::make_unique<OverlappingReads>(make_reads())}
+    , map {}
+    {
+        for (const auto& facet : {std::cref(samples_facet), std::cref(alleles_facet), std::cref(reads_facet)}) {
+            map.emplace(facet.get().name(), facet);
+        }
+    }
+};
+
+bool is_typed(const Measure::Column& column) noexcept
+{
+    return boost::get<Measure::Array<Measure::ResultType>>(&column) == nullptr;
+}
+
+// The block path must give the same call and sample values as evaluating each call on its own
+void check_block_matches_calls(const MeasureWrapper& measure, const std::vector<VcfRecord>& calls, const Measure::FacetMap& facets)
+{
+    const auto column = measure(calls, facets);
+    BOOST_CHECK(is_typed(column));
+    for (std::size_t call_idx {0}; call_idx < calls.size(); ++call_idx) {
+        const auto expected = measure(calls[call_idx], facets);
+        BOOST_CHECK_MESSAGE(get_call_value(column, measure, call_idx) == expected,
+                            measure.name() << " differs for call " << call_idx);
+        for (std::size_t sample_idx {0}; sample_idx < samples.size(); ++sample_idx) {
+            for (const bool aggregate : {false, true}) {
+                BOOST_CHECK_MESSAGE(get_sample_value(column, measure, call_idx, sample_idx, aggregate)
+                                    == get_sample_value(expected, measure, sample_idx, aggregate),
+                                    measure.name() << " differs for call " << call_idx << " sample " << sample_idx);
+            }
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(block_evaluation_matches_call_evaluation)
+{
+    const auto calls = make_calls();
+    const Facets facets {calls};
+    const std::vector<MeasureWrapper> measures {
+        make_wrapped_measure<Depth>(false, true),
+        make_wrapped_measure<Depth>(false, false),
+        make_wrapped_measure<Depth>(true, true),
+        make_wrapped_measure<Depth>(true, false),
+        make_wrapped_measure<GenotypeQuality>(),
+        make_wrapped_measure<IsRefcall>(true),
+        make_wrapped_measure<IsRefcall>(false),
+        make_wrapped_measure<ModelPosterior>(),
+        make_wrapped_measure<PosteriorProbability>(),
+        make_wrapped_measure<Quality>(),
+        make_wrapped_measure<VariantLength>()
+    };
+    for (const auto& measure : measures) {
+        check_block_matches_calls(measure, calls, facets.map);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(typed_columns_mark_missing_values)
+{
+    const auto calls = make_calls();
+    const Facets facets {calls};
+
+    const auto quality = boost::get<Measure::TypedColumn<double>>(make_wrapped_measure<Quality>()(calls, facets.map));
+    BOOST_CHECK_EQUAL(quality.values_per_call, 1);
+    BOOST_CHECK(quality.missing == (std::vector<bool> {false, true, false}));
+    BOOST_CHECK_EQUAL(quality.values[0], 30);
+    BOOST_CHECK_EQUAL(quality.values[2], 10);
+
+    const auto posterior = boost::get<Measure::TypedColumn<double>>(make_wrapped_measure<PosteriorProbability>()(calls, facets.map));
+    BOOST_CHECK(posterior.missing == (std::vector<bool> {false, true, true}));
+
+    const auto gq = boost::get<Measure::TypedColumn<double>>(make_wrapped_measure<GenotypeQuality>()(calls, facets.map));
+    BOOST_CHECK_EQUAL(gq.values_per_call, samples.size());
+    BOOST_CHECK(gq.missing == (std::vector<bool> {false, false, true, true, false, false}));
+
+    // Values that are never missing leave the mask empty
+    const auto depth = boost::get<Measure::TypedColumn<std::size_t>>(make_wrapped_measure<Depth>(false, false)(calls, facets.map));
+    BOOST_CHECK_EQUAL(depth.values_per_call, samples.size());
+    BOOST_CHECK(depth.missing.empty());
+    BOOST_CHECK(depth.values == (std::vector<std::size_t> {10, 10, 3, 2, 4, 4}));
+
+    const auto recalculated_depth = boost::get<Measure::TypedColumn<std::size_t>>(make_wrapped_measure<Depth>(true, false)(calls, facets.map));
+    BOOST_CHECK(recalculated_depth.values == (std::vector<std::size_t> {1, 1, 1, 0, 1, 0}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
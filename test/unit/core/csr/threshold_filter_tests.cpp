@@ -0,0 +1,166 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+#include "config/common.hpp"
+#include "io/variant/vcf_header.hpp"
+#include "io/variant/vcf_record.hpp"
+#include "core/csr/facets/facet_factory.hpp"
+#include "core/csr/measures/measure.hpp"
+#include "core/csr/measures/depth.hpp"
+#include "core/csr/measures/genotype_quality.hpp"
+#include "core/csr/measures/model_posterior.hpp"
+#include "core/csr/measures/posterior_probability.hpp"
+#include "core/csr/measures/quality.hpp"
+#include "core/csr/measures/variant_length.hpp"
+#include "core/csr/filters/threshold_filter.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(csr)
+BOOST_AUTO_TEST_SUITE(filters)
+
+using namespace ::octopus::csr;
+
+namespace {
+
+const std::vector<SampleName> samples {"A", "B"};
+
+using Phasing = VcfRecord::Builder::Phasing;
+using AlleleList = std::vector<VcfRecord::NucleotideSequence>;
+
+std::vector<VcfRecord> make_calls()
+{
+    std::vector<VcfRecord> result {};
+    result.push_back(VcfRecord::Builder {}
+                     .set_chrom("1").set_pos(100).set_ref("A").set_alt("C").set_qual(30)
+                     .set_info("DP", "20").set_info("MP", "5.5").set_info("PP", "40")
+                     .set_format({"GT", "GQ", "DP"})
+                     .set_genotype("A", AlleleList {"A", "C"}, Phasing::unphased).set_format("A", "GQ", "25").set_format("A", "DP", "10")
+                     .set_genotype("B", AlleleList {"A", "A"}, Phasing::unphased).set_format("B", "GQ", "40").set_format("B", "DP", "10")
+                     .build_once());
+    result.push_back(VcfRecord::Builder {}
+                     .set_chrom("1").set_pos(200).set_ref("AT").set_alt("A")
+                     .set_info("DP", "5").set_info_missing("MP")
+                     .set_format({"GT", "DP"})
+                     .set_genotype("A", AlleleList {"A", "A"}, Phasing::unphased).set_format("A", "DP", "3")
+                     .set_genotype("B", AlleleList {"AT", "A"}, Phasing::unphased).set_format("B", "DP", "2")
+                     .build_once());
+    result.push_back(VcfRecord::Builder {}
+                     .set_chrom("1").set_pos(300).set_ref("G").set_alt("TTT").set_qual(40)
+                     .set_info("DP", "8").set_info("MP", "1").set_info("PP", ".")
+                     .set_format({"GT", "GQ", "DP"})
+                     .set_genotype("A", AlleleList {"G", "G"}, Phasing::unphased).set_format("A", "GQ", "12").set_format("A", "DP", "4")
+                     .set_genotype("B", AlleleList {"TTT", "TTT"}, Phasing::phased).set_format("B", "GQ", "7").set_format("B", "DP", "4")
+                     .build_once());
+    result.push_back(VcfRecord::Builder {}
+                     .set_chrom("1").set_pos(400).set_ref("C").set_alt("G").set_qual(3)
+                     .set_info("DP", "30").set_info("MP", "10").set_info("PP", "50")
+                     .set_format({"GT", "GQ", "DP"})
+                     .set_genotype("A", AlleleList {"C", "G"}, Phasing::unphased).set_format("A", "GQ", "50").set_format("A", "DP", "15")
+                     .set_genotype("B", AlleleList {"C", "G"}, Phasing::unphased).set_format("B", "GQ", "50").set_format("B", "DP", "15")
+                     .build_once());
+    return result;
+}
+
+VcfHeader make_test_header()
+{
+    return VcfHeader::Builder {}.set_samples(samples).build_once();
+}
+
+using Condition = ThresholdVariantCallFilter::Condition;
+
+ThresholdVariantCallFilter::ConditionVectorPair make_conditions()
+{
+    ThresholdVariantCallFilter::ConditionVectorPair result {};
+    result.hard.push_back({make_wrapped_measure<Quality>(), make_wrapped_threshold<LessThreshold<>>(5)});
+    result.soft.push_back({make_wrapped_measure<Quality>(), make_wrapped_threshold<LessThreshold<>>(35), "q35"});
+    result.soft.push_back({make_wrapped_measure<GenotypeQuality>(), make_wrapped_threshold<LessThreshold<>>(30), "LGQ"});
+    result.soft.push_back({make_wrapped_measure<Depth>(false, false), make_wrapped_threshold<LessThreshold<>>(4), "DP"});
+    result.soft.push_back({make_wrapped_measure<ModelPosterior>(), make_wrapped_threshold<LessThreshold<>>(3), "LMP"});
+    result.soft.push_back({make_wrapped_measure<PosteriorProbability>(), make_wrapped_threshold<LessThreshold<>>(45), "LMP"});
+    result.soft.push_back({make_wrapped_measure<VariantLength>(), make_wrapped_threshold<GreaterThreshold<>>(1), "VL"});
+    return result;
+}
+
+// Exposes the column-wise and call-wise classification paths of ThresholdVariantCallFilter
+class TestThresholdFilter : public ThresholdVariantCallFilter
+{
+public:
+    TestThresholdFilter()
+    : ThresholdVariantCallFilter {FacetFactory {make_test_header()}, make_conditions(), OutputOptions {}, ConcurrencyPolicy {}}
+    {}
+
+    std::vector<ClassificationList> classify_by_column(const CallBlock& block) const
+    {
+        return classify_block(measure(block), block.size(), samples);
+    }
+
+    std::vector<ClassificationList> classify_by_call(const CallBlock& block) const
+    {
+        const FacetFactory facet_factory {make_test_header()};
+        const auto facets = facet_factory.make(get_all_requirements(measures_), block);
+        Measure::FacetMap facet_map {};
+        for (const auto& facet : facets) {
+            facet_map.emplace(facet.name(), std::cref(facet));
+        }
+        MeasureBlock measures(measures_.size());
+        for (std::size_t i {0}; i < measures_.size(); ++i) {
+            Measure::Array<Measure::ResultType> values {};
+            values.reserve(block.size());
+            for (const auto& call : block) {
+                values.push_back(measures_[i](call, facet_map));
+            }
+            measures[i] = std::move(values);
+        }
+        return SinglePassVariantCallFilter::classify_block(measures, block.size(), samples);
+    }
+
+    static bool is_hard_filtered(const Classification& classification) noexcept
+    {
+        return classification.category == Classification::Category::hard_filtered;
+    }
+
+    static bool is_equal(const Classification& lhs, const Classification& rhs)
+    {
+        return lhs.category == rhs.category && lhs.reasons == rhs.reasons;
+    }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(classify_block_matches_call_classification)
+{
+    const auto calls = make_calls();
+    const TestThresholdFilter filter {};
+    const auto column_classifications = filter.classify_by_column(calls);
+    const auto call_classifications = filter.classify_by_call(calls);
+    BOOST_REQUIRE_EQUAL(column_classifications.size(), calls.size());
+    BOOST_REQUIRE_EQUAL(call_classifications.size(), calls.size());
+    for (std::size_t call_idx {0}; call_idx < calls.size(); ++call_idx) {
+        BOOST_REQUIRE_EQUAL(column_classifications[call_idx].size(), samples.size());
+        BOOST_REQUIRE_EQUAL(call_classifications[call_idx].size(), samples.size());
+        for (std::size_t sample_idx {0}; sample_idx < samples.size(); ++sample_idx) {
+            BOOST_CHECK_MESSAGE(TestThresholdFilter::is_equal(column_classifications[call_idx][sample_idx],
+                                                              call_classifications[call_idx][sample_idx]),
+                                "classification differs for call " << call_idx << " sample " << sample_idx);
+        }
+    }
+    // The last call fails the hard QUAL threshold in both paths
+    BOOST_CHECK(TestThresholdFilter::is_hard_filtered(column_classifications.back().front()));
+    BOOST_CHECK(TestThresholdFilter::is_hard_filtered(call_classifications.back().front()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
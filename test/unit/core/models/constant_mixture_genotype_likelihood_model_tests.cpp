@@ -0,0 +1,174 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <cstddef>
+#include <cmath>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/cigar_string.hpp"
+#include "basics/aligned_read.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "containers/mappable_block.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/indexed_haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_model.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/constant_mixture_genotype_likelihood_model.hpp"
+#include "utils/maths.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+using octopus::model::ConstantMixtureGenotypeLikelihoodModel;
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+
+namespace {
+
+const GenomicRegion haplotype_region {"1", 100, 160};
+constexpr GenomicRegion::Size read_length {40};
+
+// Each read is one column of maths::simd::sum_log_sum_exp, which takes 4 reads at a time with SSE2 and 8 with AVX.
+// These counts cover fewer reads than a block, exact blocks, and reads left over for its scalar loop.
+const std::vector<std::size_t> test_num_reads {1, 3, 4, 5, 7, 8, 9, 17, 33};
+
+// The reference haplotype and SNVs in the region covered by every read
+MappableBlock<Haplotype> make_haplotypes(const ReferenceGenome& reference)
+{
+    const auto reference_sequence = reference.fetch_sequence(haplotype_region);
+    const auto mutate = [&] (std::vector<std::size_t> offsets) {
+        auto result = reference_sequence;
+        for (const auto offset : offsets) result[offset] = result[offset] == 'A' ? 'C' : 'A';
+        return Haplotype {haplotype_region, std::move(result), reference};
+    };
+    MappableBlock<Haplotype> result {haplotype_region};
+    result.push_back(mutate({}));
+    result.push_back(mutate({25}));
+    result.push_back(mutate({35}));
+    result.push_back(mutate({25, 35}));
+    result.push_back(mutate({22, 25, 28, 31, 35, 38})); // far from the other haplotypes
+    return result;
+}
+
+// Reads cycle through the haplotypes and base qualities, so likelihoods range from near zero to very small
+ReadContainer sample_reads(const MappableBlock<Haplotype>& haplotypes, const std::size_t num_reads, const std::string& sample)
+{
+    const std::vector<AlignedRead::BaseQuality> base_qualities {40, 5, 60, 20};
+    ReadContainer result {};
+    for (std::size_t i {0}; i < num_reads; ++i) {
+        const auto& haplotype = haplotypes[i % haplotypes.size()];
+        const auto offset = static_cast<GenomicRegion::Position>(i % 21);
+        const GenomicRegion read_region {"1", haplotype_region.begin() + offset, haplotype_region.begin() + offset + read_length};
+        result.emplace(sample + std::to_string(i), read_region, haplotype.sequence().substr(offset, read_length),
+                       AlignedRead::BaseQualityVector(read_length, base_qualities[i % base_qualities.size()]),
+                       parse_cigar(std::to_string(read_length) + "M"), 60, AlignedRead::Flags {}, "RG", "");
+    }
+    return result;
+}
+
+// sum {read} ln (1 / ploidy) sum {haplotype in genotype} p(read | haplotype), computed read by read
+double evaluate_reference(const Genotype<IndexedHaplotype<>>& genotype, const HaplotypeLikelihoodArray& likelihoods)
+{
+    const auto num_reads = likelihoods[genotype[0]].size();
+    std::vector<double> read_likelihoods(genotype.ploidy());
+    double result {0};
+    for (std::size_t read {0}; read < num_reads; ++read) {
+        for (unsigned i {0}; i < genotype.ploidy(); ++i) read_likelihoods[i] = likelihoods[genotype[i]][read];
+        result += maths::log_sum_exp(read_likelihoods) - std::log(genotype.ploidy());
+    }
+    return result;
+}
+
+void check_batch(const std::vector<Genotype<IndexedHaplotype<>>>& genotypes, const HaplotypeLikelihoodArray& likelihoods)
+{
+    const ConstantMixtureGenotypeLikelihoodModel model {likelihoods};
+    const auto batched = evaluate(genotypes, model);
+    BOOST_REQUIRE_EQUAL(batched.size(), genotypes.size());
+    const auto num_reads = likelihoods.num_likelihoods();
+    for (std::size_t g {0}; g < genotypes.size(); ++g) {
+        BOOST_TEST_CONTEXT("genotype " << g << ", ploidy " << genotypes[g].ploidy() << ", reads " << num_reads) {
+            BOOST_REQUIRE(std::isfinite(batched[g]));
+            BOOST_CHECK_SMALL(batched[g] - model.evaluate(genotypes[g]), 1e-6 * num_reads);
+            BOOST_CHECK_SMALL(batched[g] - evaluate_reference(genotypes[g], likelihoods), 1e-6 * num_reads);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(batched_evaluation_matches_single_genotype_evaluation)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference);
+    const auto indexed_haplotypes = index(haplotypes);
+    const std::vector<SampleName> samples {"sample"};
+    for (const auto num_reads : test_num_reads) {
+        ReadMap reads {};
+        reads.emplace(samples[0], sample_reads(haplotypes, num_reads, samples[0]));
+        HaplotypeLikelihoodArray likelihoods {HaplotypeLikelihoodModel {}, static_cast<unsigned>(haplotypes.size()), samples};
+        likelihoods.populate(reads, haplotypes);
+        likelihoods.prime(samples[0]);
+        for (unsigned ploidy {1}; ploidy <= 5; ++ploidy) {
+            const std::vector<Genotype<IndexedHaplotype<>>> genotypes = generate_all_genotypes(indexed_haplotypes, ploidy);
+            check_batch(genotypes, likelihoods);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batched_evaluation_does_not_depend_on_genotype_order)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference);
+    const auto indexed_haplotypes = index(haplotypes);
+    const std::vector<SampleName> samples {"sample"};
+    ReadMap reads {};
+    reads.emplace(samples[0], sample_reads(haplotypes, 13, samples[0]));
+    HaplotypeLikelihoodArray likelihoods {HaplotypeLikelihoodModel {}, static_cast<unsigned>(haplotypes.size()), samples};
+    likelihoods.populate(reads, haplotypes);
+    likelihoods.prime(samples[0]);
+    std::mt19937 generator {42};
+    for (unsigned ploidy {3}; ploidy <= 4; ++ploidy) {
+        std::vector<Genotype<IndexedHaplotype<>>> genotypes = generate_all_genotypes(indexed_haplotypes, ploidy);
+        // Unsorted genotypes share fewer leading haplotypes with their predecessor
+        std::shuffle(std::begin(genotypes), std::end(genotypes), generator);
+        check_batch(genotypes, likelihoods);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batched_evaluation_restarts_when_primed_sample_changes)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference);
+    const auto indexed_haplotypes = index(haplotypes);
+    const std::vector<SampleName> samples {"A", "B"};
+    ReadMap reads {};
+    reads.emplace(samples[0], sample_reads(haplotypes, 9, samples[0]));
+    reads.emplace(samples[1], sample_reads(haplotypes, 6, samples[1]));
+    HaplotypeLikelihoodArray likelihoods {HaplotypeLikelihoodModel {}, static_cast<unsigned>(haplotypes.size()), samples};
+    likelihoods.populate(reads, haplotypes);
+    const std::vector<Genotype<IndexedHaplotype<>>> genotypes = generate_all_genotypes(indexed_haplotypes, 4);
+    const ConstantMixtureGenotypeLikelihoodModel model {likelihoods};
+    for (const auto& sample : samples) {
+        likelihoods.prime(sample);
+        const auto batched = evaluate(genotypes, model);
+        for (std::size_t g {0}; g < genotypes.size(); ++g) {
+            BOOST_CHECK_SMALL(batched[g] - evaluate_reference(genotypes[g], likelihoods), 1e-6 * likelihoods.num_likelihoods());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -1,4 +1,253 @@
 // Copyright (c) 2017 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#include <stdio.h>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <limits>
+#include <cstddef>
+
+#include "utils/kmer_mapper.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+
+namespace {
+
+// The previous k-mer index, one vector of positions per k-mer, and its mapping loop
+namespace legacy {
+
+using KmerHashTable = std::vector<std::vector<std::size_t>>;
+
+template <unsigned char K>
+KmerPerfectHashes compute_kmer_hashes(const std::string& sequence)
+{
+    KmerPerfectHashes result {};
+    for (std::size_t i {0}; i + K <= sequence.size(); ++i) {
+        result.push_back(perfect_kmer_hash<K>(std::next(std::cbegin(sequence), i)));
+    }
+    return result;
+}
+
+template <unsigned char K>
+KmerHashTable make_kmer_hash_table(const std::string& sequence)
+{
+    KmerHashTable result(num_kmers(K));
+    const auto hashes = compute_kmer_hashes<K>(sequence);
+    for (std::size_t index {0}; index < hashes.size(); ++index) {
+        result[hashes[index]].push_back(index);
+    }
+    return result;
+}
+
+std::vector<std::size_t> map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target,
+                                             const std::size_t num_target_positions,
+                                             std::size_t max_mapping_positions = std::numeric_limits<std::size_t>::max())
+{
+    std::vector<std::size_t> result {};
+    MappedIndexCounts mapping_counts(num_target_positions, 0);
+    unsigned max_hit_count {0};
+    std::size_t first_max_hit_index {0};
+    unsigned num_max_hits {0};
+    for (std::size_t query_index {0}; query_index < query.size(); ++query_index) {
+        for (const auto target_index : target[query[query_index]]) {
+            if (target_index >= query_index) {
+                const auto mapping_begin = target_index - query_index;
+                if (++mapping_counts[mapping_begin] > max_hit_count) {
+                    max_hit_count = mapping_counts[mapping_begin];
+                    first_max_hit_index = mapping_begin;
+                    num_max_hits = 1;
+                } else if (mapping_counts[mapping_begin] == max_hit_count) {
+                    ++num_max_hits;
+                    if (mapping_begin < first_max_hit_index) {
+                        first_max_hit_index = mapping_begin;
+                    }
+                }
+            }
+        }
+    }
+    if (max_hit_count > 0) {
+        result.push_back(first_max_hit_index++);
+        --num_max_hits;
+        --max_mapping_positions;
+        while (max_mapping_positions > 0 && num_max_hits > 0) {
+            if (mapping_counts[first_max_hit_index] == max_hit_count) {
+                result.push_back(first_max_hit_index);
+                --num_max_hits;
+                --max_mapping_positions;
+            }
+            ++first_max_hit_index;
+        }
+    }
+    return result;
+}
+
+} // namespace legacy
+
+// Mostly ACGT, with some N and lowercase bases which hash like A
+std::string random_sequence(const std::size_t length, std::mt19937& generator)
+{
+    static const std::string bases {"ACGTACGTACGTACGTNa"};
+    std::uniform_int_distribution<std::size_t> base_dist {0, bases.size() - 1};
+    std::string result(length, 'N');
+    std::generate(std::begin(result), std::end(result), [&] () { return bases[base_dist(generator)]; });
+    return result;
+}
+
+// encode_bases encodes 16 bases per SSE2 load and any remainder one at a time. These lengths cover sequences
+// shorter than the k-mers, just under, at and over multiples of 16, and typical read lengths.
+const std::vector<std::size_t> test_lengths {0, 1, 5, 6, 7, 15, 16, 17, 21, 31, 32, 33, 48, 100, 151};
+
+template <unsigned char K>
+void check_rolling_hashes_match_perfect_kmer_hash(std::mt19937& generator)
+{
+    std::vector<std::string> sequences {std::string(40, 'N'), "NNNNNNNNNNNNNNNNNACGTACGTNNNACGT", "acgtACGTnnNNacgtACGTnnNNacgtACGT"};
+    for (const auto length : test_lengths) {
+        sequences.push_back(random_sequence(length, generator));
+    }
+    for (const auto& sequence : sequences) {
+        const auto hashes = compute_kmer_hashes<K>(sequence);
+        BOOST_TEST_CONTEXT("K = " << static_cast<unsigned>(K) << ", sequence = " << sequence) {
+            BOOST_REQUIRE_EQUAL(hashes.size(), sequence.size() < K ? 0 : sequence.size() - K + 1);
+            for (std::size_t i {0}; i < hashes.size(); ++i) {
+                BOOST_CHECK_EQUAL(hashes[i], perfect_kmer_hash<K>(std::next(std::cbegin(sequence), i)));
+            }
+        }
+    }
+}
+
+template <unsigned char K>
+void check_hash_table_matches_legacy(const std::string& target, const KmerHashTable& table)
+{
+    const auto expected = legacy::make_kmer_hash_table<K>(target);
+    BOOST_REQUIRE_EQUAL(table.offsets.size(), expected.size() + 1);
+    BOOST_CHECK_EQUAL(table.num_positions, target.size() < K ? 0 : target.size() - K + 1);
+    BOOST_CHECK_EQUAL(table.positions.size(), table.num_positions);
+    for (std::size_t hash {0}; hash < expected.size(); ++hash) {
+        const auto first = std::next(std::cbegin(table.positions), table.offsets[hash]);
+        const auto last = std::next(std::cbegin(table.positions), table.offsets[hash + 1]);
+        BOOST_REQUIRE(first <= last);
+        BOOST_CHECK(std::equal(first, last, std::cbegin(expected[hash]), std::cend(expected[hash])));
+    }
+}
+
+// A target with repeats, so queries can map to several positions with equal hit counts
+std::string make_repetitive_target(std::mt19937& generator)
+{
+    const auto unit = random_sequence(23, generator);
+    return random_sequence(30, generator) + unit + random_sequence(11, generator) + unit + unit
+           + std::string(20, 'N') + random_sequence(40, generator) + "ACACACACACACACACACACACACAC";
+}
+
+std::vector<std::string> make_queries(const std::string& target, std::mt19937& generator)
+{
+    std::vector<std::string> result {};
+    std::uniform_int_distribution<std::size_t> position_dist {0, target.size() - 1};
+    std::uniform_int_distribution<std::size_t> length_dist {1, 40};
+    for (int i {0}; i < 200; ++i) {
+        auto query = target.substr(position_dist(generator), length_dist(generator));
+        if (i % 3 == 0 && !query.empty()) query[position_dist(generator) % query.size()] = 'G';
+        if (i % 5 == 0 && !query.empty()) query[position_dist(generator) % query.size()] = 'N';
+        result.push_back(std::move(query));
+    }
+    for (const auto length : test_lengths) {
+        result.push_back(random_sequence(length, generator));
+    }
+    result.push_back("ACACACACACAC");
+    return result;
+}
+
+constexpr unsigned char mapperKmerSize {6}; // as used by HaplotypeLikelihoodArray
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(rolling_kmer_hashes_match_perfect_kmer_hash)
+{
+    std::mt19937 generator {42};
+    check_rolling_hashes_match_perfect_kmer_hash<1>(generator);
+    check_rolling_hashes_match_perfect_kmer_hash<2>(generator);
+    check_rolling_hashes_match_perfect_kmer_hash<5>(generator);
+    check_rolling_hashes_match_perfect_kmer_hash<mapperKmerSize>(generator);
+    check_rolling_hashes_match_perfect_kmer_hash<8>(generator);
+    check_rolling_hashes_match_perfect_kmer_hash<16>(generator);
+}
+
+BOOST_AUTO_TEST_CASE(kmer_hash_table_bins_match_legacy_index)
+{
+    std::mt19937 generator {42};
+    auto reused_table = init_kmer_hash_table<mapperKmerSize>();
+    // Re-populating must not leave positions from a longer target behind
+    for (const auto length : {151, 17, 0, 5, 6, 100, 33}) {
+        const auto target = random_sequence(length, generator);
+        BOOST_TEST_CONTEXT("target length = " << length) {
+            check_hash_table_matches_legacy<mapperKmerSize>(target, make_kmer_hash_table<mapperKmerSize>(target));
+            populate_kmer_hash_table<mapperKmerSize>(target, reused_table);
+            check_hash_table_matches_legacy<mapperKmerSize>(target, reused_table);
+        }
+    }
+    const auto target = make_repetitive_target(generator);
+    check_hash_table_matches_legacy<mapperKmerSize>(target, make_kmer_hash_table<mapperKmerSize>(target));
+}
+
+BOOST_AUTO_TEST_CASE(map_query_to_target_matches_legacy_mapping)
+{
+    std::mt19937 generator {42};
+    const auto target = make_repetitive_target(generator);
+    const auto table = make_kmer_hash_table<mapperKmerSize>(target);
+    const auto legacy_table = legacy::make_kmer_hash_table<mapperKmerSize>(target);
+    auto mapping_counts = init_mapping_counts(table);
+    for (const auto& query : make_queries(target, generator)) {
+        const auto hashes = compute_kmer_hashes<mapperKmerSize>(query);
+        BOOST_TEST_CONTEXT("query = " << query) {
+            const auto expected = legacy::map_query_to_target(hashes, legacy_table, table.num_positions);
+            BOOST_CHECK(map_query_to_target(hashes, table) == expected);
+            BOOST_CHECK(map_query_to_target<mapperKmerSize>(query, target) == expected);
+            for (const std::size_t max_mapping_positions : {1, 2, 10}) {
+                std::vector<std::size_t> positions {};
+                map_query_to_target(hashes, table, mapping_counts, std::back_inserter(positions), max_mapping_positions);
+                reset_mapping_counts(mapping_counts);
+                BOOST_CHECK(positions == legacy::map_query_to_target(hashes, legacy_table, table.num_positions, max_mapping_positions));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(map_queries_to_target_matches_legacy_mapping)
+{
+    std::mt19937 generator {42};
+    const auto target = make_repetitive_target(generator);
+    const auto table = make_kmer_hash_table<mapperKmerSize>(target);
+    const auto legacy_table = legacy::make_kmer_hash_table<mapperKmerSize>(target);
+    const auto queries = make_queries(target, generator);
+    std::vector<KmerPerfectHashes> query_hashes(queries.size());
+    std::transform(std::cbegin(queries), std::cend(queries), std::begin(query_hashes),
+                   [] (const auto& query) { return compute_kmer_hashes<mapperKmerSize>(query); });
+    auto mapping_counts = init_mapping_counts(table);
+    std::vector<std::vector<std::size_t>> positions {};
+    for (const std::size_t max_mapping_positions : {1, 10}) {
+        map_queries_to_target(query_hashes, table, mapping_counts, positions, max_mapping_positions);
+        BOOST_REQUIRE_EQUAL(positions.size(), queries.size());
+        for (std::size_t i {0}; i < queries.size(); ++i) {
+            BOOST_CHECK_MESSAGE(positions[i] == legacy::map_query_to_target(query_hashes[i], legacy_table, table.num_positions,
+                                                                            max_mapping_positions),
+                                "mapping differs for query " << queries[i]);
+        }
+    }
+    // An empty target maps nothing
+    const auto empty_table = make_kmer_hash_table<mapperKmerSize>("");
+    auto empty_counts = init_mapping_counts(empty_table);
+    map_queries_to_target(query_hashes, empty_table, empty_counts, positions, 10);
+    BOOST_CHECK(std::all_of(std::cbegin(positions), std::cend(positions), [] (const auto& p) { return p.empty(); }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -11,6 +11,7 @@
 #include <iostream>
 
 #include "core/models/pairhmm/simd_pair_hmm_factory.hpp"
+#include "core/models/pairhmm/simd_batch_pair_hmm.hpp"
 
 namespace octopus { namespace test {
 
@@ -713,6 +714,46 @@ BOOST_AUTO_TEST_CASE(avx2_check_alignments)
 #endif /* __AVX2__ */
 
 
+template <typename BatchHMM>
+void check_batch_scores(const TestCase& test, const BatchHMM& batch_hmm)
+{
+    SSE2PairHMM<8, short> hmm {};
+    // Each lane gets a different read by mutating one base and lowering one quality
+    const auto num_lanes = BatchHMM::lanes();
+    std::vector<std::string> targets(num_lanes, test.query);
+    std::vector<std::vector<std::int8_t>> qualities(num_lanes, test.base_qualities);
+    const std::vector<char> snv_mask(std::cbegin(test.target), std::cend(test.target));
+    const std::vector<std::int8_t> snv_prior(test.target.size(), 30), gap_extend(test.target.size(), test.gap_extend);
+    std::vector<BatchPairHMMLane> lanes {};
+    std::vector<int> expected_scores {};
+    for (int lane {0}; lane < num_lanes; ++lane) {
+        const auto pos = (lane * 37) % test.query.size();
+        targets[lane][pos] = "ACGTN"[lane % 5];
+        qualities[lane][(pos + 11) % test.query.size()] = 5 + lane;
+        lanes.push_back({test.target.data(), targets[lane].data(), qualities[lane].data(),
+                         snv_mask.data(), snv_prior.data(), test.gap_open.data(), gap_extend.data()});
+        expected_scores.push_back(hmm.align(test.target.data(), targets[lane].data(), qualities[lane].data(),
+                                            static_cast<int>(test.target.size()), static_cast<int>(test.query.size()),
+                                            snv_mask.data(), snv_prior.data(), test.gap_open.data(), gap_extend.data(),
+                                            test.nuc_prior));
+    }
+    for (int num_used_lanes : {1, num_lanes / 2, num_lanes}) {
+        std::vector<int> scores(num_lanes);
+        batch_hmm.align(lanes.data(), num_used_lanes, static_cast<int>(test.query.size()), hmm.band_size(), test.nuc_prior, scores.data());
+        for (int lane {0}; lane < num_used_lanes; ++lane) {
+            BOOST_CHECK_EQUAL(scores[lane], expected_scores[lane]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_pair_hmm_scores_match_banded_pair_hmm)
+{
+    check_batch_scores(band8_speed_test, ScalarBatchPairHMM<> {});
+    check_batch_scores(band8_speed_test, SSE2BatchPairHMM<> {});
+    check_batch_scores(band8_speed_test, FastestBatchPairHMM {});
+}
+
+
 // Speed tests
 
 
@@ -0,0 +1,159 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <random>
+#include <limits>
+#include <cstddef>
+#include <cmath>
+
+#include "utils/maths.hpp"
+#include "core/models/genotype/simd_vb_kernels.hpp"
+
+namespace octopus { namespace test {
+
+namespace simd = octopus::model::simd;
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+
+namespace {
+
+// The kernels work on 8 floats at a time with AVX2 and 4 with SSE2, then finish the last n % 8 (or n % 4)
+// values in a scalar loop. The lengths include some shorter than a block, exact multiples of both widths,
+// and most remainders.
+const std::vector<std::size_t> test_lengths {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100};
+
+// Up to 8 rows are normalised with vector instructions, more fall back to the scalar loop
+const std::vector<std::size_t> test_num_rows {1, 2, 3, 5, 8, 9};
+
+using FloatMatrix = std::vector<std::vector<float>>;
+
+FloatMatrix make_log_matrix(const std::size_t k, const std::size_t n, const float offset, const float range,
+                            const double inf_frequency, std::mt19937& generator)
+{
+    std::uniform_real_distribution<float> value_dist {offset - range, offset};
+    std::bernoulli_distribution inf_dist {inf_frequency};
+    FloatMatrix result(k, std::vector<float>(n));
+    for (auto& row : result) {
+        std::generate(std::begin(row), std::end(row), [&] () { return value_dist(generator); });
+    }
+    if (k > 1) {
+        // Any row but the first may be -inf, so every column keeps a finite value
+        for (std::size_t j {1}; j < k; ++j) {
+            for (auto& x : result[j]) {
+                if (inf_dist(generator)) x = -std::numeric_limits<float>::infinity();
+            }
+        }
+    }
+    return result;
+}
+
+struct NormalisedColumns
+{
+    std::vector<std::vector<double>> probabilities;
+    std::vector<double> row_sums;
+    double entropy;
+};
+
+NormalisedColumns normalise_exp_columns_double(const FloatMatrix& logs)
+{
+    const auto k = logs.size(), n = logs.front().size();
+    NormalisedColumns result {std::vector<std::vector<double>>(k, std::vector<double>(n)), std::vector<double>(k), 0.0};
+    std::vector<double> column(k);
+    for (std::size_t i {0}; i < n; ++i) {
+        for (std::size_t j {0}; j < k; ++j) column[j] = logs[j][i];
+        const auto ln_norm = maths::log_sum_exp(column);
+        for (std::size_t j {0}; j < k; ++j) {
+            const auto ln_p = column[j] - ln_norm;
+            const auto p = std::exp(ln_p);
+            result.probabilities[j][i] = p;
+            result.row_sums[j] += p;
+            if (p > 0) result.entropy -= p * ln_p;
+        }
+    }
+    return result;
+}
+
+void check_normalise_exp_columns(const float offset, const float range, const double inf_frequency)
+{
+    std::mt19937 generator {42};
+    for (const auto k : test_num_rows) {
+        for (const auto n : test_lengths) {
+            auto logs = make_log_matrix(k, n, offset, range, inf_frequency, generator);
+            const auto expected = normalise_exp_columns_double(logs);
+            std::vector<float*> rows(k);
+            std::transform(std::begin(logs), std::end(logs), std::begin(rows), [] (auto& row) { return row.data(); });
+            std::vector<double> row_sums(k);
+            const auto entropy = simd::normalise_exp_columns(rows.data(), k, n, row_sums.data());
+            BOOST_TEST_CONTEXT("k = " << k << ", n = " << n) {
+                BOOST_REQUIRE(std::isfinite(entropy));
+                BOOST_CHECK_SMALL(entropy - expected.entropy, 1e-5 * n);
+                for (std::size_t j {0}; j < k; ++j) {
+                    BOOST_CHECK_SMALL(row_sums[j] - expected.row_sums[j], 1e-5 * n);
+                    for (std::size_t i {0}; i < n; ++i) {
+                        BOOST_REQUIRE(std::isfinite(logs[j][i]));
+                        BOOST_CHECK_SMALL(logs[j][i] - expected.probabilities[j][i], 1e-5);
+                    }
+                }
+                for (std::size_t i {0}; i < n; ++i) {
+                    double column_sum {0};
+                    for (std::size_t j {0}; j < k; ++j) column_sum += logs[j][i];
+                    BOOST_CHECK_CLOSE(column_sum, 1.0, 1e-3);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(normalise_exp_columns_matches_double_log_sum_exp)
+{
+    check_normalise_exp_columns(0, 20, 0);
+}
+
+BOOST_AUTO_TEST_CASE(normalise_exp_columns_handles_large_magnitude_inputs)
+{
+    check_normalise_exp_columns(-1e4, 30, 0);
+    check_normalise_exp_columns(1e4, 30, 0);
+    check_normalise_exp_columns(0, 1e3, 0); // most probabilities underflow
+}
+
+BOOST_AUTO_TEST_CASE(normalise_exp_columns_handles_negative_infinity)
+{
+    check_normalise_exp_columns(0, 20, 0.3);
+    check_normalise_exp_columns(-1e4, 30, 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(axpy_and_dot_match_scalar_double)
+{
+    std::mt19937 generator {42};
+    std::uniform_real_distribution<float> dist {-1, 1};
+    for (const auto n : test_lengths) {
+        std::vector<float> x(n), y(n);
+        std::generate(std::begin(x), std::end(x), [&] () { return dist(generator); });
+        std::generate(std::begin(y), std::end(y), [&] () { return dist(generator); });
+        const float a {0.37f};
+        const auto expected_dot = std::inner_product(std::cbegin(x), std::cend(x), std::cbegin(y), 0.0,
+                                                     std::plus<> {}, [] (float lhs, float rhs) { return double {lhs} * rhs; });
+        BOOST_CHECK_SMALL(simd::dot(x.data(), y.data(), n) - expected_dot, 1e-5 * n);
+        auto expected_axpy = y;
+        for (std::size_t i {0}; i < n; ++i) expected_axpy[i] = static_cast<float>(double {a} * x[i] + y[i]);
+        simd::axpy(a, x.data(), y.data(), n);
+        for (std::size_t i {0}; i < n; ++i) {
+            BOOST_CHECK_SMALL(y[i] - expected_axpy[i], 1e-6f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,159 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <cmath>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/cigar_string.hpp"
+#include "basics/aligned_read.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "containers/mappable_block.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/indexed_haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_model.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/uniform_genotype_prior_model.hpp"
+#include "core/models/genotype/subclone_model.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+using octopus::model::SubcloneModel;
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+
+namespace {
+
+const GenomicRegion haplotype_region {"1", 100, 160};
+constexpr GenomicRegion::Size read_length {40};
+
+// The reference haplotype and SNVs at offsets 25 and 35
+MappableBlock<Haplotype> make_subclone_haplotypes(const ReferenceGenome& reference)
+{
+    const auto reference_sequence = reference.fetch_sequence(haplotype_region);
+    const auto mutate = [&] (std::vector<std::size_t> offsets) {
+        auto result = reference_sequence;
+        for (const auto offset : offsets) result[offset] = result[offset] == 'A' ? 'C' : 'A';
+        return Haplotype {haplotype_region, std::move(result), reference};
+    };
+    MappableBlock<Haplotype> result {haplotype_region};
+    result.push_back(mutate({}));
+    result.push_back(mutate({25}));
+    result.push_back(mutate({35}));
+    result.push_back(mutate({25, 35}));
+    return result;
+}
+
+// Reads are sampled from the haplotypes in turn, so each haplotype's share of the reads is its weight
+ReadContainer sample_reads(const MappableBlock<Haplotype>& haplotypes, const std::vector<unsigned>& weights,
+                           const std::size_t num_reads, const AlignedRead::BaseQuality base_quality,
+                           const std::string& sample)
+{
+    std::vector<std::size_t> schedule {};
+    for (std::size_t i {0}; i < weights.size(); ++i) schedule.insert(std::cend(schedule), weights[i], i);
+    ReadContainer result {};
+    for (std::size_t i {0}; i < num_reads; ++i) {
+        const auto& haplotype = haplotypes[schedule[i % schedule.size()]];
+        const auto offset = static_cast<GenomicRegion::Position>(i % 21);
+        const GenomicRegion read_region {"1", haplotype_region.begin() + offset, haplotype_region.begin() + offset + read_length};
+        result.emplace(sample + std::to_string(i), read_region, haplotype.sequence().substr(offset, read_length),
+                       AlignedRead::BaseQualityVector(read_length, base_quality), parse_cigar(std::to_string(read_length) + "M"),
+                       60, AlignedRead::Flags {}, "RG", "");
+    }
+    return result;
+}
+
+auto max_index(const std::vector<double>& probabilities)
+{
+    return std::distance(std::cbegin(probabilities), std::max_element(std::cbegin(probabilities), std::cend(probabilities)));
+}
+
+struct SubcloneModelComparison
+{
+    MappableBlock<IndexedHaplotype<>> haplotypes;
+    std::vector<Genotype<IndexedHaplotype<>>> genotypes;
+    SubcloneModel::InferredLatents float_inferences, double_inferences;
+};
+
+// Evaluates a normal and a tumour with a subclone, using both the float and the double precision VB.
+// The result refers to the haplotypes.
+SubcloneModelComparison evaluate_float_and_double_vb(const MappableBlock<Haplotype>& haplotypes,
+                                                     const std::size_t num_normal_reads, const std::size_t num_tumour_reads,
+                                                     const AlignedRead::BaseQuality base_quality)
+{
+    const std::vector<SampleName> samples {"normal", "tumour"};
+    ReadMap reads {};
+    reads.emplace(samples[0], sample_reads(haplotypes, {1, 1}, num_normal_reads, base_quality, samples[0]));
+    reads.emplace(samples[1], sample_reads(haplotypes, {2, 2, 1}, num_tumour_reads, base_quality, samples[1]));
+    HaplotypeLikelihoodArray haplotype_likelihoods {HaplotypeLikelihoodModel {}, static_cast<unsigned>(haplotypes.size()), samples};
+    haplotype_likelihoods.populate(reads, haplotypes);
+    auto indexed_haplotypes = index(haplotypes);
+    std::vector<Genotype<IndexedHaplotype<>>> genotypes = generate_all_genotypes(indexed_haplotypes, 3);
+    const UniformGenotypePriorModel genotype_prior_model {};
+    SubcloneModel::Priors priors {genotype_prior_model, {}};
+    for (const auto& sample : samples) priors.alphas.emplace(sample, std::vector<double>(3, 1.0));
+    SubcloneModel::AlgorithmParameters float_params {}, double_params {};
+    double_params.double_precision_vb = true;
+    SubcloneModel float_model {samples, priors, float_params}, double_model {samples, priors, double_params};
+    float_model.prime(haplotypes);
+    double_model.prime(haplotypes);
+    auto float_inferences = float_model.evaluate(genotypes, haplotype_likelihoods);
+    auto double_inferences = double_model.evaluate(genotypes, haplotype_likelihoods);
+    return {std::move(indexed_haplotypes), std::move(genotypes), std::move(float_inferences), std::move(double_inferences)};
+}
+
+void check_float_vb_matches_double_precision_vb(const SubcloneModelComparison& comparison)
+{
+    const auto& float_posteriors = comparison.float_inferences.max_evidence_params.genotype_probabilities;
+    const auto& double_posteriors = comparison.double_inferences.max_evidence_params.genotype_probabilities;
+    BOOST_REQUIRE_EQUAL(float_posteriors.size(), comparison.genotypes.size());
+    BOOST_REQUIRE_EQUAL(double_posteriors.size(), comparison.genotypes.size());
+    BOOST_CHECK_EQUAL(max_index(float_posteriors), max_index(double_posteriors));
+    for (std::size_t g {0}; g < comparison.genotypes.size(); ++g) {
+        BOOST_CHECK_SMALL(float_posteriors[g] - double_posteriors[g], 1e-4);
+    }
+    BOOST_CHECK(std::isfinite(comparison.float_inferences.approx_log_evidence));
+    BOOST_CHECK_CLOSE_FRACTION(comparison.float_inferences.approx_log_evidence,
+                               comparison.double_inferences.approx_log_evidence, 1e-5);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(subclone_model_float_vb_matches_double_precision_vb)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_subclone_haplotypes(reference);
+    const auto comparison = evaluate_float_and_double_vb(haplotypes, 60, 100, 30);
+    BOOST_REQUIRE_EQUAL(comparison.genotypes.size(), 20);
+    check_float_vb_matches_double_precision_vb(comparison);
+    // The tumour has reads from the reference and both single SNV haplotypes
+    const auto& posteriors = comparison.double_inferences.max_evidence_params.genotype_probabilities;
+    BOOST_CHECK(contains(comparison.genotypes[max_index(posteriors)], comparison.haplotypes[2]));
+}
+
+BOOST_AUTO_TEST_CASE(subclone_model_float_vb_matches_double_precision_vb_with_uncertain_genotypes)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_subclone_haplotypes(reference);
+    const auto comparison = evaluate_float_and_double_vb(haplotypes, 6, 10, 5);
+    const auto& posteriors = comparison.double_inferences.max_evidence_params.genotype_probabilities;
+    // Low quality reads leave several genotypes with appreciable posterior mass
+    BOOST_REQUIRE_GE(std::count_if(std::cbegin(posteriors), std::cend(posteriors), [] (double p) { return p > 0.01; }), 2);
+    check_float_vb_matches_double_precision_vb(comparison);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
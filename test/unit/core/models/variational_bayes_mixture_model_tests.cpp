@@ -0,0 +1,161 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <random>
+#include <cstddef>
+#include <cmath>
+
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/variational_bayes_mixture_model.hpp"
+
+namespace octopus { namespace test {
+
+using octopus::model::VariationalBayesParameters;
+using octopus::model::VBReadLikelihoodMatrix;
+using octopus::model::VBReadLikelihoodArray;
+using octopus::model::VBAlphaVector;
+using octopus::model::LogProbabilityVector;
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(model)
+
+namespace {
+
+using LikelihoodVector = HaplotypeLikelihoodArray::LikelihoodVector;
+
+// Reads from a two-haplotype mixture over num_haplotypes haplotypes, where haplotypes 2 and 3
+// partly resemble the true haplotypes 0 and 1, so point seeds converge to several local modes.
+struct TestProblem
+{
+    std::vector<std::vector<double>> haplotype_log_likelihoods; // one per haplotype, one element per read
+    std::vector<LikelihoodVector> haplotype_likelihood_views;
+    VBReadLikelihoodMatrix<2> log_likelihoods;
+    VBAlphaVector<2> prior_alphas;
+    LogProbabilityVector genotype_log_priors;
+    std::vector<LogProbabilityVector> seeds;
+    
+    TestProblem(const std::size_t num_haplotypes, const std::size_t num_reads, const unsigned seed)
+    : haplotype_log_likelihoods(num_haplotypes, std::vector<double>(num_reads))
+    , haplotype_likelihood_views {}
+    , log_likelihoods(1)
+    , prior_alphas {{{1.0f, 1.0f}}}
+    , genotype_log_priors {}
+    , seeds {}
+    {
+        std::mt19937 generator {seed};
+        std::bernoulli_distribution source_dist {0.3}, lookalike_dist {0.5};
+        std::normal_distribution<double> noise_dist {0, 0.5};
+        for (std::size_t n {0}; n < num_reads; ++n) {
+            const std::size_t source {source_dist(generator) ? 1u : 0u};
+            for (std::size_t h {0}; h < num_haplotypes; ++h) {
+                double log_likelihood {-4.0};
+                if (h == source) {
+                    log_likelihood = 0;
+                } else if (h == source + 2 && lookalike_dist(generator)) {
+                    log_likelihood = -0.5;
+                }
+                haplotype_log_likelihoods[h][n] = std::min(log_likelihood + noise_dist(generator), 0.0);
+            }
+        }
+        for (const auto& likelihoods : haplotype_log_likelihoods) {
+            haplotype_likelihood_views.emplace_back(likelihoods.data(), likelihoods.size());
+        }
+        for (std::size_t h1 {0}; h1 < num_haplotypes; ++h1) {
+            for (std::size_t h2 {h1 + 1}; h2 < num_haplotypes; ++h2) {
+                log_likelihoods[0].push_back({{VBReadLikelihoodArray {haplotype_likelihood_views[h1]},
+                                               VBReadLikelihoodArray {haplotype_likelihood_views[h2]}}});
+            }
+        }
+        const auto num_genotypes = log_likelihoods[0].size();
+        genotype_log_priors.assign(num_genotypes, -std::log(num_genotypes));
+        for (std::size_t g {0}; g < num_genotypes; ++g) {
+            LogProbabilityVector point_seed(num_genotypes, std::log(0.0001 / (num_genotypes - 1)));
+            point_seed[g] = std::log(0.9999);
+            seeds.push_back(std::move(point_seed));
+        }
+        seeds.push_back(genotype_log_priors);
+    }
+    
+    TestProblem(const TestProblem&) = delete;
+    TestProblem& operator=(const TestProblem&) = delete;
+};
+
+auto run_vb(const TestProblem& problem, const VariationalBayesParameters& params)
+{
+    return octopus::model::run_variational_bayes(problem.prior_alphas, problem.genotype_log_priors, problem.log_likelihoods,
+                                                 params, problem.seeds);
+}
+
+// Seeds in these problems converge within a few rounds of the default size, so rounds of a single
+// iteration are used to give the pruning a chance to act.
+void check_seed_pruning_keeps_best_seed(VariationalBayesParameters base_params)
+{
+    base_params.seed_pruning_round_iterations = 1;
+    for (const unsigned problem_seed : {1u, 2u, 6u}) {
+        const TestProblem problem {10, 150, problem_seed};
+        auto unpruned_params = base_params;
+        unpruned_params.seed_pruning_margin = boost::none;
+        const auto unpruned = run_vb(problem, unpruned_params);
+        const auto pruned = run_vb(problem, base_params);
+        BOOST_TEST_CONTEXT("problem " << problem_seed) {
+            BOOST_CHECK_EQUAL(unpruned.statistics.num_pruned_seeds, 0);
+            BOOST_CHECK_EQUAL(pruned.statistics.num_seeds, problem.seeds.size());
+            BOOST_CHECK_GT(pruned.statistics.num_pruned_seeds, 0);
+            BOOST_CHECK_LT(pruned.statistics.num_iterations, unpruned.statistics.num_iterations);
+            // Several seeds converge to the best mode, each stopping within epsilon of it, so pruning
+            // may change which of them is reported but not the mode itself
+            BOOST_CHECK_SMALL(pruned.max_log_evidence - unpruned.max_log_evidence, base_params.epsilon);
+            const auto& pruned_posteriors = pruned.map_latents.genotype_posteriors;
+            const auto& unpruned_posteriors = unpruned.map_latents.genotype_posteriors;
+            BOOST_REQUIRE_EQUAL(pruned_posteriors.size(), unpruned_posteriors.size());
+            for (std::size_t g {0}; g < pruned_posteriors.size(); ++g) {
+                BOOST_CHECK_SMALL(pruned_posteriors[g] - unpruned_posteriors[g], 1e-3);
+            }
+            BOOST_REQUIRE_EQUAL(pruned.map_latents.alphas.size(), unpruned.map_latents.alphas.size());
+            for (std::size_t s {0}; s < pruned.map_latents.alphas.size(); ++s) {
+                for (std::size_t k {0}; k < 2; ++k) {
+                    BOOST_CHECK_CLOSE(pruned.map_latents.alphas[s][k], unpruned.map_latents.alphas[s][k], 0.1);
+                }
+            }
+            // Pruned seeds would end far below the best evidence, so have negligible weight
+            const auto& pruned_weighted = pruned.evidence_weighted_genotype_posteriors;
+            const auto& unpruned_weighted = unpruned.evidence_weighted_genotype_posteriors;
+            BOOST_REQUIRE_EQUAL(pruned_weighted.size(), unpruned_weighted.size());
+            for (std::size_t g {0}; g < pruned_weighted.size(); ++g) {
+                BOOST_CHECK_SMALL(pruned_weighted[g] - unpruned_weighted[g], 1e-6);
+            }
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(vb_seed_pruning_keeps_best_seed_evidence_and_posteriors)
+{
+    check_seed_pruning_keeps_best_seed(VariationalBayesParameters {});
+}
+
+BOOST_AUTO_TEST_CASE(vb_seed_pruning_keeps_best_seed_evidence_and_posteriors_with_double_precision)
+{
+    VariationalBayesParameters params {};
+    params.double_precision = true;
+    check_seed_pruning_keeps_best_seed(params);
+}
+
+BOOST_AUTO_TEST_CASE(vb_seed_pruning_keeps_best_seed_evidence_and_posteriors_when_saving_memory)
+{
+    VariationalBayesParameters params {};
+    params.save_memory = true;
+    check_seed_pruning_keeps_best_seed(params);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -4,6 +4,11 @@
 #include <boost/test/unit_test.hpp>
 
 #include <exception>
+#include <string>
+#include <vector>
+#include <deque>
+#include <random>
+#include <cstdint>
 
 #include "core/tools/vargen/utils/assembler.hpp"
 
@@ -14,6 +19,92 @@ using octopus::coretools::Assembler;
 BOOST_AUTO_TEST_SUITE(core)
 BOOST_AUTO_TEST_SUITE(assembler)
 
+namespace {
+
+Assembler::NucleotideSequence make_random_sequence(const std::size_t length, std::mt19937& generator)
+{
+    static const Assembler::NucleotideSequence bases {"ACGT"};
+    std::uniform_int_distribution<std::size_t> base_dist {0, 3};
+    Assembler::NucleotideSequence result(length, 'N');
+    for (auto& base : result) base = bases[base_dist(generator)];
+    return result;
+}
+
+// Every read of length read_length from each haplotype, on alternating strands
+std::vector<Assembler::NucleotideSequence>
+tile_reads(const std::vector<Assembler::NucleotideSequence>& haplotypes, const std::size_t read_length, const std::size_t step = 1)
+{
+    std::vector<Assembler::NucleotideSequence> result {};
+    for (const auto& haplotype : haplotypes) {
+        for (std::size_t pos {0}; pos + read_length <= haplotype.size(); pos += step) {
+            result.push_back(haplotype.substr(pos, read_length));
+        }
+    }
+    return result;
+}
+
+struct AssemblyResult
+{
+    std::size_t num_inserted_kmers, num_cleaned_kmers;
+    bool is_acyclic, is_unique_reference;
+    std::deque<Assembler::Variant> variants;
+};
+
+// Runs the same passes as LocalReassembler
+AssemblyResult assemble(const Assembler::NucleotideSequence& reference, const std::vector<Assembler::NucleotideSequence>& reads,
+                        const unsigned kmer_size, const Assembler::Backend backend)
+{
+    Assembler::Parameters params {kmer_size};
+    params.backend = backend;
+    Assembler assembler {params, reference};
+    AssemblyResult result {};
+    bool forward {true};
+    for (const auto& read : reads) {
+        const Assembler::BaseQualityVector base_qualities(read.size(), 30);
+        assembler.insert_read(read, base_qualities, forward ? Assembler::Direction::forward : Assembler::Direction::reverse);
+        forward = !forward;
+    }
+    result.num_inserted_kmers = assembler.num_kmers();
+    assembler.try_recover_dangling_branches();
+    assembler.prune(2);
+    result.is_acyclic = assembler.is_acyclic();
+    if (!result.is_acyclic) assembler.remove_nonreference_cycles();
+    try {
+        assembler.cleanup();
+        result.is_unique_reference = true;
+    } catch (const Assembler::NonUniqueReferenceSequence&) {
+        result.is_unique_reference = false;
+        return result;
+    }
+    result.num_cleaned_kmers = assembler.num_kmers();
+    if (!(assembler.is_empty() || assembler.is_all_reference())) {
+        result.variants = assembler.extract_variants(20, 2.0);
+    }
+    return result;
+}
+
+void check_backends_agree(const Assembler::NucleotideSequence& reference, const std::vector<Assembler::NucleotideSequence>& reads,
+                          const unsigned kmer_size)
+{
+    const auto expected = assemble(reference, reads, kmer_size, Assembler::Backend::adjacency_list);
+    const auto result = assemble(reference, reads, kmer_size, Assembler::Backend::compact);
+    BOOST_TEST_CONTEXT("kmer size " << kmer_size) {
+        BOOST_CHECK_EQUAL(result.num_inserted_kmers, expected.num_inserted_kmers);
+        BOOST_CHECK_EQUAL(result.is_acyclic, expected.is_acyclic);
+        BOOST_REQUIRE_EQUAL(result.is_unique_reference, expected.is_unique_reference);
+        if (!expected.is_unique_reference) return;
+        BOOST_CHECK_EQUAL(result.num_cleaned_kmers, expected.num_cleaned_kmers);
+        BOOST_REQUIRE_EQUAL(result.variants.size(), expected.variants.size());
+        for (std::size_t i {0}; i < expected.variants.size(); ++i) {
+            BOOST_CHECK_EQUAL(result.variants[i].begin_pos, expected.variants[i].begin_pos);
+            BOOST_CHECK_EQUAL(result.variants[i].ref, expected.variants[i].ref);
+            BOOST_CHECK_EQUAL(result.variants[i].alt, expected.variants[i].alt);
+        }
+    }
+}
+
+} // namespace
+
 BOOST_AUTO_TEST_CASE(assembler_can_be_constructed_with_reference_sequence)
 {
     const Assembler::NucleotideSequence reference {"AAAAACCCCC"};
@@ -73,6 +164,90 @@ BOOST_AUTO_TEST_CASE(assembler_throws_if_reference_sequence_is_inserted_twice)
 }
 
 
+BOOST_AUTO_TEST_CASE(assembler_backends_agree_on_bubbles)
+{
+    std::mt19937 generator {42};
+    const auto reference = make_random_sequence(150, generator);
+    auto snv = reference;
+    snv[50] = snv[50] == 'A' ? 'C' : 'A';
+    auto insertion = reference, deletion = reference;
+    insertion.insert(100, "GATTACA");
+    deletion.erase(75, 5);
+    const auto reads = tile_reads({reference, snv, insertion, deletion}, 50, 2);
+    
+    for (const unsigned kmer_size : {10u, 15u, 25u}) {
+        const auto result = assemble(reference, reads, kmer_size, Assembler::Backend::compact);
+        BOOST_CHECK_EQUAL(result.variants.size(), 3);
+        check_backends_agree(reference, reads, kmer_size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(assembler_backends_agree_on_nonreference_cycles)
+{
+    std::mt19937 generator {42};
+    const auto flank = make_random_sequence(60, generator);
+    const Assembler::NucleotideSequence repeat_unit {"ACGTTGCA"};
+    const auto reference = flank + repeat_unit + repeat_unit + flank.substr(0, 30);
+    const auto expansion = flank + repeat_unit + repeat_unit + repeat_unit + repeat_unit + flank.substr(0, 30);
+    const auto reads = tile_reads({reference, expansion}, 50);
+    
+    const auto result = assemble(reference, reads, 5, Assembler::Backend::compact);
+    BOOST_CHECK(!result.is_acyclic);
+    for (const unsigned kmer_size : {5u, 7u, 9u, 15u}) {
+        check_backends_agree(reference, reads, kmer_size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(assembler_backends_agree_when_pruning)
+{
+    std::mt19937 generator {42};
+    const auto reference = make_random_sequence(150, generator);
+    auto alt = reference;
+    alt[80] = alt[80] == 'G' ? 'T' : 'G';
+    auto reads = tile_reads({reference, alt}, 60, 3);
+    // Single read errors, which should be pruned
+    for (const std::size_t pos : {20, 45, 70, 110}) {
+        auto error = reference.substr(pos - 10, 60);
+        error[10] = error[10] == 'C' ? 'A' : 'C';
+        reads.push_back(std::move(error));
+    }
+    
+    for (const unsigned kmer_size : {10u, 15u, 25u}) {
+        const auto result = assemble(reference, reads, kmer_size, Assembler::Backend::compact);
+        BOOST_CHECK_LT(result.num_cleaned_kmers, result.num_inserted_kmers);
+        BOOST_CHECK_EQUAL(result.variants.size(), 1);
+        check_backends_agree(reference, reads, kmer_size);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(assembler_backends_agree_on_random_read_sets)
+{
+    std::mt19937 generator {42};
+    std::uniform_int_distribution<std::size_t> position_dist {30, 120}, length_dist {1, 8};
+    std::bernoulli_distribution error_dist {0.01};
+    for (int i {0}; i < 20; ++i) {
+        const auto reference = make_random_sequence(150, generator);
+        std::vector<Assembler::NucleotideSequence> haplotypes {reference};
+        for (int h {0}; h < 2; ++h) {
+            auto haplotype = reference;
+            haplotype[position_dist(generator)] = make_random_sequence(1, generator).front();
+            haplotype.erase(position_dist(generator), length_dist(generator));
+            haplotype.insert(position_dist(generator), make_random_sequence(length_dist(generator), generator));
+            haplotypes.push_back(std::move(haplotype));
+        }
+        auto reads = tile_reads(haplotypes, 50, 4);
+        for (auto& read : reads) {
+            for (auto& base : read) {
+                if (error_dist(generator)) base = make_random_sequence(1, generator).front();
+            }
+        }
+        BOOST_TEST_CONTEXT("read set " << i) {
+            for (const unsigned kmer_size : {10u, 15u, 25u}) {
+                check_backends_agree(reference, reads, kmer_size);
+            }
+        }
+    }
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,285 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+#include <cmath>
+
+#include <boost/filesystem.hpp>
+
+#include "htslib/hts.h"
+#include "htslib/vcf.h"
+
+#include "basics/contig_region.hpp"
+#include "io/variant/bcf_record.hpp"
+#include "io/variant/htslib_bcf_facade.hpp"
+#include "io/variant/vcf_reader.hpp"
+#include "io/variant/vcf_utils.hpp"
+#include "mock/temp_directory.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(io)
+BOOST_AUTO_TEST_SUITE(bcf_record)
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const std::string colon_contig {"HLA-A*01:01:01:01"};
+
+std::string make_test_vcf(const std::string& samples)
+{
+    return "##fileformat=VCFv4.2\n"
+           "##contig=<ID=1,length=1000>\n"
+           "##contig=<ID=" + colon_contig + ",length=1000>\n"
+           "##contig=<ID=2,length=1000>\n"
+           "##FILTER=<ID=PASS,Description=\"All filters passed\">\n"
+           "##FILTER=<ID=q10,Description=\"Quality below 10\">\n"
+           "##INFO=<ID=DP,Number=1,Type=Integer,Description=\"Depth\">\n"
+           "##INFO=<ID=AF,Number=A,Type=Float,Description=\"Allele frequency\">\n"
+           "##INFO=<ID=BIG,Number=.,Type=Integer,Description=\"Large values\">\n"
+           "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n"
+           "##FORMAT=<ID=GQ,Number=1,Type=Integer,Description=\"Genotype quality\">\n"
+           "##FORMAT=<ID=HF,Number=.,Type=Float,Description=\"Haplotype frequencies\">\n"
+           "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t" + samples + "\n"
+           "1\t100\trs1\tA\tC,G\t30.5\tPASS\tDP=20;AF=0.25,.;BIG=1,300,70000\tGT:GQ:HF\t0|1:300:0.5,0.5\t1/.:.:.\n"
+           "1\t200\t.\tAT\tA\t.\tq10\tDP=5\tGT:GQ\t0/0:10\t./.:20\n"
+           + colon_contig + "\t10\t.\tG\tT\t10\t.\t.\tGT\t1|1\t0|1\n"
+           + colon_contig + "\t20\t.\tC\tA\t10\t.\t.\tGT\t0|1\t0|0\n"
+           "2\t5\t.\tT\tG\t10\t.\t.\tGT\t0/1\t0/1\n";
+}
+
+// A reference block with INFO/END, at the same position as a SNV
+const std::string end_vcf {
+    "##fileformat=VCFv4.2\n"
+    "##contig=<ID=1,length=1000>\n"
+    "##INFO=<ID=END,Number=1,Type=Integer,Description=\"End position\">\n"
+    "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\n"
+    "1\t100\t.\tA\t<*>\t.\t.\tEND=101\n"
+    "1\t100\t.\tA\tC\t.\t.\t.\n"
+    "1\t120\t.\tG\tT\t.\t.\t.\n"
+};
+
+fs::path write_vcf(const TempDirectory& directory, const std::string& name, const std::string& samples = "A\tB")
+{
+    return directory.write(name, make_test_vcf(samples));
+}
+
+// All the records of a VCF file, read with htslib so they can be viewed as BcfRecords
+struct RecordFile
+{
+    htsFile* file;
+    bcf_hdr_t* header;
+    std::vector<bcf1_t*> records;
+    
+    RecordFile(const fs::path& path)
+    : file {hts_open(path.c_str(), "r")}
+    , header {file != nullptr ? bcf_hdr_read(file) : nullptr}
+    , records {}
+    {
+        if (header == nullptr) {
+            if (file != nullptr) hts_close(file);
+            throw std::runtime_error {"could not read " + path.string()};
+        }
+        auto record = bcf_init();
+        while (bcf_read(file, header, record) == 0) {
+            records.push_back(record);
+            record = bcf_init();
+        }
+        bcf_destroy(record);
+    }
+    
+    ~RecordFile()
+    {
+        for (auto record : records) bcf_destroy(record);
+        if (header != nullptr) bcf_hdr_destroy(header);
+        if (file != nullptr) hts_close(file);
+    }
+    
+    BcfRecord operator[](const std::size_t i) const { return BcfRecord {header, records[i]}; }
+};
+
+fs::path write_indexed(const fs::path& src, const fs::path& dst, const char* mode)
+{
+    const RecordFile src_records {src};
+    auto file = hts_open(dst.c_str(), mode);
+    if (file == nullptr) throw std::runtime_error {"could not open " + dst.string()};
+    bcf_hdr_write(file, src_records.header);
+    for (auto record : src_records.records) bcf_write(file, src_records.header, record);
+    hts_close(file);
+    index_vcf(dst);
+    return dst;
+}
+
+std::vector<BcfRecord::Position> stream_positions(const fs::path& path, const std::string& contig)
+{
+    std::vector<BcfRecord::Position> result {};
+    for (BcfRecordStream stream {path, contig}; !stream.done(); stream.next()) {
+        BOOST_CHECK_EQUAL(stream.record().chrom(), contig);
+        result.push_back(stream.record().pos());
+    }
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(bcf_record_site_accessors_decode_fields)
+{
+    const TempDirectory directory {};
+    const RecordFile records {write_vcf(directory, "test.vcf")};
+    BOOST_REQUIRE_EQUAL(records.records.size(), 5);
+    
+    const auto first = records[0];
+    BOOST_CHECK_EQUAL(first.chrom(), std::string {"1"});
+    BOOST_CHECK_EQUAL(first.pos(), 100);
+    BOOST_CHECK(first.mapped_contig_region() == ContigRegion(99, 100));
+    BOOST_CHECK_EQUAL(first.id(), "rs1");
+    BOOST_CHECK_EQUAL(first.ref(), "A");
+    BOOST_REQUIRE_EQUAL(first.num_alt(), 2);
+    BOOST_CHECK_EQUAL(first.alt(0), "C");
+    BOOST_CHECK_EQUAL(first.alt(1), "G");
+    BOOST_REQUIRE(first.qual());
+    BOOST_CHECK_CLOSE(*first.qual(), 30.5f, 1e-4);
+    BOOST_CHECK(first.has_filter("PASS"));
+    BOOST_CHECK(!first.is_filtered());
+    
+    const auto second = records[1];
+    BOOST_CHECK(second.mapped_contig_region() == ContigRegion(199, 201));
+    BOOST_CHECK_EQUAL(second.id(), ".");
+    BOOST_CHECK(!second.qual());
+    BOOST_CHECK(second.has_filter("q10"));
+    BOOST_CHECK(second.is_filtered());
+    BOOST_CHECK(!records[2].is_filtered());
+    
+    BOOST_CHECK(first < second);
+    BOOST_CHECK(!(second < first));
+    BOOST_CHECK(!(first < first));
+}
+
+BOOST_AUTO_TEST_CASE(bcf_record_regions_and_order_match_vcf_record_for_end_records)
+{
+    const TempDirectory directory {};
+    const auto vcf = directory.write("end.vcf", end_vcf);
+    const RecordFile records {vcf};
+    BOOST_REQUIRE_EQUAL(records.records.size(), 3);
+    // VcfRecord regions stop before END, so are not the rlen htslib derives from END
+    BOOST_CHECK(records[0].mapped_contig_region() == ContigRegion(99, 100));
+    BOOST_CHECK(records[1].mapped_contig_region() == ContigRegion(99, 100));
+    BOOST_CHECK(records[0].get()->rlen == 2);
+    // the regions are the same, so the records are ordered by ALT
+    BOOST_CHECK(records[0] < records[1]);
+    BOOST_CHECK(!(records[1] < records[0]));
+    
+    const auto vcf_records = VcfReader {vcf}.fetch_records();
+    BOOST_REQUIRE_EQUAL(vcf_records.size(), records.records.size());
+    for (std::size_t i {0}; i < vcf_records.size(); ++i) {
+        BOOST_CHECK(records[i].mapped_region() == mapped_region(vcf_records[i]));
+        for (std::size_t j {0}; j < vcf_records.size(); ++j) {
+            BOOST_CHECK_EQUAL(records[i] < records[j], vcf_records[i] < vcf_records[j]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bcf_record_info_accessors_decode_typed_values)
+{
+    const TempDirectory directory {};
+    const RecordFile records {write_vcf(directory, "test.vcf")};
+    BOOST_REQUIRE_EQUAL(records.records.size(), 5);
+    const auto first = records[0], second = records[1];
+    
+    BOOST_CHECK(first.has_info("DP"));
+    BOOST_CHECK(first.info_ints("DP") == std::vector<BcfRecord::IntType> {20});
+    // values too large for smaller integer encodings
+    BOOST_CHECK(first.info_ints("BIG") == (std::vector<BcfRecord::IntType> {1, 300, 70000}));
+    const auto af = first.info_floats("AF");
+    BOOST_REQUIRE_EQUAL(af.size(), 2);
+    BOOST_CHECK_CLOSE(af[0], 0.25f, 1e-4);
+    BOOST_CHECK(std::isnan(af[1]));
+    BOOST_CHECK_THROW(first.info_ints("AF"), std::runtime_error);
+    BOOST_CHECK_THROW(first.info_floats("DP"), std::runtime_error);
+    
+    BOOST_CHECK(!second.has_info("BIG"));
+    BOOST_CHECK(second.info_ints("BIG").empty());
+    BOOST_CHECK(second.info_ints("DP") == std::vector<BcfRecord::IntType> {5});
+}
+
+BOOST_AUTO_TEST_CASE(bcf_record_format_accessors_decode_typed_values)
+{
+    const TempDirectory directory {};
+    const RecordFile records {write_vcf(directory, "test.vcf")};
+    BOOST_REQUIRE_EQUAL(records.records.size(), 5);
+    const auto first = records[0], second = records[1];
+    
+    BOOST_REQUIRE_EQUAL(first.num_samples(), 2);
+    BOOST_CHECK(first.has_format("HF"));
+    BOOST_CHECK(!second.has_format("HF"));
+    BOOST_CHECK(first.format_ints("GQ", 0) == std::vector<BcfRecord::IntType> {300});
+    BOOST_CHECK(first.format_ints("GQ", 1) == std::vector<BcfRecord::IntType> {bcf_int32_missing});
+    BOOST_CHECK(first.format_ints("GQ", 2).empty());
+    BOOST_CHECK(second.format_ints("GQ", 1) == std::vector<BcfRecord::IntType> {20});
+    const auto hf = first.format_floats("HF", 0);
+    BOOST_REQUIRE_EQUAL(hf.size(), 2);
+    BOOST_CHECK_CLOSE(hf[0], 0.5f, 1e-4);
+    BOOST_CHECK_CLOSE(hf[1], 0.5f, 1e-4);
+    const auto missing_hf = first.format_floats("HF", 1);
+    BOOST_REQUIRE_EQUAL(missing_hf.size(), 1);
+    BOOST_CHECK(std::isnan(missing_hf[0]));
+    BOOST_CHECK_THROW(first.format_floats("GQ", 0), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(bcf_record_genotype_decodes_alleles_and_phasing)
+{
+    const TempDirectory directory {};
+    const RecordFile records {write_vcf(directory, "test.vcf")};
+    BOOST_REQUIRE_EQUAL(records.records.size(), 5);
+    
+    const auto phased = records[0].genotype(0);
+    BOOST_CHECK(phased.indices == (std::vector<BcfRecord::AlleleIndex> {0, 1}));
+    BOOST_CHECK(phased.phased);
+    const auto partly_missing = records[0].genotype(1);
+    BOOST_CHECK(partly_missing.indices == (std::vector<BcfRecord::AlleleIndex> {1, -1}));
+    BOOST_CHECK(!partly_missing.phased);
+    const auto missing = records[1].genotype(1);
+    BOOST_CHECK(missing.indices == (std::vector<BcfRecord::AlleleIndex> {-1, -1}));
+    BOOST_CHECK(!missing.phased);
+    BOOST_CHECK(records[0].genotype(2).indices.empty());
+}
+
+BOOST_AUTO_TEST_CASE(bcf_record_stream_reads_contigs_containing_colons)
+{
+    const TempDirectory directory {};
+    const auto vcf = write_vcf(directory, "test.vcf");
+    for (const auto& path : {write_indexed(vcf, directory.path() / "test.bcf", "wb"),
+                             write_indexed(vcf, directory.path() / "test.vcf.gz", "wz")}) {
+        BOOST_CHECK(stream_positions(path, "1") == (std::vector<BcfRecord::Position> {100, 200}));
+        BOOST_CHECK(stream_positions(path, colon_contig) == (std::vector<BcfRecord::Position> {10, 20}));
+        BOOST_CHECK(stream_positions(path, "2") == std::vector<BcfRecord::Position> {5});
+        BOOST_CHECK(stream_positions(path, "HLA-A*01").empty());
+        BOOST_CHECK(stream_positions(path, "3").empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bcf_record_write_requires_matching_sample_names)
+{
+    const TempDirectory directory {};
+    const RecordFile records {write_vcf(directory, "test.vcf")};
+    const RecordFile swapped_records {write_vcf(directory, "swapped.vcf", "B\tA")};
+    const RecordFile renamed_records {write_vcf(directory, "renamed.vcf", "A\tC")};
+    const auto header = VcfReader {directory.path() / "test.vcf"}.fetch_header();
+    HtslibBcfFacade writer {directory.path() / "out.vcf", HtslibBcfFacade::Mode::write};
+    writer.write(header);
+    BOOST_CHECK_NO_THROW(writer.write(records[0]));
+    BOOST_CHECK_THROW(writer.write(swapped_records[0]), std::runtime_error);
+    BOOST_CHECK_THROW(writer.write(renamed_records[0]), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,149 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <cstddef>
+
+#include "basics/genomic_region.hpp"
+#include "io/reference/reference_reader.hpp"
+#include "io/reference/caching_fasta.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(io)
+BOOST_AUTO_TEST_SUITE(caching_fasta)
+
+using ::octopus::io::ReferenceReader;
+using ::octopus::io::CachingFasta;
+
+namespace {
+
+// A MockReference that counts the sequence fetches reaching it, so tests can see cache misses
+class CountingReference : public ReferenceReader
+{
+public:
+    CountingReference(std::atomic<std::size_t>& num_fetches) : reference_ {}, num_fetches_ {num_fetches} {}
+
+private:
+    mock::MockReference reference_;
+    std::atomic<std::size_t>& num_fetches_;
+
+    std::unique_ptr<ReferenceReader> do_clone() const override
+    {
+        return std::make_unique<CountingReference>(num_fetches_);
+    }
+    bool do_is_open() const noexcept override { return true; }
+    std::string do_fetch_reference_name() const override { return reference_.fetch_reference_name(); }
+    std::vector<ContigName> do_fetch_contig_names() const override { return reference_.fetch_contig_names(); }
+    GenomicSize do_fetch_contig_size(const ContigName& contig) const override
+    {
+        return reference_.fetch_contig_size(contig);
+    }
+    GeneticSequence do_fetch_sequence(const GenomicRegion& region) const override
+    {
+        ++num_fetches_;
+        return reference_.fetch_sequence(region);
+    }
+};
+
+// Smallest block size CachingFasta uses, so a cache this size holds just four blocks of the mock genome
+constexpr GenomicRegion::Size block_size {1 << 10};
+constexpr GenomicRegion::Size small_cache_size {4 * block_size};
+
+std::size_t count_blocks(const ReferenceReader& reference)
+{
+    std::size_t result {0};
+    for (const auto& contig : reference.fetch_contig_names()) {
+        result += (reference.fetch_contig_size(contig) + block_size - 1) / block_size;
+    }
+    return result;
+}
+
+// Mostly regions within a block or spanning a few, with some larger than the small cache
+GenomicRegion make_random_region(const ReferenceReader& reference, std::mt19937& generator)
+{
+    const auto contigs = reference.fetch_contig_names();
+    std::uniform_int_distribution<std::size_t> contig_dist {0, contigs.size() - 1};
+    std::discrete_distribution<int> length_class_dist {10, 5, 1};
+    const auto& contig = contigs[contig_dist(generator)];
+    const auto contig_size = reference.fetch_contig_size(contig);
+    const GenomicRegion::Size max_lengths[] {100, 2 * block_size, 2 * small_cache_size};
+    std::uniform_int_distribution<GenomicRegion::Size> begin_dist {0, contig_size - 1};
+    std::uniform_int_distribution<GenomicRegion::Size> length_dist {1, max_lengths[length_class_dist(generator)]};
+    const auto begin = begin_dist(generator);
+    return GenomicRegion {contig, begin, std::min(begin + length_dist(generator), contig_size)};
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(caching_fasta_returns_reference_sequence_and_caches_blocks)
+{
+    const mock::MockReference expected {};
+    std::atomic<std::size_t> num_fetches {0};
+    const CachingFasta reference {std::make_unique<CountingReference>(num_fetches), 64 * block_size};
+    BOOST_REQUIRE_LE(count_blocks(expected), 64);
+    std::vector<GenomicRegion> regions {};
+    for (const auto& contig : expected.fetch_contig_names()) {
+        const auto size = expected.fetch_contig_size(contig);
+        regions.emplace_back(contig, 0, size);
+        regions.emplace_back(contig, 0, 1);
+        regions.emplace_back(contig, size - 1, size);
+        regions.emplace_back(contig, 10, 10);
+        if (size > block_size + 1) {
+            regions.emplace_back(contig, block_size - 1, block_size + 1); // spans a block boundary
+            regions.emplace_back(contig, block_size, size);
+        }
+    }
+    for (const auto& region : regions) {
+        BOOST_CHECK_EQUAL(reference.fetch_sequence(region), expected.fetch_sequence(region));
+    }
+    const auto num_first_pass_fetches = num_fetches.load();
+    BOOST_CHECK_LE(num_first_pass_fetches, count_blocks(expected));
+    for (const auto& region : regions) {
+        BOOST_CHECK_EQUAL(reference.fetch_sequence(region), expected.fetch_sequence(region));
+    }
+    BOOST_CHECK_EQUAL(num_fetches.load(), num_first_pass_fetches);
+}
+
+BOOST_AUTO_TEST_CASE(caching_fasta_concurrent_fetches_return_reference_sequence_while_evicting)
+{
+    const mock::MockReference expected {};
+    std::atomic<std::size_t> num_fetches {0};
+    const CachingFasta reference {std::make_unique<CountingReference>(num_fetches), small_cache_size};
+    BOOST_REQUIRE_GT(count_blocks(expected), 2 * small_cache_size / block_size);
+
+    constexpr unsigned num_threads {8};
+    constexpr unsigned num_fetches_per_thread {5000};
+    std::atomic<std::size_t> num_mismatches {0};
+    std::vector<std::thread> threads {};
+    threads.reserve(num_threads);
+    for (unsigned t {0}; t < num_threads; ++t) {
+        threads.emplace_back([&, t] () {
+            std::mt19937 generator {t};
+            for (unsigned i {0}; i < num_fetches_per_thread; ++i) {
+                const auto region = make_random_region(expected, generator);
+                if (reference.fetch_sequence(region) != expected.fetch_sequence(region)) ++num_mismatches;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    BOOST_CHECK_EQUAL(num_mismatches.load(), 0);
+    // Blocks must have been evicted and read again, else the test did not exercise eviction
+    BOOST_CHECK_GT(num_fetches.load(), count_blocks(expected));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
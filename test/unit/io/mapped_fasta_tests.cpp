@@ -0,0 +1,157 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstddef>
+
+#include <boost/filesystem.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "io/reference/fasta.hpp"
+#include "io/reference/mapped_fasta.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "mock/temp_directory.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(io)
+BOOST_AUTO_TEST_SUITE(mapped_fasta)
+
+namespace fs = boost::filesystem;
+
+using ::octopus::io::Fasta;
+using ::octopus::io::MappedFasta;
+using ::octopus::io::make_mapped_fasta;
+using ::octopus::io::is_mapped_fasta_current;
+
+namespace {
+
+struct TestContig
+{
+    std::string name, sequence;
+    std::size_t line_width;
+};
+
+const std::vector<TestContig> test_contigs {
+    {"1", "ACGTACGTNNacgtacgtRYKMSWacgtACGTACGTTTTTGGGGCCCCAAAAnnnnACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTAC"
+          "GTACGTACGTacgtacgtBDHVacgtACGTACGTACGTACGTACGTACGTACGTACGT", 60},
+    {"chr2", "TTTTTaaaaaCCCCCgg", 10},
+    {"3", "A", 60}
+};
+
+// A fasta and its index in a fresh directory
+struct TestFasta
+{
+    TempDirectory directory;
+    fs::path path;
+    
+    TestFasta()
+    : directory {}
+    , path {directory.path() / "reference.fa"}
+    {
+        std::ofstream fasta {path.string()}, index {path.string() + ".fai"};
+        std::size_t offset {0};
+        for (const auto& contig : test_contigs) {
+            const auto header = ">" + contig.name + " description\n";
+            fasta << header;
+            offset += header.size();
+            index << contig.name << '\t' << contig.sequence.size() << '\t' << offset << '\t'
+                  << contig.line_width << '\t' << contig.line_width + 1 << '\n';
+            for (std::size_t pos {0}; pos < contig.sequence.size(); pos += contig.line_width) {
+                const auto line = contig.sequence.substr(pos, contig.line_width);
+                fasta << line << '\n';
+                offset += line.size() + 1;
+            }
+        }
+    }
+};
+
+auto make_test_regions()
+{
+    std::vector<GenomicRegion> result {};
+    for (const auto& contig : test_contigs) {
+        const auto size = static_cast<GenomicRegion::Position>(contig.sequence.size());
+        for (GenomicRegion::Position begin {0}; begin <= size; begin += 7) {
+            for (GenomicRegion::Position end {begin}; end <= size; end += 11) {
+                result.emplace_back(contig.name, begin, end);
+            }
+            result.emplace_back(contig.name, begin, size);
+        }
+    }
+    return result;
+}
+
+auto make_test_options()
+{
+    std::vector<Fasta::Options> result(4);
+    result[1].base_transform_policy = Fasta::Options::CapitalisationPolicy::capitalise;
+    result[2].iupac_ambiguity_symbol_policy = Fasta::Options::IUPACAmbiguitySymbolPolicy::disambiguate;
+    result[3].base_transform_policy = Fasta::Options::CapitalisationPolicy::capitalise;
+    result[3].iupac_ambiguity_symbol_policy = Fasta::Options::IUPACAmbiguitySymbolPolicy::disambiguate;
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(mapped_fasta_views_match_fasta_sequences)
+{
+    const TestFasta test_fasta {};
+    const auto regions = make_test_regions();
+    for (const auto& options : make_test_options()) {
+        const Fasta fasta {test_fasta.path, options};
+        auto mapped_path = test_fasta.path;
+        mapped_path += ".octomap";
+        make_mapped_fasta(test_fasta.path, mapped_path, options);
+        BOOST_REQUIRE(is_mapped_fasta_current(mapped_path, test_fasta.path, options));
+        const MappedFasta mapped_fasta {mapped_path};
+        BOOST_CHECK_EQUAL(mapped_fasta.fetch_reference_name(), fasta.fetch_reference_name());
+        BOOST_CHECK(mapped_fasta.fetch_contig_names() == fasta.fetch_contig_names());
+        for (const auto& contig : fasta.fetch_contig_names()) {
+            BOOST_CHECK_EQUAL(mapped_fasta.fetch_contig_size(contig), fasta.fetch_contig_size(contig));
+        }
+        for (const auto& region : regions) {
+            const auto expected = fasta.fetch_sequence(region);
+            const auto view = mapped_fasta.fetch_sequence_view(region);
+            BOOST_REQUIRE(view);
+            BOOST_CHECK_EQUAL(view->to_string(), expected);
+            BOOST_CHECK_EQUAL(mapped_fasta.fetch_sequence(region), expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(mapped_fasta_is_remade_when_options_change)
+{
+    const TestFasta test_fasta {};
+    const auto options = make_test_options();
+    auto mapped_path = test_fasta.path;
+    mapped_path += ".octomap";
+    BOOST_CHECK(!is_mapped_fasta_current(mapped_path, test_fasta.path, options[0]));
+    make_mapped_fasta(test_fasta.path, mapped_path, options[0]);
+    BOOST_CHECK(is_mapped_fasta_current(mapped_path, test_fasta.path, options[0]));
+    BOOST_CHECK(!is_mapped_fasta_current(mapped_path, test_fasta.path, options[3]));
+}
+
+BOOST_AUTO_TEST_CASE(memory_mapped_reference_genome_matches_fasta_reference_genome)
+{
+    const TestFasta test_fasta {};
+    const auto mapped_reference = make_reference(test_fasta.path, 0, false, true, false, true);
+    const auto reference = make_reference(test_fasta.path, 0, false, true, false, false);
+    BOOST_CHECK_EQUAL(mapped_reference.name(), reference.name());
+    BOOST_REQUIRE(mapped_reference.contig_names() == reference.contig_names());
+    for (const auto& region : make_test_regions()) {
+        ReferenceGenome::GeneticSequence buffer {};
+        const auto view = mapped_reference.fetch_sequence_view(region, buffer);
+        BOOST_CHECK(buffer.empty()); // the view is of the mapped sequence
+        BOOST_CHECK_EQUAL(view.to_string(), reference.fetch_sequence(region));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -1,57 +1,225 @@
-// Copyright (c) 2017 Daniel Cooke
+// Copyright (c) 2015-2020 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#define BOOST_TEST_DYN_LINK
-
 #include <boost/test/unit_test.hpp>
 
-#include <iostream>
+#include <string>
 #include <vector>
-#include <algorithm> // std::sort
-#include <iterator>  // std::back_inserter
-
-//#include "basics/genomic_region.hpp"
-//#include "io/read/read_manager.hpp"
-//#include "read_filter.hpp"
-//#include "read_filters.hpp"
-
-BOOST_AUTO_TEST_SUITE(Components)
-
-BOOST_AUTO_TEST_CASE(read_filter_test)
-{
-//    BOOST_REQUIRE(test_file_exists(NA12878_low_coverage));
-//    
-//    ReadManager read_manager {NA12878_low_coverage};
-//    
-//    auto sample_ids = read_manager.samples();
-//    
-//    auto sample = sample_ids.front();
-//    
-//    GenomicRegion region {"X", 1000000, 1010000};
-//    
-//    auto reads = read_manager.fetch_reads(sample, region);
-//    
-//    BOOST_REQUIRE(std::is_sorted(std::cbegin(reads), std::cend(reads)));
-//    
-//    BOOST_CHECK(reads.size() == 485);
-//    
-//    octopus::ReadFilter<std::vector<AlignedRead>::iterator> read_filter {};
-    
-//    read_filter.register_filter(octopus::ReadFilters::IsNotSecondaryAlignment());
-//    read_filter.register_filter(octopus::ReadFilters::IsGoodMappingQuality(20));
-//    read_filter.register_filter(octopus::ReadFilters::HasSufficientGoodQualityBases(20, 10));
-//    read_filter.register_filter(octopus::ReadFilters::FilterDuplicates());
-    
-//    std::vector<AlignedRead> good_reads {}, bad_reads {};
-//    good_reads.reserve(reads.size());
-//    bad_reads.reserve(reads.size());
-//    
-//    read_filter.partition_copy(std::make_move_iterator(reads.begin()), std::make_move_iterator(reads.end()),
-//                               context_back_inserter(good_reads), context_back_inserter(bad_reads));
-//    
-//    // TODO: check these numbers are actually correct!
-//    BOOST_CHECK(good_reads.size() == 436);
-//    BOOST_CHECK(bad_reads.size() == 49);
+#include <unordered_map>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <cstddef>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/cigar_string.hpp"
+#include "basics/aligned_read.hpp"
+#include "readpipe/filtering/read_filter.hpp"
+#include "readpipe/filtering/read_filterer.hpp"
+#include "readpipe/transformers/read_transform.hpp"
+#include "readpipe/transformers/read_transformer.hpp"
+#include "utils/read_duplicates.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(readpipe)
+BOOST_AUTO_TEST_SUITE(read_filterer)
+
+using namespace ::octopus::readpipe;
+
+namespace {
+
+using ReadVector = std::vector<AlignedRead>;
+using SampleReadMap = std::unordered_map<SampleName, ReadVector>;
+using Filterer = ReadFiltererTp<ReadVector>;
+
+const std::vector<SampleName> samples {"S1", "S2", "S3"};
+constexpr int read_length {40};
+
+// Coordinate sorted reads in groups of three at each position, so some are duplicates. Low quality runs at
+// either end make masking change both which reads have enough good bases and which duplicate is kept.
+ReadVector make_reads(const SampleName& sample, const int num_reads)
+{
+    const std::string bases {"ACGTTGCAacgtAACCGGTTACGTACGTAGCTAGCTAGGATCCATGCA"};
+    const std::vector<AlignedRead::MappingQuality> mapping_qualities {60, 10, 40, 25, 60, 0};
+    ReadVector result {};
+    result.reserve(num_reads);
+    for (int i {0}; i < num_reads; ++i) {
+        const GenomicRegion::Position begin = 100 + (i / 3) * 5;
+        const bool is_reverse {i % 5 == 3};
+        const bool is_marked_duplicate {i % 13 == 0};
+        AlignedRead::BaseQualityVector qualities(read_length, 30);
+        const auto num_low_back = (i * 7) % 15, num_low_front = (i * 3) % 11;
+        std::fill_n(std::rbegin(qualities), num_low_back, 5);
+        std::fill_n(std::begin(qualities), num_low_front, 8);
+        qualities[read_length / 2] = static_cast<AlignedRead::BaseQuality>(20 + i % 7);
+        AlignedRead::Flags flags {};
+        flags.reverse_mapped = is_reverse;
+        flags.duplicate = is_marked_duplicate;
+        result.emplace_back(sample + "-r" + std::to_string(i), GenomicRegion {"1", begin, begin + read_length},
+                            bases.substr(i % 8, read_length), std::move(qualities),
+                            parse_cigar(std::to_string(read_length) + "M"),
+                            mapping_qualities[i % mapping_qualities.size()], flags, sample, "");
+    }
+    return result;
+}
+
+SampleReadMap make_read_map()
+{
+    SampleReadMap result {};
+    int num_reads {31};
+    for (const auto& sample : samples) {
+        result.emplace(sample, make_reads(sample, num_reads));
+        num_reads = 2 * num_reads + 17;
+    }
+    result.emplace("empty", ReadVector {});
+    return result;
+}
+
+Filterer make_filterer(const bool add_basic_filters = true, const bool add_context_filters = true)
+{
+    Filterer result {};
+    if (add_basic_filters) {
+        result.add(std::make_unique<IsGoodMappingQuality>(20));
+        result.add(std::make_unique<HasSufficientGoodQualityBases>(20, 28));
+        result.add(std::make_unique<IsNotMarkedDuplicate>());
+    }
+    if (add_context_filters) {
+        result.add(std::make_unique<IsNotDuplicate<Filterer::ReadIterator, FivePrimeAndCigarDuplicateDefinition>>());
+    }
+    return result;
+}
+
+ReadTransformer make_transformer()
+{
+    ReadTransformer result {};
+    result.add(CapitaliseBases {});
+    result.add(MaskLowQualityTails {20});
+    result.add(MaskTail {6});
+    return result;
+}
+
+struct FilterResult
+{
+    SampleReadMap reads;
+    std::size_t num_removed;
+    SampleFilterCountMap<SampleName, Filterer> filter_counts;
+};
+
+// Transforms every read, then filters in a separate pass, counting the reads failing each filter
+FilterResult transform_then_filter(SampleReadMap reads, const Filterer& filterer, const ReadTransformer& transformer)
+{
+    FilterResult result {};
+    transform_reads(reads, transformer);
+    for (const auto& p : reads) {
+        result.filter_counts[p.first].reserve(filterer.num_filters());
+    }
+    result.num_removed = erase_filtered_reads(reads, filter(reads, filterer, result.filter_counts));
+    result.reads = std::move(reads);
+    return result;
+}
+
+FilterResult fused_transform_filter(SampleReadMap reads, const Filterer& filterer, const ReadTransformer& transformer)
+{
+    FilterResult result {};
+    const auto transform = [&] (AlignedRead& read) { transformer.transform_read(read); };
+    result.num_removed = erase_filtered_reads(reads, transform_filter(reads, filterer, transform));
+    result.reads = std::move(reads);
+    return result;
+}
+
+std::size_t count_filtered(const FilterResult& result, const SampleName& sample)
+{
+    const auto& counts = result.filter_counts.at(sample);
+    return std::accumulate(std::cbegin(counts), std::cend(counts), std::size_t {0},
+                           [] (auto total, const auto& p) { return total + p.second; });
+}
+
+void check_same_result(const SampleReadMap& original, const Filterer& filterer, const ReadTransformer& transformer)
+{
+    const auto expected = transform_then_filter(original, filterer, transformer);
+    const auto result = fused_transform_filter(original, filterer, transformer);
+    BOOST_CHECK_EQUAL(result.num_removed, expected.num_removed);
+    BOOST_REQUIRE_EQUAL(result.reads.size(), original.size());
+    for (const auto& p : original) {
+        BOOST_TEST_CONTEXT("sample " << p.first) {
+            const auto& expected_reads = expected.reads.at(p.first);
+            const auto& result_reads = result.reads.at(p.first);
+            BOOST_CHECK_EQUAL(result_reads.size(), expected_reads.size());
+            BOOST_CHECK(std::equal(std::cbegin(result_reads), std::cend(result_reads),
+                                   std::cbegin(expected_reads), std::cend(expected_reads)));
+            if (filterer.num_filters() > 0) {
+                // transform_filter does not count reads by filter, but every read removed must be counted once
+                BOOST_CHECK_EQUAL(count_filtered(expected, p.first), p.second.size() - result_reads.size());
+            }
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(transform_filter_matches_transform_then_filter)
+{
+    const auto reads = make_read_map();
+    const auto filterer = make_filterer();
+    const auto transformer = make_transformer();
+    check_same_result(reads, filterer, transformer);
+    // The test data must exercise every filter, and leave reads in every sample
+    const auto expected = transform_then_filter(reads, filterer, transformer);
+    for (const auto& sample : samples) {
+        BOOST_TEST_CONTEXT("sample " << sample) {
+            BOOST_CHECK(!expected.reads.at(sample).empty());
+            BOOST_CHECK_LT(expected.reads.at(sample).size(), reads.at(sample).size());
+        }
+    }
+    std::unordered_map<std::string, std::size_t> total_filter_counts {};
+    for (const auto& p : expected.filter_counts) {
+        for (const auto& c : p.second) total_filter_counts[c.first] += c.second;
+    }
+    BOOST_CHECK_EQUAL(total_filter_counts.size(), filterer.num_filters());
+    for (const auto& c : total_filter_counts) {
+        BOOST_CHECK_MESSAGE(c.second > 0, "no reads failed the " << c.first << " filter");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(transform_filter_matches_transform_then_filter_with_partial_filterers)
+{
+    const auto reads = make_read_map();
+    const auto transformer = make_transformer();
+    check_same_result(reads, make_filterer(true, false), transformer);
+    check_same_result(reads, make_filterer(false, true), transformer);
+    check_same_result(reads, make_filterer(false, false), transformer);
+    check_same_result(reads, make_filterer(), ReadTransformer {});
+}
+
+BOOST_AUTO_TEST_CASE(transform_remove_transforms_every_read)
+{
+    const auto filterer = make_filterer();
+    const auto transformer = make_transformer();
+    const auto reads = make_reads(samples.back(), 50);
+    auto expected = reads;
+    transform_reads(expected, transformer);
+    const auto expected_last = remove(expected, filterer);
+    auto result = reads;
+    const auto result_last = transform_remove(result, filterer, [&] (AlignedRead& read) { transformer.transform_read(read); });
+    BOOST_REQUIRE_EQUAL(std::distance(std::begin(result), result_last), std::distance(std::begin(expected), expected_last));
+    BOOST_CHECK(std::equal(std::begin(result), result_last, std::begin(expected), expected_last));
+    // Surviving reads are transformed, whichever filters are present
+    for (const bool add_context_filters : {false, true}) {
+        const auto f = make_filterer(false, add_context_filters);
+        auto transformed = reads;
+        transform_remove(transformed, f, [&] (AlignedRead& read) { transformer.transform_read(read); });
+        auto all_transformed = reads;
+        transform_reads(all_transformed, transformer);
+        const auto last = remove(all_transformed, f);
+        BOOST_CHECK(std::equal(std::begin(all_transformed), last, std::begin(transformed)));
+    }
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -1,16 +1,193 @@
-// Copyright (c) 2017 Daniel Cooke
+// Copyright (c) 2015-2020 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#define BOOST_TEST_DYN_LINK
-
 #include <boost/test/unit_test.hpp>
 
+#include <string>
+#include <vector>
+#include <sstream>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <cstddef>
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include "htslib/hts.h"
+#include "htslib/sam.h"
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "io/read/read_manager.hpp"
 #include "readpipe/read_pipe.hpp"
+#include "readpipe/filtering/read_filter.hpp"
+#include "readpipe/transformers/read_transform.hpp"
+#include "utils/read_duplicates.hpp"
+#include "utils/executor.hpp"
+#include "mock/temp_directory.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(readpipe)
+BOOST_AUTO_TEST_SUITE(read_pipe)
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const std::vector<SampleName> samples {"S1", "S2", "S3", "S4", "S5"};
+constexpr int read_length {50};
+const GenomicRegion fetch_region {"1", 0, 1000};
+
+// Coordinate sorted reads for every sample, with a mix of mapping qualities, duplicates, lowercase bases
+// and enough depth in some samples to trigger downsampling
+std::string make_test_sam()
+{
+    std::ostringstream result {};
+    result << "@HD\tVN:1.6\tSO:coordinate\n"
+           << "@SQ\tSN:1\tLN:2000\n";
+    for (const auto& sample : samples) {
+        result << "@RG\tID:" << sample << "\tSM:" << sample << "\n";
+    }
+    const std::string bases {"ACGTTGCAacgtAACCGGTTACGTACGTAGCTAGCTAGGATCCATGCATGCA"};
+    const std::vector<int> mapping_qualities {60, 0, 15, 40, 25};
+    int read_idx {0};
+    for (int pos {100}; pos < 900; pos += 7) {
+        for (std::size_t s {0}; s < samples.size(); ++s) {
+            const auto depth = 1 + static_cast<int>(s) * (pos % 3);
+            for (int d {0}; d < depth; ++d, ++read_idx) {
+                const auto flag = (read_idx % 2 == 0 ? 0 : 16) | (read_idx % 11 == 0 ? 1024 : 0);
+                const auto mapping_quality = mapping_qualities[read_idx % mapping_qualities.size()];
+                std::string qualities(read_length, static_cast<char>('!' + (read_idx % 13 == 0 ? 5 : 45)));
+                result << "r" << read_idx << "\t" << flag << "\t1\t" << pos << "\t" << mapping_quality << "\t"
+                       << read_length << "M\t*\t0\t0\t" << bases.substr(read_idx % 3, read_length) << "\t" << qualities
+                       << "\tRG:Z:" << samples[s] << "\n";
+            }
+        }
+    }
+    return result.str();
+}
+
+// An indexed BAM file in a fresh directory
+struct TestBam
+{
+    TempDirectory directory;
+    fs::path path;
+
+    TestBam()
+    : directory {}
+    , path {directory.path() / "reads.bam"}
+    {
+        const auto sam_path = directory.write("reads.sam", make_test_sam());
+        auto in = sam_open(sam_path.c_str(), "r");
+        if (in == nullptr) throw std::runtime_error {"could not open " + sam_path.string()};
+        auto header = sam_hdr_read(in);
+        auto out = sam_open(path.c_str(), "wb");
+        if (header == nullptr || out == nullptr || sam_hdr_write(out, header) < 0) {
+            throw std::runtime_error {"could not write " + path.string()};
+        }
+        auto record = bam_init1();
+        while (sam_read1(in, header, record) >= 0) sam_write1(out, header, record);
+        bam_destroy1(record);
+        bam_hdr_destroy(header);
+        hts_close(out);
+        hts_close(in);
+        if (sam_index_build(path.c_str(), 0) < 0) throw std::runtime_error {"could not index " + path.string()};
+    }
+};
+
+ReadPipe make_read_pipe(const ReadManager& source)
+{
+    using namespace octopus::readpipe;
+    ReadPipe::ReadTransformer transformer {};
+    transformer.add(CapitaliseBases {});
+    transformer.add(CapBaseQualities {40});
+    ReadPipe::ReadFilterer filterer {};
+    filterer.add(std::make_unique<IsGoodMappingQuality>(20));
+    filterer.add(std::make_unique<HasSufficientGoodQualityBases>(20, 20));
+    filterer.add(std::make_unique<IsNotMarkedDuplicate>());
+    filterer.add(std::make_unique<IsNotDuplicate<ReadPipe::ReadFilterer::ReadIterator, FivePrimeAndCigarDuplicateDefinition>>());
+    return ReadPipe {source, std::move(transformer), std::move(filterer), Downsampler {6, 4}, samples};
+}
+
+struct FetchResult
+{
+    ReadMap reads;
+    ReadPipe::Report report;
+};
+
+FetchResult fetch(const ReadPipe& pipe)
+{
+    FetchResult result {};
+    result.reads = pipe.fetch_reads(fetch_region, result.report);
+    return result;
+}
+
+template <typename Map>
+std::vector<SampleName> sorted_keys(const Map& map)
+{
+    std::vector<SampleName> result {};
+    std::transform(std::cbegin(map), std::cend(map), std::back_inserter(result), [] (const auto& p) { return p.first; });
+    std::sort(std::begin(result), std::end(result));
+    return result;
+}
+
+void check_equal(const FetchResult& serial, const FetchResult& parallel)
+{
+    BOOST_REQUIRE(sorted_keys(serial.reads) == sorted_keys(parallel.reads));
+    for (const auto& sample : samples) {
+        BOOST_TEST_CONTEXT("sample " << sample) {
+            const auto& serial_reads = serial.reads.at(sample);
+            const auto& parallel_reads = parallel.reads.at(sample);
+            BOOST_CHECK(!serial_reads.empty());
+            BOOST_CHECK_EQUAL(serial_reads.size(), parallel_reads.size());
+            BOOST_CHECK(std::equal(std::cbegin(serial_reads), std::cend(serial_reads),
+                                   std::cbegin(parallel_reads), std::cend(parallel_reads)));
+            BOOST_CHECK(serial.report.raw_depths.at(sample).get(fetch_region) == parallel.report.raw_depths.at(sample).get(fetch_region));
+            BOOST_CHECK(serial.report.mapping_quality_zero_depths.at(sample).get(fetch_region)
+                        == parallel.report.mapping_quality_zero_depths.at(sample).get(fetch_region));
+        }
+    }
+    BOOST_REQUIRE(sorted_keys(serial.report.downsample_report) == sorted_keys(parallel.report.downsample_report));
+    for (const auto& p : serial.report.downsample_report) {
+        const auto& serial_regions = p.second.downsampled_regions;
+        const auto& parallel_regions = parallel.report.downsample_report.at(p.first).downsampled_regions;
+        BOOST_CHECK_EQUAL(serial_regions.size(), parallel_regions.size());
+        BOOST_CHECK(std::equal(std::cbegin(serial_regions), std::cend(serial_regions),
+                               std::cbegin(parallel_regions), std::cend(parallel_regions),
+                               [] (const auto& lhs, const auto& rhs) {
+                                   return lhs.mapped_region() == rhs.mapped_region() && lhs.num_reads() == rhs.num_reads();
+                               }));
+    }
+}
+
+} // namespace
 
-BOOST_AUTO_TEST_SUITE(Components)
-BOOST_AUTO_TEST_SUITE(IO)
+BOOST_AUTO_TEST_CASE(parallel_fetch_merges_samples_like_serial_fetch)
+{
+    set_thread_budget(4);
+    const TestBam bam {};
+    const ReadManager source {bam.path};
+    BOOST_REQUIRE_EQUAL(source.num_samples(), samples.size());
+    const auto pipe = make_read_pipe(source);
+    FetchResult serial {};
+    {
+        // With the whole budget leased there are no helpers, so every sample is processed on this thread
+        const HelperThreads budget_holder {get_thread_budget()};
+        serial = fetch(pipe);
+    }
+    BOOST_REQUIRE(!HelperThreads {1}.empty());
+    const auto parallel = fetch(pipe);
+    check_equal(serial, parallel);
+    BOOST_CHECK(!serial.report.downsample_report.empty());
+    // Repeated parallel fetches give the same result however the helpers are scheduled
+    for (int i {0}; i < 5; ++i) check_equal(serial, fetch(pipe));
+}
 
-// TODO
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
 
-BOOST_AUTO_TEST_SUITE_END() // IO
-BOOST_AUTO_TEST_SUITE_END() // Components
+} // namespace test
+} // namespace octopus
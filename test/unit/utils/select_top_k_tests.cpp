@@ -0,0 +1,120 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <random>
+#include <cstddef>
+
+#include "utils/select_top_k.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(select_top_k)
+
+namespace {
+
+void enumerate_multisets(const std::size_t num_values, const std::size_t size, IndexTuple& curr, IndexTupleVector& result)
+{
+    if (curr.size() == size) {
+        result.push_back(curr);
+        return;
+    }
+    for (Index idx {curr.empty() ? 0 : curr.back()}; idx < num_values; ++idx) {
+        curr.push_back(idx);
+        enumerate_multisets(num_values, size, curr, result);
+        curr.pop_back();
+    }
+}
+
+IndexTupleVector enumerate_multisets(const std::size_t num_values, const std::size_t size)
+{
+    IndexTupleVector result {};
+    IndexTuple curr {};
+    enumerate_multisets(num_values, size, curr, result);
+    return result;
+}
+
+template <typename T>
+T score(const IndexTuple& multiset, const std::vector<T>& values)
+{
+    return std::accumulate(std::cbegin(multiset), std::cend(multiset), T {0},
+                           [&] (const T curr, const Index idx) { return curr + values[idx]; });
+}
+
+template <typename T>
+void check_against_brute_force(const std::vector<T>& values, const std::size_t size, const std::size_t k)
+{
+    const auto all_multisets = enumerate_multisets(values.size(), size);
+    std::vector<T> all_scores(all_multisets.size());
+    std::transform(std::cbegin(all_multisets), std::cend(all_multisets), std::begin(all_scores),
+                   [&] (const auto& multiset) { return score(multiset, values); });
+    std::sort(std::begin(all_scores), std::end(all_scores), std::greater<> {});
+    const auto top_k = select_top_k_multisets(values, size, k);
+    BOOST_REQUIRE_EQUAL(top_k.size(), std::min(k, all_multisets.size()));
+    std::set<IndexTuple> seen {};
+    for (std::size_t i {0}; i < top_k.size(); ++i) {
+        auto multiset = top_k[i];
+        BOOST_REQUIRE_EQUAL(multiset.size(), size);
+        BOOST_CHECK(std::all_of(std::cbegin(multiset), std::cend(multiset), [&] (Index idx) { return idx < values.size(); }));
+        std::sort(std::begin(multiset), std::end(multiset));
+        BOOST_CHECK(seen.insert(multiset).second);
+        // Ties may be broken differently, but the scores must be the k best
+        BOOST_CHECK_CLOSE(score(multiset, values), all_scores[i], 1e-9);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(select_top_k_multisets_returns_nothing_for_empty_requests)
+{
+    const std::vector<double> values {-1.0, -2.0, -3.0};
+    BOOST_CHECK(select_top_k_multisets(values, 2, 0).empty());
+    BOOST_CHECK(select_top_k_multisets(values, 0, 5).empty());
+    BOOST_CHECK(select_top_k_multisets(std::vector<double> {}, 2, 5).empty());
+}
+
+BOOST_AUTO_TEST_CASE(select_top_k_multisets_returns_best_multiset_first)
+{
+    const std::vector<double> values {-3.0, -1.0, -2.0};
+    const auto top_k = select_top_k_multisets(values, 3, 1);
+    BOOST_REQUIRE_EQUAL(top_k.size(), 1);
+    BOOST_CHECK(top_k.front() == IndexTuple({1, 1, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(select_top_k_multisets_matches_brute_force_enumeration)
+{
+    std::mt19937 generator {42};
+    std::uniform_real_distribution<double> value_dist {-100.0, 0.0};
+    for (std::size_t num_values {1}; num_values <= 7; ++num_values) {
+        std::vector<double> values(num_values);
+        std::generate(std::begin(values), std::end(values), [&] () { return value_dist(generator); });
+        for (std::size_t size {1}; size <= 4; ++size) {
+            for (const std::size_t k : {1, 2, 5, 17, 100, 1000}) {
+                check_against_brute_force(values, size, k);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(select_top_k_multisets_handles_tied_values)
+{
+    const std::vector<double> values {-1.0, -2.0, -1.0, -2.0, -1.0};
+    for (std::size_t size {1}; size <= 4; ++size) {
+        for (const std::size_t k : {1, 3, 10, 50, 200}) {
+            check_against_brute_force(values, size, k);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,184 @@
+// Copyright (c) 2015-2020 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <limits>
+#include <cstddef>
+#include <cmath>
+
+#include "utils/maths.hpp"
+#include "utils/simd_log_sum_exp.hpp"
+
+namespace octopus { namespace test {
+
+namespace simd = octopus::maths::simd;
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(maths)
+
+namespace {
+
+// sum_log_sum_exp sums 8 columns of doubles per iteration with AVX (two 4-wide vectors) and 4 with SSE2
+// (two 2-wide vectors). These lengths cover no full iteration, exact iterations, and 1 to 7 columns left over.
+const std::vector<std::size_t> test_lengths {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100};
+
+// Genotype ploidies, plus a larger mixture
+const std::vector<std::size_t> test_num_rows {1, 2, 3, 4, 5, 8};
+
+using Matrix = std::vector<std::vector<double>>;
+
+Matrix make_log_matrix(const std::size_t k, const std::size_t n, const double offset, const double range,
+                       const double inf_frequency, std::mt19937& generator)
+{
+    std::uniform_real_distribution<double> value_dist {offset - range, offset};
+    std::bernoulli_distribution inf_dist {inf_frequency};
+    Matrix result(k, std::vector<double>(n));
+    for (auto& row : result) {
+        std::generate(std::begin(row), std::end(row), [&] () { return value_dist(generator); });
+    }
+    // Any row but the first may be -inf, so every column keeps a finite value
+    for (std::size_t j {1}; j < k; ++j) {
+        for (auto& x : result[j]) {
+            if (inf_dist(generator)) x = -std::numeric_limits<double>::infinity();
+        }
+    }
+    return result;
+}
+
+// ln(copies) weights, as used for genotypes with repeated haplotypes
+std::vector<double> make_offsets(const std::size_t k, std::mt19937& generator)
+{
+    std::uniform_int_distribution<unsigned> copies_dist {1, 3};
+    std::vector<double> result(k);
+    std::generate(std::begin(result), std::end(result), [&] () { return std::log(copies_dist(generator)); });
+    return result;
+}
+
+double sum_log_sum_exp_double(const Matrix& logs, const std::vector<double>& offsets)
+{
+    const auto k = logs.size(), n = logs.front().size();
+    std::vector<double> column(k);
+    double result {0};
+    for (std::size_t i {0}; i < n; ++i) {
+        for (std::size_t j {0}; j < k; ++j) column[j] = logs[j][i] + offsets[j];
+        result += octopus::maths::log_sum_exp(column);
+    }
+    return result;
+}
+
+void check_sum_log_sum_exp(const double offset, const double range, const double inf_frequency)
+{
+    std::mt19937 generator {42};
+    for (const auto k : test_num_rows) {
+        for (const auto n : test_lengths) {
+            const auto logs = make_log_matrix(k, n, offset, range, inf_frequency, generator);
+            const auto offsets = make_offsets(k, generator);
+            std::vector<const double*> rows(k);
+            std::transform(std::cbegin(logs), std::cend(logs), std::begin(rows), [] (const auto& row) { return row.data(); });
+            const auto expected = sum_log_sum_exp_double(logs, offsets);
+            const auto result = simd::sum_log_sum_exp(rows.data(), offsets.data(), k, n);
+            BOOST_TEST_CONTEXT("k = " << k << ", n = " << n) {
+                BOOST_REQUIRE(std::isfinite(result));
+                BOOST_CHECK_SMALL(result - expected, 1e-6 * n);
+            }
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(sum_log_sum_exp_matches_double_log_sum_exp)
+{
+    check_sum_log_sum_exp(0, 20, 0);
+    check_sum_log_sum_exp(0, 1e-6, 0); // all terms nearly equal
+}
+
+BOOST_AUTO_TEST_CASE(sum_log_sum_exp_handles_extreme_inputs)
+{
+    check_sum_log_sum_exp(-1e4, 30, 0);
+    check_sum_log_sum_exp(-700, 1e3, 0); // most terms underflow
+    check_sum_log_sum_exp(0, 1e3, 0);
+}
+
+BOOST_AUTO_TEST_CASE(sum_log_sum_exp_handles_negative_infinity)
+{
+    check_sum_log_sum_exp(0, 20, 0.3);
+    check_sum_log_sum_exp(-1e4, 30, 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(sum_log_sum_exp_fixed_size_matches_dynamic_size)
+{
+    std::mt19937 generator {42};
+    for (const auto n : test_lengths) {
+        const auto logs = make_log_matrix(2, n, 0, 20, 0.2, generator);
+        const std::array<const double*, 2> rows {logs[0].data(), logs[1].data()};
+        const std::array<double, 2> offsets {0, std::log(2)};
+        BOOST_CHECK_EQUAL(simd::sum_log_sum_exp(rows, offsets, n), simd::sum_log_sum_exp(rows.data(), offsets.data(), 2, n));
+    }
+}
+
+#if defined(__AVX2__)
+
+namespace {
+
+template <typename F>
+std::array<float, 8> apply(F f, const std::array<float, 8>& x)
+{
+    std::array<float, 8> result;
+    _mm256_storeu_ps(result.data(), f(_mm256_loadu_ps(x.data())));
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(avx_exp_matches_std_exp)
+{
+    const std::vector<std::array<float, 8>> inputs {
+        {0.0f, -1e-8f, -1e-3f, -0.5f, -0.6931472f, -1.0f, -2.5f, -10.0f},
+        {-20.0f, -33.3f, -50.0f, -70.0f, -80.0f, -86.0f, -86.9f, -87.0f}
+    };
+    for (const auto& x : inputs) {
+        const auto result = apply([] (__m256 v) { return simd::detail::exp(v); }, x);
+        for (std::size_t i {0}; i < x.size(); ++i) {
+            BOOST_CHECK_CLOSE_FRACTION(double {result[i]}, std::exp(double {x[i]}), 1e-6);
+        }
+    }
+    // Inputs below the clamp, including -inf, give a tiny positive value rather than NaN
+    const auto inf = std::numeric_limits<float>::infinity();
+    const auto clamped = apply([] (__m256 v) { return simd::detail::exp(v); },
+                               {-87.5f, -100.0f, -1e4f, -1e30f, -inf, -inf, -88.0f, -1e3f});
+    for (const auto value : clamped) {
+        BOOST_CHECK(std::isfinite(value));
+        BOOST_CHECK_GE(value, 0.0f);
+        BOOST_CHECK_LE(value, 1e-37f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(avx_log_matches_std_log)
+{
+    // Column sums of k terms in (0, 1] where one term is 1 lie in [1, k]
+    const std::vector<std::array<float, 8>> inputs {
+        {1.0f, 1.0000001f, 1.001f, 1.25f, 1.4142135f, 1.4142137f, 1.5f, 1.9999999f},
+        {2.0f, 2.5f, 2.828427f, 3.0f, 3.9999998f, 4.0f, 5.0f, 8.0f}
+    };
+    for (const auto& x : inputs) {
+        const auto result = apply([] (__m256 v) { return simd::detail::log(v); }, x);
+        for (std::size_t i {0}; i < x.size(); ++i) {
+            BOOST_CHECK_SMALL(result[i] - std::log(double {x[i]}), 1e-6);
+        }
+    }
+}
+
+#endif // __AVX2__
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus